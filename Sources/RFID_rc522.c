@@ -39,6 +39,10 @@
 //      - SDA          | Connect to J99-6 (SS0)                          -
 //      ------------------------------------------------------------------
 //
+//    Up to two more modules can hang off SPI1 and SPI2 (see readers.h).
+//    Each module is driven through an RC522_READER_t set up by
+//    rc522_reader_init(), which picks the SPI port and slave select.
+//
 //    Serial Peripheral Interface timing requirements for MFRC522 (from
 //    NXP Semiconductors MFRC522 data sheet)
 //      - The SPI clock must idle low (CPOL=0).
@@ -67,6 +71,8 @@
 #include "main_asm.h"               // interface to the assembly module
 #include "csc202_lab_support.h"     // include CSC202 Support
 #include "RFID_rc522.h"             // include CSC202 Support
+#include "idle.h"                   // sleep_ms()
+#include "perf.h"                   // PERF_ENTER(), PERF_EXIT()
 
 #define LCD_LINE_2_ADDR 0x40
 
@@ -75,12 +81,52 @@
 //                        Define symbolic constants
 //-----------------------------------------------------------------------------
 
+// Polls of ComIrqReg before giving up on a command, ~150 ms. The RC522
+// timer ends a command with no answer well before this (TimerIRq); this
+// only catches a reader that stopped answering the SPI.
+#define RC522_POLL_LIMIT        2000
+
+// ISO/IEC 14443-3 CRC_A
+#define CRC_A_INITIAL           0x6363
+
 
 
 //-----------------------------------------------------------------------------
 //                        Define types constants
 //-----------------------------------------------------------------------------
 
+// A card answers REQA, ANTICOLL and SELECT within ~100 us and sends
+// nothing back for HLTA, so those get 1-2 ms. AUTH, READ and WRITE wait
+// on the card's own processing (a write takes up to ~10 ms).
+const RC522_PROFILE_t rc522_default_profile =
+  {
+    {
+      1000,             // RC522_TIMEOUT_REQA
+      2000,             // RC522_TIMEOUT_ANTICOLL
+      2000,             // RC522_TIMEOUT_SELECT
+      10000,            // RC522_TIMEOUT_AUTH
+      5000,             // RC522_TIMEOUT_READ
+      25000,            // RC522_TIMEOUT_WRITE
+      1000              // RC522_TIMEOUT_HALT
+    },
+    RC522_RX_GAIN_33DB
+  };
+
+// For cards read through a thick enclosure
+const RC522_PROFILE_t rc522_max_gain_profile =
+  {
+    {
+      1000,             // RC522_TIMEOUT_REQA
+      2000,             // RC522_TIMEOUT_ANTICOLL
+      2000,             // RC522_TIMEOUT_SELECT
+      10000,            // RC522_TIMEOUT_AUTH
+      5000,             // RC522_TIMEOUT_READ
+      25000,            // RC522_TIMEOUT_WRITE
+      1000              // RC522_TIMEOUT_HALT
+    },
+    RC522_RX_GAIN_48DB
+  };
+
 char *PICC_TYPE_STRING[] =
   {
     "PICC_TYPE_NOT_COMPLETE",
@@ -97,11 +143,82 @@ char *PICC_TYPE_STRING[] =
 
 
 
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+static void rc522_write_fifo(RC522_READER_t* reader, const uint8* data, uint8 length);
+static void rc522_read_fifo(RC522_READER_t* reader, uint8* data, uint8 length);
+
+
 //-----------------------------------------------------------------------------
 //                               Public functions
 //-----------------------------------------------------------------------------
 
 
+//----------------------------------------------------------------------------
+// NAME: rc522_reader_init
+//
+// DESCRIPTION:
+//    This function binds a reader handle to the SPI port its RC522 is
+//    wired to and sets the port up. Call rc522_init() next.
+//
+// INPUT:
+//   reader - the handle to set up
+//   port   - RC522_SPI0, RC522_SPI1 or RC522_SPI2
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void rc522_reader_init(RC522_READER_t* reader, uint8 port)
+{
+
+  switch (port)
+  {
+    case RC522_SPI1:
+    {
+      reader->send     = send_SPI1;
+      reader->select   = SS1_LO;
+      reader->deselect = SS1_HI;
+      SPI1_init();
+      break;
+    } /* case */
+
+    case RC522_SPI2:
+    {
+      reader->send     = send_SPI2;
+      reader->select   = SS2_LO;
+      reader->deselect = SS2_HI;
+      SPI2_init();
+      break;
+    } /* case */
+
+    default:
+    {
+      port = RC522_SPI0;
+      reader->send     = send_SPI0;
+      reader->select   = SS0_LO;
+      reader->deselect = SS0_HI;
+      SPI0_init();
+      break;
+    } /* default */
+
+  } /* switch */
+
+  reader->deselect();
+  reader->port = port;
+  reader->command = RC522_IDLE_CMD;
+  reader->profile = &rc522_default_profile;
+  reader->timeout = RC522_TIMEOUTS;
+  reader->card = FALSE;
+  reader->session = 0;
+  reader->authenticated = FALSE;
+
+} /* rc522_reader_init */
+
+
 //----------------------------------------------------------------------------
 // NAME: rc522_get_firmware_version
 //
@@ -109,7 +226,7 @@ char *PICC_TYPE_STRING[] =
 //    This function returns the firmware version for the module.
 //
 // INPUT:
-//   none
+//   reader - the reader to use
 //
 // OUTPUT:
 //   none
@@ -117,10 +234,10 @@ char *PICC_TYPE_STRING[] =
 // RETURN:
 //   an uint8 data value that represents the firmware version of the module.
 //----------------------------------------------------------------------------
-uint8 rc522_get_firmware_version(void)
+uint8 rc522_get_firmware_version(RC522_READER_t* reader)
 {
 
-  return (rc522_read_reg(VERSION_REG));
+  return (rc522_read_reg(reader, VERSION_REG));
 
 } /* rc522_get_firmware_version */
 
@@ -132,7 +249,7 @@ uint8 rc522_get_firmware_version(void)
 //    This function resets the RFID-RC522 module.
 //
 // INPUT:
-//   none
+//   reader - the reader to use
 //
 // OUTPUT:
 //   none
@@ -140,10 +257,11 @@ uint8 rc522_get_firmware_version(void)
 // RETURN:
 //   none
 //----------------------------------------------------------------------------
-void rc522_soft_reset(void)
+void rc522_soft_reset(RC522_READER_t* reader)
 {
 
-  rc522_write_reg(COMMAND_REG, RC522_RESET_CMD);
+  rc522_write_reg(reader, COMMAND_REG, RC522_RESET_CMD);
+  reader->timeout = RC522_TIMEOUTS;     // TReloadReg is back to 0
 
 } /* rc522_reset */
 
@@ -159,6 +277,7 @@ void rc522_soft_reset(void)
 //    and protocol initialization procedures (Part 3).
 //
 // INPUT:
+//   reader    - the reader to use
 //   card_type - a uint8 that represents the ASIC letters A or B
 //
 // OUTPUT:
@@ -167,52 +286,211 @@ void rc522_soft_reset(void)
 // RETURN:
 //   a sint8 data value 0 means Success
 //----------------------------------------------------------------------------
-uint8 rc522_init(uint8 card_type)
+uint8 rc522_init(RC522_READER_t* reader, uint8 card_type)
 {
   uint8 data;
   uint8 status = MI_OK;
 
-  rc522_soft_reset();
+  rc522_soft_reset(reader);
 
-  ms_delay(200);
+  sleep_ms(200);
 
-  rc522_write_reg(T_PRESCALER_REG, 0x3E);
+  rc522_write_reg(reader, T_PRESCALER_REG, RC522_TIMER_PRESCALER);
 
-  data = rc522_read_reg(T_PRESCALER_REG);
+  data = rc522_read_reg(reader, T_PRESCALER_REG);
+  reader->version = rc522_get_firmware_version(reader);
 
-  // do a quick sanity check to ensure RFID reader is present
-  if (data != 0x3E)
+  // do a quick sanity check to ensure RFID reader is present; a missing
+  // reader reads all 0s or all 1s
+  if ((data != RC522_TIMER_PRESCALER) ||
+      (reader->version == 0x00) || (reader->version == 0xFF))
   {
     status = MI_ERR;
   } /* if */
 
-  rc522_write_reg(T_MODE_REG, 0x8D);
-  rc522_write_reg(T_PRESCALER_REG, 0x3E);
-  rc522_write_reg(T_RELOAD_REG_L, 30);
-  rc522_write_reg(T_RELOAD_REG_H, 0);
-  rc522_write_reg(TX_ASK_REG, 0x40);
-  rc522_write_reg(MODE_REG, 0x3D);
+  rc522_write_reg(reader, T_MODE_REG, RC522_TIMER_MODE);
+  rc522_write_reg(reader, TX_ASK_REG, 0x40);
+  rc522_write_reg(reader, MODE_REG, 0x3D);
 
   // Card Type A requires a slightly differt configuration
   if (card_type == 'A')
   {
-    rc522_clear_bitmask(STATUS2_REG, 0x08);
-    rc522_write_reg(MODE_REG, 0x3D);
-    rc522_write_reg(RX_SEL_REG, 0x86);
-    rc522_write_reg(RF_CFG_REG, 0x7F);
-    rc522_write_reg(T_RELOAD_REG_L, 30);
-    rc522_write_reg(T_RELOAD_REG_H, 0);
-    rc522_write_reg(T_MODE_REG, 0x8D);
-    rc522_write_reg(T_PRESCALER_REG, 0x3E);
+    rc522_clear_bitmask(reader, STATUS2_REG, 0x08);
+    rc522_write_reg(reader, RX_SEL_REG, 0x86);
+    rc522_set_profile(reader, &rc522_max_gain_profile);
   } /* if */
+  else
+  {
+    rc522_set_profile(reader, &rc522_default_profile);
+  } /* else */
 
-  rc522_antenna_on();
+  rc522_antenna_on(reader);
 
   return (status);
 
 } /* rc522_init */
 
 
+//----------------------------------------------------------------------------
+// NAME: rc522_set_profile
+//
+// DESCRIPTION:
+//    This function makes a reader use a timeout and gain profile. The
+//    profile is not copied and must stay in place.
+//
+// INPUT:
+//   reader  - the reader to use
+//   profile - the timeouts and receiver gain
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void rc522_set_profile(RC522_READER_t* reader, const RC522_PROFILE_t* profile)
+{
+
+  reader->profile = profile;
+  reader->timeout = RC522_TIMEOUTS;     // reload the timer on next use
+
+  rc522_write_reg(reader, RF_CFG_REG, profile->rx_gain & RC522_RX_GAIN_MASK);
+
+} /* rc522_set_profile */
+
+
+//----------------------------------------------------------------------------
+// NAME: rc522_set_timeout
+//
+// DESCRIPTION:
+//    This function sets the RC522 timer for the next command from the
+//    reader's profile. The registers are only written when the timeout
+//    differs from the one already set.
+//
+// INPUT:
+//   reader  - the reader to use
+//   timeout - RC522_TIMEOUT_REQA ... RC522_TIMEOUT_HALT
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void rc522_set_timeout(RC522_READER_t* reader, uint8 timeout)
+{
+  uint16 reload;
+
+  if (timeout == reader->timeout)
+  {
+    return;
+  } /* if */
+
+  reload = rc522_timer_reload(reader->profile->timeout_us[timeout]);
+  rc522_write_reg(reader, T_RELOAD_REG_H, (uint8)(reload >> 8));
+  rc522_write_reg(reader, T_RELOAD_REG_L, (uint8)reload);
+  reader->timeout = timeout;
+
+} /* rc522_set_timeout */
+
+
+//----------------------------------------------------------------------------
+// NAME: rc522_timer_reload
+//
+// DESCRIPTION:
+//    This function works out the TReloadReg value for a timeout. The timer
+//    runs for TReload + 1 ticks, rounded up here to whole ticks.
+//
+// INPUT:
+//   timeout_us - the timeout in microseconds
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the reload value
+//----------------------------------------------------------------------------
+uint16 rc522_timer_reload(uint16 timeout_us)
+{
+  uint16 ticks = timeout_us / RC522_TIMER_TICK_US;
+
+  if ((timeout_us % RC522_TIMER_TICK_US) != 0)
+  {
+    ticks++;
+  } /* if */
+
+  if (ticks == 0)
+  {
+    ticks = 1;
+  } /* if */
+
+  return (ticks - 1);
+
+} /* rc522_timer_reload */
+
+
+//----------------------------------------------------------------------------
+// NAME: rc522_check
+//
+// DESCRIPTION:
+//    This function reads back registers that only change if the reader
+//    was reset or the SPI link is bad: the version read by rc522_init(),
+//    the timer set up and the receiver gain. A failure is counted.
+//
+// INPUT:
+//   reader - the reader to use
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if the reader still holds its set up
+//----------------------------------------------------------------------------
+bool rc522_check(RC522_READER_t* reader)
+{
+
+  if ((rc522_read_reg(reader, VERSION_REG) == reader->version) &&
+      (rc522_read_reg(reader, T_PRESCALER_REG) == RC522_TIMER_PRESCALER) &&
+      (rc522_read_reg(reader, T_MODE_REG) == RC522_TIMER_MODE) &&
+      ((rc522_read_reg(reader, RF_CFG_REG) & RC522_RX_GAIN_MASK) ==
+       (reader->profile->rx_gain & RC522_RX_GAIN_MASK)))
+  {
+    return (TRUE);
+  } /* if */
+
+  rc522_count(&reader->stats.check_failures);
+
+  return (FALSE);
+
+} /* rc522_check */
+
+
+//----------------------------------------------------------------------------
+// NAME: rc522_count
+//
+// DESCRIPTION:
+//    This function adds one to a statistics counter, stopping at 0xFFFF.
+//
+// INPUT:
+//   counter - the counter
+//
+// OUTPUT:
+//   counter - the counter plus one
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void rc522_count(uint16* counter)
+{
+
+  if (*counter != 0xFFFF)
+  {
+    (*counter)++;
+  } /* if */
+
+} /* rc522_count */
+
+
 //----------------------------------------------------------------------------
 // NAME: rc522_read_reg
 //
@@ -220,6 +498,7 @@ uint8 rc522_init(uint8 card_type)
 //    This function reads a single register in the MFRC522 chip.
 //
 // INPUT:
+//   reader - the reader to use
 //   reg    - This parameter is a uint8 value that represents the register
 //            address to read from
 //   value  - This parameter is a uint8 value that represents the data value
@@ -231,15 +510,15 @@ uint8 rc522_init(uint8 card_type)
 // RETURN:
 //   an uint8 data value to read into the register
 //----------------------------------------------------------------------------
-uint8 rc522_read_reg(uint8 reg)
+uint8 rc522_read_reg(RC522_READER_t* reader, uint8 reg)
 {
   uint8 data;
 
   // rc522 requires SS to remain low for entire burst transfer
-  SS0_LO();
-  (void)send_SPI0((reg << 1 & 0xFE) | 0x80);
-  data = send_SPI0(0x00);
-  SS0_HI();
+  reader->select();
+  (void)reader->send((reg << 1 & 0xFE) | 0x80);
+  data = reader->send(0x00);
+  reader->deselect();
 
   return data;
 
@@ -253,6 +532,7 @@ uint8 rc522_read_reg(uint8 reg)
 //    This function write single register in the MFRC522 chip.
 //
 // INPUT:
+//   reader - the reader to use
 //   reg    - This parameter is a uint8 value that represents the register
 //            address write to
 //   value  - This parameter is a uint8 value that represents the data value
@@ -264,14 +544,14 @@ uint8 rc522_read_reg(uint8 reg)
 // RETURN:
 //   none
 //----------------------------------------------------------------------------
-void rc522_write_reg(uint8 reg, uint8 value)
+void rc522_write_reg(RC522_READER_t* reader, uint8 reg, uint8 value)
 {
 
   // rc522 requires SS to remain low for entire burst transfer
-  SS0_LO();
-  (void)send_SPI0((reg << 1) & 0x7E);
-  (void)send_SPI0(value);
-  SS0_HI();
+  reader->select();
+  (void)reader->send((reg << 1) & 0x7E);
+  (void)reader->send(value);
+  reader->deselect();
 
 } /* rc522_write_reg */
 
@@ -284,6 +564,7 @@ void rc522_write_reg(uint8 reg, uint8 value)
 //    marked by the bit mask.
 //
 // INPUT:
+//   reader - the reader to use
 //   reg    - This parameter is a uint8 value that represents the register
 //            address to be modified.
 //   mask   - This parameter is a uint8 value that represents the bitmask
@@ -295,15 +576,15 @@ void rc522_write_reg(uint8 reg, uint8 value)
 // RETURN:
 //   none
 //----------------------------------------------------------------------------
-void rc522_set_bitmask(uint8 reg, uint8 mask)
+void rc522_set_bitmask(RC522_READER_t* reader, uint8 reg, uint8 mask)
 {
   uint8 reg_value = 0;
 
-  reg_value = rc522_read_reg(reg);
+  reg_value = rc522_read_reg(reader, reg);
 
   reg_value |= mask;
 
-  rc522_write_reg(reg, reg_value);
+  rc522_write_reg(reader, reg, reg_value);
 
 } /* rc522_set_bitmask */
 
@@ -316,6 +597,7 @@ void rc522_set_bitmask(uint8 reg, uint8 mask)
 //    marked by the bit mask.
 //
 // INPUT:
+//   reader - the reader to use
 //   reg    - This parameter is a uint8 value that represents the register
 //            address to be modified.
 //   mask   - This parameter is a uint8 value that represents the bitmask
@@ -327,15 +609,15 @@ void rc522_set_bitmask(uint8 reg, uint8 mask)
 // RETURN:
 //   none
 //----------------------------------------------------------------------------
-void rc522_clear_bitmask(uint8 reg, uint8 mask)
+void rc522_clear_bitmask(RC522_READER_t* reader, uint8 reg, uint8 mask)
 {
   uint8 reg_value = 0;
 
-  reg_value = rc522_read_reg(reg);
+  reg_value = rc522_read_reg(reader, reg);
 
   reg_value &= ~mask;
 
-  rc522_write_reg(reg, reg_value);
+  rc522_write_reg(reader, reg, reg_value);
 
 } /* rc522_clear_bitmask */
 
@@ -345,9 +627,10 @@ void rc522_clear_bitmask(uint8 reg, uint8 mask)
 //
 // DESCRIPTION:
 //    This function sends command and data to send to the FIFO on RFID-RC522
-//    module.
+//    module. At most RC522_MAX_LEN bytes are read back.
 //
 // INPUT:
+//    reader        - the reader to use
 //    command       - this parameter is a unit8 that defines the RC522
 //                    command to execute
 //    data_to_send  - this is an array of uint8 data that is written to the
@@ -360,135 +643,273 @@ void rc522_clear_bitmask(uint8 reg, uint8 mask)
 //                    is read back from the FIFO after the command was
 //                    executed.
 //    bytes_received- this is the address of a unit16 that defines the number
-//                    of data bytes read from the FIFO.
+//                    of data bits read from the FIFO.
 //
 // RETURN:
 //   status of the operation
 //----------------------------------------------------------------------------
-sint8 rc522_to_card(uint8 command, uint8* data_to_send, uint8 data_length,
+sint8 rc522_to_card(RC522_READER_t* reader, uint8 command, uint8* data_to_send, uint8 data_length,
                       uint8* receive_data, uint16* bytes_received)
 {
-  sint8 status  = MI_ERR;
-  uint8 irqEn   = 0x00;
-  uint8 waitIRq = 0x00;
-  uint8 lastBits;
-  uint8 ird_status_reg;
-  uint8 data_in_fifo;
-  uint8 idx;
-  uint16 timeout_cntr;
+
+  return (rc522_exchange(reader, command, data_to_send, data_length,
+                         receive_data, RC522_MAX_LEN, bytes_received));
+
+} /* rc522_to_card */
+
+
+//----------------------------------------------------------------------------
+// NAME: rc522_exchange
+//
+// DESCRIPTION:
+//    This function runs a command on the RFID-RC522 module and waits for
+//    the answer. The FIFO is filled and emptied in single SPI bursts and
+//    ComIrqReg is polled back to back, so a command takes as long as the
+//    card takes to answer rather than a fixed delay.
+//
+// INPUT:
+//    reader        - the reader to use
+//    command       - the RC522 command to execute
+//    data_to_send  - the data written to the FIFO before the command
+//    data_length   - the number of bytes to write
+//    receive_size  - the size of receive_data
+//
+// OUTPUT:
+//    receive_data  - the data read back from the FIFO, at most
+//                    receive_size bytes
+//    bits_received - the number of bits the card sent
+//
+// RETURN:
+//   status of the operation
+//----------------------------------------------------------------------------
+sint8 rc522_exchange(RC522_READER_t* reader, uint8 command, uint8* data_to_send, uint8 data_length,
+                     uint8* receive_data, uint8 receive_size, uint16* bits_received)
+{
+  sint8  status;
+  uint16 timeout_cntr = RC522_POLL_LIMIT;
+
+  PERF_ENTER(PERF_RC522_EXCHANGE);
+  rc522_command_start(reader, command, data_to_send, data_length);
+
+  do
+  {
+    status = rc522_command_poll(reader, receive_data, receive_size, bits_received);
+    timeout_cntr--;
+  } while ((status == MI_BUSY) && (timeout_cntr != 0));
+
+  if (status == MI_BUSY)
+  {
+    rc522_command_abort(reader);
+    status = MI_ERR;
+  } /* if */
+
+  PERF_EXIT(PERF_RC522_EXCHANGE);
+  return (status);
+
+} /* rc522_exchange */
+
+
+//----------------------------------------------------------------------------
+// NAME: rc522_command_start
+//
+// DESCRIPTION:
+//    This function starts a command on the RFID-RC522 module and returns
+//    without waiting, so other readers can be served while the card
+//    answers. rc522_command_poll() collects the result.
+//
+// INPUT:
+//    reader        - the reader to use
+//    command       - the RC522 command to execute
+//    data_to_send  - the data written to the FIFO before the command
+//    data_length   - the number of bytes to write
+//
+// OUTPUT:
+//    none
+//
+// RETURN:
+//    none
+//----------------------------------------------------------------------------
+void rc522_command_start(RC522_READER_t* reader, uint8 command,
+                         const uint8* data_to_send, uint8 data_length)
+{
 
   switch (command)
   {
     case RC522_AUTHENT_CMD:
     {
-      irqEn   = 0x12;
-      waitIRq = 0x10;
+      reader->irq_enable = 0x12;
+      reader->wait_irq   = 0x10;
       break;
     } /* case */
 
     case RC522_TRANSCEIVE_CMD:
     {
-      irqEn   = 0x77;
-      waitIRq = 0x30;
+      reader->irq_enable = 0x77;
+      reader->wait_irq   = 0x30;
       break;
     } /* case */
 
     default:
+    {
+      reader->irq_enable = 0x00;
+      reader->wait_irq   = 0x00;
       break;
+    } /* default */
 
   } /* switch */
 
-  rc522_write_reg(COM_IEN_REG, irqEn | 0x80);
+  reader->command = command;
 
-  rc522_clear_bitmask(COM_IRQ_REG, 0x80);
-  rc522_set_bitmask(FIFO_LEVEL_REG, 0x80);
+  rc522_write_reg(reader, COM_IEN_REG, reader->irq_enable | 0x80);
 
-  rc522_write_reg(COMMAND_REG, RC522_IDLE_CMD);
+  rc522_clear_bitmask(reader, COM_IRQ_REG, 0x80);
+  rc522_set_bitmask(reader, FIFO_LEVEL_REG, 0x80);
+
+  rc522_write_reg(reader, COMMAND_REG, RC522_IDLE_CMD);
 
   // Writing data to the FIFO
-  for (idx = 0; idx < data_length; idx++)
-  {
-    rc522_write_reg(FIFO_DATA_REG, data_to_send[idx]);
-  } /* for */
+  rc522_write_fifo(reader, data_to_send, data_length);
 
   // Execute the command
-  rc522_write_reg(COMMAND_REG, command);
+  rc522_write_reg(reader, COMMAND_REG, command);
 
   if (command == RC522_TRANSCEIVE_CMD)
   {
     // Set StartSend=1 to transmission of data
-    rc522_set_bitmask(BIT_FRAMING_REG, 0x80);
+    rc522_set_bitmask(reader, BIT_FRAMING_REG, 0x80);
   } /* if */
 
-  // Waiting to receive data to complete
-  timeout_cntr = 2000;
+} /* rc522_command_start */
+
+
+//----------------------------------------------------------------------------
+// NAME: rc522_command_poll
+//
+// DESCRIPTION:
+//    This function checks once whether the command started by
+//    rc522_command_start() has finished, and if so reads back the answer.
+//    A command with no answer is ended by the RC522 timer (TimerIRq).
+//
+// INPUT:
+//    reader        - the reader to use
+//    receive_size  - the size of receive_data
+//
+// OUTPUT:
+//    receive_data  - the data read back from the FIFO, at most
+//                    receive_size bytes
+//    bits_received - the number of bits the card sent
+//
+// RETURN:
+//   MI_BUSY while the command is running, otherwise its status
+//----------------------------------------------------------------------------
+sint8 rc522_command_poll(RC522_READER_t* reader, uint8* receive_data,
+                         uint8 receive_size, uint16* bits_received)
+{
+  sint8 status = MI_ERR;
+  uint8 lastBits;
+  uint8 ird_status_reg;
+  uint8 error_reg;
+  uint8 data_in_fifo;
 
   // CommIrqReg[7..0]
   // Set1 TxIRq RxIRq IdleIRq HiAlerIRq LoAlertIRq ErrIRq TimerIRq
-  do
+  ird_status_reg = rc522_read_reg(reader, COM_IRQ_REG);
+
+  if (!(ird_status_reg & 0x01) && !(ird_status_reg & reader->wait_irq))
   {
-    ms_delay(10);
-    ird_status_reg = rc522_read_reg(COM_IRQ_REG);
-    timeout_cntr--;
-  } while ((timeout_cntr != 0) && !(ird_status_reg & 0x01) && !(ird_status_reg & waitIRq));
+    return (MI_BUSY);
+  } /* if */
 
   // Tranfser to card done so set StartSend=0
-  rc522_clear_bitmask(BIT_FRAMING_REG, 0x80);
+  rc522_clear_bitmask(reader, BIT_FRAMING_REG, 0x80);
+
+  error_reg = rc522_read_reg(reader, ERROR_REG);
+
+  if (reader->timeout < RC522_TIMEOUTS)
+  {
+    rc522_count(&reader->stats.commands[reader->timeout]);
+
+    if (error_reg & 0x1B)
+    {
+      rc522_count(&reader->stats.errors[reader->timeout]);
+    } /* if */
+    else if (ird_status_reg & 0x01)
+    {
+      rc522_count(&reader->stats.no_answer[reader->timeout]);
+    } /* else if */
+  } /* if */
 
-  if (timeout_cntr != 0)
+  if (!(error_reg & 0x1B))
   {
-    if (!(rc522_read_reg(ERROR_REG) & 0x1B))
+    if (ird_status_reg & reader->irq_enable & 0x01)
+    {
+      status = MI_NOTAGERR;
+    } /* if */
+    else
+    {
+      status = MI_OK;
+    } /* else */
+
+    if (reader->command == RC522_TRANSCEIVE_CMD)
     {
-      if (ird_status_reg & irqEn & 0x01)
+      data_in_fifo = rc522_read_reg(reader, FIFO_LEVEL_REG);
+      lastBits = rc522_read_reg(reader, CONTROL_REG) & 0x07;
+
+      if (lastBits)
       {
-        status = MI_NOTAGERR;
+        *bits_received = (data_in_fifo - 1) * 8 + lastBits;
       } /* if */
       else
       {
-        status = MI_OK;
+        *bits_received = data_in_fifo * 8;
       } /* else */
 
-      if (command == RC522_TRANSCEIVE_CMD)
+      if (data_in_fifo == 0)
       {
-        data_in_fifo = rc522_read_reg(FIFO_LEVEL_REG);
-        lastBits = rc522_read_reg(CONTROL_REG) & 0x07;
-
-        if (lastBits)
-        {
-          *bytes_received = (data_in_fifo - 1) * 8 + lastBits;
-        } /* if */
-        else
-        {
-          *bytes_received = data_in_fifo * 8;
-        } /* else */
-
-        if (data_in_fifo == 0)
-        {
-          data_in_fifo = 1;
-        } /* if */
-
-        if (data_in_fifo > RC522_MAX_LEN)
-        {
-          data_in_fifo = RC522_MAX_LEN;
-        } /* if */
-
-        // Reading the received data in FIFO
-        for (idx = 0; idx < data_in_fifo; idx++)
-        {
-          receive_data[idx] = rc522_read_reg(FIFO_DATA_REG);
-        } /* for */
-
-      }  /* if */
-    }  /* if */
+        data_in_fifo = 1;
+      } /* if */
 
-    else
-    {
-      status = MI_ERR;
-    }  /* else */
+      if (data_in_fifo > receive_size)
+      {
+        data_in_fifo = receive_size;
+      } /* if */
+
+      // Reading the received data in FIFO
+      rc522_read_fifo(reader, receive_data, data_in_fifo);
+
+    }  /* if */
   }  /* if */
 
-  return status;
-} /* rc522_to_card */
+  return (status);
+
+} /* rc522_command_poll */
+
+
+//----------------------------------------------------------------------------
+// NAME: rc522_command_abort
+//
+// DESCRIPTION:
+//    This function stops a running command that never ended, and counts
+//    it as stuck.
+//
+// INPUT:
+//    reader - the reader to use
+//
+// OUTPUT:
+//    none
+//
+// RETURN:
+//    none
+//----------------------------------------------------------------------------
+void rc522_command_abort(RC522_READER_t* reader)
+{
+
+  rc522_count(&reader->stats.stuck);
+
+  rc522_write_reg(reader, COMMAND_REG, RC522_IDLE_CMD);
+  rc522_clear_bitmask(reader, BIT_FRAMING_REG, 0x80);
+
+} /* rc522_command_abort */
 
 
 
@@ -499,7 +920,7 @@ sint8 rc522_to_card(uint8 command, uint8* data_to_send, uint8 data_length,
 //    This function checks if a card is present on the RFID-RC522 module.
 //
 // INPUT:
-//   none
+//   reader - the reader to use
 //
 // OUTPUT:
 //   none
@@ -507,16 +928,17 @@ sint8 rc522_to_card(uint8 command, uint8* data_to_send, uint8 data_length,
 // RETURN:
 //   none
 //----------------------------------------------------------------------------
-sint8 rc522_is_card_present(uint8 req_mode, uint8* tag_type)
+sint8 rc522_is_card_present(RC522_READER_t* reader, uint8 req_mode, uint8* tag_type)
 {
   sint8  status = MI_OK;
   uint16 backBits;      //The received data bits
 
-  rc522_write_reg(BIT_FRAMING_REG, 0x07);
+  rc522_write_reg(reader, BIT_FRAMING_REG, 0x07);
+  rc522_set_timeout(reader, RC522_TIMEOUT_REQA);
 
   tag_type[0] = req_mode;
 
-  status = rc522_to_card(RC522_TRANSCEIVE_CMD, tag_type, 1, tag_type, &backBits);
+  status = rc522_to_card(reader, RC522_TRANSCEIVE_CMD, tag_type, 1, tag_type, &backBits);
 
   if (status != MI_OK)
   {
@@ -544,6 +966,7 @@ sint8 rc522_is_card_present(uint8 req_mode, uint8* tag_type)
 //    to avoid waiting indefinitely.
 //
 // INPUT:
+//   reader   - the reader to use
 //   timeout  - this value is a uint16 loop counter to define how many times
 //              the function checks before giving up.//
 // OUTPUT:
@@ -552,7 +975,7 @@ sint8 rc522_is_card_present(uint8 req_mode, uint8* tag_type)
 // RETURN:
 //   If a card is detected, it returns true, otherwise, it returns false
 //----------------------------------------------------------------------------
-bool rc522_wait_for_card_present(uint16 timeout)
+bool rc522_wait_for_card_present(RC522_READER_t* reader, uint16 timeout)
 {
   uint8 data;
   uint8 status = FALSE;
@@ -560,8 +983,8 @@ bool rc522_wait_for_card_present(uint16 timeout)
   while (timeout > 0)
   {
     // sets the StartSend bit to 1, which initiates a data transfer between the RFID reader and the RFID tag.
-    rc522_write_reg(BIT_FRAMING_REG, 0x87);
-    data = rc522_read_reg(COM_IRQ_REG);
+    rc522_write_reg(reader, BIT_FRAMING_REG, 0x87);
+    data = rc522_read_reg(reader, COM_IRQ_REG);
 
     #define IRQ_REG_IDLE_BITMASK            0x00
     #define IRQ_REG_ERR_BITMASK             0x08
@@ -571,13 +994,13 @@ bool rc522_wait_for_card_present(uint16 timeout)
     if (((data & 0x10) == 0x10))// && (data & 0x01) == 0x00))
     {
       // Clear CommIrqReg register
-      rc522_write_reg(COM_IRQ_REG, 0x7F);
+      rc522_write_reg(reader, COM_IRQ_REG, 0x7F);
       status  = TRUE;
       timeout = 0;
     } /* if */
     else
     {
-      ms_delay(5);
+      sleep_ms(5);
       timeout--;
     } /* else */
   } /* while */
@@ -596,6 +1019,7 @@ bool rc522_wait_for_card_present(uint16 timeout)
 //    avoid waiting indefinitely.
 //
 // INPUT:
+//   reader   - the reader to use
 //   timeout  - this value is a uint16 loop counter to define how many times
 //              the function checks before giving up.
 //
@@ -605,18 +1029,18 @@ bool rc522_wait_for_card_present(uint16 timeout)
 // RETURN:
 //   If a card is removed, it returns true, otherwise, it returns false.
 //----------------------------------------------------------------------------
-bool rc522_wait_for_card_removed(uint16 timeout)
+bool rc522_wait_for_card_removed(RC522_READER_t* reader, uint16 timeout)
 {
   uint8 irq_status;
   uint8 removed = FALSE;
 
   // Clear the card present flag
-  rc522_write_reg(BIT_FRAMING_REG, 0x00);
+  rc522_write_reg(reader, BIT_FRAMING_REG, 0x00);
 
   while (timeout > 0 && !removed)
   {
     // Check the IRQ status register for card removal events
-    irq_status = rc522_read_reg(COM_IRQ_REG);
+    irq_status = rc522_read_reg(reader, COM_IRQ_REG);
 
     if ((irq_status & 0x10) && (irq_status & 0x02))
     {
@@ -624,7 +1048,7 @@ bool rc522_wait_for_card_removed(uint16 timeout)
     } /* if */
     else
     {
-      ms_delay(1);
+      sleep_ms(1);
       timeout--;
     } /* else */
 
@@ -641,7 +1065,7 @@ bool rc522_wait_for_card_removed(uint16 timeout)
 //    This function turns on the antenna of the RFID-RC522 module.
 //
 // INPUT:
-//   none
+//   reader - the reader to use
 //
 // OUTPUT:
 //   none
@@ -649,14 +1073,14 @@ bool rc522_wait_for_card_removed(uint16 timeout)
 // RETURN:
 //   none
 //----------------------------------------------------------------------------
-void rc522_antenna_on(void)
+void rc522_antenna_on(RC522_READER_t* reader)
 {
   uint8 reg_value = 0;
 
-  reg_value = rc522_read_reg(TX_CONTROL_REG);
+  reg_value = rc522_read_reg(reader, TX_CONTROL_REG);
   if (!(reg_value & 0x03))
   {
-    rc522_set_bitmask(TX_CONTROL_REG, 0x03);
+    rc522_set_bitmask(reader, TX_CONTROL_REG, 0x03);
   } /* if */
 
 } /* rc522_antenna_on */
@@ -669,7 +1093,7 @@ void rc522_antenna_on(void)
 //    This function turns off the antenna of the RFID-RC522 module.
 //
 // INPUT:
-//   none
+//   reader - the reader to use
 //
 // OUTPUT:
 //   none
@@ -677,10 +1101,10 @@ void rc522_antenna_on(void)
 // RETURN:
 //   none
 //----------------------------------------------------------------------------
-void rc522_antenna_off(void)
+void rc522_antenna_off(RC522_READER_t* reader)
 {
 
-  rc522_clear_bitmask(TX_CONTROL_REG, 0x03);
+  rc522_clear_bitmask(reader, TX_CONTROL_REG, 0x03);
 
 } /* rc522_antenna_off */
 
@@ -693,6 +1117,7 @@ void rc522_antenna_off(void)
 //    module.
 //
 // INPUT:
+//   reader     - the reader to use
 //   serial_num - TBD
 //
 // OUTPUT:
@@ -701,19 +1126,21 @@ void rc522_antenna_off(void)
 // RETURN:
 //   none
 //----------------------------------------------------------------------------
-sint8 MFRC522_Anticoll(uint8* serial_num)
+sint8 MFRC522_Anticoll(RC522_READER_t* reader, uint8* serial_num)
 {
   sint8  status;
   uint8  idx;
   uint8  serial_numCheck = 0;
   uint16 unLen;
 
-  rc522_write_reg(BIT_FRAMING_REG, 0x00);
+  rc522_write_reg(reader, BIT_FRAMING_REG, 0x00);
+  rc522_set_timeout(reader, RC522_TIMEOUT_ANTICOLL);
 
   serial_num[0] = PICC_ANTICOLL;
   serial_num[1] = 0x20;
   
-  status = rc522_to_card(RC522_TRANSCEIVE_CMD, serial_num, 2, serial_num, &unLen);
+  status = rc522_exchange(reader, RC522_TRANSCEIVE_CMD, serial_num, 2, serial_num,
+                          MIFARE_UID_SIZE + 1, &unLen);
 
   if (status == MI_OK)
   {
@@ -726,6 +1153,7 @@ sint8 MFRC522_Anticoll(uint8* serial_num)
     // check sum with last byte
     if (serial_numCheck != serial_num[idx])
     {
+      rc522_count(&reader->stats.bcc_errors);
       status = MI_ERR;
     } /* if */
   } /* if */
@@ -742,6 +1170,7 @@ sint8 MFRC522_Anticoll(uint8* serial_num)
 //    This function initializes the RFID-RC522 module
 //
 // INPUT:
+//   reader    - the reader to use
 //   card_type -
 //
 // OUTPUT:
@@ -750,32 +1179,32 @@ sint8 MFRC522_Anticoll(uint8* serial_num)
 // RETURN:
 //   TBD
 //----------------------------------------------------------------------------
-void rc522_calculate_CRC(uint8* pIndata, uint8 len, uint8* pOutData)
+void rc522_calculate_CRC(RC522_READER_t* reader, uint8* pIndata, uint8 len, uint8* pOutData)
 {
   uint8 i, n;
 
-  rc522_clear_bitmask(DIV_IRQ_REG, 0x04);     //CRCIrq = 0
-  rc522_set_bitmask(FIFO_LEVEL_REG, 0x80);  //Clear the FIFO pointer
+  rc522_clear_bitmask(reader, DIV_IRQ_REG, 0x04);     //CRCIrq = 0
+  rc522_set_bitmask(reader, FIFO_LEVEL_REG, 0x80);  //Clear the FIFO pointer
   //Write_MFRC522(CommandReg, PCD_IDLE);
 
   //Writing data to the FIFO
   for (i = 0; i < len; i++)
   {
-    rc522_write_reg(FIFO_DATA_REG, *(pIndata + i));
+    rc522_write_reg(reader, FIFO_DATA_REG, *(pIndata + i));
   }
-  rc522_write_reg(COMMAND_REG, RC522_CALC_CRC_CMD);
+  rc522_write_reg(reader, COMMAND_REG, RC522_CALC_CRC_CMD);
 
   //Wait CRC calculation is complete
   i = 0xFF;
   do
   {
-    n = rc522_read_reg(DIV_IRQ_REG);
+    n = rc522_read_reg(reader, DIV_IRQ_REG);
     i--;
   } while ((i != 0) && !(n & 0x04));      //CRCIrq = 1
 
   //Read CRC calculation result
-  pOutData[0] = rc522_read_reg(CRC_RESULT_REG_L);
-  pOutData[1] = rc522_read_reg(CRC_RESULT_REG_M);
+  pOutData[0] = rc522_read_reg(reader, CRC_RESULT_REG_L);
+  pOutData[1] = rc522_read_reg(reader, CRC_RESULT_REG_M);
 
 } /* rc522_calculate_CRC */
 
@@ -787,6 +1216,7 @@ void rc522_calculate_CRC(uint8* pIndata, uint8 len, uint8* pOutData)
 //    This function select card and reads card storage volume
 //
 // INPUT:
+//   reader     - the reader to use
 //   serial_num - a uint8 that represents the serial number of the card
 //
 // OUTPUT:
@@ -795,7 +1225,7 @@ void rc522_calculate_CRC(uint8* pIndata, uint8 len, uint8* pOutData)
 // RETURN:
 //   return MI_OK if success
 //----------------------------------------------------------------------------
-uint8 rc522_select_tag(uint8* serial_num)
+uint8 rc522_select_tag(RC522_READER_t* reader, uint8* serial_num)
 {
   uint8  i;
   sint8  status;
@@ -810,8 +1240,9 @@ uint8 rc522_select_tag(uint8* serial_num)
   {
     buffer[i + 2] = *(serial_num + i);
   }
-  rc522_calculate_CRC(buffer, 7, &buffer[7]); //Fill [7:8] with 2byte CRC
-  status = rc522_to_card(RC522_TRANSCEIVE_CMD, buffer, 9, buffer, &data_received);
+  rc522_crc_a(buffer, 7, &buffer[7]); //Fill [7:8] with 2byte CRC
+  rc522_set_timeout(reader, RC522_TIMEOUT_SELECT);
+  status = rc522_to_card(reader, RC522_TRANSCEIVE_CMD, buffer, 9, buffer, &data_received);
 
   if ((status == MI_OK) && (data_received == 0x18))
   {
@@ -928,7 +1359,7 @@ sint16 MFRC522_ParseType(uint8 TagSelectRet)
 //    go to state HALT.
 //
 // INPUT:
-//    none
+//   reader - the reader to use
 //
 // OUTPUT:
 //    none
@@ -936,35 +1367,98 @@ sint16 MFRC522_ParseType(uint8 TagSelectRet)
 // RETURN:
 //    none
 //----------------------------------------------------------------------------
-void rc522_send_halt(void)
+void rc522_send_halt(RC522_READER_t* reader)
 {
-  uint8 status;
-  uint8 unLen;
-  uint8 buff[4]; 
+  uint16 unLen;
+  uint8  buff[4]; 
 
   //ISO14443-3: 6.4.3 HLTA command
   buff[0] = PICC_HALT;
   buff[1] = 0;
   
-  rc522_calculate_CRC(buff, 2, &buff[2]);
+  rc522_crc_a(buff, 2, &buff[2]);
 
-  status = rc522_to_card(RC522_TRANSCEIVE_CMD, buff, 4, buff, &unLen);
+  // The card doesn't answer HLTA, so this always ends on TimerIRq
+  rc522_set_timeout(reader, RC522_TIMEOUT_HALT);
+  (void)rc522_exchange(reader, RC522_TRANSCEIVE_CMD, buff, 4, buff, sizeof(buff), &unLen);
   
 } /* rc522_send_halt */
 
 
 
 
-#if(0)
+//----------------------------------------------------------------------------
+// NAME: rc522_crc_a
+//
+// DESCRIPTION:
+//    This function computes the ISO/IEC 14443-3 CRC_A on the HCS12. It is
+//    quicker than a round trip to the CRC coprocessor for short frames.
+//
+// INPUT:
+//    data    - the bytes to check
+//    length  - the number of bytes
+//
+// OUTPUT:
+//    crc     - the two CRC bytes, low byte first as they are sent
+//
+// RETURN:
+//    none
+//----------------------------------------------------------------------------
+void rc522_crc_a(const uint8* data, uint8 length, uint8* crc)
+{
+  uint16 value = CRC_A_INITIAL;
+  uint8  ch;
+
+  while (length-- > 0)
+  {
+    ch = *data++ ^ (uint8)value;
+    ch ^= (uint8)(ch << 4);
+    value = (value >> 8) ^ ((uint16)ch << 8) ^ ((uint16)ch << 3) ^ (ch >> 4);
+  } /* while */
+
+  crc[0] = (uint8)value;
+  crc[1] = (uint8)(value >> 8);
+
+} /* rc522_crc_a */
+
+
+//----------------------------------------------------------------------------
+// NAME: rc522_stop_crypto1
+//
+// DESCRIPTION:
+//    This function ends an authenticated session. It must be called before
+//    talking to another card, since the RC522 keeps encrypting everything
+//    while Crypto1 is on.
+//
+// INPUT:
+//   reader - the reader to use
+//
+// OUTPUT:
+//    none
+//
+// RETURN:
+//    none
+//----------------------------------------------------------------------------
+void rc522_stop_crypto1(RC522_READER_t* reader)
+{
+
+  rc522_clear_bitmask(reader, STATUS2_REG, STATUS2_CRYPTO1_ON);
+
+} /* rc522_stop_crypto1 */
+
+
 //Source files for reference:
 // https://github.com/londonhackspace/mfrc522-energia/blob/master/examples/RC522DumpMifare/RC522DumpMifare.ino
 //----------------------------------------------------------------------------
 // NAME: MFRC522_Auth
 //
 // DESCRIPTION:
-//    This function verify's the card's password. 
+//    This function verify's the card's password. Once it succeeds every
+//    block of the sector can be read or written until another sector is
+//    authenticated or rc522_stop_crypto1(reader) is called.
 //
 // INPUT:
+//    reader    - the reader to use
 //    authMode  - the a parameter defines the password verify mode
 //                 0x60 = verify A passowrd key 
 //                 0x61 = verify B passowrd key 
@@ -980,7 +1474,7 @@ void rc522_send_halt(void)
 // RETURN:
 //   return MI_OK if successed
 //----------------------------------------------------------------------------
-uint8 MFRC522_Auth(uint8 authMode, uint8 block_address, uint8 *sector_key, uint8 *serial_num)
+uint8 MFRC522_Auth(RC522_READER_t* reader, uint8 authMode, uint8 block_address, uint8 *sector_key, uint8 *serial_num)
 {
   uint8  status;
   uint16 data_received;
@@ -991,19 +1485,20 @@ uint8 MFRC522_Auth(uint8 authMode, uint8 block_address, uint8 *sector_key, uint8
   buff[0] = authMode;
   buff[1] = block_address;
   
-  for (i = 0; i < 6; i++)
+  for (i = 0; i < MIFARE_KEY_SIZE; i++)
   {    
     buff[i+2] = *(sector_key+i);   
   } /* for */
   
-  for (i = 0; i < 4; i++)
+  for (i = 0; i < MIFARE_UID_SIZE; i++)
   {    
     buff[i+8] = *(serial_num+i);   
   } /* for */
   
-  status = rc522_to_card(RC522_AUTHENT_CMD, buff, 12, buff, &data_received);
+  rc522_set_timeout(reader, RC522_TIMEOUT_AUTH);
+  status = rc522_to_card(reader, RC522_AUTHENT_CMD, buff, 12, buff, &data_received);
 
-  if ((status != MI_OK) || (!(rc522_read_reg(STATUS2_REG) & 0x08)))
+  if ((status != MI_OK) || (!(rc522_read_reg(reader, STATUS2_REG) & STATUS2_CRYPTO1_ON)))
   {   
       status = MI_ERR;   
   } /* if */
@@ -1018,34 +1513,46 @@ uint8 MFRC522_Auth(uint8 authMode, uint8 block_address, uint8 *sector_key, uint8
 //
 // DESCRIPTION:
 //    This function reads and returns the data on the RFID tag at a specific 
-//    block address.
+//    block address. The CRC the card sends is checked.
 //
 // INPUT:
+//    reader          - the reader to use
 //    block_address   - this represents the block address on the card to read
 //
 // OUTPUT:
 //    data_received   - this represents address that points to the block 
-//                      data which are read
+//                      data which are read; it must hold 18 bytes (the
+//                      block and its CRC)
 //
 // RETURN:
 //   return MI_OK if successed
 //----------------------------------------------------------------------------
-uint8 MFRC522_Read(uint8 block_address, uint8 *data_received)
+uint8 MFRC522_Read(RC522_READER_t* reader, uint8 block_address, uint8 *data_received)
 {
   uint8  status;
   uint16 unLen;
+  uint8  crc[MIFARE_CRC_SIZE];
 
   data_received[0] = PICC_READ;
   data_received[1] = block_address;
   
-  rc522_calculate_CRC(data_received,2, &data_received[2]);
+  rc522_crc_a(data_received, 2, &data_received[2]);
+  rc522_set_timeout(reader, RC522_TIMEOUT_READ);
   
-  status = rc522_to_card(RC522_TRANSCEIVE_CMD, data_received, 4, data_received, &unLen);
+  status = rc522_exchange(reader, RC522_TRANSCEIVE_CMD, data_received, 4, data_received,
+                          MIFARE_BLOCK_SIZE + MIFARE_CRC_SIZE, &unLen);
 
-  if ((status != MI_OK) || (unLen != 0x90))
+  if ((status != MI_OK) || (unLen != (MIFARE_BLOCK_SIZE + MIFARE_CRC_SIZE) * 8))
+  {
+    return (MI_ERR);
+  } /* if */
+
+  rc522_crc_a(data_received, MIFARE_BLOCK_SIZE, crc);
+  if ((crc[0] != data_received[MIFARE_BLOCK_SIZE]) ||
+      (crc[1] != data_received[MIFARE_BLOCK_SIZE + 1]))
   {
     status = MI_ERR;
-  }
+  } /* if */
   
   return (status);
     
@@ -1059,6 +1566,7 @@ uint8 MFRC522_Read(uint8 block_address, uint8 *data_received)
 //    This function writes data to a specific blcok address on the RFID tag.
 //
 // INPUT:
+//    reader          - the reader to use
 //    block_address   - this represents the block address on the card to read
 //    data_received   - this represents address that points to the block 
 //                      16 bytes of data to write
@@ -1069,21 +1577,22 @@ uint8 MFRC522_Read(uint8 block_address, uint8 *data_received)
 // RETURN:
 //   return MI_OK if successed
 //----------------------------------------------------------------------------
-uint8 MFRC522_Write(uint8 block_address, uint8 *writeData)
+uint8 MFRC522_Write(RC522_READER_t* reader, uint8 block_address, uint8 *writeData)
 {
   uint8  status;
   uint16 data_received;
   uint8  idx;
-  uint8  buff[18]; 
+  uint8  buff[MIFARE_BLOCK_SIZE + MIFARE_CRC_SIZE]; 
   
   buff[0] = PICC_WRITE;
   buff[1] = block_address;
   
-  rc522_calculate_CRC(buff, 2, &buff[2]);
+  rc522_crc_a(buff, 2, &buff[2]);
+  rc522_set_timeout(reader, RC522_TIMEOUT_WRITE);
   
-  status = rc522_to_card(RC522_TRANSCEIVE_CMD, buff, 4, buff, &data_received);
+  status = rc522_to_card(reader, RC522_TRANSCEIVE_CMD, buff, 4, buff, &data_received);
 
-  if ((status != MI_OK) || (data_received != 4) || ((buff[0] & 0x0F) != 0x0A))
+  if ((status != MI_OK) || (data_received != 4) || ((buff[0] & 0x0F) != MIFARE_ACK))
   {   
     status = MI_ERR;   
   } /* if */
@@ -1091,18 +1600,20 @@ uint8 MFRC522_Write(uint8 block_address, uint8 *writeData)
   if (status == MI_OK)
   {
     // Write 16 bytes data into FIFO
-    for (idx = 0; idx < 16; idx++)
+    for (idx = 0; idx < MIFARE_BLOCK_SIZE; idx++)
     {    
       buff[idx] = *(writeData + idx);   
     } /* for */
     
-    rc522_calculate_CRC(buff, 16, &buff[16]);
+    rc522_crc_a(buff, MIFARE_BLOCK_SIZE, &buff[MIFARE_BLOCK_SIZE]);
     
-    status = rc522_to_card(RC522_TRANSCEIVE_CMD, buff, 18, buff, &data_received);
+    status = rc522_to_card(reader, RC522_TRANSCEIVE_CMD, buff, MIFARE_BLOCK_SIZE + MIFARE_CRC_SIZE,
+                           buff, &data_received);
       
-  if ((status != MI_OK) || (data_received != 4) || ((buff[0] & 0x0F) != 0x0A))
-  {   
-    status = MI_ERR;   
+    if ((status != MI_OK) || (data_received != 4) || ((buff[0] & 0x0F) != MIFARE_ACK))
+    {   
+      status = MI_ERR;   
+    } /* if */
   } /* if */
   
   return (status);
@@ -1110,34 +1621,71 @@ uint8 MFRC522_Write(uint8 block_address, uint8 *writeData)
 } /* MFRC522_Write */
 
 
-#if(0)
-void dumpHex(char* buffer, int len)
-{
-  for(byte i=0; i < len; i++) 
-  {
-    char text[4];
-    if (i % 16 == 0) 
-    {
-      Serial.print(" "); 
-    }
-    
-    sprintf(text, "%02X \x00", (byte)(*(buffer + i)));
-    Serial.print(text);
-
-    if (i % 16 == 15) 
-    {
-      Serial.println(""); 
-    } /* if */
-  } /* for */
-    //Serial.println(" "); 
-}
-#endif
-
-#endif
 //-----------------------------------------------------------------------------
 //                             Private functions
 //-----------------------------------------------------------------------------
 
 
+//----------------------------------------------------------------------------
+// NAME: rc522_write_fifo
+//
+// DESCRIPTION:
+//    This function writes bytes to the FIFO in one SPI burst. The RC522
+//    takes every byte after the address as data for the same register.
+//
+// INPUT:
+//    reader  - the reader to use
+//    data    - the bytes to write
+//    length  - the number of bytes
+//
+// OUTPUT:
+//    none
+//
+// RETURN:
+//    none
+//----------------------------------------------------------------------------
+static void rc522_write_fifo(RC522_READER_t* reader, const uint8* data, uint8 length)
+{
+
+  reader->select();
+  (void)reader->send((FIFO_DATA_REG << 1) & 0x7E);
+  while (length-- > 0)
+  {
+    (void)reader->send(*data++);
+  } /* while */
+  reader->deselect();
+
+} /* rc522_write_fifo */
+
+
+//----------------------------------------------------------------------------
+// NAME: rc522_read_fifo
+//
+// DESCRIPTION:
+//    This function reads bytes from the FIFO in one SPI burst. Each byte
+//    out is the address of the next read; a 0 ends the burst.
+//
+// INPUT:
+//    reader  - the reader to use
+//    length  - the number of bytes, at least 1
+//
+// OUTPUT:
+//    data    - the bytes read
+//
+// RETURN:
+//    none
+//----------------------------------------------------------------------------
+static void rc522_read_fifo(RC522_READER_t* reader, uint8* data, uint8 length)
+{
+  uint8 address = ((FIFO_DATA_REG << 1) & 0x7E) | 0x80;
 
+  reader->select();
+  (void)reader->send(address);
+  while (--length > 0)
+  {
+    *data++ = reader->send(address);
+  } /* while */
+  *data = reader->send(0x00);
+  reader->deselect();
 
+} /* rc522_read_fifo */
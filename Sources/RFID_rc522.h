@@ -24,8 +24,13 @@ typedef   signed char       sint8;      // signed 8 bit values
 typedef unsigned char       uint8;      // unsigned 8 bit values
 typedef   signed short int  sint16;     // signed 16 bit values
 typedef unsigned short int  uint16;     // unsigned 16 bit values
+#ifdef HOST_TEST
+typedef   signed int        sint32;     // long is 64 bits on the test host
+typedef unsigned int        uint32;
+#else
 typedef   signed long  int  sint32;     // signed 32 bit values
 typedef unsigned long  int  uint32;     // unsigned 32 bit values
+#endif
 typedef unsigned char       uint8_t;      // unsigned 8 bit values
 //  Floating Point Types
 typedef float  real32;                  // single precision floating values
@@ -74,11 +79,53 @@ typedef unsigned short bool;            // Boolean
 #define MI_OK                   (0)
 #define MI_NOTAGERR             (1)
 #define MI_ERR                  (2)
+#define MI_BUSY                 (3)     // rc522_command_poll(): still running
+
+// SPI ports a reader can be wired to
+#define RC522_SPI0              0
+#define RC522_SPI1              1
+#define RC522_SPI2              2
 
 //Dummy byte
 #define MFRC522_DUMMY            0x00
 #define RC522_MAX_LEN            16
 
+// Mifare Classic sizes
+#define MIFARE_UID_SIZE          4
+#define MIFARE_KEY_SIZE          6
+#define MIFARE_BLOCK_SIZE        16
+#define MIFARE_CRC_SIZE          2
+#define MIFARE_ACK               0x0A    // 4-bit acknowledge
+
+// Status2Reg: Crypto1 is on after a successful authentication
+#define STATUS2_CRYPTO1_ON       0x08
+
+// RC522 timer: TAuto starts it when a frame has been sent and TimerIRq
+// ends the command if the card hasn't answered when it runs out. With
+// a prescaler of 169 it ticks at 13.56 MHz / (2 * 169 + 1) = 40 kHz.
+#define RC522_TIMER_MODE         0x80    // TModeReg: TAuto, prescaler bits 11:8 = 0
+#define RC522_TIMER_PRESCALER    0xA9    // TPrescalerReg: prescaler bits 7:0
+#define RC522_TIMER_TICK_US      25
+
+// Timeout for each kind of card command, see RC522_PROFILE_t
+#define RC522_TIMEOUT_REQA       0
+#define RC522_TIMEOUT_ANTICOLL   1
+#define RC522_TIMEOUT_SELECT     2
+#define RC522_TIMEOUT_AUTH       3
+#define RC522_TIMEOUT_READ       4
+#define RC522_TIMEOUT_WRITE      5
+#define RC522_TIMEOUT_HALT       6
+#define RC522_TIMEOUTS           7
+
+// RFCfgReg receiver gain
+#define RC522_RX_GAIN_18DB       0x00
+#define RC522_RX_GAIN_23DB       0x10
+#define RC522_RX_GAIN_33DB       0x40    // reset value
+#define RC522_RX_GAIN_38DB       0x50
+#define RC522_RX_GAIN_43DB       0x60
+#define RC522_RX_GAIN_48DB       0x70
+#define RC522_RX_GAIN_MASK       0x70
+
 
 // Define the types of PICC (Proximity Integrated Circuit Card): 
 // Basically the PICC is card or tag using the ISO 14443A interface, eg Mifare 
@@ -97,29 +144,94 @@ typedef enum
   PICC_TYPE_UNKNOWN
 } PICC_TYPE_t;
 
+// How long each kind of command may wait for the card, and how much the
+// receiver amplifies its answer. More gain reads cards further from the
+// antenna but picks up more noise.
+typedef struct
+{
+  uint16 timeout_us[RC522_TIMEOUTS];    // RC522_TIMEOUT_xx, up to 65 ms
+  uint8  rx_gain;                       // RC522_RX_GAIN_xx
+} RC522_PROFILE_t;
+
+// Link statistics of one reader. Counters stop at 0xFFFF.
+typedef struct
+{
+  uint16 commands[RC522_TIMEOUTS];      // card commands sent, by RC522_TIMEOUT_xx
+  uint16 no_answer[RC522_TIMEOUTS];     // ended by TimerIRq
+  uint16 errors[RC522_TIMEOUTS];        // ErrorReg: protocol, parity, CRC or collision
+  uint16 bcc_errors;                    // ANTICOLL UID check byte wrong
+  uint16 stuck;                         // never ended, aborted by software
+  uint16 check_failures;                // rc522_check() failed
+  uint16 resets;                        // soft reset recoveries
+  uint16 reinits;                       // SPI and RC522 re-init recoveries
+} RC522_STATS_t;
+
+// One RC522 reader: the SPI port it is wired to and its state
+typedef struct
+{
+  char   (*send)(char);         // send_SPIn
+  void   (*select)(void);       // SSn_LO
+  void   (*deselect)(void);     // SSn_HI
+  uint8  port;                  // RC522_SPIn
+  uint8  command;               // command started by rc522_command_start()
+  uint8  irq_enable;            // ComIEnReg bits of that command
+  uint8  wait_irq;              // ComIrqReg bits that end it
+  const RC522_PROFILE_t* profile;
+  uint8  timeout;               // RC522_TIMEOUT_xx the timer is set for
+  uint8  version;               // VERSION_REG read by rc522_init()
+  RC522_STATS_t stats;
+
+  // Card session, kept by mifare.c
+  uint8  uid[MIFARE_UID_SIZE];
+  bool   card;                  // mifare_begin() was called
+  uint8  session;               // counts mifare_begin() calls
+  bool   authenticated;         // Crypto1 is running
+  uint8  sector;
+  uint8  key_type;
+  uint8  key[MIFARE_KEY_SIZE];
+} RC522_READER_t;
+
 //-----------------------------------------------------------------------------
 //                      Define Public Functions
 //-----------------------------------------------------------------------------
-uint8  rc522_init(uint8 Type);
-void   rc522_soft_reset(void);
-void   rc522_write_reg(uint8 reg, uint8 value);
-uint8  rc522_read_reg(uint8 reg);
-void   rc522_set_bitmask(uint8 reg, uint8 mask);
-void   rc522_clear_bitmask(uint8 reg, uint8 mask);
-void   rc522_antenna_on(void);
-void   rc522_antenna_off(void);
+void   rc522_reader_init(RC522_READER_t* reader, uint8 port);
+uint8  rc522_init(RC522_READER_t* reader, uint8 Type);
+void   rc522_soft_reset(RC522_READER_t* reader);
+void   rc522_set_profile(RC522_READER_t* reader, const RC522_PROFILE_t* profile);
+void   rc522_set_timeout(RC522_READER_t* reader, uint8 timeout);
+uint16 rc522_timer_reload(uint16 timeout_us);
+bool   rc522_check(RC522_READER_t* reader);
+void   rc522_count(uint16* counter);
+void   rc522_write_reg(RC522_READER_t* reader, uint8 reg, uint8 value);
+uint8  rc522_read_reg(RC522_READER_t* reader, uint8 reg);
+void   rc522_set_bitmask(RC522_READER_t* reader, uint8 reg, uint8 mask);
+void   rc522_clear_bitmask(RC522_READER_t* reader, uint8 reg, uint8 mask);
+void   rc522_antenna_on(RC522_READER_t* reader);
+void   rc522_antenna_off(RC522_READER_t* reader);
 bool   rc522_select_card(uint8 *card_id);
-uint8  rc522_get_firmware_version(void);
-sint8  rc522_is_card_present(uint8 req_mode, uint8* tag_type);
-bool   rc522_wait_for_card_present(uint16 timeout);
-bool   rc522_wait_for_card_removed(uint16 timeout);
-void   rc522_send_halt(void);
-sint8  rc522_to_card(uint8 command, uint8* data_to_send, uint8 data_length,
+uint8  rc522_get_firmware_version(RC522_READER_t* reader);
+sint8  rc522_is_card_present(RC522_READER_t* reader, uint8 req_mode, uint8* tag_type);
+bool   rc522_wait_for_card_present(RC522_READER_t* reader, uint16 timeout);
+bool   rc522_wait_for_card_removed(RC522_READER_t* reader, uint16 timeout);
+void   rc522_send_halt(RC522_READER_t* reader);
+sint8  rc522_to_card(RC522_READER_t* reader, uint8 command, uint8* data_to_send, uint8 data_length,
                      uint8* receive_data, uint16* backLen);
-sint8  MFRC522_Anticoll(uint8* serNum);
-sint8* rc522_type_to_string(PICC_TYPE_t type);
+sint8  rc522_exchange(RC522_READER_t* reader, uint8 command, uint8* data_to_send, uint8 data_length,
+                      uint8* receive_data, uint8 receive_size, uint16* bits_received);
+void   rc522_command_start(RC522_READER_t* reader, uint8 command,
+                           const uint8* data_to_send, uint8 data_length);
+sint8  rc522_command_poll(RC522_READER_t* reader, uint8* receive_data,
+                          uint8 receive_size, uint16* bits_received);
+void   rc522_command_abort(RC522_READER_t* reader);
+void   rc522_crc_a(const uint8* data, uint8 length, uint8* crc);
+void   rc522_stop_crypto1(RC522_READER_t* reader);
+uint8  MFRC522_Auth(RC522_READER_t* reader, uint8 authMode, uint8 block_address, uint8 *sector_key, uint8 *serial_num);
+uint8  MFRC522_Read(RC522_READER_t* reader, uint8 block_address, uint8 *data_received);
+uint8  MFRC522_Write(RC522_READER_t* reader, uint8 block_address, uint8 *writeData);
+sint8  MFRC522_Anticoll(RC522_READER_t* reader, uint8* serNum);
+char*  rc522_type_to_string(PICC_TYPE_t type);
 sint16 MFRC522_ParseType(uint8 TagSelectRet);
-uint8  rc522_select_tag(uint8* serial_num);
+uint8  rc522_select_tag(RC522_READER_t* reader, uint8* serial_num);
 
 
 
@@ -127,6 +239,8 @@ uint8  rc522_select_tag(uint8* serial_num);
 //-----------------------------------------------------------------------------
 //                 Define Public Global Variables
 //-----------------------------------------------------------------------------
+extern const RC522_PROFILE_t rc522_default_profile;
+extern const RC522_PROFILE_t rc522_max_gain_profile;
 
 
 #endif /* _RFID_RC522_MOD_H_ */
\ No newline at end of file
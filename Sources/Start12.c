@@ -23,6 +23,7 @@ Note: C++ destructors of global objects are NOT yet supported in the HIWARE Obje
 
 #include "hidef.h"
 #include "start12.h"
+#include "stack.h"
 
 /***************************************************************************/
 /* Macros to control how the startup code handles the COP:                 */
@@ -415,6 +416,7 @@ __EXTERN_C void _Startup(void) {
 #endif
 
    /* Here user defined code could be inserted, the stack could be used */
+   stack_paint(); /* after the RAM is mapped; see stack.c */
 #if defined(_DO_DISABLE_COP_)
    _DISABLE_COP();
 #endif
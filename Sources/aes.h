@@ -0,0 +1,53 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: aes.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for AES-128 block encryption and
+//    decryption, AES-CMAC (RFC 4493) message authentication and key
+//    derivation from a master key.
+//
+//*****************************************************************************
+
+#ifndef _AES_H_
+#define _AES_H_
+
+#include "sys_types.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// 1: round lookup tables (8 KB in ROM_4000), about 4 times faster
+// 0: S-boxes only (512 bytes)
+#ifndef AES_USE_TTABLES
+#define AES_USE_TTABLES         1
+#endif
+
+#define AES_BLOCK_SIZE          16
+#define AES_KEY_SIZE            16
+#define AES_ROUNDS              10
+
+// Longest label aes_derive_key() takes
+#define AES_KDF_LABEL_MAX       16
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+void aes_set_key(const uint8* key);
+void aes_encrypt_block(const uint8* input, uint8* output);
+void aes_decrypt_block(const uint8* input, uint8* output);
+void aes_cmac(const uint8* message, uint16 length, uint8* mac);
+bool aes_cmac_verify(const uint8* message, uint16 length, const uint8* mac,
+                     uint8 mac_length);
+void aes_derive_key(const uint8* master, const uint8* label, uint8 label_length,
+                    uint8* derived);
+bool aes_self_test(void);
+
+#endif /* _AES_H_ */
@@ -0,0 +1,232 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: anomaly.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file implements an online anomaly detector for the environment
+//    sensors. Instead of comparing a reading to a hand tuned threshold, each
+//    sensor learns its own baseline as an exponentially weighted mean and
+//    variance:
+//
+//      mean     += (x - mean) >> ANOMALY_MEAN_SHIFT
+//      variance += ((x - mean)^2 - variance) >> ANOMALY_VAR_SHIFT
+//
+//    with the shifts set in anomaly.h.
+//    A reading is scored by comparing (x - mean)^2 against z^2 * variance,
+//    which avoids the square root. Everything is integer math, each update
+//    is O(1) and a detector takes 12 bytes of RAM.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include "anomaly.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// Largest deviation scored; keeps (deviation^2 << 6) inside 32 bits
+#define MAX_DEVIATION           4095
+
+// Largest variance kept; keeps (z^2 * variance) inside 32 bits for z2 <= 255
+#define MAX_VARIANCE            0x00FFFFFFUL
+
+// Anomalous samples still pull the mean, just 16 times slower, so a lasting
+// change of scene (lights switched on for a shift) is eventually learned.
+#define ANOMALY_DRIFT_SHIFT     (ANOMALY_MEAN_SHIFT + 4)
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: anomaly_init
+//
+// DESCRIPTION:
+//    This function clears a detector so it starts learning a new baseline.
+//
+// INPUT:
+//   detector  - the detector to initialize
+//   var_floor - the smallest variance used when scoring. This should be
+//               about the square of the sensor noise so a very quiet
+//               sensor does not alarm on a single count of noise.
+//   flags     - ANOMALY_ONE_SIDED to ignore readings below the mean
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void anomaly_init(ANOMALY_t* detector, uint16 var_floor, uint8 flags)
+{
+
+  detector->mean      = 0;
+  detector->variance  = 0;
+  detector->var_floor = var_floor;
+  detector->samples   = 0;
+  detector->flags     = flags;
+
+} /* anomaly_init */
+
+
+//----------------------------------------------------------------------------
+// NAME: anomaly_update
+//
+// DESCRIPTION:
+//    This function scores a new sample against the learned baseline and then
+//    folds it into the baseline. Samples scored as an alarm are not allowed
+//    to inflate the variance, otherwise an intruder would teach the detector
+//    to accept them.
+//
+// INPUT:
+//   detector   - the sensor's detector
+//   sample     - the new sensor reading
+//   z2_suspect - z^2 in quarter units for a suspicious reading
+//   z2_alarm   - z^2 in quarter units for an alarm
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   ANOMALY_NONE, ANOMALY_SUSPECT or ANOMALY_ALARM. ANOMALY_NONE is always
+//   returned until the detector has seen ANOMALY_WARMUP samples.
+//----------------------------------------------------------------------------
+uint8 anomaly_update(ANOMALY_t* detector, sint16 sample, uint8 z2_suspect,
+                     uint8 z2_alarm)
+{
+  uint8  level = ANOMALY_NONE;
+  sint32 error;
+  sint16 deviation;
+  uint32 deviation2;
+  uint32 variance;
+  uint32 floor;
+
+  // The first sample seeds the mean
+  if (detector->samples == 0)
+  {
+    detector->mean = (sint32)sample << ANOMALY_MEAN_FRAC_BITS;
+    detector->variance = (uint32)detector->var_floor << ANOMALY_VAR_FRAC_BITS;
+    detector->samples = 1;
+    return (ANOMALY_NONE);
+  } /* if */
+
+  error = ((sint32)sample << ANOMALY_MEAN_FRAC_BITS) - detector->mean;
+  deviation = (sint16)(error >> ANOMALY_MEAN_FRAC_BITS);
+
+  if (deviation > MAX_DEVIATION)
+  {
+    deviation = MAX_DEVIATION;
+  } /* if */
+  else if (deviation < -MAX_DEVIATION)
+  {
+    deviation = -MAX_DEVIATION;
+  } /* else if */
+
+  deviation2 = (uint32)((sint32)deviation * deviation);
+
+  // Score the sample against the baseline as it was before this sample
+  if ((detector->samples >= ANOMALY_WARMUP) &&
+      (!(detector->flags & ANOMALY_ONE_SIDED) || (deviation > 0)))
+  {
+    variance = detector->variance;
+    floor = (uint32)detector->var_floor << ANOMALY_VAR_FRAC_BITS;
+    if (variance < floor)
+    {
+      variance = floor;
+    } /* if */
+
+    // d^2 > z^2 * var  <=>  (d^2 * 16 * 4) > (z^2 * 4) * (var * 16)
+    if ((deviation2 << 6) > (uint32)z2_alarm * variance)
+    {
+      level = ANOMALY_ALARM;
+    } /* if */
+    else if ((deviation2 << 6) > (uint32)z2_suspect * variance)
+    {
+      level = ANOMALY_SUSPECT;
+    } /* else if */
+  } /* if */
+
+  // Fold the sample into the baseline
+  if (level != ANOMALY_ALARM)
+  {
+    detector->mean += error >> ANOMALY_MEAN_SHIFT;
+    detector->variance += ((sint32)(deviation2 << ANOMALY_VAR_FRAC_BITS) -
+                           (sint32)detector->variance) >> ANOMALY_VAR_SHIFT;
+
+    if (detector->variance > MAX_VARIANCE)
+    {
+      detector->variance = MAX_VARIANCE;
+    } /* if */
+  } /* if */
+  else
+  {
+    detector->mean += error >> ANOMALY_DRIFT_SHIFT;
+  } /* else */
+
+  if (detector->samples < ANOMALY_WARMUP)
+  {
+    detector->samples++;
+  } /* if */
+
+  return (level);
+
+} /* anomaly_update */
+
+
+//----------------------------------------------------------------------------
+// NAME: anomaly_is_ready
+//
+// DESCRIPTION:
+//    This function reports whether the detector has seen enough samples to
+//    score readings.
+//
+// INPUT:
+//   detector - the sensor's detector
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE once the warm up is complete, otherwise FALSE
+//----------------------------------------------------------------------------
+bool anomaly_is_ready(ANOMALY_t* detector)
+{
+
+  return (detector->samples >= ANOMALY_WARMUP);
+
+} /* anomaly_is_ready */
+
+
+//----------------------------------------------------------------------------
+// NAME: anomaly_mean
+//
+// DESCRIPTION:
+//    This function returns the learned baseline of a sensor.
+//
+// INPUT:
+//   detector - the sensor's detector
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the integer part of the exponentially weighted mean
+//----------------------------------------------------------------------------
+sint16 anomaly_mean(ANOMALY_t* detector)
+{
+
+  return ((sint16)(detector->mean >> ANOMALY_MEAN_FRAC_BITS));
+
+} /* anomaly_mean */
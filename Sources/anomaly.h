@@ -0,0 +1,74 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: anomaly.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for the adaptive sensor baseline.
+//    Each sensor keeps an exponentially weighted mean and variance in fixed
+//    point and a sample is flagged when its z-score leaves the band set by
+//    the current alertness level.
+//
+//*****************************************************************************
+
+#ifndef _ANOMALY_H_
+#define _ANOMALY_H_
+
+#include "sys_types.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// Values returned by anomaly_update()
+#define ANOMALY_NONE            0
+#define ANOMALY_SUSPECT         1
+#define ANOMALY_ALARM           2
+
+// Detector flags
+#define ANOMALY_ONE_SIDED       0x01    // only readings above the mean count
+
+// Fixed point formats (mean is Q8, variance is Q4)
+#define ANOMALY_MEAN_FRAC_BITS  8
+#define ANOMALY_VAR_FRAC_BITS   4
+
+// Smoothing weights expressed as shifts (1/128 for mean, 1/256 for
+// variance). Fed once per ~100 ms status step, the mean follows the scene
+// over about 13 s and the variance over about 26 s.
+#define ANOMALY_MEAN_SHIFT      7
+#define ANOMALY_VAR_SHIFT       8
+
+// Samples needed before the z-score is trusted, one mean time constant
+#define ANOMALY_WARMUP          128
+
+// z^2 thresholds are passed in quarter units, e.g. z = 3 -> 9 * 4 = 36
+#define ANOMALY_Z2(z_tenths)    ((uint8)(((uint16)(z_tenths) * (z_tenths)) / 25))
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  sint32 mean;          // Q8 exponentially weighted mean
+  uint32 variance;      // Q4 exponentially weighted variance
+  uint16 var_floor;     // smallest variance used when scoring (sensor noise)
+  uint8  samples;       // samples seen, saturates at ANOMALY_WARMUP
+  uint8  flags;         // ANOMALY_ONE_SIDED
+} ANOMALY_t;
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+void   anomaly_init(ANOMALY_t* detector, uint16 var_floor, uint8 flags);
+uint8  anomaly_update(ANOMALY_t* detector, sint16 sample, uint8 z2_suspect,
+                      uint8 z2_alarm);
+bool   anomaly_is_ready(ANOMALY_t* detector);
+sint16 anomaly_mean(ANOMALY_t* detector);
+
+#endif /* _ANOMALY_H_ */
@@ -0,0 +1,335 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: critical.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file takes the place of DisableInterrupts and EnableInterrupts
+//    around data shared with the ISRs. EnableInterrupts clears the I bit
+//    whatever it was before, so a section inside another one, or inside
+//    an ISR, would let interrupts in too early. critical_enter() hands
+//    back the CCR instead, and critical_exit() leaves the I bit set if it
+//    was set then.
+//
+//    The outermost section of each nest is timed with TCNT, so the
+//    longest time the main loop keeps interrupts masked is known. An ISR
+//    masks them for as long as it runs, which the perf probes time.
+//
+//    An interrupt that is masked, or that waits for another ISR to
+//    finish, runs late. The echo and speaker ISRs pass TCNT less the
+//    time their timer channel latched or matched to latency_record(), so
+//    the delay of each run is known, including the hardware's own entry.
+//    The real-time interrupt calls latency_tick(); a tick that comes more
+//    than LATENCY_RTI_COUNTS after the one before ran that much late.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include <mc9s12dg256.h>            // derivative information
+#include "critical.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+static uint16 window_start;         // TCNT at the outermost critical_enter()
+static uint16 window_max;           // TCNT counts
+static uint32 sections;             // outermost sections timed
+
+static LATENCY_STATS_t latency[LATENCY_VECTORS];
+static uint16 last_tick;            // TCNT at the last latency_tick()
+static bool   tick_seen;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+static void latency_clear(void);
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: critical_enter
+//
+// DESCRIPTION:
+//    This function masks interrupts and starts timing the window if they
+//    weren't masked already.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the CCR from before, for critical_exit()
+//----------------------------------------------------------------------------
+CRITICAL_t critical_enter(void)
+{
+  CRITICAL_t saved;
+
+  __asm
+  {
+    TFR  CCR, B
+    SEI
+    STAB saved
+  }
+
+  if ((saved & CRITICAL_CCR_I) == 0)
+  {
+    window_start = TCNT;
+  } /* if */
+
+  return (saved);
+
+} /* critical_enter */
+
+
+//----------------------------------------------------------------------------
+// NAME: critical_exit
+//
+// DESCRIPTION:
+//    This function ends a critical section. Interrupts are unmasked only
+//    if the matching critical_enter() found them unmasked, and then the
+//    window is timed.
+//
+// INPUT:
+//   saved - what critical_enter() returned
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void critical_exit(CRITICAL_t saved)
+{
+  uint16 window;
+
+  if ((saved & CRITICAL_CCR_I) == 0)
+  {
+    window = TCNT - window_start;
+    if (window > window_max)
+    {
+      window_max = window;
+    } /* if */
+    sections++;
+
+    __asm CLI;
+  } /* if */
+
+} /* critical_exit */
+
+
+//----------------------------------------------------------------------------
+// NAME: critical_max_window
+//
+// DESCRIPTION:
+//    This function gives the longest a critical section has kept
+//    interrupts masked since critical_clear(). Only critical_enter() and
+//    critical_exit() pairs are timed: ISR bodies and start up before
+//    EnableInterrupts aren't included.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TCNT counts of 16 bus cycles
+//----------------------------------------------------------------------------
+uint16 critical_max_window(void)
+{
+
+  return (window_max);
+
+} /* critical_max_window */
+
+
+//----------------------------------------------------------------------------
+// NAME: critical_sections
+//
+// DESCRIPTION:
+//    This function gives how many outermost critical sections were timed
+//    since critical_clear().
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the count
+//----------------------------------------------------------------------------
+uint32 critical_sections(void)
+{
+
+  return (sections);
+
+} /* critical_sections */
+
+
+//----------------------------------------------------------------------------
+// NAME: critical_clear
+//
+// DESCRIPTION:
+//    This function starts the window and latency figures over.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void critical_clear(void)
+{
+  CRITICAL_t saved;
+
+  saved = critical_enter();
+  latency_clear();
+  critical_exit(saved);
+
+  // After the exit, which is timed itself
+  window_max = 0;
+  sections = 0;
+
+} /* critical_clear */
+
+
+//----------------------------------------------------------------------------
+// NAME: latency_record
+//
+// DESCRIPTION:
+//    This function adds how late an interrupt ran. Only ISRs call it,
+//    with interrupts masked.
+//
+// INPUT:
+//   vector - LATENCY_ECHO ... LATENCY_RTI
+//   counts - TCNT counts from the event to the ISR
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void latency_record(uint8 vector, uint16 counts)
+{
+  LATENCY_STATS_t* stats = &latency[vector];
+
+  stats->count++;
+  stats->total += counts;
+  if (counts > stats->max)
+  {
+    stats->max = counts;
+  } /* if */
+
+} /* latency_record */
+
+
+//----------------------------------------------------------------------------
+// NAME: latency_tick
+//
+// DESCRIPTION:
+//    This function records how late the real-time interrupt ran, from the
+//    time since the tick before. The tick ISR calls it first thing.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void latency_tick(void)
+{
+  uint16 now = TCNT;
+  uint16 interval = now - last_tick;
+
+  if (tick_seen)
+  {
+    latency_record(LATENCY_RTI, (interval > LATENCY_RTI_COUNTS) ?
+                                (interval - LATENCY_RTI_COUNTS) : 0);
+  } /* if */
+  last_tick = now;
+  tick_seen = TRUE;
+
+} /* latency_tick */
+
+
+//----------------------------------------------------------------------------
+// NAME: latency_get
+//
+// DESCRIPTION:
+//    This function copies an interrupt's latency figures.
+//
+// INPUT:
+//   vector - LATENCY_ECHO ... LATENCY_RTI
+//
+// OUTPUT:
+//   stats - the figures since critical_clear()
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void latency_get(uint8 vector, LATENCY_STATS_t* stats)
+{
+  CRITICAL_t saved;
+
+  saved = critical_enter();
+  *stats = latency[vector];
+  critical_exit(saved);
+
+} /* latency_get */
+
+
+//-----------------------------------------------------------------------------
+//                               Private functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: latency_clear
+//
+// DESCRIPTION:
+//    This function empties the latency figures. Interrupts must be masked.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void latency_clear(void)
+{
+  uint8 vector;
+
+  for (vector = 0; vector < LATENCY_VECTORS; vector++)
+  {
+    latency[vector].count = 0;
+    latency[vector].total = 0;
+    latency[vector].max = 0;
+  } /* for */
+
+} /* latency_clear */
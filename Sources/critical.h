@@ -0,0 +1,70 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: critical.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for critical sections and for
+//    measuring interrupt response. critical_enter() masks interrupts and
+//    returns the condition code register; critical_exit() only unmasks
+//    them again if they were unmasked at the matching critical_enter(),
+//    so sections can nest and can be used from an ISR. The longest time
+//    interrupts stay masked by a critical section is kept, as is how late
+//    each timed interrupt runs.
+//
+//*****************************************************************************
+
+#ifndef _CRITICAL_H_
+#define _CRITICAL_H_
+
+#include "sys_types.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define CRITICAL_CCR_I          0x10    // I bit, set while interrupts are masked
+
+// Interrupts whose latency is kept. The timer ISRs compare TCNT on entry
+// with the time the channel latched or matched; the real-time interrupt
+// has no such register, so its lateness is taken from the time since the
+// tick before.
+#define LATENCY_ECHO            0       // TC2 input capture, the ultrasonic echo
+#define LATENCY_SPEAKER         1       // TC5 output compare
+#define LATENCY_RTI             2
+#define LATENCY_VECTORS         3
+
+#define LATENCY_RTI_COUNTS      1536    // TCNT counts between ticks
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef uint8 CRITICAL_t;               // CCR saved by critical_enter()
+
+typedef struct
+{
+  uint32 count;
+  uint32 total;                 // TCNT counts, for the average
+  uint16 max;
+} LATENCY_STATS_t;
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+CRITICAL_t critical_enter(void);
+void       critical_exit(CRITICAL_t saved);
+uint16     critical_max_window(void);
+uint32     critical_sections(void);
+void       critical_clear(void);
+
+void       latency_record(uint8 vector, uint16 counts);
+void       latency_tick(void);
+void       latency_get(uint8 vector, LATENCY_STATS_t* stats);
+
+#endif /* _CRITICAL_H_ */
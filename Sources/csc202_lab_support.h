@@ -47,8 +47,13 @@ typedef   signed char       sint8;      // signed 8 bit values
 typedef unsigned char       uint8;      // unsigned 8 bit values
 typedef   signed short int  sint16;     // signed 16 bit values
 typedef unsigned short int  uint16;     // unsigned 16 bit values
+#ifdef HOST_TEST
+typedef   signed int        sint32;     // long is 64 bits on the test host
+typedef unsigned int        uint32;
+#else
 typedef   signed long  int  sint32;     // signed 32 bit values
 typedef unsigned long  int  uint32;     // unsigned 32 bit values
+#endif
 typedef unsigned char       uint8_t;      // unsigned 8 bit values
 //  Floating Point Types
 typedef float  real32;                  // single precision floating values
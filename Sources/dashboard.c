@@ -0,0 +1,583 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: dashboard.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file draws the dashboard on the SCI1 terminal. The caller draws
+//    the fixed parts of the screen once with dashboard_goto() and
+//    dashboard_print(), then sets fields and adds sparkline samples as
+//    often as it likes.
+//
+//    Each field remembers what the terminal shows. Setting it compares
+//    the new text a character at a time and sends only the changes,
+//    with a cursor move only where the terminal's cursor isn't already in
+//    the right place. The module keeps track of the cursor, which a VT100
+//    moves one column on after each character, so a move can be made
+//    relative to it (ESC [ n A/B/C, backspaces) when that is shorter than
+//    going there directly (ESC [ row ; column H). Every byte sent is
+//    counted so the caller can show the cost of a refresh.
+//
+//    Nothing else may write to the terminal while a dashboard is up, or
+//    the cursor position is lost; dashboard_begin() starts over.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include "main_asm.h"               // outchar1()
+#include "dashboard.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define ESC                     0x1B
+#define BACKSPACE               0x08    // moves left without erasing
+#define CURSOR_UNKNOWN          0
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+static const char spark_levels[] = DASHBOARD_SPARK_LEVELS;
+
+static uint8  cursor_row;               // CURSOR_UNKNOWN after a clear
+static uint8  cursor_column;
+static uint16 bytes_sent;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+static void  dashboard_put(char character);
+static void  dashboard_put_number(uint8 number);
+static void  dashboard_move(uint8 distance, char direction);
+static uint8 dashboard_move_cost(uint8 distance);
+static uint8 dashboard_digits(uint8 number);
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: dashboard_begin
+//
+// DESCRIPTION:
+//    This function clears the terminal and homes the cursor, ready for
+//    the fixed parts of a dashboard to be drawn.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void dashboard_begin(void)
+{
+
+  dashboard_put(ESC);
+  dashboard_print("[2J");
+  dashboard_put(ESC);
+  dashboard_print("[H");
+
+  cursor_row = 1;
+  cursor_column = 1;
+
+} /* dashboard_begin */
+
+
+//----------------------------------------------------------------------------
+// NAME: dashboard_goto
+//
+// DESCRIPTION:
+//    This function moves the cursor the shortest way, if it isn't
+//    already there.
+//
+// INPUT:
+//   row    - 1 based
+//   column - 1 based
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void dashboard_goto(uint8 row, uint8 column)
+{
+  uint8 absolute;
+  uint8 relative;
+  uint8 rows;
+  uint8 columns;
+  bool  backspace;
+
+  if ((row == cursor_row) && (column == cursor_column))
+  {
+    return;
+  } /* if */
+
+  absolute = (uint8)(4 + dashboard_digits(row) + dashboard_digits(column));
+
+  if (cursor_row != CURSOR_UNKNOWN)
+  {
+    rows = (uint8)((row > cursor_row) ? row - cursor_row : cursor_row - row);
+    columns = (uint8)((column > cursor_column) ? column - cursor_column : cursor_column - column);
+
+    // A few columns to the left are quicker with backspaces
+    backspace = (bool)((column < cursor_column) && (columns < dashboard_move_cost(columns)));
+    relative = (uint8)(dashboard_move_cost(rows) + (backspace ? columns : dashboard_move_cost(columns)));
+
+    if (relative < absolute)
+    {
+      dashboard_move(rows, (row > cursor_row) ? 'B' : 'A');
+      if (backspace)
+      {
+        for (; columns > 0; columns--)
+        {
+          dashboard_put(BACKSPACE);
+        } /* for */
+      } /* if */
+      else
+      {
+        dashboard_move(columns, (column > cursor_column) ? 'C' : 'D');
+      } /* else */
+
+      cursor_row = row;
+      cursor_column = column;
+      return;
+    } /* if */
+  } /* if */
+
+  dashboard_put(ESC);
+  dashboard_put('[');
+  dashboard_put_number(row);
+  dashboard_put(';');
+  dashboard_put_number(column);
+  dashboard_put('H');
+
+  cursor_row = row;
+  cursor_column = column;
+
+} /* dashboard_goto */
+
+
+//----------------------------------------------------------------------------
+// NAME: dashboard_print
+//
+// DESCRIPTION:
+//    This function sends text at the cursor. The text must not contain
+//    line breaks; use dashboard_goto() to start a new line.
+//
+// INPUT:
+//   text - the text
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void dashboard_print(const char* text)
+{
+
+  while (*text != '\0')
+  {
+    dashboard_put(*text++);
+  } /* while */
+
+} /* dashboard_print */
+
+
+//----------------------------------------------------------------------------
+// NAME: dashboard_field_init
+//
+// DESCRIPTION:
+//    This function places a text field. The first dashboard_field_set()
+//    draws all of it.
+//
+// INPUT:
+//   row    - 1 based
+//   column - 1 based
+//   width  - up to DASHBOARD_FIELD_WIDTH
+//
+// OUTPUT:
+//   field - the field
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void dashboard_field_init(DASHBOARD_FIELD_t* field, uint8 row, uint8 column, uint8 width)
+{
+  uint8 idx;
+
+  field->row = row;
+  field->column = column;
+  field->width = (width > DASHBOARD_FIELD_WIDTH) ? DASHBOARD_FIELD_WIDTH : width;
+
+  // Never sent, so every character differs the first time
+  for (idx = 0; idx < DASHBOARD_FIELD_WIDTH; idx++)
+  {
+    field->shown[idx] = '\0';
+  } /* for */
+
+} /* dashboard_field_init */
+
+
+//----------------------------------------------------------------------------
+// NAME: dashboard_field_set
+//
+// DESCRIPTION:
+//    This function shows new text in a field, left aligned and padded
+//    with spaces, sending only the characters that changed.
+//
+// INPUT:
+//   field - the field
+//   text  - the text, cut to the field's width
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void dashboard_field_set(DASHBOARD_FIELD_t* field, const char* text)
+{
+  char  wanted[DASHBOARD_FIELD_WIDTH];
+  uint8 idx;
+  uint8 last = 0xFF;                    // last column sent, 0xFF for none
+  uint8 gap;
+
+  for (idx = 0; idx < field->width; idx++)
+  {
+    wanted[idx] = (*text != '\0') ? *text++ : ' ';
+  } /* for */
+
+  for (idx = 0; idx < field->width; idx++)
+  {
+    if (wanted[idx] == field->shown[idx])
+    {
+      continue;
+    } /* if */
+
+    // Close gaps by sending what is already there
+    gap = (uint8)(idx - last - 1);
+    if ((last != 0xFF) && (gap <= DASHBOARD_GAP_MAX) &&
+        (cursor_row == field->row) && (cursor_column == field->column + last + 1))
+    {
+      for (last++; last < idx; last++)
+      {
+        dashboard_put(field->shown[last]);
+      } /* for */
+    } /* if */
+    else
+    {
+      dashboard_goto(field->row, field->column + idx);
+    } /* else */
+
+    dashboard_put(wanted[idx]);
+    field->shown[idx] = wanted[idx];
+    last = idx;
+  } /* for */
+
+} /* dashboard_field_set */
+
+
+//----------------------------------------------------------------------------
+// NAME: dashboard_spark_init
+//
+// DESCRIPTION:
+//    This function places a sparkline, DASHBOARD_SPARK_WIDTH columns
+//    wide, and draws it empty.
+//
+// INPUT:
+//   row    - 1 based
+//   column - 1 based
+//   low    - value shown as the lowest level, and anything below it
+//   high   - value shown as the highest level, and anything above it
+//
+// OUTPUT:
+//   spark - the sparkline
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void dashboard_spark_init(DASHBOARD_SPARK_t* spark, uint8 row, uint8 column, sint16 low, sint16 high)
+{
+  uint8 idx;
+
+  spark->row = row;
+  spark->column = column;
+  spark->position = 0;
+  spark->low = low;
+  spark->high = (high > low) ? high : low + 1;
+
+  dashboard_goto(row, column);
+  dashboard_put(DASHBOARD_SPARK_CURSOR);
+  for (idx = 1; idx < DASHBOARD_SPARK_WIDTH; idx++)
+  {
+    dashboard_put(spark_levels[0]);
+  } /* for */
+
+} /* dashboard_spark_init */
+
+
+//----------------------------------------------------------------------------
+// NAME: dashboard_spark_add
+//
+// DESCRIPTION:
+//    This function draws a sample over the cursor mark and moves the mark
+//    on to the oldest sample.
+//
+// INPUT:
+//   spark - the sparkline
+//   value - the sample
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void dashboard_spark_add(DASHBOARD_SPARK_t* spark, sint16 value)
+{
+  sint32 step;
+
+  if (value <= spark->low)
+  {
+    step = 0;
+  } /* if */
+  else if (value >= spark->high)
+  {
+    step = DASHBOARD_SPARK_STEPS - 1;
+  } /* else if */
+  else
+  {
+    step = ((sint32)(value - spark->low) * DASHBOARD_SPARK_STEPS) / (spark->high - spark->low);
+  } /* else */
+
+  dashboard_goto(spark->row, spark->column + spark->position);
+  dashboard_put(spark_levels[step]);
+
+  spark->position++;
+  if (spark->position == DASHBOARD_SPARK_WIDTH)
+  {
+    spark->position = 0;
+    dashboard_goto(spark->row, spark->column);
+  } /* if */
+  dashboard_put(DASHBOARD_SPARK_CURSOR);
+
+} /* dashboard_spark_add */
+
+
+//----------------------------------------------------------------------------
+// NAME: dashboard_bytes
+//
+// DESCRIPTION:
+//    This function returns how many bytes were sent since
+//    dashboard_clear_bytes().
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the byte count, stuck at 0xFFFF
+//----------------------------------------------------------------------------
+uint16 dashboard_bytes(void)
+{
+
+  return (bytes_sent);
+
+} /* dashboard_bytes */
+
+
+//----------------------------------------------------------------------------
+// NAME: dashboard_clear_bytes
+//
+// DESCRIPTION:
+//    This function restarts the byte count.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void dashboard_clear_bytes(void)
+{
+
+  bytes_sent = 0;
+
+} /* dashboard_clear_bytes */
+
+
+//-----------------------------------------------------------------------------
+//                             Private functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: dashboard_put
+//
+// DESCRIPTION:
+//    This function sends one byte and keeps track of the cursor. Escape
+//    sequences don't move the cursor themselves; dashboard_goto() sets
+//    it afterwards.
+//
+// INPUT:
+//   character - the byte
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void dashboard_put(char character)
+{
+
+  outchar1((unsigned char)character);
+  cursor_column++;
+
+  if (bytes_sent != 0xFFFF)
+  {
+    bytes_sent++;
+  } /* if */
+
+} /* dashboard_put */
+
+
+//----------------------------------------------------------------------------
+// NAME: dashboard_put_number
+//
+// DESCRIPTION:
+//    This function sends a number in decimal, for an escape sequence.
+//
+// INPUT:
+//   number - the number
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void dashboard_put_number(uint8 number)
+{
+
+  if (number >= 100)
+  {
+    dashboard_put((char)('0' + number / 100));
+  } /* if */
+  if (number >= 10)
+  {
+    dashboard_put((char)('0' + (number / 10) % 10));
+  } /* if */
+  dashboard_put((char)('0' + number % 10));
+
+} /* dashboard_put_number */
+
+
+//----------------------------------------------------------------------------
+// NAME: dashboard_move
+//
+// DESCRIPTION:
+//    This function moves the cursor up, down, right or left. The terminal
+//    stops at the edge of the screen.
+//
+// INPUT:
+//   distance  - how far, nothing is sent for 0
+//   direction - 'A' up, 'B' down, 'C' right or 'D' left
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void dashboard_move(uint8 distance, char direction)
+{
+
+  if (distance == 0)
+  {
+    return;
+  } /* if */
+
+  dashboard_put(ESC);
+  dashboard_put('[');
+  if (distance > 1)
+  {
+    dashboard_put_number(distance);
+  } /* if */
+  dashboard_put(direction);
+
+} /* dashboard_move */
+
+
+//----------------------------------------------------------------------------
+// NAME: dashboard_move_cost
+//
+// DESCRIPTION:
+//    This function returns the bytes dashboard_move() sends.
+//
+// INPUT:
+//   distance - how far
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the byte count
+//----------------------------------------------------------------------------
+static uint8 dashboard_move_cost(uint8 distance)
+{
+
+  if (distance == 0)
+  {
+    return (0);
+  } /* if */
+
+  return ((uint8)((distance > 1) ? 3 + dashboard_digits(distance) : 3));
+
+} /* dashboard_move_cost */
+
+
+//----------------------------------------------------------------------------
+// NAME: dashboard_digits
+//
+// DESCRIPTION:
+//    This function returns the digits dashboard_put_number() sends.
+//
+// INPUT:
+//   number - the number
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   1 - 3
+//----------------------------------------------------------------------------
+static uint8 dashboard_digits(uint8 number)
+{
+
+  return ((uint8)((number >= 100) ? 3 : ((number >= 10) ? 2 : 1)));
+
+} /* dashboard_digits */
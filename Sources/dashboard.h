@@ -0,0 +1,75 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: dashboard.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for drawing a live dashboard on a
+//    VT100 terminal: text fields and sparklines at fixed places on the
+//    screen that are kept up to date by sending only what changed.
+//
+//*****************************************************************************
+
+#ifndef _DASHBOARD_H_
+#define _DASHBOARD_H_
+
+#include "sys_types.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define DASHBOARD_FIELD_WIDTH   16      // widest text field
+#define DASHBOARD_SPARK_WIDTH   40      // samples shown by a sparkline
+
+// Unchanged characters between two changes are sent again rather than
+// moving the cursor over them, which takes 6-8 bytes
+#define DASHBOARD_GAP_MAX       6
+
+// Sparkline characters, lowest to highest
+#define DASHBOARD_SPARK_LEVELS  " .:-=+*#"
+#define DASHBOARD_SPARK_STEPS   8
+#define DASHBOARD_SPARK_CURSOR  '|'     // marks the newest sample
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  uint8 row;                            // 1 based, as VT100 counts
+  uint8 column;
+  uint8 width;                          // up to DASHBOARD_FIELD_WIDTH
+  char  shown[DASHBOARD_FIELD_WIDTH];   // what the terminal shows
+} DASHBOARD_FIELD_t;
+
+// A sweep, like an oscilloscope: each sample overwrites the oldest one
+// and moves the cursor on, so adding a sample sends two characters
+typedef struct
+{
+  uint8  row;
+  uint8  column;
+  uint8  position;                      // where the next sample goes
+  sint16 low;                           // value shown as the lowest level
+  sint16 high;                          // value shown as the highest level
+} DASHBOARD_SPARK_t;
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+void   dashboard_begin(void);
+void   dashboard_goto(uint8 row, uint8 column);
+void   dashboard_print(const char* text);
+void   dashboard_field_init(DASHBOARD_FIELD_t* field, uint8 row, uint8 column, uint8 width);
+void   dashboard_field_set(DASHBOARD_FIELD_t* field, const char* text);
+void   dashboard_spark_init(DASHBOARD_SPARK_t* spark, uint8 row, uint8 column, sint16 low, sint16 high);
+void   dashboard_spark_add(DASHBOARD_SPARK_t* spark, sint16 value);
+uint16 dashboard_bytes(void);
+void   dashboard_clear_bytes(void);
+
+#endif /* _DASHBOARD_H_ */
@@ -0,0 +1,351 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: flash.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file implements word programming and sector erase for the
+//    MC9S12DG256's banked flash. The 256K array is four 64K blocks, each
+//    with its own command state machine:
+//
+//      block 0 - pages 0x3C - 0x3F (includes ROM_4000 and ROM_C000)
+//      block 1 - pages 0x38 - 0x3B
+//      block 2 - pages 0x34 - 0x37
+//      block 3 - pages 0x30 - 0x33
+//
+//    A block can't be read while it is being programmed or erased, but the
+//    others can. The program is built with the small memory model, so all
+//    code runs from block 0 and commands on blocks 1 - 3 can be left
+//    running while the main loop carries on.
+//
+//    Offsets are relative to the start of a page (0 - 0x3FFF). The page is
+//    mapped in through PPAGE only for the array access itself; no code or
+//    interrupt handler depends on PPAGE in the small memory model.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include <mc9s12dg256.h>            // derivative information
+#include "flash.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// FCLKDIV: 8 MHz OSCCLK / (39 + 1) = 200 kHz, inside the 150 - 200 kHz
+// the flash state machine needs
+#define FLASH_CLOCK_DIVIDER     0x27
+
+// FSTAT bits
+#define FSTAT_CBEIF             0x80    // command buffer empty
+#define FSTAT_CCIF              0x40    // command complete
+#define FSTAT_PVIOL             0x20    // protection violation
+#define FSTAT_ACCERR            0x10    // access error
+
+// FCMD commands
+#define FCMD_PROGRAM            0x20
+#define FCMD_SECTOR_ERASE       0x40
+
+#define FLASH_LAST_PAGE         0x3F
+#define PAGES_PER_BLOCK_SHIFT   2
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+static void  flash_select(uint8 page);
+static uint8 flash_launch(uint8 page, uint16 offset, uint16 data, uint8 command);
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: flash_init
+//
+// DESCRIPTION:
+//    This function sets the flash clock. FCLKDIV can only be written once
+//    after reset, so later calls have no effect.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void flash_init(void)
+{
+
+  FCLKDIV = FLASH_CLOCK_DIVIDER;
+
+} /* flash_init */
+
+
+//----------------------------------------------------------------------------
+// NAME: flash_start_program
+//
+// DESCRIPTION:
+//    This function starts programming one aligned word. The word must be
+//    erased (0xFFFF).
+//
+// INPUT:
+//   page   - the flash page (0x30 - 0x3B)
+//   offset - the even offset within the page
+//   data   - the word to program
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   FLASH_OK if the command was started, FLASH_BUSY or FLASH_ERROR
+//----------------------------------------------------------------------------
+uint8 flash_start_program(uint8 page, uint16 offset, uint16 data)
+{
+
+  return (flash_launch(page, offset, data, FCMD_PROGRAM));
+
+} /* flash_start_program */
+
+
+//----------------------------------------------------------------------------
+// NAME: flash_start_erase
+//
+// DESCRIPTION:
+//    This function starts erasing the 512-byte sector holding an offset.
+//    The erase takes about 20 ms.
+//
+// INPUT:
+//   page   - the flash page (0x30 - 0x3B)
+//   offset - any offset within the sector
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   FLASH_OK if the command was started, FLASH_BUSY or FLASH_ERROR
+//----------------------------------------------------------------------------
+uint8 flash_start_erase(uint8 page, uint16 offset)
+{
+
+  return (flash_launch(page, offset & ~(FLASH_SECTOR_SIZE - 1), 0xFFFF, FCMD_SECTOR_ERASE));
+
+} /* flash_start_erase */
+
+
+//----------------------------------------------------------------------------
+// NAME: flash_is_busy
+//
+// DESCRIPTION:
+//    This function reports whether the block holding a page is still
+//    running a command. The block must not be read while it is.
+//
+// INPUT:
+//   page - any page in the block
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE while a command is in progress
+//----------------------------------------------------------------------------
+bool flash_is_busy(uint8 page)
+{
+
+  flash_select(page);
+
+  return ((FSTAT & FSTAT_CCIF) == 0);
+
+} /* flash_is_busy */
+
+
+//----------------------------------------------------------------------------
+// NAME: flash_result
+//
+// DESCRIPTION:
+//    This function reports whether the last command on a block failed.
+//
+// INPUT:
+//   page - any page in the block
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   FLASH_BUSY, FLASH_ERROR or FLASH_OK
+//----------------------------------------------------------------------------
+uint8 flash_result(uint8 page)
+{
+  uint8 status;
+
+  flash_select(page);
+  status = FSTAT;
+
+  if ((status & FSTAT_CCIF) == 0)
+  {
+    return (FLASH_BUSY);
+  } /* if */
+
+  if (status & (FSTAT_PVIOL | FSTAT_ACCERR))
+  {
+    return (FLASH_ERROR);
+  } /* if */
+
+  return (FLASH_OK);
+
+} /* flash_result */
+
+
+//----------------------------------------------------------------------------
+// NAME: flash_read_word
+//
+// DESCRIPTION:
+//    This function reads one word from a banked page.
+//
+// INPUT:
+//   page   - the flash page
+//   offset - the even offset within the page
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the word
+//----------------------------------------------------------------------------
+uint16 flash_read_word(uint8 page, uint16 offset)
+{
+  uint8  saved_page = PPAGE;
+  uint16 data;
+
+  PPAGE = page;
+  data = *(volatile uint16*)(FLASH_PAGE_WINDOW + offset);
+  PPAGE = saved_page;
+
+  return (data);
+
+} /* flash_read_word */
+
+
+//----------------------------------------------------------------------------
+// NAME: flash_read
+//
+// DESCRIPTION:
+//    This function copies bytes out of a banked page.
+//
+// INPUT:
+//   page   - the flash page
+//   offset - the offset within the page
+//   length - the number of bytes, not crossing the end of the page
+//
+// OUTPUT:
+//   destination - the bytes read
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void flash_read(uint8 page, uint16 offset, uint8* destination, uint16 length)
+{
+  uint8  saved_page = PPAGE;
+  volatile uint8* source = (volatile uint8*)(FLASH_PAGE_WINDOW + offset);
+
+  PPAGE = page;
+  while (length-- > 0)
+  {
+    *destination++ = *source++;
+  } /* while */
+  PPAGE = saved_page;
+
+} /* flash_read */
+
+
+//-----------------------------------------------------------------------------
+//                             Private functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: flash_select
+//
+// DESCRIPTION:
+//    This function points FSTAT, FCMD and FPROT at the block holding a
+//    page.
+//
+// INPUT:
+//   page - the flash page
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void flash_select(uint8 page)
+{
+
+  FCNFG = (uint8)((FLASH_LAST_PAGE - page) >> PAGES_PER_BLOCK_SHIFT);
+
+} /* flash_select */
+
+
+//----------------------------------------------------------------------------
+// NAME: flash_launch
+//
+// DESCRIPTION:
+//    This function runs the command sequence: latch the address and data
+//    with an array write, write the command, then clear CBEIF to launch.
+//
+// INPUT:
+//   page    - the flash page
+//   offset  - the even offset within the page
+//   data    - the word latched with the command
+//   command - FCMD_PROGRAM or FCMD_SECTOR_ERASE
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   FLASH_OK if the command was started, FLASH_BUSY or FLASH_ERROR
+//----------------------------------------------------------------------------
+static uint8 flash_launch(uint8 page, uint16 offset, uint16 data, uint8 command)
+{
+  uint8 saved_page;
+
+  flash_select(page);
+
+  // Wait for the whole command, not just the buffer, so the caller always
+  // knows which command an error belongs to
+  if ((FSTAT & FSTAT_CCIF) == 0)
+  {
+    return (FLASH_BUSY);
+  } /* if */
+
+  FSTAT = FSTAT_PVIOL | FSTAT_ACCERR;
+
+  saved_page = PPAGE;
+  PPAGE = page;
+  *(volatile uint16*)(FLASH_PAGE_WINDOW + offset) = data;
+  PPAGE = saved_page;
+
+  FCMD = command;
+  FSTAT = FSTAT_CBEIF;
+
+  if (FSTAT & (FSTAT_PVIOL | FSTAT_ACCERR))
+  {
+    return (FLASH_ERROR);
+  } /* if */
+
+  return (FLASH_OK);
+
+} /* flash_launch */
@@ -0,0 +1,48 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: flash.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for the banked flash driver. The
+//    driver only starts commands; callers poll flash_is_busy() so a sector
+//    erase never holds up the main loop.
+//
+//*****************************************************************************
+
+#ifndef _FLASH_H_
+#define _FLASH_H_
+
+#include "sys_types.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// Banked pages appear at 0x8000 - 0xBFFF through PPAGE
+#define FLASH_PAGE_WINDOW       0x8000
+#define FLASH_PAGE_SIZE         0x4000
+#define FLASH_SECTOR_SIZE       512
+
+// Command results
+#define FLASH_OK                0
+#define FLASH_BUSY              1       // previous command still running
+#define FLASH_ERROR             2       // access error or protection violation
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+void   flash_init(void);
+uint8  flash_start_program(uint8 page, uint16 offset, uint16 data);
+uint8  flash_start_erase(uint8 page, uint16 offset);
+bool   flash_is_busy(uint8 page);
+uint8  flash_result(uint8 page);
+uint16 flash_read_word(uint8 page, uint16 offset);
+void   flash_read(uint8 page, uint16 offset, uint8* destination, uint16 length);
+
+#endif /* _FLASH_H_ */
@@ -0,0 +1,710 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: flicker.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file implements the high rate light sampling mode. The tick
+//    interrupt converts the light channel every tick (976.5 Hz) and, while
+//    the mode is enabled, feeds a small bank of Goertzel filters:
+//
+//      - 100 Hz and 120 Hz over 128 samples (131 ms). Lamps on 50/60 Hz
+//        mains flicker at twice the line frequency; daylight does not.
+//      - 1 to 3 Hz in 0.5 Hz steps over 32 samples decimated by 64
+//        (2.1 s). The bins are about 0.5 Hz wide so together they cover
+//        the whole band a flashlight swept across the room shows up in.
+//      - 0.5 Hz over the same samples. A block is too short to tell a
+//        slow drift (dimming, a light switched on) from a sweep by the
+//        band alone, because the drift leaks into the band bins; it
+//        leaks into this bin more, so the bin vetoes the sweep.
+//
+//    Each Goertzel bin costs one multiply per sample:
+//
+//      s[n] = x[n] + coef * s[n-1] - s[n-2],  coef = 2 cos(2 pi f / fs)
+//
+//    At the end of a block the interrupt only snapshots the filter state.
+//    The bin power, s1^2 + s2^2 - coef * s1 * s2, and the classification
+//    are worked out in the main loop by flicker_poll().
+//
+//    The AD0 sequence converts the light channel and the three after it,
+//    so the temperature reading is cached too. The sequence keeps running
+//    with the mode off, so the main loop never has to share the converter
+//    with the interrupt.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include <hidef.h>                  // common defines and macros
+#include <mc9s12dg256.h>            // derivative information
+#include "flicker.h"
+#include "critical.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define MAINS_BLOCK             128     // samples per mains block
+#define MAINS_BLOCK_SHIFT       7
+#define MAINS_BINS              2
+
+// Ticks per low band sample; 64 10-bit readings just fit decimate_sum
+#define SWEEP_DECIMATION        64
+#define SWEEP_DECIMATION_SHIFT  6
+#define SWEEP_BLOCK             32      // decimated samples per sweep block
+#define SWEEP_BLOCK_SHIFT       5
+#define SWEEP_BINS              6
+#define SWEEP_DRIFT_BIN         0       // the 0.5 Hz bin, the rest are the band
+
+// Goertzel coefficients, 2 cos(w) in Q14
+#define COEF_FRAC_BITS          14
+
+// State is scaled down by this many bits before squaring
+#define POWER_SHIFT             4
+
+// Percent of AC energy that must sit in the bins to count. A beam
+// crossing the sensor is a train of short pulses with much of its energy
+// in harmonics above the sweep band, so that share is set lower.
+#define MAINS_MIN_PERCENT       40
+#define SWEEP_MIN_PERCENT       30
+
+// Smallest AC power (mean square, counts^2) worth classifying
+#define MAINS_MIN_POWER         4       // 2 counts RMS
+#define SWEEP_MIN_POWER         64      // 8 counts RMS
+
+// ATD0CTL5: right justified, multichannel, starting at the light channel
+#define ATD_START_LIGHT         (0x90 | FLICKER_LIGHT_CHANNEL)
+#define ATD_SEQUENCE_DONE       0x80
+
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  sint32 s1;                        // s[n-1]
+  sint32 s2;                        // s[n-2]
+} GOERTZEL_t;
+
+typedef struct
+{
+  GOERTZEL_t  state[MAINS_BINS > SWEEP_BINS ? MAINS_BINS : SWEEP_BINS];
+  uint32      energy;               // sum of x^2 over the block
+  sint32      sum;                  // sum of x over the block
+} BLOCK_RESULT_t;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+// 100 Hz, 120 Hz at 976.5625 Hz
+static const sint16 mains_coef[MAINS_BINS] = { 26216, 23477 };
+
+// 0.5 Hz, then 1 Hz to 3 Hz in 0.5 Hz steps, at 15.26 Hz
+static const sint16 sweep_coef[SWEEP_BINS] =
+{
+  32076, 30029, 26714, 22270, 16885, 10788
+};
+
+static volatile bool   enabled = FALSE;
+static volatile uint16 light_level;
+static volatile uint16 temp_level;
+
+// Interrupt side state
+static bool       seeded;
+static GOERTZEL_t mains[MAINS_BINS];
+static GOERTZEL_t sweep[SWEEP_BINS];
+static uint32     mains_energy;
+static uint32     sweep_energy;
+static sint32     mains_sum;
+static sint32     sweep_sum;
+static sint16     mains_dc;
+static sint16     sweep_dc;
+static uint8      mains_count;
+static uint8      sweep_count;
+static uint8      decimate_count;
+static uint16     decimate_sum;
+
+// Finished blocks handed to the main loop
+static BLOCK_RESULT_t   mains_result;
+static BLOCK_RESULT_t   sweep_result;
+static volatile bool    mains_ready;
+static volatile bool    sweep_ready;
+
+// Main loop side results
+static uint8 source = LIGHT_SOURCE_UNKNOWN;
+static uint8 mains_percent;
+static uint8 sweep_percent;
+static bool  mains_active;
+static bool  sweep_active;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+static void  flicker_reset(void);
+static uint8 flicker_bin_percent(GOERTZEL_t* state, sint16 coef,
+                                 uint32 ac_energy, uint16 scale);
+static uint32 flicker_ac_energy(BLOCK_RESULT_t* result, uint8 block_shift);
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: flicker_init
+//
+// DESCRIPTION:
+//    This function clears the filter bank and starts the AD0 sequence.
+//    The analysis starts off. ad0_enable() must have been called first.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void flicker_init(void)
+{
+
+  enabled = FALSE;
+  flicker_reset();
+  source = LIGHT_SOURCE_UNKNOWN;
+  ATD0CTL5 = ATD_START_LIGHT;
+
+} /* flicker_init */
+
+
+//----------------------------------------------------------------------------
+// NAME: flicker_set_enabled
+//
+// DESCRIPTION:
+//    This function turns the flicker analysis on or off. Either way AD0
+//    belongs to the tick interrupt and ad0conv() must not be used on it;
+//    read flicker_light_level() and flicker_temp_level() instead.
+//
+// INPUT:
+//   enable - TRUE to start sampling, FALSE to stop
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void flicker_set_enabled(bool enable)
+{
+
+  // Stop the interrupt from touching the state before resetting it
+  enabled = FALSE;
+
+  if (enable)
+  {
+    flicker_reset();
+    enabled = TRUE;
+  } /* if */
+
+} /* flicker_set_enabled */
+
+
+//----------------------------------------------------------------------------
+// NAME: flicker_is_enabled
+//
+// DESCRIPTION:
+//    This function reports whether the high rate sampling mode is on.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if the light source is being classified
+//----------------------------------------------------------------------------
+bool flicker_is_enabled(void)
+{
+
+  return (enabled);
+
+} /* flicker_is_enabled */
+
+
+//----------------------------------------------------------------------------
+// NAME: flicker_sample
+//
+// DESCRIPTION:
+//    This function caches the light and temperature readings and, when
+//    the analysis is on, steps the Goertzel filters. It is called from the
+//    tick interrupt on every tick.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void flicker_sample(void)
+{
+  sint16 light;
+  sint16 x;
+  sint32 s0;
+  uint8  bin;
+
+  if (!(ATD0STAT0 & ATD_SEQUENCE_DONE))
+  {
+    return;
+  } /* if */
+
+  light = (sint16)ATD0DR0;
+  temp_level = ATD0DR1;
+  ATD0CTL5 = ATD_START_LIGHT;
+  light_level = light;
+
+  if (!enabled)
+  {
+    return;
+  } /* if */
+
+  if (!seeded)
+  {
+    mains_dc = light;
+    sweep_dc = light;
+    seeded = TRUE;
+  } /* if */
+
+  // Mains flicker bins, centred on the previous block's mean
+  x = light - mains_dc;
+  mains_sum += x;
+  mains_energy += (uint32)((sint32)x * x);
+
+  for (bin = 0; bin < MAINS_BINS; bin++)
+  {
+    s0 = x + ((mains_coef[bin] * mains[bin].s1) >> COEF_FRAC_BITS) - mains[bin].s2;
+    mains[bin].s2 = mains[bin].s1;
+    mains[bin].s1 = s0;
+  } /* for */
+
+  if (++mains_count == MAINS_BLOCK)
+  {
+    for (bin = 0; bin < MAINS_BINS; bin++)
+    {
+      mains_result.state[bin] = mains[bin];
+      mains[bin].s1 = 0;
+      mains[bin].s2 = 0;
+    } /* for */
+
+    mains_result.energy = mains_energy;
+    mains_result.sum = mains_sum;
+    mains_ready = TRUE;
+
+    mains_dc += (sint16)(mains_sum >> MAINS_BLOCK_SHIFT);
+    mains_energy = 0;
+    mains_sum = 0;
+    mains_count = 0;
+  } /* if */
+
+  // Low band: average SWEEP_DECIMATION ticks into one sample
+  decimate_sum += (uint16)light;
+  if (++decimate_count < SWEEP_DECIMATION)
+  {
+    return;
+  } /* if */
+
+  x = (sint16)(decimate_sum >> SWEEP_DECIMATION_SHIFT) - sweep_dc;
+  decimate_sum = 0;
+  decimate_count = 0;
+
+  sweep_sum += x;
+  sweep_energy += (uint32)((sint32)x * x);
+
+  for (bin = 0; bin < SWEEP_BINS; bin++)
+  {
+    s0 = x + ((sweep_coef[bin] * sweep[bin].s1) >> COEF_FRAC_BITS) - sweep[bin].s2;
+    sweep[bin].s2 = sweep[bin].s1;
+    sweep[bin].s1 = s0;
+  } /* for */
+
+  if (++sweep_count == SWEEP_BLOCK)
+  {
+    for (bin = 0; bin < SWEEP_BINS; bin++)
+    {
+      sweep_result.state[bin] = sweep[bin];
+      sweep[bin].s1 = 0;
+      sweep[bin].s2 = 0;
+    } /* for */
+
+    sweep_result.energy = sweep_energy;
+    sweep_result.sum = sweep_sum;
+    sweep_ready = TRUE;
+
+    sweep_dc += (sint16)(sweep_sum >> SWEEP_BLOCK_SHIFT);
+    sweep_energy = 0;
+    sweep_sum = 0;
+    sweep_count = 0;
+  } /* if */
+
+} /* flicker_sample */
+
+
+//----------------------------------------------------------------------------
+// NAME: flicker_poll
+//
+// DESCRIPTION:
+//    This function analyses any block finished by the interrupt since the
+//    last call and updates the light source classification.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if the classification was updated
+//----------------------------------------------------------------------------
+bool flicker_poll(void)
+{
+  BLOCK_RESULT_t result;
+  uint32 ac_energy;
+  uint16 percent;
+  uint8  bin_percent;
+  uint8  bin;
+  bool   updated = FALSE;
+  CRITICAL_t saved;
+
+  if (mains_ready)
+  {
+    saved = critical_enter();
+    result = mains_result;
+    mains_ready = FALSE;
+    critical_exit(saved);
+
+    ac_energy = flicker_ac_energy(&result, MAINS_BLOCK_SHIFT);
+    mains_percent = 0;
+
+    for (bin = 0; bin < MAINS_BINS; bin++)
+    {
+      bin_percent = flicker_bin_percent(&result.state[bin], mains_coef[bin],
+                                        ac_energy, 3200 / MAINS_BLOCK);
+      if (bin_percent > mains_percent)
+      {
+        mains_percent = bin_percent;
+      } /* if */
+    } /* for */
+
+    mains_active = ((ac_energy >> MAINS_BLOCK_SHIFT) >= MAINS_MIN_POWER) &&
+                   (mains_percent >= MAINS_MIN_PERCENT);
+    updated = TRUE;
+  } /* if */
+
+  if (sweep_ready)
+  {
+    saved = critical_enter();
+    result = sweep_result;
+    sweep_ready = FALSE;
+    critical_exit(saved);
+
+    ac_energy = flicker_ac_energy(&result, SWEEP_BLOCK_SHIFT);
+    percent = 0;
+
+    // The bins leak into each other so the sum is capped
+    for (bin = SWEEP_DRIFT_BIN + 1; bin < SWEEP_BINS; bin++)
+    {
+      percent += flicker_bin_percent(&result.state[bin], sweep_coef[bin],
+                                     ac_energy, 3200 / SWEEP_BLOCK);
+    } /* for */
+
+    sweep_percent = (percent > 100) ? 100 : (uint8)percent;
+    bin_percent = flicker_bin_percent(&result.state[SWEEP_DRIFT_BIN],
+                                      sweep_coef[SWEEP_DRIFT_BIN],
+                                      ac_energy, 3200 / SWEEP_BLOCK);
+    sweep_active = ((ac_energy >> SWEEP_BLOCK_SHIFT) >= SWEEP_MIN_POWER) &&
+                   (sweep_percent >= SWEEP_MIN_PERCENT) &&
+                   (sweep_percent > bin_percent);
+    updated = TRUE;
+  } /* if */
+
+  if (updated)
+  {
+    if (sweep_active)
+    {
+      source = LIGHT_SOURCE_MOVING;
+    } /* if */
+    else if (mains_active)
+    {
+      source = LIGHT_SOURCE_ARTIFICIAL;
+    } /* else if */
+    else
+    {
+      source = LIGHT_SOURCE_AMBIENT;
+    } /* else */
+  } /* if */
+
+  return (updated);
+
+} /* flicker_poll */
+
+
+//----------------------------------------------------------------------------
+// NAME: flicker_source
+//
+// DESCRIPTION:
+//    This function returns the latest light source classification.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   one of the LIGHT_SOURCE_ values
+//----------------------------------------------------------------------------
+uint8 flicker_source(void)
+{
+
+  return (source);
+
+} /* flicker_source */
+
+
+//----------------------------------------------------------------------------
+// NAME: flicker_light_level
+//
+// DESCRIPTION:
+//    This function returns the latest light reading taken by the interrupt.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the light level (10-bit ADC counts)
+//----------------------------------------------------------------------------
+uint16 flicker_light_level(void)
+{
+
+  return (light_level);
+
+} /* flicker_light_level */
+
+
+//----------------------------------------------------------------------------
+// NAME: flicker_temp_level
+//
+// DESCRIPTION:
+//    This function returns the latest temperature channel reading taken by
+//    the interrupt as part of the light sequence.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the raw temperature reading (10-bit ADC counts)
+//----------------------------------------------------------------------------
+uint16 flicker_temp_level(void)
+{
+
+  return (temp_level);
+
+} /* flicker_temp_level */
+
+
+//----------------------------------------------------------------------------
+// NAME: flicker_mains_percent
+//
+// DESCRIPTION:
+//    This function returns the share of the light's AC energy found at the
+//    strongest mains flicker frequency in the last block.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the percentage, 0 to 100
+//----------------------------------------------------------------------------
+uint8 flicker_mains_percent(void)
+{
+
+  return (mains_percent);
+
+} /* flicker_mains_percent */
+
+
+//----------------------------------------------------------------------------
+// NAME: flicker_sweep_percent
+//
+// DESCRIPTION:
+//    This function returns the share of the light's slow AC energy found in
+//    the 1-3 Hz sweep band in the last block.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the percentage, 0 to 100
+//----------------------------------------------------------------------------
+uint8 flicker_sweep_percent(void)
+{
+
+  return (sweep_percent);
+
+} /* flicker_sweep_percent */
+
+
+//-----------------------------------------------------------------------------
+//                             Private functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: flicker_reset
+//
+// DESCRIPTION:
+//    This function clears the interrupt side filter state.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void flicker_reset(void)
+{
+  uint8 bin;
+
+  for (bin = 0; bin < MAINS_BINS; bin++)
+  {
+    mains[bin].s1 = 0;
+    mains[bin].s2 = 0;
+  } /* for */
+
+  for (bin = 0; bin < SWEEP_BINS; bin++)
+  {
+    sweep[bin].s1 = 0;
+    sweep[bin].s2 = 0;
+  } /* for */
+
+  seeded = FALSE;
+  mains_energy = 0;
+  sweep_energy = 0;
+  mains_sum = 0;
+  sweep_sum = 0;
+  mains_count = 0;
+  sweep_count = 0;
+  decimate_count = 0;
+  decimate_sum = 0;
+  mains_ready = FALSE;
+  sweep_ready = FALSE;
+
+} /* flicker_reset */
+
+
+//----------------------------------------------------------------------------
+// NAME: flicker_ac_energy
+//
+// DESCRIPTION:
+//    This function removes what is left of the DC level from a block's
+//    energy: sum(x^2) - N * mean^2.
+//
+// INPUT:
+//   result      - the finished block
+//   block_shift - log2 of the block length
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the AC energy of the block
+//----------------------------------------------------------------------------
+static uint32 flicker_ac_energy(BLOCK_RESULT_t* result, uint8 block_shift)
+{
+  sint16 mean;
+  uint32 dc_energy;
+
+  mean = (sint16)(result->sum >> block_shift);
+  dc_energy = (uint32)((sint32)mean * mean) << block_shift;
+
+  if (dc_energy >= result->energy)
+  {
+    return (0);
+  } /* if */
+
+  return (result->energy - dc_energy);
+
+} /* flicker_ac_energy */
+
+
+//----------------------------------------------------------------------------
+// NAME: flicker_bin_percent
+//
+// DESCRIPTION:
+//    This function works out how much of a block's AC energy a Goertzel bin
+//    holds. A pure tone at the bin frequency gives |X|^2 = (N A / 2)^2 and
+//    an energy of N A^2 / 2, so the share is 2 |X|^2 / (N * energy).
+//
+// INPUT:
+//   state     - the bin's final s1 and s2
+//   coef      - the bin's coefficient (Q14)
+//   ac_energy - the block's AC energy
+//   scale     - 3200 / N, folding in the scaling of the state
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the percentage, 0 to 100
+//----------------------------------------------------------------------------
+static uint8 flicker_bin_percent(GOERTZEL_t* state, sint16 coef,
+                                 uint32 ac_energy, uint16 scale)
+{
+  sint32 s1 = state->s1 >> POWER_SHIFT;
+  sint32 s2 = state->s2 >> POWER_SHIFT;
+  sint32 power;
+  uint32 denominator = ac_energy >> POWER_SHIFT;
+  uint32 percent;
+
+  power = (s1 * s1) + (s2 * s2) - (((coef * s1) >> COEF_FRAC_BITS) * s2);
+
+  if ((power <= 0) || (denominator == 0))
+  {
+    return (0);
+  } /* if */
+
+  percent = ((uint32)power * scale) / denominator;
+
+  return ((percent > 100) ? 100 : (uint8)percent);
+
+} /* flicker_bin_percent */
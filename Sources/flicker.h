@@ -0,0 +1,52 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: flicker.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for the high rate light sampler and
+//    the Goertzel filter bank used to tell daylight, mains powered lighting
+//    and a moving light source (a swinging flashlight) apart.
+//
+//*****************************************************************************
+
+#ifndef _FLICKER_H_
+#define _FLICKER_H_
+
+#include "sys_types.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// Light source classes
+#define LIGHT_SOURCE_UNKNOWN    0       // no block analysed yet
+#define LIGHT_SOURCE_AMBIENT    1       // steady light (daylight, darkness)
+#define LIGHT_SOURCE_ARTIFICIAL 2       // 100/120 Hz mains flicker present
+#define LIGHT_SOURCE_MOVING     3       // strong 1-3 Hz sweep
+
+// AD0 channels; the sequence converts the light channel and the next three,
+// so the temperature channel comes along for free
+#define FLICKER_LIGHT_CHANNEL   4
+#define FLICKER_TEMP_CHANNEL    5
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+void   flicker_init(void);
+void   flicker_set_enabled(bool enabled);
+bool   flicker_is_enabled(void);
+void   flicker_sample(void);
+bool   flicker_poll(void);
+uint8  flicker_source(void);
+uint16 flicker_light_level(void);
+uint16 flicker_temp_level(void);
+uint8  flicker_mains_percent(void);
+uint8  flicker_sweep_percent(void);
+
+#endif /* _FLICKER_H_ */
@@ -0,0 +1,363 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: idle.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file replaces the ms_delay() busy loop in main.asm. ms_delay()
+//    counts down a register for the whole delay, so nothing else in the
+//    main loop runs: the siren stops changing pitch, the readers aren't
+//    polled and console input is lost.
+//
+//    sleep_ms() and wait_until() time the wait on the timebase instead.
+//    While they wait they call the idle task, which main() sets to
+//    background_service(), then execute WAI. WAI stops the CPU clocks
+//    until an interrupt; the 1.024 ms real-time interrupt wakes it at the
+//    latest, so the wait ends at most a tick late.
+//
+//    The idle task is only set once start up is over, so the drivers'
+//    waits during their own set up just sleep. A task that waits in turn
+//    calls itself again; background_service() returns straight away when
+//    it is already running.
+//
+//    Every WAI and every run of the idle task from a wait is timed, which
+//    tells how much of the CPU the system uses (idle_get_load()). Time
+//    spent in interrupts that wake a WAI counts as asleep.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include <stddef.h>                 // NULL
+#include <mc9s12dg256.h>            // derivative information
+#include "idle.h"
+#include "timebase.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define RTI_ENABLE              0x80    // CRGINT RTIE
+#define US_PER_MS               1000
+
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  uint32 ms;
+  uint16 us;            // not yet in ms
+} IDLE_TIME_t;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+static IDLE_TASK_t idle_task;
+static IDLE_TIME_t sleep_time;
+static IDLE_TIME_t task_time;
+static uint32      cleared_ms;
+static uint16      waits;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+static void idle_run_task(void);
+static void idle_account(IDLE_TIME_t* total, uint32 start_us);
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: idle_init
+//
+// DESCRIPTION:
+//    This function removes the idle task and clears the time counts. The
+//    timebase must be running.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void idle_init(void)
+{
+
+  idle_task = NULL;
+  idle_clear_load();
+
+} /* idle_init */
+
+
+//----------------------------------------------------------------------------
+// NAME: idle_set_task
+//
+// DESCRIPTION:
+//    This function sets the work to run while waiting.
+//
+// INPUT:
+//   task - called over and over during a wait, or NULL to only sleep
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void idle_set_task(IDLE_TASK_t task)
+{
+
+  idle_task = task;
+
+} /* idle_set_task */
+
+
+//----------------------------------------------------------------------------
+// NAME: sleep_ms
+//
+// DESCRIPTION:
+//    This function waits for a time, running the idle task and sleeping
+//    in between. It takes the place of ms_delay().
+//
+// INPUT:
+//   ms - the time to wait; the wait may run over by an idle task run or
+//        a tick
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void sleep_ms(uint16 ms)
+{
+  uint32 start = timebase_us();
+  uint32 span = (uint32)ms * US_PER_MS;
+
+  waits++;
+  while (timebase_us() - start < span)
+  {
+    idle_run_task();
+    if (timebase_us() - start < span)
+    {
+      idle_wait();
+    } /* if */
+  } /* while */
+
+} /* sleep_ms */
+
+
+//----------------------------------------------------------------------------
+// NAME: wait_until
+//
+// DESCRIPTION:
+//    This function waits for a condition, running the idle task and
+//    sleeping in between checks. An interrupt that makes the condition
+//    true ends the wait as soon as the CPU wakes.
+//
+// INPUT:
+//   predicate  - returns TRUE once the condition is met
+//   context    - passed to predicate
+//   timeout_ms - the longest time to wait
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if the condition was met, FALSE on a timeout
+//----------------------------------------------------------------------------
+bool wait_until(IDLE_PREDICATE_t predicate, void* context, uint16 timeout_ms)
+{
+  uint32 start = timebase_us();
+  uint32 span = (uint32)timeout_ms * US_PER_MS;
+
+  waits++;
+  for (;;)
+  {
+    if (predicate(context))
+    {
+      return (TRUE);
+    } /* if */
+
+    if (timebase_us() - start >= span)
+    {
+      return (FALSE);
+    } /* if */
+
+    idle_run_task();
+    if (!predicate(context))
+    {
+      idle_wait();
+    } /* if */
+  } /* for */
+
+} /* wait_until */
+
+
+//----------------------------------------------------------------------------
+// NAME: idle_wait
+//
+// DESCRIPTION:
+//    This function stops the CPU until the next interrupt. It returns at
+//    once if the real-time interrupt is off, since then nothing might
+//    wake it. Interrupts must not be masked.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void idle_wait(void)
+{
+  uint32 start;
+
+  if (!(CRGINT & RTI_ENABLE))
+  {
+    return;
+  } /* if */
+
+  start = timebase_us();
+  __asm WAI;
+  idle_account(&sleep_time, start);
+
+} /* idle_wait */
+
+
+//----------------------------------------------------------------------------
+// NAME: idle_get_load
+//
+// DESCRIPTION:
+//    This function returns how the time since the counts were cleared
+//    was spent. Busy time is elapsed_ms - sleep_ms.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   load - the time counts
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void idle_get_load(IDLE_LOAD_t* load)
+{
+
+  load->elapsed_ms = timebase_ms() - cleared_ms;
+  load->sleep_ms = sleep_time.ms;
+  load->task_ms = task_time.ms;
+  load->waits = waits;
+
+} /* idle_get_load */
+
+
+//----------------------------------------------------------------------------
+// NAME: idle_clear_load
+//
+// DESCRIPTION:
+//    This function starts the time counts over.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void idle_clear_load(void)
+{
+
+  sleep_time.ms = 0;
+  sleep_time.us = 0;
+  task_time.ms = 0;
+  task_time.us = 0;
+  waits = 0;
+  cleared_ms = timebase_ms();
+
+} /* idle_clear_load */
+
+
+//-----------------------------------------------------------------------------
+//                             Private functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: idle_run_task
+//
+// DESCRIPTION:
+//    This function runs the idle task, if there is one, and times it.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void idle_run_task(void)
+{
+  uint32 start;
+
+  if (idle_task == NULL)
+  {
+    return;
+  } /* if */
+
+  start = timebase_us();
+  idle_task();
+  idle_account(&task_time, start);
+
+} /* idle_run_task */
+
+
+//----------------------------------------------------------------------------
+// NAME: idle_account
+//
+// DESCRIPTION:
+//    This function adds the time since start_us to a total. Totals are
+//    kept in ms, so they last 49 days rather than the 71 minutes of the
+//    us clock.
+//
+// INPUT:
+//   total    - the total to add to
+//   start_us - timebase_us() at the start of the period
+//
+// OUTPUT:
+//   total - the new total
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void idle_account(IDLE_TIME_t* total, uint32 start_us)
+{
+  uint32 us = timebase_us() - start_us + total->us;
+
+  total->ms += us / US_PER_MS;
+  total->us = (uint16)(us % US_PER_MS);
+
+} /* idle_account */
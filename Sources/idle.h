@@ -0,0 +1,50 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: idle.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for waiting without spinning:
+//    sleep_ms() and wait_until() run the main loop's other work, then
+//    stop the CPU until the next interrupt, and keep count of the time
+//    spent both ways.
+//
+//*****************************************************************************
+
+#ifndef _IDLE_H_
+#define _IDLE_H_
+
+#include "sys_types.h"
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef void (*IDLE_TASK_t)(void);
+typedef bool (*IDLE_PREDICATE_t)(void* context);
+
+typedef struct
+{
+  uint32 elapsed_ms;    // since idle_clear_load()
+  uint32 sleep_ms;      // stopped in WAI
+  uint32 task_ms;       // running the idle task from inside a wait
+  uint16 waits;         // sleep_ms() and wait_until() calls
+} IDLE_LOAD_t;
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+void idle_init(void);
+void idle_set_task(IDLE_TASK_t task);
+void sleep_ms(uint16 ms);
+bool wait_until(IDLE_PREDICATE_t predicate, void* context, uint16 timeout_ms);
+void idle_wait(void);
+void idle_get_load(IDLE_LOAD_t* load);
+void idle_clear_load(void);
+
+#endif /* _IDLE_H_ */
@@ -0,0 +1,907 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: journal.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file implements the event journal. Flash block 3 (pages 0x30 -
+//    0x33, 64K) is used as a ring of 128 sectors of 32 records each:
+//
+//      byte  0-3   sequence number
+//      byte  4-7   timestamp, ms since start up
+//      byte  8     event type
+//      byte  9     detail
+//      byte 10-13  value
+//      byte 14-15  CRC-16 (CCITT) of bytes 0-13
+//
+//    All values are big endian. Records are only ever appended:
+//
+//      - The CRC word is programmed last, so a record torn by a reset or
+//        power loss fails its check and is skipped. Nothing is ever
+//        written twice, so a torn record can't damage an older one.
+//      - The sector after the one being filled is always erased ahead of
+//        time, taking the oldest records with it. An erase interrupted by
+//        a reset is simply redone at start up.
+//      - journal_append() only queues a record in RAM. journal_service()
+//        starts at most one flash command per call and never waits for
+//        one, so a 20 ms sector erase doesn't hold up the main loop.
+//
+//    At start up the first record of every sector is read to find the
+//    oldest and newest sectors. Sequence numbers increase around the ring,
+//    so journal_read() finds a record with a binary search over sectors
+//    followed by a scan of at most 32 slots.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include "journal.h"
+#include "flash.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define SECTORS_PER_PAGE        (FLASH_PAGE_SIZE / FLASH_SECTOR_SIZE)
+#define SECTORS                 (JOURNAL_PAGES * SECTORS_PER_PAGE)
+#define SLOTS_PER_SECTOR        (FLASH_SECTOR_SIZE / JOURNAL_RECORD_SIZE)
+#define WORDS_PER_RECORD        (JOURNAL_RECORD_SIZE / 2)
+#define RECORD_CHECKED_SIZE     (JOURNAL_RECORD_SIZE - 2)
+
+#define NO_SEQUENCE             0xFFFFFFFFUL
+
+// Slot states
+#define SLOT_EMPTY              0       // still erased
+#define SLOT_VALID              1
+#define SLOT_TORN               2       // partly programmed
+
+#define CRC_POLYNOMIAL          0x1021
+#define CRC_INITIAL             0xFFFF
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+static uint8  head_sector;              // sector being filled
+static uint8  head_slot;                // next free slot in it
+static uint8  oldest_sector;
+static uint32 next_sequence;
+static uint32 first_sequence;
+static bool   first_sequence_stale;
+
+static bool   erase_pending;
+static uint8  erase_sector;
+static bool   command_active;
+
+static uint8  queue[JOURNAL_QUEUE_SIZE][JOURNAL_RECORD_SIZE];
+static uint8  queue_head;
+static uint8  queue_tail;
+static uint8  queue_count;
+static uint8  word_index;               // next word of the tail record
+
+static uint16 dropped_records;
+static uint16 flash_errors;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+static uint8  journal_page(uint8 sector);
+static uint16 journal_offset(uint8 sector, uint8 slot);
+static uint8  journal_read_slot(uint8 sector, uint8 slot, uint8 raw[JOURNAL_RECORD_SIZE]);
+static uint32 journal_sector_sequence(uint8 sector);
+static void   journal_release(uint8 sector);
+static void   journal_erase_ahead(void);
+static void   journal_erase_now(uint8 sector);
+static uint16 journal_crc(const uint8* data, uint8 length);
+static void   journal_put32(uint8* destination, uint32 value);
+static uint32 journal_get32(const uint8* source);
+static void   journal_decode(const uint8 raw[JOURNAL_RECORD_SIZE], JOURNAL_RECORD_t* record);
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: journal_init
+//
+// DESCRIPTION:
+//    This function finds the end of the journal left by the last run and
+//    schedules the erase of the sector ahead of it. A blank or unreadable
+//    journal is started over at sequence 1.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void journal_init(void)
+{
+  uint8  raw[JOURNAL_RECORD_SIZE];
+  uint8  sector;
+  uint8  slot;
+  uint32 sequence;
+  uint32 newest = 0;
+  uint32 oldest = NO_SEQUENCE;
+  bool   found = FALSE;
+
+  flash_init();
+
+  queue_head = 0;
+  queue_tail = 0;
+  queue_count = 0;
+  word_index = 0;
+  command_active = FALSE;
+  erase_pending = FALSE;
+  first_sequence_stale = FALSE;
+  dropped_records = 0;
+  flash_errors = 0;
+
+  for (sector = 0; sector < SECTORS; sector++)
+  {
+    sequence = journal_sector_sequence(sector);
+    if (sequence == NO_SEQUENCE)
+    {
+      continue;
+    } /* if */
+
+    if (!found || (sequence > newest))
+    {
+      newest = sequence;
+      head_sector = sector;
+    } /* if */
+    if (!found || (sequence < oldest))
+    {
+      oldest = sequence;
+      oldest_sector = sector;
+    } /* if */
+    found = TRUE;
+  } /* for */
+
+  if (!found)
+  {
+    head_sector = 0;
+    head_slot = 0;
+    oldest_sector = 0;
+    next_sequence = 1;
+    first_sequence = 1;
+    journal_erase_now(0);
+  } /* if */
+  else
+  {
+    // Resume after the last slot that was touched, valid or torn
+    head_slot = 0;
+    next_sequence = newest + 1;
+    for (slot = 0; slot < SLOTS_PER_SECTOR; slot++)
+    {
+      switch (journal_read_slot(head_sector, slot, raw))
+      {
+        case SLOT_VALID:
+          next_sequence = journal_get32(raw) + 1;
+          head_slot = slot + 1;
+          break;
+
+        case SLOT_TORN:
+          head_slot = slot + 1;
+          break;
+
+        default:
+          break;
+      } /* switch */
+    } /* for */
+
+    first_sequence = oldest;
+  } /* else */
+
+  if (head_slot == SLOTS_PER_SECTOR)
+  {
+    // The sector ahead may not have been erased yet; do it before using it
+    journal_erase_now((head_sector + 1) % SECTORS);
+    head_sector = (head_sector + 1) % SECTORS;
+    head_slot = 0;
+  } /* if */
+
+  // Always redo the erase ahead; the last one may have been cut short
+  journal_erase_ahead();
+
+} /* journal_init */
+
+
+//----------------------------------------------------------------------------
+// NAME: journal_append
+//
+// DESCRIPTION:
+//    This function queues a record to be written by journal_service(). The
+//    sequence number is assigned now, so records are numbered in the order
+//    they were appended.
+//
+// INPUT:
+//   timestamp - ms since start up
+//   type      - JOURNAL_*
+//   detail    - type specific detail
+//   value     - type specific value
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if queued, FALSE if the queue was full and the record was dropped
+//----------------------------------------------------------------------------
+bool journal_append(uint32 timestamp, uint8 type, uint8 detail, uint32 value)
+{
+  uint8* raw;
+  uint16 crc;
+
+  if (queue_count == JOURNAL_QUEUE_SIZE)
+  {
+    dropped_records++;
+    return (FALSE);
+  } /* if */
+
+  raw = queue[queue_head];
+  journal_put32(&raw[0], next_sequence++);
+  journal_put32(&raw[4], timestamp);
+  raw[8] = type;
+  raw[9] = detail;
+  journal_put32(&raw[10], value);
+  crc = journal_crc(raw, RECORD_CHECKED_SIZE);
+  raw[14] = (uint8)(crc >> 8);
+  raw[15] = (uint8)crc;
+
+  queue_head = (queue_head + 1) % JOURNAL_QUEUE_SIZE;
+  queue_count++;
+
+  return (TRUE);
+
+} /* journal_append */
+
+
+//----------------------------------------------------------------------------
+// NAME: journal_service
+//
+// DESCRIPTION:
+//    This function moves the journal along by at most one flash command:
+//    an erase ahead if one is due, otherwise the next word of the oldest
+//    queued record. It returns straight away while the flash is busy.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void journal_service(void)
+{
+  uint8* raw;
+  uint16 data;
+
+  if (flash_is_busy(JOURNAL_FIRST_PAGE))
+  {
+    return;
+  } /* if */
+
+  if (command_active)
+  {
+    command_active = FALSE;
+    if (flash_result(JOURNAL_FIRST_PAGE) == FLASH_ERROR)
+    {
+      // A failed word leaves a torn record, which readers skip
+      flash_errors++;
+    } /* if */
+  } /* if */
+
+  if (erase_pending)
+  {
+    erase_pending = FALSE;
+    if (flash_start_erase(journal_page(erase_sector), journal_offset(erase_sector, 0)) == FLASH_OK)
+    {
+      command_active = TRUE;
+    } /* if */
+    else
+    {
+      flash_errors++;
+    } /* else */
+    return;
+  } /* if */
+
+  if (first_sequence_stale)
+  {
+    first_sequence_stale = FALSE;
+    first_sequence = journal_sector_sequence(oldest_sector);
+  } /* if */
+
+  if (queue_count == 0)
+  {
+    return;
+  } /* if */
+
+  raw = queue[queue_tail];
+  data = ((uint16)raw[2 * word_index] << 8) | raw[2 * word_index + 1];
+  if (flash_start_program(journal_page(head_sector),
+                          journal_offset(head_sector, head_slot) + 2 * word_index,
+                          data) != FLASH_OK)
+  {
+    flash_errors++;
+  } /* if */
+  else
+  {
+    command_active = TRUE;
+  } /* else */
+
+  if (++word_index < WORDS_PER_RECORD)
+  {
+    return;
+  } /* if */
+
+  word_index = 0;
+  queue_tail = (queue_tail + 1) % JOURNAL_QUEUE_SIZE;
+  queue_count--;
+
+  if (++head_slot == SLOTS_PER_SECTOR)
+  {
+    head_sector = (head_sector + 1) % SECTORS;
+    head_slot = 0;
+    journal_erase_ahead();
+  } /* if */
+
+} /* journal_service */
+
+
+//----------------------------------------------------------------------------
+// NAME: journal_read
+//
+// DESCRIPTION:
+//    This function looks a record up by sequence number, including records
+//    still waiting in the queue.
+//
+// INPUT:
+//   sequence - the sequence number to find
+//
+// OUTPUT:
+//   record - the record, if found
+//
+// RETURN:
+//   JOURNAL_OK, JOURNAL_NOT_FOUND, or JOURNAL_BUSY while the flash is busy
+//----------------------------------------------------------------------------
+uint8 journal_read(uint32 sequence, JOURNAL_RECORD_t* record)
+{
+  uint8  raw[JOURNAL_RECORD_SIZE];
+  uint32 queued = next_sequence - queue_count;
+  uint8  count;
+  uint8  low;
+  uint8  high;
+  uint8  middle;
+  uint8  sector;
+  uint8  slot;
+
+  if (sequence >= next_sequence)
+  {
+    return (JOURNAL_NOT_FOUND);
+  } /* if */
+
+  if (sequence >= queued)
+  {
+    journal_decode(queue[(queue_tail + (uint8)(sequence - queued)) % JOURNAL_QUEUE_SIZE], record);
+    return (JOURNAL_OK);
+  } /* if */
+
+  if (flash_is_busy(JOURNAL_FIRST_PAGE) || first_sequence_stale)
+  {
+    return (JOURNAL_BUSY);
+  } /* if */
+
+  if (sequence < first_sequence)
+  {
+    return (JOURNAL_NOT_FOUND);
+  } /* if */
+
+  // Sectors holding records, oldest first; the head only once it has one
+  count = (uint8)((head_sector + SECTORS - oldest_sector) % SECTORS);
+  if (head_slot > 0)
+  {
+    count++;
+  } /* if */
+  if (count == 0)
+  {
+    return (JOURNAL_NOT_FOUND);
+  } /* if */
+
+  // Last sector whose first record is not after the one wanted
+  low = 0;
+  high = count - 1;
+  while (low < high)
+  {
+    middle = (uint8)((low + high + 1) / 2);
+    if (journal_sector_sequence((oldest_sector + middle) % SECTORS) <= sequence)
+    {
+      low = middle;
+    } /* if */
+    else
+    {
+      high = middle - 1;
+    } /* else */
+  } /* while */
+
+  sector = (oldest_sector + low) % SECTORS;
+  for (slot = 0; slot < SLOTS_PER_SECTOR; slot++)
+  {
+    if ((journal_read_slot(sector, slot, raw) == SLOT_VALID) &&
+        (journal_get32(raw) == sequence))
+    {
+      journal_decode(raw, record);
+      return (JOURNAL_OK);
+    } /* if */
+  } /* for */
+
+  // Lost to a torn write
+  return (JOURNAL_NOT_FOUND);
+
+} /* journal_read */
+
+
+//----------------------------------------------------------------------------
+// NAME: journal_next_sequence
+//
+// DESCRIPTION:
+//    This function returns the sequence number the next record will get.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the next sequence number
+//----------------------------------------------------------------------------
+uint32 journal_next_sequence(void)
+{
+
+  return (next_sequence);
+
+} /* journal_next_sequence */
+
+
+//----------------------------------------------------------------------------
+// NAME: journal_first_sequence
+//
+// DESCRIPTION:
+//    This function returns the sequence number of the oldest record still
+//    in flash.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the oldest sequence number
+//----------------------------------------------------------------------------
+uint32 journal_first_sequence(void)
+{
+
+  return (first_sequence);
+
+} /* journal_first_sequence */
+
+
+//----------------------------------------------------------------------------
+// NAME: journal_dropped
+//
+// DESCRIPTION:
+//    This function returns how many records were lost to a full queue.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the number of dropped records
+//----------------------------------------------------------------------------
+uint16 journal_dropped(void)
+{
+
+  return (dropped_records);
+
+} /* journal_dropped */
+
+
+//----------------------------------------------------------------------------
+// NAME: journal_errors
+//
+// DESCRIPTION:
+//    This function returns how many flash commands failed.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the number of failed flash commands
+//----------------------------------------------------------------------------
+uint16 journal_errors(void)
+{
+
+  return (flash_errors);
+
+} /* journal_errors */
+
+
+//-----------------------------------------------------------------------------
+//                             Private functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: journal_page
+//
+// DESCRIPTION:
+//    This function returns the flash page holding a sector.
+//
+// INPUT:
+//   sector - the sector, 0 to SECTORS - 1
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the page number
+//----------------------------------------------------------------------------
+static uint8 journal_page(uint8 sector)
+{
+
+  return ((uint8)(JOURNAL_FIRST_PAGE + sector / SECTORS_PER_PAGE));
+
+} /* journal_page */
+
+
+//----------------------------------------------------------------------------
+// NAME: journal_offset
+//
+// DESCRIPTION:
+//    This function returns the offset of a slot within its page.
+//
+// INPUT:
+//   sector - the sector
+//   slot   - the slot within the sector
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the offset within the page
+//----------------------------------------------------------------------------
+static uint16 journal_offset(uint8 sector, uint8 slot)
+{
+
+  return ((uint16)(sector % SECTORS_PER_PAGE) * FLASH_SECTOR_SIZE +
+          (uint16)slot * JOURNAL_RECORD_SIZE);
+
+} /* journal_offset */
+
+
+//----------------------------------------------------------------------------
+// NAME: journal_read_slot
+//
+// DESCRIPTION:
+//    This function reads a slot and works out what state it is in.
+//
+// INPUT:
+//   sector - the sector
+//   slot   - the slot within the sector
+//
+// OUTPUT:
+//   raw - the slot's bytes
+//
+// RETURN:
+//   SLOT_EMPTY, SLOT_VALID or SLOT_TORN
+//----------------------------------------------------------------------------
+static uint8 journal_read_slot(uint8 sector, uint8 slot, uint8 raw[JOURNAL_RECORD_SIZE])
+{
+  uint8 i;
+  bool  erased = TRUE;
+
+  flash_read(journal_page(sector), journal_offset(sector, slot), raw, JOURNAL_RECORD_SIZE);
+
+  for (i = 0; i < JOURNAL_RECORD_SIZE; i++)
+  {
+    if (raw[i] != 0xFF)
+    {
+      erased = FALSE;
+      break;
+    } /* if */
+  } /* for */
+
+  if (erased)
+  {
+    return (SLOT_EMPTY);
+  } /* if */
+
+  if (journal_crc(raw, RECORD_CHECKED_SIZE) != (((uint16)raw[14] << 8) | raw[15]))
+  {
+    return (SLOT_TORN);
+  } /* if */
+
+  return (SLOT_VALID);
+
+} /* journal_read_slot */
+
+
+//----------------------------------------------------------------------------
+// NAME: journal_sector_sequence
+//
+// DESCRIPTION:
+//    This function returns the sequence number of the first valid record
+//    in a sector. Usually that is slot 0, so this is one read.
+//
+// INPUT:
+//   sector - the sector
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the sequence number, or NO_SEQUENCE if the sector holds no records
+//----------------------------------------------------------------------------
+static uint32 journal_sector_sequence(uint8 sector)
+{
+  uint8 raw[JOURNAL_RECORD_SIZE];
+  uint8 slot;
+
+  for (slot = 0; slot < SLOTS_PER_SECTOR; slot++)
+  {
+    switch (journal_read_slot(sector, slot, raw))
+    {
+      case SLOT_VALID:
+        return (journal_get32(raw));
+
+      case SLOT_EMPTY:
+        return (NO_SEQUENCE);
+
+      default:
+        break;
+    } /* switch */
+  } /* for */
+
+  return (NO_SEQUENCE);
+
+} /* journal_sector_sequence */
+
+
+//----------------------------------------------------------------------------
+// NAME: journal_release
+//
+// DESCRIPTION:
+//    This function gives up a sector's records before it is erased,
+//    moving the oldest sector on if it was that one. The flash is usually
+//    busy here, so the first sequence number is moved past every number
+//    the sector could hold until journal_service() can read the exact one.
+//
+// INPUT:
+//   sector - the sector about to be erased
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void journal_release(uint8 sector)
+{
+
+  if ((sector == oldest_sector) && (sector != head_sector))
+  {
+    oldest_sector = (oldest_sector + 1) % SECTORS;
+    first_sequence += SLOTS_PER_SECTOR;
+    if (first_sequence > next_sequence)
+    {
+      first_sequence = next_sequence;
+    } /* if */
+    first_sequence_stale = TRUE;
+  } /* if */
+
+} /* journal_release */
+
+
+//----------------------------------------------------------------------------
+// NAME: journal_erase_ahead
+//
+// DESCRIPTION:
+//    This function schedules the erase of the sector after the head, so it
+//    is blank by the time the head reaches it.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void journal_erase_ahead(void)
+{
+
+  erase_sector = (head_sector + 1) % SECTORS;
+  journal_release(erase_sector);
+  erase_pending = TRUE;
+
+} /* journal_erase_ahead */
+
+
+//----------------------------------------------------------------------------
+// NAME: journal_erase_now
+//
+// DESCRIPTION:
+//    This function erases a sector and waits for it. It is only used at
+//    start up, before detection is running.
+//
+// INPUT:
+//   sector - the sector to erase
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void journal_erase_now(uint8 sector)
+{
+
+  journal_release(sector);
+
+  while (flash_is_busy(JOURNAL_FIRST_PAGE))
+  {
+  } /* while */
+
+  if (flash_start_erase(journal_page(sector), journal_offset(sector, 0)) != FLASH_OK)
+  {
+    flash_errors++;
+    return;
+  } /* if */
+
+  while (flash_is_busy(JOURNAL_FIRST_PAGE))
+  {
+  } /* while */
+
+  if (flash_result(JOURNAL_FIRST_PAGE) == FLASH_ERROR)
+  {
+    flash_errors++;
+  } /* if */
+
+} /* journal_erase_now */
+
+
+//----------------------------------------------------------------------------
+// NAME: journal_crc
+//
+// DESCRIPTION:
+//    This function computes the CRC-16 (CCITT, 0x1021, initial 0xFFFF).
+//
+// INPUT:
+//   data   - the bytes to check
+//   length - the number of bytes
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the CRC
+//----------------------------------------------------------------------------
+static uint16 journal_crc(const uint8* data, uint8 length)
+{
+  uint16 crc = CRC_INITIAL;
+  uint8  bit;
+
+  while (length-- > 0)
+  {
+    crc ^= (uint16)(*data++) << 8;
+    for (bit = 0; bit < 8; bit++)
+    {
+      crc = (crc & 0x8000) ? (uint16)((crc << 1) ^ CRC_POLYNOMIAL) : (uint16)(crc << 1);
+    } /* for */
+  } /* while */
+
+  return (crc);
+
+} /* journal_crc */
+
+
+//----------------------------------------------------------------------------
+// NAME: journal_put32
+//
+// DESCRIPTION:
+//    This function stores a 32-bit value big endian.
+//
+// INPUT:
+//   destination - where to store it
+//   value       - the value
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void journal_put32(uint8* destination, uint32 value)
+{
+
+  destination[0] = (uint8)(value >> 24);
+  destination[1] = (uint8)(value >> 16);
+  destination[2] = (uint8)(value >> 8);
+  destination[3] = (uint8)value;
+
+} /* journal_put32 */
+
+
+//----------------------------------------------------------------------------
+// NAME: journal_get32
+//
+// DESCRIPTION:
+//    This function loads a big endian 32-bit value.
+//
+// INPUT:
+//   source - where to load it from
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the value
+//----------------------------------------------------------------------------
+static uint32 journal_get32(const uint8* source)
+{
+
+  return (((uint32)source[0] << 24) | ((uint32)source[1] << 16) |
+          ((uint32)source[2] << 8) | (uint32)source[3]);
+
+} /* journal_get32 */
+
+
+//----------------------------------------------------------------------------
+// NAME: journal_decode
+//
+// DESCRIPTION:
+//    This function unpacks a record.
+//
+// INPUT:
+//   raw - the record's bytes
+//
+// OUTPUT:
+//   record - the unpacked record
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void journal_decode(const uint8 raw[JOURNAL_RECORD_SIZE], JOURNAL_RECORD_t* record)
+{
+
+  record->sequence = journal_get32(&raw[0]);
+  record->timestamp = journal_get32(&raw[4]);
+  record->type = raw[8];
+  record->detail = raw[9];
+  record->value = journal_get32(&raw[10]);
+
+} /* journal_decode */
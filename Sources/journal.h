@@ -0,0 +1,80 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: journal.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for the event journal, an append
+//    only log of fixed size records kept in banked flash so security
+//    events survive a reset or power loss.
+//
+//*****************************************************************************
+
+#ifndef _JOURNAL_H_
+#define _JOURNAL_H_
+
+#include "sys_types.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// The journal owns flash block 3. PAGE_30 - PAGE_33 must stay out of the
+// PRM placement.
+#define JOURNAL_FIRST_PAGE      0x30
+#define JOURNAL_PAGES           4
+#define JOURNAL_RECORD_SIZE     16
+#define JOURNAL_QUEUE_SIZE      8       // records waiting to be programmed
+
+// Event types
+#define JOURNAL_BOOT            1       // detail: WATCHDOG_RESET_*, value: task that missed
+#define JOURNAL_AUTH_USER       2       // value: card UID
+#define JOURNAL_AUTH_ADMIN      3       // value: card UID
+#define JOURNAL_AUTH_REJECTED   4       // value: card UID
+#define JOURNAL_PIN_OK          5       // detail: 1 if skipped for a recent login
+#define JOURNAL_PIN_FAILED      6       // detail: attempt number
+#define JOURNAL_STATUS          7       // detail: new SYSTEM_STATUS_*
+#define JOURNAL_ALARM_SILENCED  8
+#define JOURNAL_ALERTNESS       9       // detail: new alertness level
+#define JOURNAL_TAMPER          10      // detail: TAMPER_*, value: magnitude
+#define JOURNAL_CARD_INVALID    11      // detail: reason, value: card UID
+#define JOURNAL_READER          12      // detail: door, value: action << 8 | cause
+#define JOURNAL_LOGOUT          13      // detail: SESSION_END_*, value: user level
+#define JOURNAL_STACK           14      // detail: 1 if it overflowed, value: bytes used
+
+// journal_read() results
+#define JOURNAL_OK              0
+#define JOURNAL_NOT_FOUND       1
+#define JOURNAL_BUSY            2       // flash busy, try again later
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  uint32 sequence;      // increases by one per record, never reused
+  uint32 timestamp;     // ms since start up
+  uint8  type;          // JOURNAL_*
+  uint8  detail;        // type specific
+  uint32 value;         // type specific
+} JOURNAL_RECORD_t;
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+void   journal_init(void);
+bool   journal_append(uint32 timestamp, uint8 type, uint8 detail, uint32 value);
+void   journal_service(void);
+uint8  journal_read(uint32 sequence, JOURNAL_RECORD_t* record);
+uint32 journal_next_sequence(void);
+uint32 journal_first_sequence(void);
+uint16 journal_dropped(void);
+uint16 journal_errors(void);
+
+#endif /* _JOURNAL_H_ */
@@ -0,0 +1,418 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: keypad.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file implements the keypad scanner. The keypad is a 4x4 matrix
+//    on port A: A3:A0 drive one line low at a time and A7:A4 read the
+//    other side with pull ups, so a pressed key reads low.
+//
+//    keypad_scan() is called from the tick interrupt. Each call reads the
+//    line driven on the previous call and drives the next one, so the
+//    line has a whole tick to settle and the interrupt never waits. After
+//    every fourth call a full scan of all 16 keys is complete and:
+//
+//      1) A scan with two lines sharing two or more pressed keys is
+//         dropped. Three keys on the corners of a rectangle make the
+//         fourth corner read as pressed (a ghost), so such a scan can't
+//         be trusted. Any other combination of keys is read correctly.
+//      2) Each key is debounced on its own with a 2-bit vertical counter:
+//         it must read the same for 4 scans (~16 ms) before its state
+//         changes. Bouncing on one key doesn't hold up the others.
+//      3) Keys that changed queue a press or release event. A key still
+//         held after KEYPAD_LONG_PRESS_SCANS queues one long press.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include <mc9s12dg256.h>            // derivative information
+#include "keypad.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define KEYPAD_LINES            4
+#define DRIVE_OUTPUTS           0x0F    // DDRA: A3:A0 out, A7:A4 in
+#define PORTA_PULLUPS           0x01    // PUCR PUPAE
+#define SENSE_SHIFT             4
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+// Key value for each driven line and sensed input (see keycodes in
+// main.asm)
+static const uint8 key_map[KEYPAD_LINES][KEYPAD_LINES] =
+{
+  { 0x1, 0x4, 0x7, KEYPAD_KEY_STAR },
+  { 0x2, 0x5, 0x8, 0x0             },
+  { 0x3, 0x6, 0x9, KEYPAD_KEY_HASH },
+  { KEYPAD_KEY_A, KEYPAD_KEY_B, KEYPAD_KEY_C, KEYPAD_KEY_D }
+};
+
+// Port A value that drives each line low
+static const uint8 line_drive[KEYPAD_LINES] = { 0x0E, 0x0D, 0x0B, 0x07 };
+
+static uint8  line;                     // line being driven
+static uint8  sensed[KEYPAD_LINES];     // pressed inputs per line, this scan
+static uint16 debounced;                // bit n set while key n is down
+static uint16 count0;                   // vertical debounce counter, bit 0
+static uint16 count1;                   // vertical debounce counter, bit 1
+static uint8  held[KEYPAD_KEYS];        // scans each key has been down
+static uint16 dropped_events;
+
+static KEYPAD_EVENT_t event_queue[KEYPAD_QUEUE_SIZE];
+static volatile uint8 event_head;       // written by the interrupt only
+static volatile uint8 event_tail;       // written by the main loop only
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+static void keypad_process(uint16 timestamp);
+static bool keypad_is_ghosted(void);
+static void keypad_queue_event(uint16 timestamp, uint8 type, uint8 key);
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: keypad_init
+//
+// DESCRIPTION:
+//    This function sets up port A for the keypad and resets the scanner.
+//    It takes the place of keypad_enable().
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void keypad_init(void)
+{
+  uint8 key;
+
+  DDRA = DRIVE_OUTPUTS;
+  PUCR |= PORTA_PULLUPS;
+
+  for (key = 0; key < KEYPAD_KEYS; key++)
+  {
+    held[key] = 0;
+  } /* for */
+
+  debounced = 0;
+  count0 = 0xFFFF;
+  count1 = 0xFFFF;
+  dropped_events = 0;
+  event_head = 0;
+  event_tail = 0;
+
+  line = 0;
+  PORTA = line_drive[line];
+
+} /* keypad_init */
+
+
+//----------------------------------------------------------------------------
+// NAME: keypad_scan
+//
+// DESCRIPTION:
+//    This function reads the line driven on the previous call, drives the
+//    next one, and processes the scan after the last line. It is meant to
+//    be called from the tick interrupt at a fixed rate.
+//
+// INPUT:
+//   timestamp - the current tick count, stored with any event raised
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void keypad_scan(uint16 timestamp)
+{
+
+  // Pressed keys pull their input low
+  sensed[line] = (uint8)(~PORTA >> SENSE_SHIFT) & 0x0F;
+
+  line = (line + 1) % KEYPAD_LINES;
+  PORTA = line_drive[line];
+
+  if (line == 0)
+  {
+    keypad_process(timestamp);
+  } /* if */
+
+} /* keypad_scan */
+
+
+//----------------------------------------------------------------------------
+// NAME: keypad_get_event
+//
+// DESCRIPTION:
+//    This function removes the oldest keypad event from the queue. The
+//    queue has a single producer (the interrupt) and a single consumer
+//    (the main loop) so no interrupt masking is needed.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   event - the oldest event, if there is one
+//
+// RETURN:
+//   TRUE if an event was returned, FALSE if the queue was empty
+//----------------------------------------------------------------------------
+bool keypad_get_event(KEYPAD_EVENT_t* event)
+{
+  uint8 tail = event_tail;
+
+  if (tail == event_head)
+  {
+    return (FALSE);
+  } /* if */
+
+  *event = event_queue[tail];
+  event_tail = (tail + 1) & (KEYPAD_QUEUE_SIZE - 1);
+
+  return (TRUE);
+
+} /* keypad_get_event */
+
+
+//----------------------------------------------------------------------------
+// NAME: keypad_flush
+//
+// DESCRIPTION:
+//    This function throws away any queued events, e.g. keys pressed before
+//    a prompt was shown.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void keypad_flush(void)
+{
+
+  event_tail = event_head;
+
+} /* keypad_flush */
+
+
+//----------------------------------------------------------------------------
+// NAME: keypad_keys_down
+//
+// DESCRIPTION:
+//    This function returns the debounced state of all keys.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   bit n is set while key n is down
+//----------------------------------------------------------------------------
+uint16 keypad_keys_down(void)
+{
+
+  return (debounced);
+
+} /* keypad_keys_down */
+
+
+//----------------------------------------------------------------------------
+// NAME: keypad_dropped_events
+//
+// DESCRIPTION:
+//    This function returns how many events were lost to a full queue.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the number of dropped events
+//----------------------------------------------------------------------------
+uint16 keypad_dropped_events(void)
+{
+
+  return (dropped_events);
+
+} /* keypad_dropped_events */
+
+
+//-----------------------------------------------------------------------------
+//                             Private functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: keypad_process
+//
+// DESCRIPTION:
+//    This function debounces a complete scan and queues the events.
+//
+// INPUT:
+//   timestamp - the tick count of the scan
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void keypad_process(uint16 timestamp)
+{
+  uint16 raw = 0;
+  uint16 changed;
+  uint16 mask;
+  uint8  drive;
+  uint8  sense;
+  uint8  key;
+
+  if (keypad_is_ghosted())
+  {
+    return;
+  } /* if */
+
+  for (drive = 0; drive < KEYPAD_LINES; drive++)
+  {
+    for (sense = 0; sense < KEYPAD_LINES; sense++)
+    {
+      if (sensed[drive] & (1 << sense))
+      {
+        raw |= 1 << key_map[drive][sense];
+      } /* if */
+    } /* for */
+  } /* for */
+
+  // Counters of keys that read the same as their state are held at 3;
+  // the others count down and the key changes when they wrap
+  changed = raw ^ debounced;
+  count0 = ~(count0 & changed);
+  count1 = count0 ^ (count1 & changed);
+  changed &= count0 & count1;
+  debounced ^= changed;
+
+  for (key = 0, mask = 1; key < KEYPAD_KEYS; key++, mask <<= 1)
+  {
+    if (changed & mask)
+    {
+      held[key] = 0;
+      keypad_queue_event(timestamp, (debounced & mask) ? KEYPAD_PRESS : KEYPAD_RELEASE, key);
+    } /* if */
+    else if ((debounced & mask) && (held[key] < KEYPAD_LONG_PRESS_SCANS))
+    {
+      if (++held[key] == KEYPAD_LONG_PRESS_SCANS)
+      {
+        keypad_queue_event(timestamp, KEYPAD_LONG_PRESS, key);
+      } /* if */
+    } /* else if */
+  } /* for */
+
+} /* keypad_process */
+
+
+//----------------------------------------------------------------------------
+// NAME: keypad_is_ghosted
+//
+// DESCRIPTION:
+//    This function checks the scan for a rectangle of pressed keys, where
+//    one of the four may be a ghost.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if the scan can't be trusted
+//----------------------------------------------------------------------------
+static bool keypad_is_ghosted(void)
+{
+  uint8 first;
+  uint8 second;
+  uint8 common;
+
+  for (first = 0; first < KEYPAD_LINES - 1; first++)
+  {
+    for (second = first + 1; second < KEYPAD_LINES; second++)
+    {
+      // More than one bit set
+      common = sensed[first] & sensed[second];
+      if (common & (common - 1))
+      {
+        return (TRUE);
+      } /* if */
+    } /* for */
+  } /* for */
+
+  return (FALSE);
+
+} /* keypad_is_ghosted */
+
+
+//----------------------------------------------------------------------------
+// NAME: keypad_queue_event
+//
+// DESCRIPTION:
+//    This function adds an event to the queue, dropping it if the queue is
+//    full.
+//
+// INPUT:
+//   timestamp - the tick count of the event
+//   type      - KEYPAD_PRESS, KEYPAD_RELEASE or KEYPAD_LONG_PRESS
+//   key       - the key value
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void keypad_queue_event(uint16 timestamp, uint8 type, uint8 key)
+{
+  uint8 head = event_head;
+  uint8 next = (head + 1) & (KEYPAD_QUEUE_SIZE - 1);
+
+  if (next == event_tail)
+  {
+    dropped_events++;
+    return;
+  } /* if */
+
+  event_queue[head].timestamp = timestamp;
+  event_queue[head].type = type;
+  event_queue[head].key = key;
+  event_head = next;
+
+} /* keypad_queue_event */
@@ -0,0 +1,68 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: keypad.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for the interrupt driven 4x4
+//    keypad scanner. The scanner runs from the periodic tick interrupt,
+//    debounces every key on its own and queues press, release and long
+//    press events for the main loop.
+//
+//*****************************************************************************
+
+#ifndef _KEYPAD_H_
+#define _KEYPAD_H_
+
+#include "sys_types.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// Key values, the same as getkey() returns
+#define KEYPAD_KEY_A            0x0A
+#define KEYPAD_KEY_B            0x0B
+#define KEYPAD_KEY_C            0x0C
+#define KEYPAD_KEY_D            0x0D
+#define KEYPAD_KEY_STAR         0x0E
+#define KEYPAD_KEY_HASH         0x0F
+#define KEYPAD_KEYS             16
+
+// Keypad event types
+#define KEYPAD_PRESS            1
+#define KEYPAD_RELEASE          2
+#define KEYPAD_LONG_PRESS       3       // still held KEYPAD_LONG_PRESS_SCANS on
+
+// One line is driven per call, so a full scan takes 4 ticks (~4 ms)
+#define KEYPAD_LONG_PRESS_SCANS 183     // ~750 ms
+
+#define KEYPAD_QUEUE_SIZE       16      // must be a power of 2
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  uint16 timestamp;     // tick count when the event was detected
+  uint8  type;          // KEYPAD_PRESS, KEYPAD_RELEASE or KEYPAD_LONG_PRESS
+  uint8  key;           // 0x0 - 0xF
+} KEYPAD_EVENT_t;
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+void   keypad_init(void);
+void   keypad_scan(uint16 timestamp);
+bool   keypad_get_event(KEYPAD_EVENT_t* event);
+void   keypad_flush(void);
+uint16 keypad_keys_down(void);
+uint16 keypad_dropped_events(void);
+
+#endif /* _KEYPAD_H_ */
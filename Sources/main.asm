@@ -20,6 +20,7 @@
             XDEF hex2lcd,hex2asc,type_lcd, write_int_lcd, write_long_lcd       
             XDEF SCI0_init, inchar0, outchar0 
             XDEF SCI1_init, inchar1, outchar1
+            XREF recorder_dumping
             XDEF number 
             XDEF ad0_enable, ad0conv, ad1_enable, ad1conv
             XDEF servo54_init,servo76_init
@@ -619,9 +620,13 @@ inchar1:
             RTS
             
 outchar1:
+            TST   recorder_dumping   ; drop console output while the
+            BNE   outchar1_done      ; black box dump owns SCI1
+outchar1_wait:
             TST   SCI1SR1
-            BPL   outchar1
+            BPL   outchar1_wait
             STAB  SCI1DRL
+outchar1_done:
             RTS
                                                                         
 
@@ -1113,12 +1118,13 @@ SS2_LO:
 ;   Real-time interrupt
 ;   RTI_init();
 RTI_init:
+		        pshc			        ;save the I bit
   	        sei			          ;disable interrupts
 		        ldaa	#$54
 		        staa	RTICTL	    ;set rti to 10.24 ms
 		        ldaa	#$80
 		        staa	CRGINT	    ;enable rti
-		        cli			          ;enable interrupts
+		        pulc			        ;interrupts back as they were
 		        rts
 
 ;   clear_RTI_flag();
@@ -1143,8 +1149,7 @@ SCI0_int_init:
             LDD   #$E360
             EDIV
             STY   SCI0BDH
-            CLI                     ;enable interrupts
-            RTS
+            RTS                     ;main() enables interrupts
 
 
 ;   Read Rx byte
@@ -1168,8 +1173,7 @@ ptrain6_init:
             bset  TCTL1,#$20  ;PT6 low on TC6  match
             bclr  TCTL1,#$10
             bset  TIE,#$40    ;enable TC6 interrupts
-            cli               ;enable interrupts
-            rts
+            rts               ;main() enables interrupts
               
 ; void ptrain(int period, int pwidth);
 ; pwidth is in D
@@ -1188,9 +1192,10 @@ ptrain6:
             
 ;  sound_init()
 sound_init:
-            movb  #$A0,TIOS   ;select output compares 5 & 7
-            movb  #$04,TSCR2  ;div by 16: 24MHz/16 = 1.5 MHz
-            movb  #$80,TSCR1  ;enable timer
+            bset  TIOS,#$A0   ;select output compares 5 & 7
+            bclr  TSCR2,#$03  ;div by 16: 24MHz/16 = 1.5 MHz
+            bset  TSCR2,#$04
+            bset  TSCR1,#$80  ;enable timer
             ldd   TCNT
             std   TC5 
             std   TC7					;init cnt in TC5 & TC7
@@ -1202,16 +1207,15 @@ sound_init:
 
 ;  sound_on()
 sound_on:
-            movb  #$80,TSCR1  ;enable timer
+            bset  TSCR1,#$80  ;enable timer
             bset  TIE,#$20    ;enable TC5 interrupts
-            cli               ;enable interrupts
-            rts
+            rts               ;main() enables interrupts
 
 ;  sound_off()
 sound_off:
-            sei
-            clr   TSCR1       ;disable timer
             bclr  TIE,#$20    ;disable TC5 interrupts
+            bclr  OC7M,#$20   ;disconnect PT5 from TC7
+            bclr  TCTL1,#$0C  ;and from TC5; the timer keeps running
             rts
             
 ; void tone(int pitch);
@@ -1238,8 +1242,7 @@ HILO1_init:
             bset  TCTL4,#$0C  ;interrupt on both edges of Ch 1
 						movb  #$02,TFLG1  ;clear any old flag on Ch 1
             bset  TIE,#$02    ;enable TC1 interrupts
-            cli               ;enable interrupts
-						rts
+						rts               ;main() enables interrupts
 
 ; calc HI-LO times of pulse train on Ch 1 
 ;   and store results in HI_time1 and LO_time1            
@@ -16,10 +16,34 @@
 
 #include <hidef.h>      /* common defines and macros */
 #include <mc9s12dg256.h>     /* derivative information */
+#include <stdio.h>      /* sprintf */
 #pragma LINK_INFO DERIVATIVE "mc9s12dg256b"
 
 #include "main_asm.h" /* interface to the assembly module */
 #include "rfid_rc522.h"
+#include "anomaly.h"
+#include "tamper.h"
+#include "flicker.h"
+#include "thermal.h"
+#include "status.h"
+#include "sensors_config.h"
+#include "recorder.h"
+#include "journal.h"
+#include "timebase.h"
+#include "keypad.h"
+#include "mifare.h"
+#include "readers.h"
+#include "aes.h"
+#include "session.h"
+#include "panel.h"
+#include "dashboard.h"
+#include "serial.h"
+#include "messages.h"
+#include "idle.h"
+#include "perf.h"
+#include "stack.h"
+#include "critical.h"
+#include "watchdog.h"
 
 // General constants
 #define TRUE 1
@@ -31,6 +55,7 @@
 #define RGB_LED_GREEN 0x40
 #define RGB_LED_BLUE 0x20
 #define RGB_LED_YELLOW RGB_LED_RED | RGB_LED_GREEN
+#define RGB_LED_PINS RGB_LED_WHITE
 #define ALL_ON 0xFF
 
 // LCD constants
@@ -55,13 +80,16 @@
 #define TEMP_CHANNEL 5
 
 // SCI constants
-#define SERIAL_COMMUNICATION_BAUD_RATE 9600
 #define ENTER_KEY '\r'
 #define NULL_STRING '\0'
 #define BACKSPACE 0x7F
 
 // Interrupt constants
 #define RTI_VECTOR 7
+#define RTI_1MS_RATE 0x17 // (7 + 1) * 2^10 / 8 MHz OSCCLK = 1.024 ms
+#define RTI_ENABLE_BITMASK 0x80
+#define RTI_FLAG_BITMASK 0x80
+#define TAMPER_SAMPLE_DIVIDER 4 // 1.024 ms * 4 = ~244 Hz accelerometer rate
 #define ULTRASONIC_BITMASK 0x04
 #define ULTRASONIC_VECTOR 10
 #define SPEAKER_VECTOR 13
@@ -72,7 +100,6 @@
 #define NO_AUTHENTICATION 0
 #define AUTHENTICATED_USER 1
 #define AUTHENTICATED_ADMINISTRATOR 2
-#define DIVIDER "=============================================\n\r"
 #define ALARM_PITCH_1 957
 #define ALARM_PITCH_2 1074
 #define GOOD_BEEP_PITCH 957
@@ -85,6 +112,10 @@
 #define SYSTEM_STATUS_GOOD 2
 #define SYSTEM_STATUS_OK 1
 #define SYSTEM_STATUS_BAD 0
+#define LEVEL_TO_SYSTEM_STATUS(level) (SYSTEM_STATUS_GOOD - (level))
+#define SENSOR_TO_LEVEL(status) ((status) - SENSOR_STATUS_GOOD)
+#define STATUS_STEP_TICKS 98 // 98 * 1.024 ms = ~100 ms per status engine step
+#define ALARM_STEP_TICKS 98  // siren pitch and LED toggle period
 
 #define ADMINISTRATOR_UID_SEGMENT_1 0xBB
 #define ADMINISTRATOR_UID_SEGMENT_2 0x85
@@ -99,6 +130,19 @@
 #define ADMINISTRATOR_PIN_CHAR_3 3
 #define ADMINISTRATOR_PIN_CHAR_4 4
 #define MAX_PIN_TRIES 4
+// On-card credential: sector 1, blocks 0 and 1, read with key A. Leave it
+// off until every card in use has been enrolled.
+#define CARD_CREDENTIAL_REQUIRED FALSE
+#define CREDENTIAL_BLOCK 4
+#define CREDENTIAL_BLOCKS 2 // AES encrypted credential, then its CMAC
+#define CREDENTIAL_MAGIC_1 'K'
+#define CREDENTIAL_MAGIC_2 'F'
+#define CREDENTIAL_VERSION 3
+#define CREDENTIAL_BAD_MAC 0x80      // journal details besides MIFARE_*
+#define CREDENTIAL_BAD_CONTENTS 0x81
+#define CREDENTIAL_NO_CRYPTO 0x82
+#define CREDENTIAL_NO_KEY 0x83
+#define ENROLL_WAIT_MS 10000 // time to present the card
 
 // Other constants
 #define NEW_LINE "\n\r"
@@ -113,6 +157,53 @@
 #define MED_ALERTNESS_COMMAND "alert_med"
 #define HIGH_ALERTNESS_COMMAND "alert_hig"
 #define READ_MOTION_COMMAND "readmotion"
+#define LIGHT_MODE_COMMAND "lightmode"
+#define JOURNAL_COMMAND "journal"
+#define JOURNAL_LIST_COUNT 10
+#define TIME_COMMAND "time"
+#define SET_TIME_COMMAND "settime"
+#define TIME_DIGITS 12 // YYMMDDhhmmss
+#define ENROLL_COMMAND "enroll"
+#define AES_COMMAND "aes"
+#define READERS_COMMAND "readers"
+#define LOGOUT_COMMAND "logout"
+#define MENU_COMMAND "menu"
+#define MONITOR_COMMAND "monitor"
+#define BAUD_COMMAND "baud"
+#define SEND_TEST_COMMAND "sendtest"
+#define LOAD_COMMAND "load"
+#define PERF_COMMAND "perf"
+#define STACK_COMMAND "stack"
+#define IRQ_COMMAND "irq"
+// background_service() stops while the console blocks on a long output
+// (sendtest is 4.3 s at 9600 baud), so the deadline allows for that
+#define WATCHDOG_SERVICE_MS 10000
+#define STACK_CHECK_MS 1000 // How often background_service() looks at the stack
+#define MONITOR_REFRESH_MS 1000
+#define MONITOR_REFRESH_MIN_MS 250
+#define MONITOR_REFRESH_MAX_MS 8000
+#define MONITOR_STATUS 0 // dashboard fields
+#define MONITOR_SCORE 1
+#define MONITOR_ALARM 2
+#define MONITOR_ALERTNESS 3
+#define MONITOR_LIGHT 4 // the sensor fields are in trace order
+#define MONITOR_TEMP 5
+#define MONITOR_MOTION 6
+#define MONITOR_DISTANCE 7
+#define MONITOR_RATE 8
+#define MONITOR_COST 9
+#define MONITOR_EVENTS 10
+#define MONITOR_FIELDS 11
+#define MONITOR_TRACES 4
+#define MONITOR_SPARK_COLUMN 21
+#define MENU_ITEMS 10
+#define MENU_OUTPUT_OFFSET 3 // rows from the status line to the command output
+#define MENU_REFRESH_MS 1000
+#define VT100_ESC "\033"
+#define SEND_TEST_LINES 64
+#define SEND_TEST_LINE_CHARS 62 // + CR LF makes 64 bytes a line
+#define AES_BENCH_BLOCKS 32
+#define BUS_CYCLES_PER_US 24
 #define SENSOR_STATUS_GOOD 1
 #define SENSOR_STATUS_OK 2
 #define SENSOR_STATUS_BAD 3
@@ -132,12 +223,40 @@
 #define SW2_BITMASK 0x08
 #define SW5_BITMASK 0x01
 
+// Status engine levels, see sensors_config.h
+const STATUS_LEVEL_CONFIG_t g_status_config[STATUS_LEVELS] = SENSORS_STATUS_CONFIG;
+
+
+// Numeric menu: a key runs one of the text commands
+typedef struct {
+  char key;     // SCI key
+  char* command;
+  uint8 length;
+  uint8 level;  // lowest user level allowed
+  char* label;
+} MENU_ITEM_t;
+
+const MENU_ITEM_t g_menu[MENU_ITEMS] = {
+  { '1', DISABLE_ALARM_COMMAND,    sizeof(DISABLE_ALARM_COMMAND) - 1,    AUTHENTICATED_ADMINISTRATOR, "Silence alarm" },
+  { '2', ALARM_ON_COMMAND,         sizeof(ALARM_ON_COMMAND) - 1,         AUTHENTICATED_ADMINISTRATOR, "Sound alarm" },
+  { '3', LOW_ALERTNESS_COMMAND,    sizeof(LOW_ALERTNESS_COMMAND) - 1,    AUTHENTICATED_ADMINISTRATOR, "Alertness low" },
+  { '4', MED_ALERTNESS_COMMAND,    sizeof(MED_ALERTNESS_COMMAND) - 1,    AUTHENTICATED_ADMINISTRATOR, "Alertness medium" },
+  { '5', HIGH_ALERTNESS_COMMAND,   sizeof(HIGH_ALERTNESS_COMMAND) - 1,   AUTHENTICATED_ADMINISTRATOR, "Alertness high" },
+  { '6', SCAN_ENVIRONMENT_COMMAND, sizeof(SCAN_ENVIRONMENT_COMMAND) - 1, AUTHENTICATED_USER,          "Scan environment" },
+  { '7', READ_LIGHT_COMMAND,       sizeof(READ_LIGHT_COMMAND) - 1,       AUTHENTICATED_USER,          "Read light" },
+  { '8', READ_TEMP_COMMAND,        sizeof(READ_TEMP_COMMAND) - 1,        AUTHENTICATED_USER,          "Read temperature" },
+  { '9', READ_MOTION_COMMAND,      sizeof(READ_MOTION_COMMAND) - 1,      AUTHENTICATED_USER,          "Read motion" },
+  { '0', LOGOUT_COMMAND,           sizeof(LOGOUT_COMMAND) - 1,           AUTHENTICATED_USER,          "Log out" }
+};
+
 
 // Global values
 uint8 g_lightDetected = 0;
-int g_alarm_on = TRUE;
-unsigned short ticks, ticks0; // RTI interrupt counts
-uint8 g_pitch;
+volatile int g_alarm_on = FALSE;
+volatile uint8 g_alarm_ack = FALSE; // set by SW2 to silence the siren
+volatile unsigned short ticks; // RTI interrupt counts
+uint16 g_pitch;
+STATUS_ENGINE_t g_status_engine;
 uint8 gstatus_level = SYSTEM_STATUS_GOOD;
 uint16 g_total_count = 0; // for isObjectNearby()
 uint8 g_measurement_ready = FALSE; // for isObjectNearby()
@@ -146,21 +265,143 @@ uint16 g_temp_threshold = 90; // 90 F
 uint16 g_motion_threshold = 200;
 uint16 g_distance = 0;
 uint8 g_user_level = NO_AUTHENTICATION;
+uint8 g_alertness = 1; // set_alertness() level, low at start up
+uint8 g_menu_mode = TRUE; // numeric menu instead of text commands
+uint8 g_monitor_on = FALSE; // the dashboard owns the SCI screen
+uint16 g_monitor_events = 0; // events not printed while it did
+uint16 g_monitor_refresh_ms = MONITOR_REFRESH_MS;
+uint8 g_aes_ok = FALSE; // power on self test result
+// MIFARE key A of the credential sector. Like the site key below, each
+// installation provisions its own: define CARD_SECTOR_KEY as 6 comma
+// separated bytes. enroll_card() moves a new card's sector from the
+// transport key to it, so the credential can't be read off a card, or
+// copied to one with a cloned UID, without it.
+#ifdef CARD_SECTOR_KEY
+const uint8 g_card_key[MIFARE_KEY_SIZE] = { CARD_SECTOR_KEY };
+#define CARD_SECTOR_KEY_SET TRUE
+#else
+const uint8 g_card_key[MIFARE_KEY_SIZE] = { 0 };
+#define CARD_SECTOR_KEY_SET FALSE
+#endif
+// Key A of every sector of a new card
+const uint8 g_card_transport_key[MIFARE_KEY_SIZE] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+// Key that seals the card credentials. Each installation provisions its
+// own and it is never kept in the source: define CARD_SITE_KEY in the
+// compiler settings as 16 comma separated bytes (-DCARD_SITE_KEY=0x..,0x..).
+// Without both keys credentials are neither written nor trusted.
+#ifdef CARD_SITE_KEY
+const uint8 g_card_site_key[AES_KEY_SIZE] = { CARD_SITE_KEY };
+#define CARD_SITE_KEY_SET TRUE
+#else
+const uint8 g_card_site_key[AES_KEY_SIZE] = { 0 };
+#define CARD_SITE_KEY_SET FALSE
+#endif
+// The site key itself is never used: derive_card_keys() gives a key that
+// only encrypts and one that only MACs
+uint8 g_card_cipher_key[AES_KEY_SIZE];
+uint8 g_card_mac_key[AES_KEY_SIZE];
+ANOMALY_t g_light_anomaly;
+ANOMALY_t g_temp_anomaly;
+ANOMALY_t g_motion_anomaly;
+uint8 g_anomaly_z2_suspect = ANOMALY_Z2(ALERTNESS_LOW_Z_SUSPECT);
+uint8 g_anomaly_z2_alarm = ANOMALY_Z2(ALERTNESS_LOW_Z_ALARM);
+// Last anomaly_update() results; only service_status() updates the detectors
+uint8 g_light_anomaly_level = ANOMALY_NONE;
+uint8 g_temp_anomaly_level = ANOMALY_NONE;
+uint8 g_motion_anomaly_level = ANOMALY_NONE;
 
 // Function headers
 void scroll_across_lcd_once(char message[]); // Scroll string across LCD once
 int getLightLevel(void);                         // Returns current light level
-uint8 getTempLevel(void);                        // Returns current temperature in Fahrenheit
+int getTempLevel(void);                          // Returns current temperature in Fahrenheit
+sint16 getTempTenths(void);                      // Returns current temperature in tenths of a degree F
 void change_status_level(uint8 new_status);  // Changes system's status level
 void scanEnvironment(void);                      // Scans environment for environmental hazards
 void change_rgb_led_value(uint8 new_value);  // Changes color of RGB LED                                            
-void beginAlarm(void);                           // Activates the alarm
+void beginAlarm(void);                           // Activates the alarm after a failed PIN
+void startAlarm(void);                           // Activates the alarm without waiting
 void stopAlarm(void);                            // Disables the alarm
+void background_service(void);                   // Runs periodic work while waiting for input
+char read_console_char(void);                    // Waits for a character from the SCI
+uint8 read_key(void);                            // Waits for a key press on the keypad
 void print_console(sint8 buffer[70]);        // Prints string to the PUTTY console
 void clear_lcd_line_2(void);                     // Clears LCD line 2
 void successful_beep(void);                      // Beeps a tone indicating something happened successfully
 void neutral_beep(void);                         // Beeps a tone indicating something happened
 void error_beep(void);                           // Beeps a tone indicating an error occurred
+void print_tenths(sint16 tenths);                // Prints a value in tenths as whole.tenth
+void print_temperature_rate(void);               // Prints the temperature rate of rise
+void print_light_source(void);                   // Prints the light source classification
+uint32 pack_uid(uint8 uid[]);                    // Packs a 4-byte card UID for the journal
+void print_journal(void);                        // Prints the most recent journal records
+void print_time(void);                           // Prints the wall clock and uptime
+void set_time(void);                             // Reads a new wall clock time from the SCI
+uint8 card_user_level(uint8 uid[]);              // Returns the user level a card UID belongs to
+void make_card_credential(uint8 block[], uint8 uid[], uint8 level); // Builds a credential block
+void derive_card_keys(void);                     // Derives the credential cipher and MAC keys
+void seal_card_credential(uint8 blocks[], uint8 uid[], uint8 level); // Encrypts and MACs a credential
+char verify_card_credential(RC522_READER_t* reader, uint8 uid[], uint8 level); // Checks the sealed credential on a card
+char wait_for_card(READER_TAP_t* tap);           // Waits for a card tap while enrolling
+uint8 write_card_credential(READER_TAP_t* tap, const uint8 key[], uint8 blocks[]); // Writes sealed credential blocks
+void enroll_card(void);                          // Writes a sealed credential to a card
+void print_aes_benchmark(void);                  // Runs the AES self test and times the cipher
+void report_reader_faults(void);                 // Prints and logs reader recoveries
+void print_reader_stats(void);                   // Prints and clears the reader link statistics
+void log_out(uint8 reason);                      // Ends the session and goes back to the card prompt
+void run_command(char buffer[], int buffer_size); // Runs a text command
+void run_menu(void);                             // Runs the numeric menu until ENTER or a logout
+uint8 draw_menu(void);                           // Draws the numeric menu, returns the status row
+void print_menu_status(uint8 row);               // Rewrites the menu status line in place
+void sound_alarm(void);                          // Forces the status to BAD and sounds the siren
+void panel_alarm_off(void);                      // Control panel actions
+void panel_alarm_on(void);
+void panel_alert_low(void);
+void panel_alert_med(void);
+void panel_alert_high(void);
+void panel_logout(void);
+void readout_alarm(char text[]);                 // Control panel readouts
+void readout_alertness(char text[]);
+void readout_light(char text[]);
+void readout_temp(char text[]);
+void readout_distance(char text[]);
+void readout_status(char text[]);
+void run_monitor(void);                          // Shows the live dashboard until ENTER
+void update_monitor(DASHBOARD_FIELD_t fields[], DASHBOARD_SPARK_t sparks[]); // Refreshes the dashboard
+void change_baud_rate(void);                     // Moves the console to another baud rate
+void send_test_pattern(void);                    // Sends a known pattern for timing the console
+void print_load(void);                           // Prints and clears the busy and idle time
+void print_share(uint32 part, uint32 whole);     // Prints part as a percentage of whole
+void print_perf(void);                           // Prints and clears the profiling probes
+void report_stack(void);                         // Prints and logs a stack near or past its end
+void print_stack(void);                          // Prints the stack high water mark
+void print_irq(void);                            // Prints and clears interrupt latency and masked time
+void report_reset(void);                         // Prints why the board last reset
+
+// Control panel menus (panel.c)
+const PANEL_ITEM_t g_panel_alertness_items[] = {
+  { "Low",           AUTHENTICATED_ADMINISTRATOR, NULL, panel_alert_low,  readout_alertness },
+  { "Medium",        AUTHENTICATED_ADMINISTRATOR, NULL, panel_alert_med,  readout_alertness },
+  { "High",          AUTHENTICATED_ADMINISTRATOR, NULL, panel_alert_high, readout_alertness }
+};
+const PANEL_MENU_t g_panel_alertness = { g_panel_alertness_items, 3 };
+
+const PANEL_ITEM_t g_panel_sensor_items[] = {
+  { "Status",        AUTHENTICATED_USER, NULL, NULL, readout_status },
+  { "Light",         AUTHENTICATED_USER, NULL, NULL, readout_light },
+  { "Temperature",   AUTHENTICATED_USER, NULL, NULL, readout_temp },
+  { "Distance",      AUTHENTICATED_USER, NULL, NULL, readout_distance }
+};
+const PANEL_MENU_t g_panel_sensors = { g_panel_sensor_items, 4 };
+
+// Silencing the alarm stays on key 1, as on the console menu
+const PANEL_ITEM_t g_panel_root_items[] = {
+  { "Silence alarm", AUTHENTICATED_ADMINISTRATOR, NULL, panel_alarm_off, readout_alarm },
+  { "Sound alarm",   AUTHENTICATED_ADMINISTRATOR, NULL, panel_alarm_on, readout_alarm },
+  { "Alertness",     AUTHENTICATED_ADMINISTRATOR, &g_panel_alertness, NULL, NULL },
+  { "Sensors",       AUTHENTICATED_USER, &g_panel_sensors, NULL, NULL },
+  { "Log out",       AUTHENTICATED_USER, NULL, panel_logout, NULL }
+};
+const PANEL_MENU_t g_panel_root = { g_panel_root_items, 5 };
 
 // HELPER METHODS //
 
@@ -212,22 +453,21 @@ void authenticate(void)
   int i;
   int current_administrator_try = 1;      
       // RFID logic here
-      uint8 _status = MI_OK;
       uint8 rc522_version = 0;
       uint8 card_tag_type;
+      READER_TAP_t tap;
 
       //Recognized card IDs
       uint8 card_id[5] = { 0x00,
      
-      };
-
-      uint8 tagType[16] = { 0x00,
-     
       };
      
       uint8 current_pin;
       uint8 current_pin_idx = 0;
       uint8 pin_sequence[4];
+      uint8 pin_ok = FALSE;
+      uint8 pin_skipped;
+      uint8 credential_ok = FALSE;
      
       // Every keycard has a unique UID which
       // it transmits to the RFID sensor.
@@ -253,93 +493,114 @@ void authenticate(void)
       ADMINISTRATOR_PIN_CHAR_3,
       ADMINISTRATOR_PIN_CHAR_4
   };
-      // Turn on SCI/terminal
-      SCI1_init(SERIAL_COMMUNICATION_BAUD_RATE);
-      SPI0_init();
-      SS0_HI();
+      messages_print(MSG_AUTHENTICATING);
 
-      print_console("Authenticating..\n\r");
-
-      _status = rc522_init('B');
+      if (readers_present_count() == 0)    // RFID not detected
+      {
+            // The supervisor keeps retrying; a reader that comes back is used
+            messages_print(MSG_RFID_NOT_WORKING);
+      }
       successful_authentication = NO_AUTHENTICATION;
 
-      if (_status == MI_OK)    // RFID is working
+      clear_lcd();
+      set_lcd_addr(LCD_LINE_1_ADDR);
+      type_lcd("Scan card");
+      messages_print(MSG_CHECKING_FOR_CARD);
+      readers_flush();
+      while (successful_authentication == NO_AUTHENTICATION)
       {
-            clear_lcd();
-            set_lcd_addr(LCD_LINE_1_ADDR);
-            type_lcd("Scan card");
-            print_console("Checking for a present card..\n\r");
-            while (successful_authentication == NO_AUTHENTICATION)
+            // The readers are polled from background_service()
+            background_service();
+            if (readers_get_event(&tap))
             {
-                  ms_delay(MS_PER_SECOND);
-                  _status = rc522_is_card_present(PICC_REQIDL, tagType);
-                  if (_status == MI_OK)
-                  {
-                        print_console("RFID Card found\n\r");
-                        _status = MFRC522_Anticoll(card_id);
-
-                        if (_status == MI_OK)
+                        messages_print(MSG_CARD_FOUND);
+                        alt_printf("Door %u\n\r", tap.door);
+                        for (i = 0; i < MIFARE_UID_SIZE; i++) {
+                              card_id[i] = tap.uid[i];
+                        }
+
+                        // Print the card's UIDs
+                        print_console("Card UID:");
+                        alt_printf(" %02X ", card_id[0]);
+                        alt_printf(" %02X ", card_id[1]);
+                        alt_printf(" %02X ", card_id[2]);
+                        alt_printf(" %02X ", card_id[3]);
+    print_console("\n\r");
+                        card_tag_type = tap.sak;
+   
+                        // Is user an admin or normal user?
+                        if (card_id[0] == ADMINISTRATOR_UID_SEGMENT_1 &&
+                              card_id[1] == ADMINISTRATOR_UID_SEGMENT_2 &&
+                              card_id[2] == ADMINISTRATOR_UID_SEGMENT_3 &&
+                              card_id[3] == ADMINISTRATOR_UID_SEGMENT_4)
                         {
-                              // Print the card's UIDs
-                              print_console("Card UID:");
-                              alt_printf(" %02X ", card_id[0]);
-                              alt_printf(" %02X ", card_id[1]);
-                              alt_printf(" %02X ", card_id[2]);
-                              alt_printf(" %02X ", card_id[3]);
-          print_console("\n\r");
-         
-                              // Is user an admin or normal user?
-                              if (card_id[0] == ADMINISTRATOR_UID_SEGMENT_1 &&
-                                    card_id[1] == ADMINISTRATOR_UID_SEGMENT_2 &&
-                                    card_id[2] == ADMINISTRATOR_UID_SEGMENT_3 &&
-                                    card_id[3] == ADMINISTRATOR_UID_SEGMENT_4)
-                              {
-                                    print_console("Detected: Administrator\n\r");
-                                    successful_authentication = AUTHENTICATED_ADMINISTRATOR;
-                              } else if (card_id[0] == USER_UID_SEGMENT_1 &&
-                                    card_id[1] == USER_UID_SEGMENT_2 &&
-                                    card_id[2] == USER_UID_SEGMENT_3 &&
-                                    card_id[3] == USER_UID_SEGMENT_4)
-                              {
-                                    print_console("Detected: User\n\r");
-                                    successful_authentication = AUTHENTICATED_USER;
+                              messages_print(MSG_DETECTED_ADMIN);
+                              successful_authentication = AUTHENTICATED_ADMINISTRATOR;
+                        } else if (card_id[0] == USER_UID_SEGMENT_1 &&
+                              card_id[1] == USER_UID_SEGMENT_2 &&
+                              card_id[2] == USER_UID_SEGMENT_3 &&
+                              card_id[3] == USER_UID_SEGMENT_4)
+                        {
+                              messages_print(MSG_DETECTED_USER);
+                              successful_authentication = AUTHENTICATED_USER;
+                        } else
+                        {
+                              messages_print(MSG_DETECTED_UNKNOWN);
+                              journal_append(timebase_ms(), JOURNAL_AUTH_REJECTED, 0, pack_uid(card_id));
+                        }
+
+                        // The UID can be copied; the credential is sealed with the site key and
+                        // its sector only opens with the site's sector key
+                        credential_ok = FALSE;
+                        if (successful_authentication != NO_AUTHENTICATION) {
+                              mifare_begin(tap.reader, card_id);
+                              credential_ok = verify_card_credential(tap.reader, card_id, successful_authentication);
+                              if (!credential_ok && CARD_CREDENTIAL_REQUIRED) {
+                                    successful_authentication = NO_AUTHENTICATION;
                               }
-
-                             
-                              // Notify user that card was detected. and print out their user level.
-                              print_console("\n\r");
-                              card_tag_type = rc522_select_tag(card_id);
-
-                             
-                              print_console("Card Selected, Type: ");
-                              print_console(rc522_type_to_string(MFRC522_ParseType(card_tag_type)));
-
-                              print_console("\n\r");
-                              print_console("**********************************\n\r");
-                              print_console("***    Remove RFID Card       ***\n\r");
-                              print_console("**********************************\n\r");
-                              print_console("\n\r");
-                        } /* End if */
-                  } /* End if */
-            } /* End while */
-      } /* End if */
-     
-      else // RFID not detected
-      {
-            print_console("Error.. RFID NOT WORKING\n\r");
-            beginAlarm();
-      }
+                        }
+                        readers_release(tap.reader);
+
+                        if (successful_authentication == AUTHENTICATED_ADMINISTRATOR) {
+                              journal_append(timebase_ms(), JOURNAL_AUTH_ADMIN, 0, pack_uid(card_id));
+                        } else if (successful_authentication == AUTHENTICATED_USER) {
+                              journal_append(timebase_ms(), JOURNAL_AUTH_USER, 0, pack_uid(card_id));
+                        }
+
+                       
+                        // Notify user that card was detected. and print out their user level.
+                        print_console("\n\r");
+                        messages_print(MSG_CARD_SELECTED);
+                        print_console(rc522_type_to_string(MFRC522_ParseType(card_tag_type)));
+
+                        print_console("\n\r");
+                        messages_print(MSG_STARS);
+                        messages_print(MSG_REMOVE_CARD);
+                        messages_print(MSG_STARS);
+                        print_console("\n\r");
+            } /* End if */
+      } /* End while */
      
   // The user has gotten past the point of scanning
       successful_beep();
-      g_user_level = successful_authentication; // Set to admin or user before
-      if (successful_authentication == AUTHENTICATED_ADMINISTRATOR) {
-        print_console("Please enter your password using the keypad.");
+
+      // An administrator who entered the PIN a few minutes ago only taps,
+      // and only with a card whose credential checked out: the UID alone
+      // can be cloned
+      pin_skipped = (successful_authentication == AUTHENTICATED_ADMINISTRATOR) &&
+                    credential_ok &&
+                    session_is_recent(card_id, successful_authentication);
+      if (pin_skipped) {
+        messages_print(MSG_PIN_NOT_NEEDED);
+        journal_append(timebase_ms(), JOURNAL_PIN_OK, 1, 0);
+      }
+      if (successful_authentication == AUTHENTICATED_ADMINISTRATOR && !pin_skipped) {
+        messages_print(MSG_ENTER_PIN);
         clear_lcd();
         set_lcd_addr(LCD_LINE_1_ADDR);
         type_lcd("Enter password");
      
-        keypad_enable();
+        keypad_flush(); // Ignore anything pressed while the card was read
         // Give the user 3 chances to enter a valid 4-digit PIN
         while (current_administrator_try < MAX_PIN_TRIES - 1) {
           int n_successful_consecutive_sequence = 0;
@@ -347,8 +608,7 @@ void authenticate(void)
           if (current_pin_idx > 3) {
              current_pin_idx = 0;
           }
-          current_pin = getkey();
-          wait_keyup();
+          current_pin = read_key();
           neutral_beep();
           pin_sequence[current_pin_idx] = current_pin;
           current_pin_idx++;
@@ -370,13 +630,15 @@ void authenticate(void)
           }
          
           if (n_successful_consecutive_sequence == MAX_PIN_TRIES) {
+             journal_append(timebase_ms(), JOURNAL_PIN_OK, 0, 0);
              successful_beep();
              clear_lcd();
-             successful_authentication == AUTHENTICATED_ADMINISTRATOR;
+             pin_ok = TRUE;
              break;
           } else if (current_pin_idx == 4) {
+             journal_append(timebase_ms(), JOURNAL_PIN_FAILED, (uint8)current_administrator_try, 0);
              error_beep();
-             ms_delay(500);
+             sleep_ms(500);
              clear_lcd();
              current_administrator_try++;
              set_lcd_addr(LCD_LINE_1_ADDR);
@@ -384,11 +646,18 @@ void authenticate(void)
           }
            
         }
-        if (successful_authentication != AUTHENTICATED_ADMINISTRATOR) {
+        if (!pin_ok) {
+          // Reached the 3rd try. Alarm on, and back to the card prompt
+          // still logged out, so only another administrator can silence it
+          g_user_level = NO_AUTHENTICATION;
           beginAlarm();
+          return;
         }
-        // Reached the 3rd try. Alarm on.
       }
+      // Only now, with the PIN entered or skipped, do the switches and
+      // commands of the level work
+      g_user_level = successful_authentication;
+      session_start(card_id, successful_authentication, pin_ok);
 }
 
 // -----------------------------------------------------------------------------
@@ -438,12 +707,18 @@ void clear_lcd_line_2(void) {
 // -----------------------------------------------------------------------------
 void printUserCommands(void)
 {
-  print_console(DIVIDER);
-  print_console("Commands:\n\r");
-  print_console("readlight  - Display information about the current light level in the area.\n\r");
-  print_console("readtemp   - Display information about the current temperature in the area.\n\r");
-  print_console("readmotion - Display information about the current motion level in the area.\n\r");
-  print_console("scan       - Scan the environment for hazards.\n\r");  
+  messages_print(MSG_DIVIDER);
+  messages_print(MSG_COMMANDS);
+  messages_print(MSG_HELP_READLIGHT);
+  messages_print(MSG_HELP_READTEMP);
+  messages_print(MSG_HELP_READMOTION);
+  messages_print(MSG_HELP_SCAN);  
+  messages_print(MSG_HELP_TIME);
+  messages_print(MSG_HELP_LOGOUT);
+  messages_print(MSG_HELP_MENU);
+  messages_print(MSG_HELP_MONITOR);
+  messages_print(MSG_HELP_BAUD);
+  messages_print(MSG_HELP_SENDTEST);
 }
 
 // -----------------------------------------------------------------------------
@@ -464,18 +739,28 @@ void set_alertness(uint8 alertness_level)
       g_light_threshold = 150;
       g_temp_threshold  = 90;
       g_motion_threshold = 200;
+      g_anomaly_z2_suspect = ANOMALY_Z2(ALERTNESS_LOW_Z_SUSPECT);
+      g_anomaly_z2_alarm = ANOMALY_Z2(ALERTNESS_LOW_Z_ALARM);
       break;
     case 2: // Med alertness
       g_light_threshold = 100;
       g_temp_threshold  = 90;
       g_motion_threshold = 150;
+      g_anomaly_z2_suspect = ANOMALY_Z2(ALERTNESS_MEDIUM_Z_SUSPECT);
+      g_anomaly_z2_alarm = ANOMALY_Z2(ALERTNESS_MEDIUM_Z_ALARM);
       break;
     case 3: // High alertness
       g_light_threshold = 50;
       g_temp_threshold  = 90;
       g_motion_threshold = 80;
+      g_anomaly_z2_suspect = ANOMALY_Z2(ALERTNESS_HIGH_Z_SUSPECT);
+      g_anomaly_z2_alarm = ANOMALY_Z2(ALERTNESS_HIGH_Z_ALARM);
       break;
+    default:
+      return;
   }
+  g_alertness = alertness_level;
+  journal_append(timebase_ms(), JOURNAL_ALERTNESS, alertness_level, 0);
 }
 
 // -----------------------------------------------------------------------------
@@ -490,15 +775,6 @@ void display_commands() {
   char character;  
   int buffer_size = 0;
   int enter_pressed = 0;
-  int i = 0;
- 
-  // Sensor variables
-  int lightLevel;
-  int tempLevel;
-  int motionLevel;
-  int motionStatus;
-  int lightStatus;
-  int tempStatus;  
  
   print_console("\n\r");
  
@@ -508,83 +784,130 @@ void display_commands() {
  
   else if (g_user_level == AUTHENTICATED_ADMINISTRATOR) {
       printUserCommands();
-      print_console("alarm_on   - Activate the alarm system.\n\r");
-      print_console("alarm_off  - Disable the alarm system.\n\r");
-      print_console("flash_led  - Flash the LEDs.\n\r");
-      print_console("alert_low  - Set the alertness level low\n\r");
-      print_console("alert_med  - Set the alertness level medium\n\r");
-      print_console("alert_hig  - Set the alertness level high\n\r");
+      messages_print(MSG_HELP_ALARM_ON);
+      messages_print(MSG_HELP_ALARM_OFF);
+      messages_print(MSG_HELP_FLASH_LED);
+      messages_print(MSG_HELP_ALERT_LOW);
+      messages_print(MSG_HELP_ALERT_MED);
+      messages_print(MSG_HELP_ALERT_HIGH);
+      messages_print(MSG_HELP_LIGHTMODE);
+      messages_print(MSG_HELP_JOURNAL);
+      messages_print(MSG_HELP_SETTIME);
+      messages_print(MSG_HELP_READERS);
+      messages_print(MSG_HELP_LOAD);
+      messages_print(MSG_HELP_PERF);
+      messages_print(MSG_HELP_STACK);
+      messages_print(MSG_HELP_IRQ);
   }
  
-  print_console("Please enter the command that you'd like to execute: \n\r");
+  messages_print(MSG_ENTER_COMMAND);
  
   while (!enter_pressed) {
-    character = inchar1(); // Take characters from putty
+    character = read_console_char(); // Take characters from putty
+    if (!session_is_active()) {
+       return; // Timed out; main() logs out
+    }
     outchar1(character); // Immediately echo characters back into putty
     if (character == ENTER_KEY) {
        enter_pressed = TRUE;
    
+       run_command(buffer, buffer_size);
+       
+    } else { // Character wasn't enter key
+      if (character == BACKSPACE) {
+         buffer[buffer_size] = NULL_STRING;
+         buffer_size--;
+      } else {
+         buffer[buffer_size++] = character;
+      }
+    } /* else */
+  } /* while */
+  print_console("\n\r");
+} /* display_commands() */
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function runs a text command typed on the SCI or picked from
+//   the numeric menu.
+//
+// INPUT PARAMETERS:
+//   buffer      - The command.
+//   buffer_size - Its length.
+// -----------------------------------------------------------------------------
+void run_command(char buffer[], int buffer_size) {
+  int i = 0;
+ 
+  // Sensor variables
+  int lightLevel;
+  int tempLevel;
+  int motionLevel;
+  int motionStatus;
+  int lightStatus;
+  int tempStatus;  
+ 
        // See what command the user has entered
        if (str_equals(buffer, buffer_size, READ_LIGHT_COMMAND, 9)) { // If user wants to read light val
-          print_console("\n\rReading light..");
+          messages_print(MSG_READING_LIGHT);
           lightLevel = getLightLevel();
          
           lightStatus = getLightStatus(lightLevel);
          
-          print_console("Light Level: "); // Display light level
+          messages_print(MSG_LIGHT_LEVEL); // Display light level
           alt_printf("%d", lightLevel);
           print_console("\n\r");
+          print_light_source();
        
           if (lightStatus == SENSOR_STATUS_BAD) { // Indicates intruder (via flashlight)
-             print_console(".. HIGH LIGHT LEVEL - NOTIFY ADMINISTRATOR");
+             messages_print(MSG_LIGHT_HIGH);
           } else if (lightStatus == SENSOR_STATUS_OK) // Suspicious light levels
           {
-             print_console(".. SUSPICIOUS LIGHT LEVEL - CONSIDER NOTIFYING ADMINSITRATOR");
+             messages_print(MSG_LIGHT_SUSPICIOUS);
           } else
           {
-            print_console(".. SAFE LEVEL");
+            messages_print(MSG_SAFE_LEVEL);
           }
              
        } /* End if */
        
        // TODO: ADD READ MOTION COMMAND
        else if (str_equals(buffer, buffer_size, READ_TEMP_COMMAND, 8)) { // If user wants to read temp val
-          print_console("\n\rReading temperature...");
+          messages_print(MSG_READING_TEMP);
          
           tempLevel = getTempLevel();
           tempStatus = getTempStatus(tempLevel);
-          print_console("Temperature: ");
-          alt_printf("%d", tempLevel);
+          messages_print(MSG_TEMPERATURE);
+          print_tenths(getTempTenths());
           print_console("\n\r");
+          print_temperature_rate();
          
           if (tempStatus == SENSOR_STATUS_BAD) { // Indicates intruder (via flashlight)
-             print_console(".. HIGH TEMP - NOTIFY ADMINISTRATOR");
+             messages_print(MSG_TEMP_HIGH);
           } else if (tempStatus == SENSOR_STATUS_OK) // Suspicious light levels
           {
-             print_console(".. REACHING HIGH TEMP - CONSIDER NOTIFYING ADMINISTRATOR");
+             messages_print(MSG_TEMP_REACHING);
           } else
           {
-            print_console(".. SAFE LEVEL");
+            messages_print(MSG_SAFE_LEVEL);
           }
        }
        else if (str_equals(buffer, buffer_size, READ_MOTION_COMMAND, 10))
        {
-          print_console("\n\rReading motion level...");
+          messages_print(MSG_READING_MOTION);
          
           motionLevel = getMotionLevel();
           motionStatus = getMotionStatus(motionLevel);
-          print_console("Motion level: ");
+          messages_print(MSG_MOTION_LEVEL);
           alt_printf("%d", motionLevel);
           print_console("\n\r");
          
           if (motionStatus == SENSOR_STATUS_BAD) { // Indicates intruder (via flashlight)
-             print_console(".. HIGH MOTION - NOTIFY ADMINISTRATOR");
+             messages_print(MSG_MOTION_HIGH);
           } else if (motionStatus == SENSOR_STATUS_OK) // Suspicious light levels
           {
-             print_console(".. REACHING MOTION - CONSIDER NOTIFYING ADMINISTRATOR");
+             messages_print(MSG_MOTION_REACHING);
           } else
           {
-            print_console(".. SAFE LEVEL");
+            messages_print(MSG_SAFE_LEVEL);
           }
  
        }
@@ -595,7 +918,7 @@ void display_commands() {
        }
          // If user wants to turn on alarms
          else if (str_equals(buffer, buffer_size, ALARM_ON_COMMAND, 8) && (g_user_level == AUTHENTICATED_ADMINISTRATOR)) {
-            beginAlarm();
+            sound_alarm();
          }
        
          // If user wants to flash LEDs
@@ -603,9 +926,9 @@ void display_commands() {
             led_enable();
               for (i = 0; i < 5; i++) {
                         leds_on(ALL_ON);
-                        ms_delay(100);
+                        sleep_ms(100);
                         leds_off();
-                        ms_delay(100);
+                        sleep_ms(100);
               } /* End for loop */
          } /* End else if */
        
@@ -617,35 +940,229 @@ void display_commands() {
          // If user wants to set alertness level low
          else if (str_equals(buffer, buffer_size, LOW_ALERTNESS_COMMAND, 9)  && (g_user_level == AUTHENTICATED_ADMINISTRATOR)) {
                set_alertness(1);
-           print_console("\n\rNEW ALERTNESS LEVEL: LOW");
+           messages_print(MSG_ALERTNESS_LOW);
          }
        
          // If user wants to set alertness level medium
          else if (str_equals(buffer, buffer_size, MED_ALERTNESS_COMMAND, 9) && (g_user_level == AUTHENTICATED_ADMINISTRATOR)) {
                set_alertness(2);
-         print_console("\n\rNEW ALERTNESS LEVEL: MED");
+         messages_print(MSG_ALERTNESS_MED);
          }
        
          // If user wants to alertness level high
          else if (str_equals(buffer, buffer_size, HIGH_ALERTNESS_COMMAND, 9) && (g_user_level == AUTHENTICATED_ADMINISTRATOR)) {
                set_alertness(3);
-         print_console("\n\rNEW ALERTNESS LEVEL: HIGH");
+         messages_print(MSG_ALERTNESS_HIGH);
+         }
+         // If user wants to toggle the high rate light sampling mode
+         else if (str_equals(buffer, buffer_size, LIGHT_MODE_COMMAND, 9) && (g_user_level == AUTHENTICATED_ADMINISTRATOR)) {
+               flicker_set_enabled(!flicker_is_enabled());
+               if (flicker_is_enabled()) {
+                  messages_print(MSG_LIGHT_SOURCE_ON);
+               } else {
+                  messages_print(MSG_LIGHT_SOURCE_OFF);
+               }
+         }
+         // If user wants to see the time
+         else if (str_equals(buffer, buffer_size, TIME_COMMAND, 4)) {
+               print_time();
+         }
+         // If user wants to log out
+         else if (str_equals(buffer, buffer_size, LOGOUT_COMMAND, 6)) {
+               log_out(SESSION_END_COMMAND);
+         }
+         // If user wants the numeric menu back
+         else if (str_equals(buffer, buffer_size, MENU_COMMAND, 4)) {
+               g_menu_mode = TRUE;
+         }
+         // If user wants to watch the sensors
+         else if (str_equals(buffer, buffer_size, MONITOR_COMMAND, 7)) {
+               run_monitor();
+         }
+         // If user wants another console baud rate
+         else if (str_equals(buffer, buffer_size, BAUD_COMMAND, 4)) {
+               change_baud_rate();
+         }
+         // If user wants to time the console
+         else if (str_equals(buffer, buffer_size, SEND_TEST_COMMAND, 8)) {
+               send_test_pattern();
+         }
+         // If user wants to set the time
+         else if (str_equals(buffer, buffer_size, SET_TIME_COMMAND, 7) && (g_user_level == AUTHENTICATED_ADMINISTRATOR)) {
+               set_time();
+         }
+         // If user wants to see the event journal
+         else if (str_equals(buffer, buffer_size, JOURNAL_COMMAND, 7) && (g_user_level == AUTHENTICATED_ADMINISTRATOR)) {
+               print_journal();
+         }
+         // If user wants to write the credential block to a card
+         else if (str_equals(buffer, buffer_size, ENROLL_COMMAND, 6) && (g_user_level == AUTHENTICATED_ADMINISTRATOR)) {
+               enroll_card();
+         }
+         // If user wants to check the AES code
+         else if (str_equals(buffer, buffer_size, AES_COMMAND, 3) && (g_user_level == AUTHENTICATED_ADMINISTRATOR)) {
+               print_aes_benchmark();
+         }
+         // If user wants to see how the card readers are doing
+         else if (str_equals(buffer, buffer_size, READERS_COMMAND, 7) && (g_user_level == AUTHENTICATED_ADMINISTRATOR)) {
+               print_reader_stats();
+         }
+         // If user wants to see how busy the system is
+         else if (str_equals(buffer, buffer_size, LOAD_COMMAND, 4) && (g_user_level == AUTHENTICATED_ADMINISTRATOR)) {
+               print_load();
+         }
+         // If user wants to see how long the probed code takes
+         else if (str_equals(buffer, buffer_size, PERF_COMMAND, 4) && (g_user_level == AUTHENTICATED_ADMINISTRATOR)) {
+               print_perf();
+         }
+         // If user wants to see how deep the stack has been
+         else if (str_equals(buffer, buffer_size, STACK_COMMAND, 5) && (g_user_level == AUTHENTICATED_ADMINISTRATOR)) {
+               print_stack();
+         }
+         // If user wants to see how late the interrupts run
+         else if (str_equals(buffer, buffer_size, IRQ_COMMAND, 3) && (g_user_level == AUTHENTICATED_ADMINISTRATOR)) {
+               print_irq();
          }
        else {
-          print_console("Error: Invalid command!");
+          messages_print(MSG_INVALID_COMMAND);
        }
-       
-    } else { // Character wasn't enter key
-      if (character == BACKSPACE) {
-         buffer[buffer_size] = NULL_STRING;
-         buffer_size--;
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function runs the numeric menu. The menu is drawn once; then a
+//   single digit on the SCI runs its command straight away, with no
+//   ENTER and no echo. The command's output replaces the last one below
+//   the menu, in a scrolling region so a long output doesn't push the
+//   menu off the screen, and the status line is rewritten in place every
+//   MENU_REFRESH_MS. ENTER goes back to the text commands. The keypad
+//   runs the LCD control panel meanwhile.
+//
+// -----------------------------------------------------------------------------
+void run_menu(void) {
+  uint8 status_row;
+  uint32 refreshed_ms;
+  char key;
+  int item;
+
+  status_row = draw_menu();
+  alt_printf(VT100_ESC "[%ur", status_row + MENU_OUTPUT_OFFSET);
+  refreshed_ms = timebase_ms();
+
+  while (g_menu_mode && session_is_active()) {
+    background_service();
+
+    if (!serial_get_char(SERIAL_PORT1, &key)) {
+      key = NULL_STRING;
+    }
+
+    if (key == ENTER_KEY) {
+      session_touch();
+      g_menu_mode = FALSE;
+    } else if (key != NULL_STRING) {
+      session_touch();
+      for (item = 0; item < MENU_ITEMS; item++) {
+        if (g_menu[item].key == key) {
+          break;
+        }
+      }
+
+      // Clear the last command's output and run this one in its place
+      alt_printf(VT100_ESC "[%uH" VT100_ESC "[J", status_row + MENU_OUTPUT_OFFSET);
+      if ((item == MENU_ITEMS) || (g_user_level < g_menu[item].level)) {
+        messages_print(MSG_NOT_ON_MENU);
+        error_beep();
       } else {
-         buffer[buffer_size++] = character;
+        print_console(g_menu[item].label);
+        print_console(":");
+        run_command(g_menu[item].command, g_menu[item].length);
       }
-    } /* else */
-  } /* while */
-  print_console("\n\r");
-} /* display_commands() */
+      refreshed_ms -= MENU_REFRESH_MS; // Show the outcome now
+    }
+
+    if (session_is_active() && ((timebase_ms() - refreshed_ms) >= MENU_REFRESH_MS)) {
+      refreshed_ms = timebase_ms();
+      print_menu_status(status_row);
+    }
+  }
+
+  // Whole screen scrolls again
+  print_console(VT100_ESC "[r");
+  alt_clear();
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function clears the SCI screen and draws the numeric menu
+//   items the user is allowed to run.
+//
+// RETURN:
+//   row - The screen row of the status line.
+// -----------------------------------------------------------------------------
+uint8 draw_menu(void) {
+  uint8 row = 1;
+  int item;
+
+  alt_clear();
+  messages_print(MSG_HEADER);
+  print_console(NEW_LINE);
+  messages_print(MSG_DIVIDER);
+  row += 2;
+
+  for (item = 0; item < MENU_ITEMS; item++) {
+    if (g_user_level >= g_menu[item].level) {
+      outchar1(g_menu[item].key);
+      print_console("  ");
+      print_console(g_menu[item].label);
+      print_console("\n\r");
+      row++;
+    }
+  }
+  messages_print(MSG_DIVIDER);
+  messages_print(MSG_MENU_PROMPT);
+  row += 2;
+
+  print_menu_status(row);
+  return row;
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function rewrites the menu's status line in place and puts the
+//   cursor back where it was.
+//
+// INPUT PARAMETERS:
+//   row - The screen row of the status line.
+// -----------------------------------------------------------------------------
+void print_menu_status(uint8 row) {
+  alt_printf(VT100_ESC "7" VT100_ESC "[%uH" VT100_ESC "[K", row);
+
+  print_console("Status: ");
+  if (gstatus_level == SYSTEM_STATUS_BAD) {
+     print_console("BAD ");
+  }
+  else if (gstatus_level == SYSTEM_STATUS_OK) {
+     print_console("OK  ");
+  }
+  else {
+     print_console("GOOD");
+  }
+  print_console("  Alarm: ");
+  print_console(g_alarm_on ? "ON " : "OFF");
+  print_console("  Alertness: ");
+  if (g_alertness == 3) {
+     print_console("HIGH");
+  }
+  else if (g_alertness == 2) {
+     print_console("MED ");
+  }
+  else {
+     print_console("LOW ");
+  }
+  alt_printf("  Score: %d", status_score(&g_status_engine));
+
+  print_console(VT100_ESC "8");
+}
 
 // -----------------------------------------------------------------------------
 // DESCRIPTION
@@ -663,40 +1180,46 @@ void scanEnvironment(void) {
   int objectLevel;
   int objectStatus;
  
-  print_console("Scanning environment..\n\r");
+  PERF_ENTER(PERF_SCAN_ENVIRONMENT);
+  messages_print(MSG_SCANNING);
   lightLevel = getLightLevel();
   clear_lcd();
   lightStatus = getLightStatus(lightLevel);
-  print_console("Light Level: ");
+  messages_print(MSG_LIGHT_LEVEL);
   alt_printf("%d", lightLevel);
  
   if (lightStatus == 3) { // Indicates intruder (via flashlight)
-     print_console(".. TOO MUCH LIGHT - DANGEROUS LEVEL");
+     messages_print(MSG_SCAN_LIGHT_DANGEROUS);
   }
   else if (lightStatus == 2) { // There may be an intruder
-       print_console(".. SUSPICIOUS LIGHT LEVELS");
+       messages_print(MSG_SCAN_LIGHT_SUSPICIOUS);
   }
   else {
-     print_console(".. SAFE LEVEL  ");
+     messages_print(MSG_SCAN_LIGHT_SAFE);
   }                                
  
   print_console("\n\r");
+  print_light_source();
  
   tempLevel = getTempLevel();
   tempStatus = getTempStatus(tempLevel);
-  print_console("Temperature:");
-  alt_printf("%d", tempLevel);
-  if (lightStatus == 3) { // Indicates environmental temperature risk
-     print_console(".. HIGH TEMPERATURE - DANGEROUS LEVEL");
+  messages_print(MSG_SCAN_TEMPERATURE);
+  print_tenths(getTempTenths());
+  if (thermal_rate_status() == THERMAL_ROR_ALARM) { // Rising like a fire
+     messages_print(MSG_SCAN_FIRE);
   }
-  else if (lightStatus == 2) {
-       print_console(".. REACHING HIGH TEMPS");
+  else if (tempStatus == SENSOR_STATUS_BAD) { // Indicates environmental temperature risk
+     messages_print(MSG_SCAN_TEMP_DANGEROUS);
+  }
+  else if (tempStatus == SENSOR_STATUS_OK) {
+       messages_print(MSG_SCAN_TEMP_REACHING);
   }
   else {
-     print_console(".. SAFE LEVEL");
+     messages_print(MSG_SAFE_LEVEL);
   }
  
   print_console("\n\r");
+  print_temperature_rate();
  
   motionLevel = getMotionLevel();
   motionStatus = getMotionStatus(motionLevel);
@@ -705,47 +1228,49 @@ void scanEnvironment(void) {
   clear_lcd();
  
   if (motionStatus == 3) { // Indicates environmental motion risk
-     print_console(".. HIGH MOTION - DANGEROUS LEVEL");
+     messages_print(MSG_SCAN_MOTION_DANGEROUS);
   }
   else if (motionStatus == 2) {
-       print_console(".. SUSPICIOUS MOTION LEVELS");
+       messages_print(MSG_SCAN_MOTION_SUSPICIOUS);
   }
   else {
-     print_console(".. SAFE LEVEL");
+     messages_print(MSG_SAFE_LEVEL);
   }
  
   print_console("\n\r");
   objectLevel = g_distance;
   objectStatus = isObjectNearby();
-  print_console("DISTANCE FROM OBJECT:");
+  messages_print(MSG_SCAN_DISTANCE);
   alt_printf("%d",objectLevel);
  
   if (objectStatus == SENSOR_STATUS_BAD) { // Indicates environmental motion risk
-     print_console(".. OBJECT NEARBY - NOTIFY ADMINISTRATOR");
+     messages_print(MSG_SCAN_OBJECT_NEARBY);
   }
   else if (motionStatus == SENSOR_STATUS_OK) {
-       print_console(".. OBJECT MAY BE NEARBY - CONSIDER NOTIFYING ADMINISTRATOR");
+       messages_print(MSG_SCAN_OBJECT_MAYBE);
   }
   else {
-     print_console(".. SAFE LEVEL");
+     messages_print(MSG_SAFE_LEVEL);
   }
  
-  // Update status based on environmental hazard levels
-  // This is done rather than updating in the previous blocks of code
-  // to ensure a lower status doesn't override a higher status.
-  // (e.g. lightStatus = 3, tempStatus == 2, so status is OK)
-  if ((lightStatus == SENSOR_STATUS_BAD) || (tempStatus == SENSOR_STATUS_BAD) || (motionStatus == SENSOR_STATUS_BAD) || (objectStatus == SENSOR_STATUS_BAD))
-  {
-        change_status_level(SYSTEM_STATUS_BAD);
-  } else if ((lightStatus == 2) || (tempStatus == SENSOR_STATUS_OK) || (motionStatus == SENSOR_STATUS_OK) || (objectStatus == SENSOR_STATUS_OK))
-  {
-    change_status_level(SYSTEM_STATUS_OK);
-  } else
-  {
-    change_status_level(SYSTEM_STATUS_GOOD);
+  // The status level itself is kept by the status engine, which
+  // samples the sensors on every tick rather than on this command
+  print_console("\n\r");
+  messages_print(MSG_SYSTEM_STATUS);
+  if (gstatus_level == SYSTEM_STATUS_BAD) {
+     print_console("BAD");
+  }
+  else if (gstatus_level == SYSTEM_STATUS_OK) {
+     print_console("OK");
   }
+  else {
+     print_console("GOOD");
+  }
+  alt_printf(" (threat score %d)", status_score(&g_status_engine));
  
   print_console("\n\r");  
+  panel_invalidate(); // The LCD was cleared above
+  PERF_EXIT(PERF_SCAN_ENVIRONMENT);
 }
 
 // -----------------------------------------------------------------------------
@@ -757,22 +1282,22 @@ void scanEnvironment(void) {
 void display_initial_console_message(void) {
   // Display header
   alt_clear();
-  print_console(DIVIDER);
-  print_console(SECURITY_SYSTEM_HEADER);
+  messages_print(MSG_DIVIDER);
+  messages_print(MSG_HEADER);
   print_console(NEW_LINE);
-  print_console(DIVIDER);
+  messages_print(MSG_DIVIDER);
  
   // Security levels:
   //  Authenticated User - [DESCRIBE PERMISSIONS]
   //  Authenticated Administrator - [DESCRIBE PERMISSIONS]
   if (g_user_level == AUTHENTICATED_USER) {
      // Display text on console
-     print_console("Welcome user, to ");
-     print_console(SECURITY_SYSTEM_HEADER);
+     messages_print(MSG_WELCOME_USER);
+     messages_print(MSG_HEADER);
      print_console(NEW_LINE);
-     print_console("You are currently logged in as a User.\n\r");
+     messages_print(MSG_LOGGED_IN_USER);
      
-     print_console("What would you like to do today?\n\r");
+     messages_print(MSG_WHAT_TO_DO);
      
      // Display text on LCD
      set_lcd_addr(LCD_LINE_1_ADDR);
@@ -783,13 +1308,13 @@ void display_initial_console_message(void) {
      
   } else if (g_user_level == AUTHENTICATED_ADMINISTRATOR) {
      // Display text on console
-     print_console("Welcome Administrator, to ");
-     print_console(SECURITY_SYSTEM_HEADER);
+     messages_print(MSG_WELCOME_ADMIN);
+     messages_print(MSG_HEADER);
      print_console(NEW_LINE);
-     print_console("You are currently logged in as an Administrator.");
-     print_console("What would you like to do today?\n\r");
+     messages_print(MSG_LOGGED_IN_ADMIN);
+     messages_print(MSG_WHAT_TO_DO);
   } else {
-     print_console("Please scan your keycard to log in.\n\r");
+     messages_print(MSG_SCAN_KEYCARD);
   }
 }
 
@@ -797,24 +1322,69 @@ void display_initial_console_message(void) {
 // ALARM METHODS //
 // -----------------------------------------------------------------------------
 // DESCRIPTION
-//   This function activates the system's alarm.
+//   This function activates the system's alarm after a failed PIN and
+//   returns with it sounding. Nobody is logged in by then, and SW2 and
+//   alarm_off need an administrator, so it keeps sounding until one
+//   logs in and silences it.
 //
 // -----------------------------------------------------------------------------
 void beginAlarm(void) {
-  // Turn alarm + LEDs on
+  startAlarm();
+  change_rgb_led_value(RGB_LED_RED);
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function turns the siren and flashing LEDs on and returns. The
+//   siren is toggled by service_alarm() until stopAlarm() is called.
+//
+// -----------------------------------------------------------------------------
+void startAlarm(void) {
+  g_alarm_ack = FALSE;
+  session_forget_all(); // Every administrator enters the PIN again
+
+  if (g_alarm_on == TRUE) {
+    return;
+  }
+  g_pitch = ALARM_PITCH_1;
   g_alarm_on = TRUE;
   sound_init();
   sound_on();
   led_enable();
-  change_rgb_led_value(RGB_LED_RED);
-  while (g_alarm_on == TRUE) {
-    // Play noise + flash lights
-    g_pitch = ALARM_PITCH_1;
-    leds_on(ALL_ON);
-    ms_delay(100);
+  leds_on(ALL_ON);
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function alternates the siren pitch and flashes the LEDs while
+//   the alarm is on, and silences it once SW2 has been pressed.
+//
+// -----------------------------------------------------------------------------
+void service_alarm(void) {
+  static uint16 last_toggle = 0;
+  static uint8 high_pitch = FALSE;
+ 
+  if (g_alarm_ack) {
+    g_alarm_ack = FALSE;
+    if (g_alarm_on == TRUE) {
+      journal_append(timebase_ms(), JOURNAL_ALARM_SILENCED, 0, 0);
+    }
+    stopAlarm();
+  }
+ 
+  if ((g_alarm_on != TRUE) || ((uint16)(ticks - last_toggle) < ALARM_STEP_TICKS)) {
+    return;
+  }
+  last_toggle = ticks;
+ 
+  // Play noise + flash lights
+  high_pitch = !high_pitch;
+  if (high_pitch) {
     g_pitch = ALARM_PITCH_2;
     leds_off();
-    ms_delay(100);
+  } else {
+    g_pitch = ALARM_PITCH_1;
+    leds_on(ALL_ON);
   }
 }
 
@@ -825,11 +1395,8 @@ void beginAlarm(void) {
 // -----------------------------------------------------------------------------
 void stopAlarm(void) {
   g_alarm_on = FALSE;
+  leds_off();
   sound_off();
-  asm { // sound_off() disables interrupts,
-        // so clear them
-    cli
-  }
 }
 
 // -----------------------------------------------------------------------------
@@ -841,15 +1408,19 @@ void stopAlarm(void) {
 //
 // -----------------------------------------------------------------------------
 void change_rgb_led_value(uint8 new_value) {
-   DDRP = 0x70; // Set RGB to outputs  
+   // Leave the rest of port P alone, SPI1/SPI2 readers select on PP3/PP6
+   DDRP |= RGB_LED_PINS; // Set RGB to outputs
    DDRM = ~0x04; // Enable the RGB LED
    PTM = ~0x04;
-   PTP = new_value;
+   PTP = (PTP & ~RGB_LED_PINS) | (new_value & RGB_LED_PINS);
 }
 
 // -----------------------------------------------------------------------------
 // DESCRIPTION
-//   This function sets the system's current status level.
+//   This function sets the system's current status level. It is called
+//   by the status engine on transitions only, so it never blocks. The
+//   siren is latched: going back to GOOD only changes the RGB LED, and
+//   the alarm sounds until SW2, alarm_off or the panel silences it.
 //
 // INPUT PARAMETERS:
 //   new_status - The new status level.
@@ -859,19 +1430,25 @@ void change_status_level(uint8 new_status) {
     if (new_status <= SYSTEM_STATUS_GOOD) {
       // Update _status + change RGBs
       gstatus_level = new_status;
+      journal_append(timebase_ms(), JOURNAL_STATUS, new_status, status_score(&g_status_engine));
       if (new_status == SYSTEM_STATUS_BAD) {
-        beginAlarm();
+        recorder_trigger(ticks); // Keep what the sensors did leading up to this
+        startAlarm();
         change_rgb_led_value(RGB_LED_RED);
-        clear_lcd();
-        set_lcd_addr(LCD_LINE_1_ADDR);
-        type_lcd("WARNING");
-        scroll_across_lcd_once("SECURITY CONCERN!");
+        if (panel_is_active()) {
+          panel_message("SECURITY CONCERN");
+        } else {
+          clear_lcd();
+          set_lcd_addr(LCD_LINE_1_ADDR);
+          type_lcd("WARNING");
+          set_lcd_addr(LCD_LINE_2_ADDR);
+          type_lcd("SECURITY CONCERN!");
+        }
        
       } else if (new_status == SYSTEM_STATUS_OK) {
         change_rgb_led_value(RGB_LED_YELLOW);
      
       } else if (new_status == SYSTEM_STATUS_GOOD) {
-        stopAlarm();
         change_rgb_led_value(RGB_LED_GREEN);
       }
     }
@@ -886,13 +1463,17 @@ void interrupt PORT_H_INTERRUPT_VECTOR switch_handler() {
   int clear_bits = 0;
   int switchValue = PIFH;
  
+  PERF_ENTER(PERF_SWITCH_ISR);
+
   // If SW2 pressed
   if ((switchValue & SW2_BITMASK) == SW2_BITMASK && g_user_level == AUTHENTICATED_ADMINISTRATOR) {
-    stopAlarm();
+    g_alarm_ack = TRUE; // Silenced from the main loop
+
     clear_bits |= SW2_BITMASK;
   }
 
   PIFH = clear_bits;
+  PERF_EXIT(PERF_SWITCH_ISR);
 }
 
 // -----------------------------------------------------------------------------
@@ -902,142 +1483,539 @@ void interrupt PORT_H_INTERRUPT_VECTOR switch_handler() {
 // -----------------------------------------------------------------------------
 void interrupt SPEAKER_VECTOR handler()
 {
+  latency_record(LATENCY_SPEAKER, TCNT - TC5);
+  PERF_ENTER(PERF_SPEAKER_ISR);
   tone(g_pitch);
+  PERF_EXIT(PERF_SPEAKER_ISR);
 }
 
 // -----------------------------------------------------------------------------
 // DESCRIPTION
-//   This function plays a beep on the speaker indicating a successful action
-//   has occurred.,
+//   This function starts the 1.024 ms real-time interrupt used as the
+//   system tick.
 //
 // -----------------------------------------------------------------------------
-void successful_beep()
+void tick_init(void)
 {
-      g_pitch = GOOD_BEEP_PITCH;
-      sound_init();
-      sound_on();
-      led_enable();
-      change_rgb_led_value(RGB_LED_GREEN);
-      ms_delay(GOOD_BEEP_DURATION);
-      led_off(0xFF);
-      sound_off();
-      asm
-      {
-            // sound_off() disables interrupts,
-            // so clear them
-            cli
-      }
+  RTICTL = RTI_1MS_RATE;
+  CRGFLG = RTI_FLAG_BITMASK;
+  CRGINT |= RTI_ENABLE_BITMASK;
 }
 
 // -----------------------------------------------------------------------------
 // DESCRIPTION
-//   This function plays a beep on the speaker indicating an action has occurred,
+//   This function is an ISR for the real-time interrupt. It counts ticks,
+//   scans the keypad and runs the light flicker, temperature and
+//   accelerometer tamper detectors.
 //
 // -----------------------------------------------------------------------------
-void neutral_beep() {
-  g_pitch = NEUTRAL_BEEP_PITCH;
-      sound_init();
-      sound_on();
-      led_enable();
-      change_rgb_led_value(RGB_LED_GREEN);
-      ms_delay(NEUTRAL_BEEP_DURATION);
-      led_off(0xFF);
-      sound_off();
-      asm
-      {
-            // sound_off() disables interrupts,
-            // so clear them
-            cli
-      }
+void interrupt RTI_VECTOR tick_handler()
+{
+  static uint8 tamper_divider = 0;
+
+  latency_tick();
+  PERF_ENTER(PERF_RTI_ISR);
+  PERF_TICK();
+  watchdog_tick();
+  timebase_tick();
+  ticks++;
+
+  flicker_sample();
+  thermal_sample(flicker_temp_level());
+
+  keypad_scan(ticks);
+
+  if (++tamper_divider >= TAMPER_SAMPLE_DIVIDER) {
+    tamper_divider = 0;
+    tamper_sample();
+  }
+
+#if STACK_GUARD_CHECK
+  stack_check();
+#endif
+  CRGFLG = RTI_FLAG_BITMASK;
+  PERF_EXIT(PERF_RTI_ISR);
 }
 
 // -----------------------------------------------------------------------------
 // DESCRIPTION
-//   This function plays a beep on the speaker indicating an
-//   error has occurred.
+//   This function prints any tamper events queued by the tick ISR and
+//   raises the system status.
 //
 // -----------------------------------------------------------------------------
-void error_beep() {
-  g_pitch = ERROR_BEEP_PITCH;
-      sound_init();
-      sound_on();
-      led_enable();
-      change_rgb_led_value(RGB_LED_RED);
-      ms_delay(ERROR_BEEP_DURATION);
-      led_off(0xFF);
-      sound_off();
-      asm
-      {
-            // sound_off() disables interrupts,
-            // so clear them
-            cli
+void report_tamper_events(void)
+{
+  TAMPER_EVENT_t event;
+  uint8 tampered = FALSE;
+
+  while (tamper_get_event(&event)) {
+    if (g_monitor_on) {
+      g_monitor_events++; // Shown as a count on the dashboard
+    } else {
+      if (event.type == TAMPER_KNOCK) {
+        print_console("TAMPER: KNOCK DETECTED at ");
+      } else {
+        print_console("TAMPER: TILT DETECTED at ");
       }
-}
-
+      alt_printfL("%lu ms", event.timestamp);
+      alt_printf(" (magnitude %u)\n\r", event.magnitude);
+    }
+    journal_append(event.timestamp, JOURNAL_TAMPER, event.type, event.magnitude);
+    tampered = TRUE;
+  }
 
-// SENSOR METHODS //
+  if (tampered && status_force(&g_status_engine, STATUS_LEVEL_BAD)) {
+    change_status_level(SYSTEM_STATUS_BAD);
+  }
+}
 
 // -----------------------------------------------------------------------------
 // DESCRIPTION
-//   This function returns the current light level.
+//   This function samples the sensors and steps the status engine once
+//   every STATUS_STEP_TICKS ticks. It is the only place the anomaly
+//   detectors are fed, so their time constants are in status steps. The
+//   RGB LED and siren are only touched when the engine changes level.
 //
-// RETURN
-//   lightLevel - The current light level.
 // -----------------------------------------------------------------------------
-int getLightLevel(void) {
-  return ad0conv(LIGHT_SENSOR_CHANNEL);
+void service_status(void)
+{
+  static uint16 last_step = 0;
+  uint16 levels[RECORDER_CHANNELS];
+  int temp;
+  int demand;
+  int sensorStatus;
+
+  if ((uint16)(ticks - last_step) < STATUS_STEP_TICKS) {
+    return;
+  }
+  last_step = ticks;
+
+  levels[RECORDER_LIGHT] = getLightLevel();
+  levels[RECORDER_TEMP] = getTempTenths();
+  levels[RECORDER_MOTION] = getMotionLevel();
+  levels[RECORDER_DISTANCE] = g_distance;
+  recorder_sample(last_step, levels);
+
+  temp = getTempLevel();
+  g_light_anomaly_level = anomaly_update(&g_light_anomaly, levels[RECORDER_LIGHT], g_anomaly_z2_suspect, g_anomaly_z2_alarm);
+  g_temp_anomaly_level = anomaly_update(&g_temp_anomaly, temp, g_anomaly_z2_suspect, g_anomaly_z2_alarm);
+  g_motion_anomaly_level = anomaly_update(&g_motion_anomaly, levels[RECORDER_MOTION], g_anomaly_z2_suspect, g_anomaly_z2_alarm);
+
+  // Worst of the sensors
+  demand = SENSOR_TO_LEVEL(getLightStatus(levels[RECORDER_LIGHT]));
+  sensorStatus = SENSOR_TO_LEVEL(getTempStatus(temp));
+  if (sensorStatus > demand) {
+    demand = sensorStatus;
+  }
+  sensorStatus = SENSOR_TO_LEVEL(getMotionStatus(levels[RECORDER_MOTION]));
+  if (sensorStatus > demand) {
+    demand = sensorStatus;
+  }
+
+  if (status_step(&g_status_engine, (uint8)demand)) {
+    change_status_level(LEVEL_TO_SYSTEM_STATUS(status_level(&g_status_engine)));
+  }
 }
 
 // -----------------------------------------------------------------------------
 // DESCRIPTION
-//   This function returns the current temperature.
+//   This function converts the latest ultrasonic echo into a distance and
+//   sends the next trigger pulse.
 //
-// RETURN
-//   tempLevel - The current temperature.
 // -----------------------------------------------------------------------------
-uint8 getTempLevel(void) {
-  uint8 temp;
+void service_ultrasonic(void)
+{
+  if (g_measurement_ready) {
+    g_measurement_ready = FALSE;
  
-  temp = ad0conv(TEMP_CHANNEL); // Get temperature from AD0 Channel 5
-  temp = temp >> 1; // Divide by 2 to convert to Celsius
-  temp = (temp * 9/5) + 32; // Convert from C to F
-     
-  //highTempDetected = (temp >= HIGH_TEMP);
-  return temp;
+    g_distance = (uint16)((uint32)g_total_count * (uint32)SPEED_OF_SOUND* (uint32)(MS_PER_SECOND)/2 * (float)(1/COUNTS_PER_SECOND));
+   
+    // Send first trigger
+    TCTL1 = 0x03; // channel 4 goes high when tc4 & tcnt match
+    CFORC = 0x10; // force a tc4 & tcnt match
+    TCTL1 = 0x02;  // channel 4 goes low when tc4 + tcnt match
+    TC4 = TCNT + 15; // set tc4 15 counts ahead of tcnt  
+  }
 }
 
 // -----------------------------------------------------------------------------
 // DESCRIPTION
-//   This function returns the motion level using an accelerometer.
+//   This function runs everything that has to keep going while the
+//   system waits on the user: the ultrasonic sensor, tamper reports,
+//   the status engine, the siren, the black box dump, the journal,
+//   the software timers, the card readers, the control panel and the
+//   console baud rate switch.
 //
-// RETURN
-//   tempLevel - The current motion level.
 // -----------------------------------------------------------------------------
-int getMotionLevel(void) {
-  // Uses X, Y, and Z components of acceleration
-  // and if there's high acceleration, high motion detected
- 
-  int accX, accY, accZ, accTotal = 0;
- 
-  // Get components from channels 0, 1, and 2 of AD1
-  accX = ad1conv(0);
-  accY = ad1conv(1);
-  accZ = ad1conv(2);
+void background_service(void)
+{
+  static bool running = FALSE;
 
-  accTotal = accX + accY + accZ;
-  return accTotal;
+  if (running) {
+    return; // A service is waiting in sleep_ms() and the idle task came back here
+  }
+  running = TRUE;
+  PERF_ENTER(PERF_BACKGROUND);
+  watchdog_checkin(WATCHDOG_BACKGROUND);
+
+  service_ultrasonic();
+  report_tamper_events();
+  service_status();
+  service_alarm();
+  recorder_service();
+  journal_service();
+  timebase_service();
+  PERF_ENTER(PERF_READERS_SERVICE);
+  readers_service();
+  PERF_EXIT(PERF_READERS_SERVICE);
+  watchdog_checkin(WATCHDOG_READERS);
+  report_reader_faults();
+  report_stack();
+  panel_service();
+  serial_service();
+  PERF_EXIT(PERF_BACKGROUND);
+  running = FALSE;
 }
 
 // -----------------------------------------------------------------------------
 // DESCRIPTION
-//   This function returns the current motion sensor status (good, ok, bad)
+//   This function prints the wall clock and the time since start up.
 //
-// RETURN
-//   motionStatus - The current motion sensor status.
 // -----------------------------------------------------------------------------
-int getMotionStatus(int motionLevel)
+void print_time(void)
+{
+  RTC_TIME_t time;
+
+  print_console("\n\r");
+  if (rtc_is_set()) {
+    rtc_get(&time);
+    alt_printf("%u-", time.year);
+    alt_printf("%02u-", time.month);
+    alt_printf("%02u ", time.day);
+    alt_printf("%02u:", time.hour);
+    alt_printf("%02u:", time.minute);
+    alt_printf("%02u\n\r", time.second);
+  } else {
+    messages_print(MSG_TIME_NOT_SET);
+  }
+  alt_printfL("Up %lu s\n\r", timebase_ms() / MS_PER_SECOND);
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function reads a new date and time as YYMMDDhhmmss from the SCI
+//   and sets the wall clock. Anything else leaves the clock alone.
+//
+// -----------------------------------------------------------------------------
+void set_time(void)
+{
+  RTC_TIME_t time;
+  uint8 digits[TIME_DIGITS];
+  uint8 count = 0;
+  char character;
+
+  messages_print(MSG_ENTER_TIME);
+  while ((character = read_console_char()) != ENTER_KEY) {
+    if (!session_is_active()) {
+      return;
+    }
+    outchar1(character);
+    if ((character < '0') || (character > '9') || (count >= TIME_DIGITS)) {
+      count = TIME_DIGITS + 1; // reject the whole entry
+    } else {
+      digits[count++] = character - '0';
+    }
+  }
+
+  if (count == TIME_DIGITS) {
+    time.year = TIMEBASE_EPOCH_YEAR + digits[0] * 10 + digits[1];
+    time.month = digits[2] * 10 + digits[3];
+    time.day = digits[4] * 10 + digits[5];
+    time.hour = digits[6] * 10 + digits[7];
+    time.minute = digits[8] * 10 + digits[9];
+    time.second = digits[10] * 10 + digits[11];
+    if ((time.month >= 1) && (time.month <= 12) && (time.day >= 1) && (time.day <= 31) &&
+        (time.hour < 24) && (time.minute < 60) && (time.second < 60)) {
+      rtc_set(&time);
+      print_time();
+      return;
+    }
+  }
+  messages_print(MSG_INVALID_TIME);
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function packs a card UID into one value, first byte highest.
+//
+// INPUT PARAMETERS:
+//   uid - The card's 4-byte UID.
+//
+// RETURN
+//   The packed UID.
+// -----------------------------------------------------------------------------
+uint32 pack_uid(uint8 uid[])
+{
+  return ((uint32)uid[0] << 24) | ((uint32)uid[1] << 16) |
+         ((uint32)uid[2] << 8) | (uint32)uid[3];
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function prints the most recent journal records, oldest first.
+//
+// -----------------------------------------------------------------------------
+void print_journal(void)
+{
+  JOURNAL_RECORD_t record;
+  uint32 sequence = journal_next_sequence();
+  uint32 first = journal_first_sequence();
+  uint8 result;
+
+  if (sequence - first > JOURNAL_LIST_COUNT) {
+    first = sequence - JOURNAL_LIST_COUNT;
+  }
+
+  print_console("\n\r");
+  for (sequence = first; sequence < journal_next_sequence(); sequence++) {
+    // Reads wait while the journal is programming or erasing
+    while ((result = journal_read(sequence, &record)) == JOURNAL_BUSY) {
+      background_service();
+    }
+    if (result != JOURNAL_OK) {
+      continue;
+    }
+    alt_printfL("#%lu ", record.sequence);
+    alt_printfL("%lu ms: ", record.timestamp);
+    switch (record.type) {
+      case JOURNAL_BOOT:           print_console("boot"); break;
+      case JOURNAL_AUTH_USER:      print_console("user card"); break;
+      case JOURNAL_AUTH_ADMIN:     print_console("administrator card"); break;
+      case JOURNAL_AUTH_REJECTED:  print_console("unknown card"); break;
+      case JOURNAL_PIN_OK:         print_console("PIN accepted"); break;
+      case JOURNAL_PIN_FAILED:     print_console("PIN rejected"); break;
+      case JOURNAL_STATUS:         print_console("status"); break;
+      case JOURNAL_ALARM_SILENCED: print_console("alarm silenced"); break;
+      case JOURNAL_ALERTNESS:      print_console("alertness"); break;
+      case JOURNAL_TAMPER:         print_console("tamper"); break;
+      case JOURNAL_CARD_INVALID:   print_console("invalid card credential"); break;
+      case JOURNAL_READER:         print_console("card reader"); break;
+      case JOURNAL_LOGOUT:         print_console("logout"); break;
+      case JOURNAL_STACK:          print_console("stack"); break;
+      default:                     print_console("unknown"); break;
+    }
+    alt_printf(" %u", record.detail);
+    alt_printfL(" %lX\n\r", record.value);
+  }
+  alt_printf("%u dropped, ", journal_dropped());
+  alt_printf("%u flash errors\n\r", journal_errors());
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function waits for a character from the SCI, running the
+//   background services instead of spinning in inchar1(). Each character
+//   keeps the session alive. It gives up if the session times out, so
+//   callers check session_is_active() before using the character.
+//
+// RETURN
+//   character - The character received, or NULL_STRING on a timeout.
+// -----------------------------------------------------------------------------
+char read_console_char(void)
+{
+  char character;
+
+  while (!serial_get_char(SERIAL_PORT1, &character)) {
+    background_service();
+    if (!session_is_active()) {
+      return NULL_STRING;
+    }
+  }
+  session_touch();
+  return character;
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function waits for a key to be pressed on the keypad, running
+//   the background services instead of blocking in getkey().
+//
+// RETURN
+//   key - The key value, 0x0 - 0xF.
+// -----------------------------------------------------------------------------
+uint8 read_key(void)
+{
+  KEYPAD_EVENT_t event;
+
+  while (TRUE) {
+    while (!keypad_get_event(&event)) {
+      background_service();
+    }
+    if (event.type == KEYPAD_PRESS) {
+      session_touch();
+      return event.key;
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function plays a beep on the speaker indicating a successful action
+//   has occurred. The beeps share the speaker and LEDs with the siren, so
+//   none of them plays while the alarm is on.
+//
+// -----------------------------------------------------------------------------
+void successful_beep()
+{
+      if (g_alarm_on == TRUE) {
+        return;
+      }
+      g_pitch = GOOD_BEEP_PITCH;
+      sound_init();
+      sound_on();
+      led_enable();
+      change_rgb_led_value(RGB_LED_GREEN);
+      sleep_ms(GOOD_BEEP_DURATION);
+      led_off(0xFF);
+      sound_off();
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function plays a beep on the speaker indicating an action has occurred,
+//
+// -----------------------------------------------------------------------------
+void neutral_beep() {
+  if (g_alarm_on == TRUE) {
+    return;
+  }
+  g_pitch = NEUTRAL_BEEP_PITCH;
+      sound_init();
+      sound_on();
+      led_enable();
+      change_rgb_led_value(RGB_LED_GREEN);
+      sleep_ms(NEUTRAL_BEEP_DURATION);
+      led_off(0xFF);
+      sound_off();
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function plays a beep on the speaker indicating an
+//   error has occurred.
+//
+// -----------------------------------------------------------------------------
+void error_beep() {
+  if (g_alarm_on == TRUE) {
+    return;
+  }
+  g_pitch = ERROR_BEEP_PITCH;
+      sound_init();
+      sound_on();
+      led_enable();
+      change_rgb_led_value(RGB_LED_RED);
+      sleep_ms(ERROR_BEEP_DURATION);
+      led_off(0xFF);
+      sound_off();
+}
+
+
+// SENSOR METHODS //
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function returns the current light level.
+//
+// RETURN
+//   lightLevel - The current light level.
+// -----------------------------------------------------------------------------
+int getLightLevel(void) {
+  // The tick ISR owns AD0 and caches the reading
+  return flicker_light_level();
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function returns the current temperature in tenths of a degree F.
+//
+// RETURN
+//   tempTenths - The current temperature.
+// -----------------------------------------------------------------------------
+sint16 getTempTenths(void) {
+  sint16 tempTenths;
+ 
+  // One second average kept by the tick ISR; until the first one is ready
+  // convert the latest reading cached with the light channel
+  tempTenths = thermal_temperature();
+  if (tempTenths == 0) {
+    tempTenths = thermal_convert(flicker_temp_level());
+  }
+  return tempTenths;
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function returns the current temperature.
+//
+// RETURN
+//   tempLevel - The current temperature in Fahrenheit.
+// -----------------------------------------------------------------------------
+int getTempLevel(void) {
+  return (getTempTenths() + 5) / 10; // Round to the nearest degree
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function returns the motion level using an accelerometer.
+//
+// RETURN
+//   tempLevel - The current motion level.
+// -----------------------------------------------------------------------------
+int getMotionLevel(void) {
+  // The tick ISR samples X, Y, and Z continuously and removes gravity,
+  // so this is the peak dynamic acceleration since the last reading
+  // regardless of how the board is oriented.
+  return tamper_motion_level();
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function converts an adaptive baseline result to a sensor status.
+//
+// INPUT PARAMETERS:
+//   anomaly - ANOMALY_NONE, ANOMALY_SUSPECT or ANOMALY_ALARM.
+//
+// RETURN
+//   sensorStatus - The matching sensor status (good, ok, bad)
+// -----------------------------------------------------------------------------
+int anomaly_to_sensor_status(uint8 anomaly)
+{
+   if (anomaly == ANOMALY_ALARM) {
+        return SENSOR_STATUS_BAD;
+   }
+   else if (anomaly == ANOMALY_SUSPECT) {
+        return SENSOR_STATUS_OK;
+   }
+   return SENSOR_STATUS_GOOD;
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function returns the current motion sensor status (good, ok, bad)
+//
+// RETURN
+//   motionStatus - The current motion sensor status.
+// -----------------------------------------------------------------------------
+int getMotionStatus(int motionLevel)
 {
    uint8 motionBuffer = 10;
+   uint8 anomaly;
+   
+   // Once the baseline is learned the z-score replaces the fixed threshold
+   anomaly = g_motion_anomaly_level;
+   if (anomaly_is_ready(&g_motion_anomaly)) {
+        return anomaly_to_sensor_status(anomaly);
+   }
    
    if (motionLevel < (g_motion_threshold - motionBuffer)) {
         return SENSOR_STATUS_GOOD; // Good motion
@@ -1059,6 +2037,22 @@ int getMotionStatus(int motionLevel)
 // -----------------------------------------------------------------------------
 int getTempStatus(int temp) {
    uint8 tempBuffer = 10;
+   uint8 anomaly;
+   
+   // The absolute limit always applies; a fire is a fire whatever the baseline
+   anomaly = g_temp_anomaly_level;
+   
+   // So does a fast rate of rise, long before the limit is reached
+   if (thermal_rate_status() == THERMAL_ROR_ALARM) {
+        return SENSOR_STATUS_BAD;
+   }
+   if ((thermal_rate_status() == THERMAL_ROR_SUSPECT) && (temp < g_temp_threshold)) {
+        return SENSOR_STATUS_OK;
+   }
+   
+   if (anomaly_is_ready(&g_temp_anomaly) && (temp < g_temp_threshold)) {
+        return anomaly_to_sensor_status(anomaly);
+   }
    
    if (temp < (g_temp_threshold - tempBuffer)) {
         return SENSOR_STATUS_GOOD; // Good temp
@@ -1080,16 +2074,101 @@ int getTempStatus(int temp) {
 // -----------------------------------------------------------------------------
 int getLightStatus(int lightValue) {
    uint8 lightBuffer = 10;
+   uint8 anomaly;
+   int lightStatus;
    
-   if (lightValue < (g_light_threshold - lightBuffer)) {
-        return SENSOR_STATUS_GOOD; // Good light
+   // Once the baseline is learned the z-score replaces the fixed threshold
+   anomaly = g_light_anomaly_level;
+   if (anomaly_is_ready(&g_light_anomaly)) {
+        lightStatus = anomaly_to_sensor_status(anomaly);
+   }
+   else if (lightValue < (g_light_threshold - lightBuffer)) {
+        lightStatus = SENSOR_STATUS_GOOD; // Good light
    }
    else if ((lightValue > (g_light_threshold - lightBuffer)) && (lightValue < g_light_threshold)) {
-        return SENSOR_STATUS_OK; // Med light
+        lightStatus = SENSOR_STATUS_OK; // Med light
    }
    else {
-        return SENSOR_STATUS_BAD; // Bad light
+        lightStatus = SENSOR_STATUS_BAD; // Bad light
+   }
+   
+   // A swept flashlight is suspicious even when it isn't bright
+   (void)flicker_poll();
+   if ((flicker_source() == LIGHT_SOURCE_MOVING) && (lightStatus == SENSOR_STATUS_GOOD)) {
+        lightStatus = SENSOR_STATUS_OK;
+   }
+   return lightStatus;
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function prints a value given in tenths as "whole.tenth".
+//
+// INPUT PARAMETERS:
+//   tenths - The value in tenths.
+// -----------------------------------------------------------------------------
+void print_tenths(sint16 tenths)
+{
+   if (tenths < 0) {
+        print_console("-");
+        tenths = -tenths;
+   }
+   alt_printf("%d", tenths / 10);
+   alt_printf(".%d", tenths % 10);
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function prints the temperature rate of rise.
+//
+// -----------------------------------------------------------------------------
+void print_temperature_rate(void)
+{
+   messages_print(MSG_RATE_OF_RISE);
+   if (!thermal_rate_ready()) {
+        messages_print(MSG_MEASURING);
+        return;
+   }
+   
+   print_tenths(thermal_rate());
+   print_console(" F/min");
+   if (thermal_rate_status() == THERMAL_ROR_ALARM) {
+        messages_print(MSG_FIRE_ALERT);
+   }
+   else if (thermal_rate_status() == THERMAL_ROR_SUSPECT) {
+        messages_print(MSG_RISING_FAST);
+   }
+   print_console("\n\r");
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function prints the light source found by the flicker detector.
+//
+// -----------------------------------------------------------------------------
+void print_light_source(void)
+{
+   if (!flicker_is_enabled()) {
+        return;
+   }
+   
+   messages_print(MSG_LIGHT_SOURCE);
+   switch (flicker_source()) {
+     case LIGHT_SOURCE_AMBIENT:
+        print_console("AMBIENT");
+        break;
+     case LIGHT_SOURCE_ARTIFICIAL:
+        print_console("ARTIFICIAL");
+        alt_printf(" (%d%% mains flicker)", flicker_mains_percent());
+        break;
+     case LIGHT_SOURCE_MOVING:
+        messages_print(MSG_LIGHT_MOVING);
+        break;
+     default:
+        print_console("ANALYSING");
+        break;
    }
+   print_console("\n\r");
 }
 
 // -----------------------------------------------------------------------------
@@ -1101,6 +2180,8 @@ int getLightStatus(int lightValue) {
 void interrupt ULTRASONIC_VECTOR echo_handler() { // Ultrasonic sensor ISR
   static uint16 start_tcnt = 0;
  
+  latency_record(LATENCY_ECHO, TCNT - TC2);
+  PERF_ENTER(PERF_ECHO_ISR);
   if ((PTT & ULTRASONIC_BITMASK) == ULTRASONIC_BITMASK) // if echo is high (rising edge)
   {
     start_tcnt = TC2;
@@ -1115,6 +2196,7 @@ void interrupt ULTRASONIC_VECTOR echo_handler() { // Ultrasonic sensor ISR
  
   // turn on channel 1 flag
   TFLG1 = TFLG1 | 0x04;
+  PERF_EXIT(PERF_ECHO_ISR);
 }
 
 // -----------------------------------------------------------------------------
@@ -1171,9 +2253,9 @@ void scroll_across_lcd_once(char message[]) {
  
   // Write portion of long string to LCD
   for (current_lcd_addr = LCD_LINE_2_ADDR + CHARACTERS_PER_LCD_LINE; current_lcd_addr >= LCD_LINE_2_ADDR; current_lcd_addr-=LCD_SCROLL_RATE) {
-    ms_delay(LCD_SCROLL_DELAY_TIME);
+    sleep_ms(LCD_SCROLL_DELAY_TIME);
     clear_lcd_line_2();
-    ms_delay(LCD_SCROLL_DELAY_TIME);
+    sleep_ms(LCD_SCROLL_DELAY_TIME);
     set_lcd_addr(current_lcd_addr);
     lcd_string_parser(message, current_lcd_addr, SECOND_LINE_END);
   }
@@ -1191,9 +2273,9 @@ void scroll_across_lcd_once(char message[]) {
           break;
        }
     }
-    ms_delay(LCD_SCROLL_DELAY_TIME);
+    sleep_ms(LCD_SCROLL_DELAY_TIME);
     clear_lcd_line_2();
-    ms_delay(LCD_SCROLL_DELAY_TIME);
+    sleep_ms(LCD_SCROLL_DELAY_TIME);
     set_lcd_addr(LCD_LINE_2_ADDR);
     msg_idx += null_terminator_bound;
     lcd_string_parser(&message[msg_idx], current_lcd_addr, SECOND_LINE_END);
@@ -1206,21 +2288,55 @@ void main(void) {
   // Ultrasonic stuff
   uint16 seconds;                              
  
+  watchdog_init(); // Before anything can reset the board again
+
   // Initialize peripherals
   PLL_init();
   lcd_init();
   ad1_enable();
   ad0_enable();
-
-  SCI1_init(SERIAL_COMMUNICATION_BAUD_RATE);
+  tamper_init();
+  flicker_init();
+  flicker_set_enabled(TRUE);
+  thermal_init();
+  timebase_init();
+  idle_init();
+  perf_init(); // Times the probes themselves, so before interrupts
+  keypad_init();
+  tick_init();
+  EnableInterrupts; // Start the clock; the other interrupts are enabled below
+
+  // Adaptive baselines (light and temperature only alarm when rising)
+  anomaly_init(&g_light_anomaly, LIGHT_VARIANCE_FLOOR, ANOMALY_ONE_SIDED);
+  anomaly_init(&g_temp_anomaly, TEMP_VARIANCE_FLOOR, ANOMALY_ONE_SIDED);
+  anomaly_init(&g_motion_anomaly, MOTION_VARIANCE_FLOOR, 0);
+  status_init(&g_status_engine, g_status_config);
+  recorder_init();
+  journal_init();
+  journal_append(timebase_ms(), JOURNAL_BOOT, watchdog_reset_cause(), watchdog_missed_task());
+  g_aes_ok = aes_self_test(); // credentials are refused if this fails
+  derive_card_keys();
+  session_init();
+  panel_init(&g_panel_root);
+
+  serial_init(SERIAL_PORT1, SERIAL_DEFAULT_RATE);
   alt_clear();
+  report_reset();
   change_status_level(SYSTEM_STATUS_GOOD);
   led_enable();
+  readers_init(); // authenticate() reports readers that didn't answer
+  idle_set_task(background_service); // Start up is over; waits run the services
+  watchdog_register(WATCHDOG_BACKGROUND, WATCHDOG_SERVICE_MS);
+  watchdog_register(WATCHDOG_READERS, WATCHDOG_SERVICE_MS);
+  watchdog_start(); // From here a hang resets the board
  
+  panel_stop(); // The PIN is read from the keypad, not the panel
   authenticate();
   display_initial_console_message();
+  if (g_user_level != NO_AUTHENTICATION) {
+    panel_start(g_user_level);
+  }
 
-  _asm CLI // Clear interrupts so we can use the ultrasonic timer ISR
   TIE != CHANNEL4_BITMASK;
  
   // Set up switch ISR
@@ -1249,18 +2365,985 @@ void main(void) {
   TCTL1 = 0x02;  // channel 4 goes low when tc4 + tcnt match
   TC4 = TCNT + ULTRASONIC_DELAY; // set tc4 15 counts ahead of tcnt
   while (TRUE) {
-    if (g_measurement_ready) {
-      g_measurement_ready = FALSE;
- 
-      g_distance = (uint16)((uint32)g_total_count * (uint32)SPEED_OF_SOUND* (uint32)(MS_PER_SECOND)/2 * (float)(1/COUNTS_PER_SECOND));
-   
-      // Send first trigger
-      TCTL1 = 0x03; // channel 4 goes high when tc4 & tcnt match
-      CFORC = 0x10; // force a tc4 & tcnt match
-      TCTL1 = 0x02;  // channel 4 goes low when tc4 + tcnt match
-      TC4 = TCNT + 15; // set tc4 15 counts ahead of tcnt  
+    background_service();
+    if (!session_is_active()) {
+      // Idle timeout, a logout or a failed PIN: wait for the next card
+      if (g_user_level != NO_AUTHENTICATION) {
+        log_out(SESSION_END_IDLE);
+      }
+      panel_stop(); // The PIN is read from the keypad, not the panel
+      authenticate();
+      display_initial_console_message();
+      if (g_user_level != NO_AUTHENTICATION) {
+        panel_start(g_user_level);
+      }
+      continue;
+    }
+    if (g_menu_mode) {
+      run_menu();
+    } else {
+      display_commands();
     }
-   
-    display_commands();
   }  
-}
\ No newline at end of file
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function returns the user level a card UID was issued for.
+//
+// -----------------------------------------------------------------------------
+uint8 card_user_level(uint8 uid[])
+{
+  if (uid[0] == ADMINISTRATOR_UID_SEGMENT_1 && uid[1] == ADMINISTRATOR_UID_SEGMENT_2 &&
+      uid[2] == ADMINISTRATOR_UID_SEGMENT_3 && uid[3] == ADMINISTRATOR_UID_SEGMENT_4) {
+    return AUTHENTICATED_ADMINISTRATOR;
+  }
+  if (uid[0] == USER_UID_SEGMENT_1 && uid[1] == USER_UID_SEGMENT_2 &&
+      uid[2] == USER_UID_SEGMENT_3 && uid[3] == USER_UID_SEGMENT_4) {
+    return AUTHENTICATED_USER;
+  }
+  return NO_AUTHENTICATION;
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function builds the credential block for a card: a magic number,
+//   a version, the user level and the card's UID, so a block copied to
+//   another card doesn't match.
+//
+// -----------------------------------------------------------------------------
+void make_card_credential(uint8 block[], uint8 uid[], uint8 level)
+{
+  uint8 i;
+
+  for (i = 0; i < MIFARE_BLOCK_SIZE; i++) {
+    block[i] = 0;
+  }
+  block[0] = CREDENTIAL_MAGIC_1;
+  block[1] = CREDENTIAL_MAGIC_2;
+  block[2] = CREDENTIAL_VERSION;
+  block[3] = level;
+  for (i = 0; i < MIFARE_UID_SIZE; i++) {
+    block[4 + i] = uid[i];
+  }
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function derives the credential cipher and MAC keys from the
+//   site key (aes_derive_key()), so no key both encrypts and MACs.
+//
+// -----------------------------------------------------------------------------
+void derive_card_keys(void)
+{
+  static const uint8 cipher_label[] = { 'c', 'a', 'r', 'd', ' ', 'c', 'i', 'p', 'h', 'e', 'r' };
+  static const uint8 mac_label[] = { 'c', 'a', 'r', 'd', ' ', 'm', 'a', 'c' };
+
+  aes_derive_key(g_card_site_key, cipher_label, sizeof(cipher_label), g_card_cipher_key);
+  aes_derive_key(g_card_site_key, mac_label, sizeof(mac_label), g_card_mac_key);
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function builds the blocks written to a card: the credential
+//   encrypted with the cipher key, then the CMAC, with the MAC key, of
+//   the UID and the encrypted credential.
+//
+// -----------------------------------------------------------------------------
+void seal_card_credential(uint8 blocks[], uint8 uid[], uint8 level)
+{
+  uint8 signed_data[MIFARE_UID_SIZE + MIFARE_BLOCK_SIZE];
+  uint8 i;
+
+  aes_set_key(g_card_cipher_key);
+  make_card_credential(blocks, uid, level);
+  aes_encrypt_block(blocks, blocks);
+
+  for (i = 0; i < MIFARE_UID_SIZE; i++) {
+    signed_data[i] = uid[i];
+  }
+  for (i = 0; i < MIFARE_BLOCK_SIZE; i++) {
+    signed_data[MIFARE_UID_SIZE + i] = blocks[i];
+  }
+  aes_set_key(g_card_mac_key);
+  aes_cmac(signed_data, sizeof(signed_data), &blocks[MIFARE_BLOCK_SIZE]);
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function reads the credential of the selected card, checks its
+//   MAC, decrypts it and checks it against the user level its UID belongs
+//   to. A bad or missing credential is logged.
+//
+// RETURN:
+//   TRUE if the credential matched
+// -----------------------------------------------------------------------------
+char verify_card_credential(RC522_READER_t* reader, uint8 uid[], uint8 level)
+{
+  uint8 blocks[CREDENTIAL_BLOCKS * MIFARE_BLOCK_SIZE];
+  uint8 work[MIFARE_UID_SIZE + MIFARE_BLOCK_SIZE]; // signed data, then the expected credential
+  uint32 start = timebase_ms();
+  uint8 result;
+  uint8 i;
+
+
+  if (!g_aes_ok) {
+    result = CREDENTIAL_NO_CRYPTO;
+  } else if (!CARD_SITE_KEY_SET || !CARD_SECTOR_KEY_SET) {
+    result = CREDENTIAL_NO_KEY;
+  } else {
+    result = mifare_read_blocks(reader, CREDENTIAL_BLOCK, CREDENTIAL_BLOCKS, g_card_key, MIFARE_KEY_A, blocks);
+  }
+
+  if (result == MIFARE_OK) {
+    aes_set_key(g_card_mac_key);
+    for (i = 0; i < MIFARE_UID_SIZE; i++) {
+      work[i] = uid[i];
+    }
+    for (i = 0; i < MIFARE_BLOCK_SIZE; i++) {
+      work[MIFARE_UID_SIZE + i] = blocks[i];
+    }
+    if (!aes_cmac_verify(work, sizeof(work), &blocks[MIFARE_BLOCK_SIZE], MIFARE_BLOCK_SIZE)) {
+      result = CREDENTIAL_BAD_MAC;
+    }
+  }
+
+  if (result == MIFARE_OK) {
+    aes_set_key(g_card_cipher_key);
+    aes_decrypt_block(blocks, blocks);
+    make_card_credential(work, uid, level);
+    for (i = 0; i < MIFARE_BLOCK_SIZE; i++) {
+      if (blocks[i] != work[i]) {
+        result = CREDENTIAL_BAD_CONTENTS;
+      }
+    }
+  }
+
+  if (result == MIFARE_OK) {
+    alt_printfL("Card credential OK (%lu ms)\n\r", timebase_ms() - start);
+    return TRUE;
+  }
+
+  alt_printf("Card credential invalid (%u)\n\r", result);
+  journal_append(timebase_ms(), JOURNAL_CARD_INVALID, result, pack_uid(uid));
+  return FALSE;
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function waits up to ENROLL_WAIT_MS for a card tap.
+//
+// RETURN:
+//   TRUE if a card was tapped
+// -----------------------------------------------------------------------------
+char wait_for_card(READER_TAP_t* tap)
+{
+  uint32 start = timebase_ms();
+
+  while (!readers_get_event(tap)) {
+    if (timebase_ms() - start >= ENROLL_WAIT_MS) {
+      return FALSE;
+    }
+    background_service();
+  }
+  return TRUE;
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function writes sealed credential blocks to a tapped card with
+//   the given key. A card still on the transport key then gets the
+//   site's sector key.
+//
+// RETURN:
+//   MIFARE_OK or the reason the write failed
+// -----------------------------------------------------------------------------
+uint8 write_card_credential(READER_TAP_t* tap, const uint8 key[], uint8 blocks[])
+{
+  uint8 result = MIFARE_OK;
+  uint8 i;
+
+  mifare_begin(tap->reader, tap->uid);
+  for (i = 0; (i < CREDENTIAL_BLOCKS) && (result == MIFARE_OK); i++) {
+    result = mifare_write_block(tap->reader, CREDENTIAL_BLOCK + i, key, MIFARE_KEY_A, &blocks[i * MIFARE_BLOCK_SIZE]);
+  }
+  if ((result == MIFARE_OK) && (key != g_card_key)) {
+    result = mifare_set_key_a(tap->reader, CREDENTIAL_BLOCK, key, MIFARE_KEY_A, g_card_key);
+  }
+  readers_release(tap->reader);
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function waits for a known card and writes its credential. A
+//   card enrolled before takes the sector key. A new one refuses it and
+//   drops back to idle, so the reader picks it up again straight away
+//   and it is written with the transport key instead.
+//
+// -----------------------------------------------------------------------------
+void enroll_card(void)
+{
+  READER_TAP_t tap;
+  uint8 blocks[CREDENTIAL_BLOCKS * MIFARE_BLOCK_SIZE];
+  uint8 uid[MIFARE_UID_SIZE];
+  uint8 level;
+  uint8 result;
+  uint8 i;
+
+  if (!g_aes_ok) {
+    messages_print(MSG_AES_FAILED);
+    return;
+  }
+  if (!CARD_SITE_KEY_SET || !CARD_SECTOR_KEY_SET) {
+    print_console("\n\rNo site keys; build with CARD_SITE_KEY and CARD_SECTOR_KEY defined");
+    return;
+  }
+
+  messages_print(MSG_PRESENT_CARD);
+  readers_flush();
+  if (!wait_for_card(&tap)) {
+    print_console("\n\rNo card");
+    return;
+  }
+
+  level = card_user_level(tap.uid);
+  if (level == NO_AUTHENTICATION) {
+    messages_print(MSG_UNKNOWN_CARD);
+    readers_release(tap.reader);
+    return;
+  }
+
+  seal_card_credential(blocks, tap.uid, level);
+
+  result = write_card_credential(&tap, g_card_key, blocks);
+  if (result == MIFARE_AUTH_ERROR) {
+    for (i = 0; i < MIFARE_UID_SIZE; i++) {
+      uid[i] = tap.uid[i];
+    }
+    if (wait_for_card(&tap)) {
+      result = MIFARE_NO_CARD;
+      if ((tap.uid[0] == uid[0]) && (tap.uid[1] == uid[1]) &&
+          (tap.uid[2] == uid[2]) && (tap.uid[3] == uid[3])) {
+        result = write_card_credential(&tap, g_card_transport_key, blocks);
+      } else {
+        readers_release(tap.reader);
+      }
+    }
+  }
+
+  if (result == MIFARE_OK) {
+    messages_print(MSG_CARD_ENROLLED);
+  } else {
+    alt_printf("\n\rEnroll failed (%u)", result);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function runs the AES known answer tests and prints how many bus
+//   cycles a block takes to encrypt and decrypt. The tick interrupt keeps
+//   running, so the figures include its share of the CPU.
+//
+// -----------------------------------------------------------------------------
+void print_aes_benchmark(void)
+{
+  uint8 block[AES_BLOCK_SIZE];
+  uint32 start;
+  uint32 elapsed;
+  uint8 i;
+
+  g_aes_ok = aes_self_test();
+  print_console(g_aes_ok ? "\n\rAES self test passed" : "\n\rAES self test FAILED");
+
+  for (i = 0; i < AES_BLOCK_SIZE; i++) {
+    block[i] = i;
+  }
+  aes_set_key(g_card_cipher_key);
+
+  start = timebase_us();
+  for (i = 0; i < AES_BENCH_BLOCKS; i++) {
+    aes_encrypt_block(block, block);
+  }
+  elapsed = timebase_us() - start;
+  alt_printfL("\n\rEncrypt: %lu cycles/block", elapsed * BUS_CYCLES_PER_US / AES_BENCH_BLOCKS);
+
+  start = timebase_us();
+  for (i = 0; i < AES_BENCH_BLOCKS; i++) {
+    aes_decrypt_block(block, block);
+  }
+  elapsed = timebase_us() - start;
+  alt_printfL("\n\rDecrypt: %lu cycles/block", elapsed * BUS_CYCLES_PER_US / AES_BENCH_BLOCKS);
+
+  start = timebase_us();
+  aes_cmac(block, MIFARE_UID_SIZE + MIFARE_BLOCK_SIZE, block);
+  elapsed = timebase_us() - start;
+  alt_printfL("\n\rCMAC of a credential: %lu cycles", elapsed * BUS_CYCLES_PER_US);
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function prints and logs what the reader supervisor did.
+//
+// -----------------------------------------------------------------------------
+void report_reader_faults(void)
+{
+  READER_FAULT_t fault;
+
+  while (readers_get_fault(&fault)) {
+    if (g_monitor_on) {
+      g_monitor_events++; // Shown as a count on the dashboard
+    } else {
+      alt_printf("READER %u: ", fault.door);
+      switch (fault.action) {
+        case READERS_SOFT_RESET: print_console("soft reset"); break;
+        case READERS_REINIT:     print_console("re-initialised"); break;
+        case READERS_OFFLINE:    print_console("OFFLINE"); break;
+        default:                 print_console("back online"); break;
+      }
+      alt_printf(" (cause %u)\n\r", fault.cause);
+    }
+    journal_append(fault.timestamp, JOURNAL_READER, fault.door, ((uint32)fault.action << 8) | fault.cause);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function prints the link statistics of every card reader since
+//   they were last printed, then clears them, so a reader going bad shows
+//   up as rising error counts.
+//
+// -----------------------------------------------------------------------------
+void print_reader_stats(void)
+{
+  static uint32 cleared_ms = 0;
+  static char* const command_names[RC522_TIMEOUTS] = {
+    "REQA    ", "ANTICOLL", "SELECT  ", "AUTH    ", "READ    ", "WRITE   ", "HALT    "
+  };
+  const RC522_READER_t* reader;
+  uint8 door;
+  uint8 i;
+
+  alt_printfL("\n\rLast %lu s", (timebase_ms() - cleared_ms) / MS_PER_SECOND);
+  for (door = 0; door < READERS_MAX; door++) {
+    if (!readers_is_fitted(door)) {
+      continue;
+    }
+    reader = readers_get(door);
+    alt_printf("\n\rReader %u: ", door);
+    print_console(readers_is_online(door) ? "online" : "OFFLINE");
+    alt_printf(", version %02X", reader->version);
+    alt_printf("\n\r %u check failures, ", reader->stats.check_failures);
+    alt_printf("%u stuck, ", reader->stats.stuck);
+    alt_printf("%u resets, ", reader->stats.resets);
+    alt_printf("%u re-inits, ", reader->stats.reinits);
+    alt_printf("%u BCC errors", reader->stats.bcc_errors);
+    print_console("\n\r command   sent  no answer  errors");
+    for (i = 0; i < RC522_TIMEOUTS; i++) {
+      print_console("\n\r ");
+      print_console(command_names[i]);
+      alt_printf(" %5u", reader->stats.commands[i]);
+      alt_printf("  %9u", reader->stats.no_answer[i]);
+      alt_printf("  %6u", reader->stats.errors[i]);
+    }
+  }
+  readers_clear_stats();
+  cleared_ms = timebase_ms();
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function ends the session, logs who was logged in and why, and
+//   drops the user level so no command runs until the next login. main()
+//   then goes back to the card prompt.
+//
+// INPUT PARAMETERS:
+//   reason - SESSION_END_IDLE or SESSION_END_COMMAND.
+// -----------------------------------------------------------------------------
+void log_out(uint8 reason)
+{
+  session_end();
+  panel_stop();
+  journal_append(timebase_ms(), JOURNAL_LOGOUT, reason, g_user_level);
+  g_user_level = NO_AUTHENTICATION;
+
+  print_console("\n\r");
+  if (reason == SESSION_END_IDLE) {
+    alt_printf("Logged out after %u s with no input.\n\r", (uint16)(SESSION_IDLE_MS / MS_PER_SECOND));
+  } else {
+    messages_print(MSG_LOGGED_OUT);
+  }
+  clear_lcd();
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function forces the status engine to BAD, which sounds the
+//   siren, or sounds it again if it already was BAD and was silenced.
+//
+// -----------------------------------------------------------------------------
+void sound_alarm(void)
+{
+  if (status_force(&g_status_engine, STATUS_LEVEL_BAD)) {
+    change_status_level(SYSTEM_STATUS_BAD);
+  } else {
+    startAlarm(); // Already BAD; sound the siren again even if it was silenced
+  }
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   These functions are the control panel actions. They run from
+//   panel_service() and report on the LCD's second line.
+//
+// -----------------------------------------------------------------------------
+void panel_alarm_off(void)
+{
+  stopAlarm();
+  panel_message("Alarm silenced");
+}
+
+void panel_alarm_on(void)
+{
+  sound_alarm();
+  panel_message("Alarm sounding");
+}
+
+void panel_alert_low(void)
+{
+  set_alertness(1);
+  panel_message("Alertness set");
+}
+
+void panel_alert_med(void)
+{
+  set_alertness(2);
+  panel_message("Alertness set");
+}
+
+void panel_alert_high(void)
+{
+  set_alertness(3);
+  panel_message("Alertness set");
+}
+
+void panel_logout(void)
+{
+  log_out(SESSION_END_COMMAND);
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   These functions are the control panel readouts. Each fills in the
+//   LCD's second line, up to PANEL_COLUMNS characters, and is called
+//   every PANEL_REFRESH_MS while its item is shown.
+//
+// INPUT PARAMETERS:
+//   text - The line to fill in.
+// -----------------------------------------------------------------------------
+void readout_alarm(char text[])
+{
+  sprintf(text, "Alarm is %s", g_alarm_on ? "ON" : "off");
+}
+
+void readout_alertness(char text[])
+{
+  if (g_alertness == 3) {
+    sprintf(text, "Now high");
+  } else if (g_alertness == 2) {
+    sprintf(text, "Now medium");
+  } else {
+    sprintf(text, "Now low");
+  }
+}
+
+void readout_light(char text[])
+{
+  sprintf(text, "%d", getLightLevel());
+}
+
+void readout_temp(char text[])
+{
+  sint16 tenths = getTempTenths();
+
+  if (tenths < 0) {
+    *text++ = '-';
+    tenths = -tenths;
+  }
+  sprintf(text, "%d.%d F", tenths / 10, tenths % 10);
+}
+
+void readout_distance(char text[])
+{
+  sprintf(text, "%u mm", g_distance);
+}
+
+void readout_status(char text[])
+{
+  if (gstatus_level == SYSTEM_STATUS_BAD) {
+    sprintf(text, "BAD  score %d", status_score(&g_status_engine));
+  } else if (gstatus_level == SYSTEM_STATUS_OK) {
+    sprintf(text, "OK   score %d", status_score(&g_status_engine));
+  } else {
+    sprintf(text, "GOOD score %d", status_score(&g_status_engine));
+  }
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function shows a live dashboard of the sensors on the SCI. The
+//   layout is drawn once; after that every g_monitor_refresh_ms only the
+//   characters of the values that changed are sent, plus one point on
+//   each sparkline, so a refresh costs tens of bytes instead of the
+//   whole screen. + and - halve and double the refresh period and ENTER
+//   goes back. Tamper and reader reports aren't printed meanwhile, since
+//   they would scroll the layout away; they are counted on the dashboard
+//   and are in the journal.
+//
+// -----------------------------------------------------------------------------
+void run_monitor(void) {
+  // Static: too big for the stack
+  static DASHBOARD_FIELD_t fields[MONITOR_FIELDS];
+  static DASHBOARD_SPARK_t sparks[MONITOR_TRACES];
+  char text[20];
+  char key;
+  uint32 refreshed_ms;
+  uint8 trace;
+
+  g_monitor_on = TRUE;
+  g_monitor_events = 0;
+  dashboard_clear_bytes();
+  dashboard_begin();
+
+  dashboard_print(SECURITY_SYSTEM_HEADER);
+  dashboard_print(" - Monitor");
+  dashboard_goto(3, 1);
+  dashboard_print("Status          Score         Alarm         Alertness");
+  dashboard_goto(5, 1);
+  dashboard_print("Light");
+  dashboard_goto(6, 1);
+  dashboard_print("Temp");
+  dashboard_goto(7, 1);
+  dashboard_print("Motion");
+  dashboard_goto(8, 1);
+  dashboard_print("Distance");
+  dashboard_goto(10, 1);
+  dashboard_print("Refresh         (+/-)  Last refresh            Events");
+  dashboard_goto(12, 1);
+  dashboard_print("ENTER to go back");
+
+  dashboard_field_init(&fields[MONITOR_STATUS], 3, 8, 4);
+  dashboard_field_init(&fields[MONITOR_SCORE], 3, 23, 5);
+  dashboard_field_init(&fields[MONITOR_ALARM], 3, 37, 3);
+  dashboard_field_init(&fields[MONITOR_ALERTNESS], 3, 55, 6);
+  for (trace = 0; trace < MONITOR_TRACES; trace++) {
+    dashboard_field_init(&fields[MONITOR_LIGHT + trace], 5 + trace, 11, 9);
+  }
+  dashboard_field_init(&fields[MONITOR_RATE], 10, 9, 7);
+  dashboard_field_init(&fields[MONITOR_COST], 10, 37, 10);
+  dashboard_field_init(&fields[MONITOR_EVENTS], 10, 55, 5);
+
+  dashboard_spark_init(&sparks[0], 5, MONITOR_SPARK_COLUMN, 0, 1023);  // light, ADC counts
+  dashboard_spark_init(&sparks[1], 6, MONITOR_SPARK_COLUMN, 500, 1000); // 50.0 - 100.0 F
+  dashboard_spark_init(&sparks[2], 7, MONITOR_SPARK_COLUMN, 0, 400);   // motion, ADC counts
+  dashboard_spark_init(&sparks[3], 8, MONITOR_SPARK_COLUMN, 0, 3000);  // mm
+
+  refreshed_ms = timebase_ms() - g_monitor_refresh_ms;
+  while (session_is_active()) {
+    background_service();
+
+    if (serial_get_char(SERIAL_PORT1, &key)) {
+      session_touch();
+      if (key == ENTER_KEY) {
+        break;
+      } else if ((key == '+') && (g_monitor_refresh_ms > MONITOR_REFRESH_MIN_MS)) {
+        g_monitor_refresh_ms /= 2;
+      } else if ((key == '-') && (g_monitor_refresh_ms < MONITOR_REFRESH_MAX_MS)) {
+        g_monitor_refresh_ms *= 2;
+      }
+    }
+
+    if ((timebase_ms() - refreshed_ms) >= g_monitor_refresh_ms) {
+      refreshed_ms = timebase_ms();
+      update_monitor(fields, sparks);
+
+      // The layout the first time, the changes after that
+      sprintf(text, "%u bytes", dashboard_bytes());
+      dashboard_field_set(&fields[MONITOR_COST], text);
+      dashboard_clear_bytes();
+    }
+  }
+
+  g_monitor_on = FALSE;
+  alt_clear();
+  if (g_monitor_events != 0) {
+    alt_printf("%u tamper or reader events while monitoring, see the journal\n\r", g_monitor_events);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function reads the sensors and sets the dashboard's fields and
+//   sparklines. Only what changed goes out on the SCI.
+//
+// INPUT PARAMETERS:
+//   fields - The dashboard fields, MONITOR_FIELDS of them.
+//   sparks - The sparklines, MONITOR_TRACES of them.
+// -----------------------------------------------------------------------------
+void update_monitor(DASHBOARD_FIELD_t fields[], DASHBOARD_SPARK_t sparks[]) {
+  char text[20];
+  sint16 samples[MONITOR_TRACES];
+  uint8 trace;
+
+  if (gstatus_level == SYSTEM_STATUS_BAD) {
+    dashboard_field_set(&fields[MONITOR_STATUS], "BAD");
+  } else if (gstatus_level == SYSTEM_STATUS_OK) {
+    dashboard_field_set(&fields[MONITOR_STATUS], "OK");
+  } else {
+    dashboard_field_set(&fields[MONITOR_STATUS], "GOOD");
+  }
+  sprintf(text, "%d", status_score(&g_status_engine));
+  dashboard_field_set(&fields[MONITOR_SCORE], text);
+  dashboard_field_set(&fields[MONITOR_ALARM], g_alarm_on ? "ON" : "off");
+  readout_alertness(text);
+  dashboard_field_set(&fields[MONITOR_ALERTNESS], &text[4]); // without "Now "
+
+  samples[0] = getLightLevel();
+  samples[1] = getTempTenths();
+  samples[2] = getMotionLevel(); // Peak since the last refresh
+  samples[3] = g_distance;
+
+  sprintf(text, "%d", samples[0]);
+  dashboard_field_set(&fields[MONITOR_LIGHT], text);
+  readout_temp(text);
+  dashboard_field_set(&fields[MONITOR_TEMP], text);
+  sprintf(text, "%d", samples[2]);
+  dashboard_field_set(&fields[MONITOR_MOTION], text);
+  readout_distance(text);
+  dashboard_field_set(&fields[MONITOR_DISTANCE], text);
+
+  for (trace = 0; trace < MONITOR_TRACES; trace++) {
+    dashboard_spark_add(&sparks[trace], samples[trace]);
+  }
+
+  sprintf(text, "%u ms", g_monitor_refresh_ms);
+  dashboard_field_set(&fields[MONITOR_RATE], text);
+  sprintf(text, "%u", g_monitor_events);
+  dashboard_field_set(&fields[MONITOR_EVENTS], text);
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function lists the console baud rates and moves the console to
+//   the one picked. The new rate is announced at the old one; the
+//   terminal then has SERIAL_SWITCH_MS to follow and type the sync
+//   characters, or the console stays where it was. tools/baud_test.py
+//   does the same from a script.
+//
+// -----------------------------------------------------------------------------
+void change_baud_rate(void)
+{
+  const SERIAL_STATS_t* stats = serial_stats(SERIAL_PORT1);
+  sint16 error;
+  uint8 rate;
+  uint8 i;
+  char key;
+
+  print_console("\n\r # baud    error");
+  for (rate = 0; rate < SERIAL_RATES; rate++) {
+    alt_printf("\n\r %u", rate);
+    alt_printfL(" %-7lu ", serial_rates[rate].baud);
+    error = serial_rates[rate].error;
+    print_console(error < 0 ? "-" : "+");
+    if (error < 0) {
+      error = -error;
+    }
+    alt_printf("%d.", error / 100);
+    alt_printf("%02d%%", error % 100);
+    if (!serial_rate_ok(rate)) {
+      print_console("  too far off");
+    } else if (rate == serial_rate(SERIAL_PORT1)) {
+      print_console("  <- now");
+    }
+  }
+  alt_printf("\n\r%u framing errors, ", stats->framing_errors);
+  alt_printf("%u overruns, ", stats->overruns);
+  alt_printf("%u breaks, ", stats->breaks);
+  alt_printf("%u fall backs", stats->fallbacks);
+  print_console("\n\rRate (ENTER to keep): ");
+
+  key = read_console_char();
+  if (!session_is_active() || (key == ENTER_KEY)) {
+    return;
+  }
+  outchar1(key);
+  rate = (uint8)(key - '0');
+  if (!serial_rate_ok(rate)) {
+    print_console("\n\rError: Can't use that rate!");
+    return;
+  }
+
+  alt_printfL("\n\rBAUD %lu: set the terminal to match and type ", serial_rates[rate].baud);
+  for (i = 0; i < SERIAL_SYNC_COUNT; i++) {
+    outchar1(SERIAL_SYNC_CHAR);
+  }
+  print_console("\n\r");
+  serial_switch(SERIAL_PORT1, rate);
+  while (serial_is_switching(SERIAL_PORT1)) {
+    background_service();
+    serial_get_char(SERIAL_PORT1, &key); // Takes the sync characters
+  }
+  session_touch();
+  alt_printfL("\n\rConsole at %lu baud", serial_rates[serial_rate(SERIAL_PORT1)].baud);
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function sends SEND_TEST_LINES lines of a known pattern between
+//   "#SEND" and "#END" lines, so a script can time the console and check
+//   nothing was lost.
+//
+// -----------------------------------------------------------------------------
+void send_test_pattern(void)
+{
+  uint8 line;
+  uint8 i;
+
+  print_console("\n\r#SEND\n\r");
+  for (line = 0; line < SEND_TEST_LINES; line++) {
+    alt_printf("%04X", line);
+    for (i = 4; i < SEND_TEST_LINE_CHARS; i++) {
+      outchar1('0' + (line + i) % 64);
+    }
+    print_console("\n\r");
+  }
+  print_console("#END\n\r");
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function prints how the CPU was spent since it was last printed,
+//   then starts the counts over. Asleep is time stopped in WAI while
+//   sleep_ms() or wait_until() waited; the services they ran meanwhile
+//   are counted as busy, and shown on their own too. A kcycle is 1000
+//   bus cycles, so 24 a ms.
+//
+// -----------------------------------------------------------------------------
+void print_load(void)
+{
+  IDLE_LOAD_t load;
+
+  idle_get_load(&load);
+  alt_printfL("\n\rLast %lu ms, ", load.elapsed_ms);
+  alt_printfL("%lu kcycles", load.elapsed_ms * BUS_CYCLES_PER_US);
+  alt_printfL("\n\rBusy           %9lu kcycles ", (load.elapsed_ms - load.sleep_ms) * BUS_CYCLES_PER_US);
+  print_share(load.elapsed_ms - load.sleep_ms, load.elapsed_ms);
+  alt_printfL("\n\rAsleep (WAI)   %9lu kcycles ", load.sleep_ms * BUS_CYCLES_PER_US);
+  print_share(load.sleep_ms, load.elapsed_ms);
+  alt_printfL("\n\rServices while waiting %lu kcycles ", load.task_ms * BUS_CYCLES_PER_US);
+  print_share(load.task_ms, load.elapsed_ms);
+  alt_printf("\n\r%u waits", load.waits);
+  idle_clear_load();
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function prints part as a percentage of whole, to a tenth.
+//
+// -----------------------------------------------------------------------------
+void print_share(uint32 part, uint32 whole)
+{
+  // Keep part * 1000 in 32 bits
+  while (whole > 4000000UL) {
+    part >>= 1;
+    whole >>= 1;
+  }
+  if (whole == 0) {
+    whole = 1;
+  }
+  print_tenths((sint16)(part * 1000 / whole));
+  print_console("%");
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function prints what each profiling probe timed since it was
+//   last printed, then starts them over. Times are in bus cycles, 24 a
+//   us, to within a 16 cycle timer count; each probe's histogram follows
+//   as the count of times under each power of two.
+//
+// -----------------------------------------------------------------------------
+void print_perf(void)
+{
+#if PERF_ENABLED
+  static PERF_PROBE_t stats; // Too big for the stack
+  uint8 probe;
+  uint8 bucket;
+  uint8 shown;
+
+  alt_printf("\n\rAn empty probe pair takes %u cycles", perf_overhead());
+  print_console("\n\r probe               count       min       avg       max");
+  for (probe = 0; probe < PERF_PROBES; probe++) {
+    perf_get(probe, &stats);
+    print_console("\n\r ");
+    print_console((char*)perf_name(probe));
+    alt_printfL(" %9lu", stats.count);
+    if (stats.count == 0) {
+      continue;
+    }
+    alt_printfL(" %9lu", stats.min * PERF_CYCLES_PER_COUNT);
+    alt_printfL(" %9lu", stats.total / stats.count * PERF_CYCLES_PER_COUNT);
+    alt_printfL(" %9lu", stats.max * PERF_CYCLES_PER_COUNT);
+    shown = 0;
+    for (bucket = 0; bucket < PERF_BUCKETS; bucket++) {
+      if (stats.buckets[bucket] == 0) {
+        continue;
+      }
+      if (shown++ % 4 == 0) {
+        print_console("\n\r  ");
+      }
+      if (bucket == PERF_BUCKETS - 1) {
+        alt_printfL("  >=%lu", (1UL << bucket) * PERF_CYCLES_PER_COUNT);
+      } else {
+        alt_printfL("  <%lu", (2UL << bucket) * PERF_CYCLES_PER_COUNT);
+      }
+      alt_printf(": %u", stats.buckets[bucket]);
+    }
+  }
+  perf_clear();
+#else
+  messages_print(MSG_PERF_OFF);
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function looks at the stack every STACK_CHECK_MS and prints and
+//   logs it the first time it goes deeper than STACK_WARN_PERCENT, and
+//   the first time it reaches the guard bytes at its end.
+//
+// -----------------------------------------------------------------------------
+void report_stack(void)
+{
+  static uint32 checked_ms = 0;
+  static bool warned = FALSE;
+  static bool overflowed = FALSE;
+  uint16 used;
+  uint8 overflow;
+
+  if (timebase_ms() - checked_ms < STACK_CHECK_MS) {
+    return;
+  }
+  checked_ms = timebase_ms();
+
+  used = stack_used();
+  overflow = stack_overflowed();
+  if ((overflow && !overflowed) ||
+      (!warned && ((uint32)used * 100 > (uint32)stack_size() * STACK_WARN_PERCENT))) {
+    if (g_monitor_on) {
+      g_monitor_events++; // Shown as a count on the dashboard
+    } else {
+      print_console(overflow ? "STACK OVERFLOW: " : "STACK: ");
+      alt_printf("%u of ", used);
+      alt_printf("%u bytes used\n\r", stack_size());
+    }
+    journal_append(timebase_ms(), JOURNAL_STACK, overflow, used);
+    warned = TRUE;
+    overflowed = overflow;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function prints the size of the stack, the most of it used since
+//   reset and what was never touched, which is RAM STACKSIZE in the PRM
+//   files could give back.
+//
+// -----------------------------------------------------------------------------
+void print_stack(void)
+{
+  uint16 used = stack_used();
+
+  alt_printf("\n\rStack %u bytes, ", stack_size());
+  alt_printf("%u used at most ", used);
+  print_share(used, stack_size());
+  alt_printf("\n\r%u never used, ", stack_size() - used);
+  print_console(stack_overflowed() ? "guard OVERWRITTEN" : "guard intact");
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function prints the longest time a critical section kept
+//   interrupts masked and how late each timed interrupt ran since they
+//   were last printed, then starts them over. Times are in bus cycles,
+//   to within a 16 cycle timer count. The critical section figure leaves
+//   out the ISRs, which mask interrupts for as long as they run, so the
+//   longest ISR the perf probes have timed since perf was last printed
+//   is shown beside it.
+//
+// -----------------------------------------------------------------------------
+void print_irq(void)
+{
+  static char* const vector_names[LATENCY_VECTORS] = {
+    "echo   ", "speaker", "rti    "
+  };
+  LATENCY_STATS_t stats;
+  uint8 vector;
+#if PERF_ENABLED
+  PERF_PROBE_t isr;
+  uint32 longest = 0;
+  uint8 probe;
+#endif
+
+  alt_printfL("\n\rCritical sections masked at most %lu cycles", (uint32)critical_max_window() * PERF_CYCLES_PER_COUNT);
+  alt_printfL(" (%lu sections, ISRs not included)", critical_sections());
+#if PERF_ENABLED
+  for (probe = PERF_RTI_ISR; probe <= PERF_SPEAKER_ISR; probe++) {
+    perf_get(probe, &isr);
+    if (isr.max > longest) {
+      longest = isr.max;
+    }
+  }
+  alt_printfL("\n\rISRs masked at most %lu cycles", longest * PERF_CYCLES_PER_COUNT);
+#endif
+  print_console("\n\r interrupt     runs  avg late  max late");
+  for (vector = 0; vector < LATENCY_VECTORS; vector++) {
+    latency_get(vector, &stats);
+    print_console("\n\r ");
+    print_console(vector_names[vector]);
+    alt_printfL(" %9lu", stats.count);
+    if (stats.count != 0) {
+      alt_printfL(" %9lu", stats.total / stats.count * PERF_CYCLES_PER_COUNT);
+      alt_printfL(" %9lu", (uint32)stats.max * PERF_CYCLES_PER_COUNT);
+    }
+  }
+  critical_clear();
+}
+
+// -----------------------------------------------------------------------------
+// DESCRIPTION
+//   This function prints why the board reset, if it wasn't powered up or
+//   reset from its button: the watchdog and the task that stopped
+//   checking in, or the clock monitor.
+//
+// -----------------------------------------------------------------------------
+void report_reset(void)
+{
+  static char* const task_names[WATCHDOG_TASKS] = {
+    "background_service", "readers_service"
+  };
+  uint8 task = watchdog_missed_task();
+
+  if (watchdog_reset_cause() == WATCHDOG_RESET_COP) {
+    messages_print(MSG_RESET_COP);
+    if (task == WATCHDOG_NO_TASK) {
+      messages_print(MSG_RESET_TICK_STOPPED);
+    } else {
+      print_console(task_names[task]);
+      messages_print(MSG_RESET_MISSED);
+    }
+    alt_printf(" (%u since power on)\n\r", watchdog_cop_resets());
+  } else if (watchdog_reset_cause() == WATCHDOG_RESET_CLOCK) {
+    messages_print(MSG_RESET_CLOCK);
+  }
+}
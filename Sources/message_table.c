@@ -0,0 +1,237 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: message_table.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Generated by tools/messages_gen.py from messages.txt; don't edit.
+//    100 messages: 3825 bytes as literals, 2460 packed.
+//
+//*****************************************************************************
+
+#include "message_table.h"
+
+#pragma CONST_SEG __PPAGE_SEG MESSAGE_TABLE
+
+const uint16 message_offsets[MESSAGES] =
+{
+   1236,   982,   879,  1458,  1428,  1292,  1304,  1056,
+   1278,  1001,   517,   242,  1631,   785,  1418,   628,
+    809,   833,   428,   655,   274,   305,   709,   488,
+    209,   682,   573,   942,  1020,   922,  1107,     0,
+    176,  1190,   336,   760,   545,   367,   143,    73,
+   1477,  1438,  1340,   856,  1603,  1495,  1661,  1565,
+   1540,  1486,  1676,  1504,  1617,  1549,  1557,  1596,
+   1638,  1589,  1090,  1374,    37,  1174,  1141,  1573,
+   1531,  1656,  1407,  1522,  1610,  1513,  1644,  1073,
+   1624,  1264,  1250,  1385,  1581,   601,  1468,  1671,
+    398,  1206,   458,   901,  1316,  1363,  1650,  1680,
+   1448,   735,  1038,   962,  1666,  1396,  1352,  1328,
+   1221,  1158,  1124,   108
+};
+
+const uint8 message_text[1683] =
+{
+  0x6C, 0x9E, 0x74, 0x6D, 0x6F, 0x64, 0xB3, 0x82, 0x54, 0x6F, 0x67, 0x67,
+  0xA3, 0x20, 0x68, 0x9E, 0x20, 0x72, 0x61, 0x89, 0x20, 0x6C, 0x9E, 0x95,
+  0x73, 0xA5, 0x72, 0x63, 0xB3, 0x64, 0x65, 0x89, 0x63, 0xBA, 0xB2, 0x83,
+  0x00, 0x50, 0xBB, 0x73, 0x73, 0x20, 0x61, 0x20, 0x6E, 0x75, 0x6D, 0x62,
+  0x65, 0x72, 0x2C, 0x20, 0xAC, 0x20, 0x45, 0x4E, 0x54, 0x45, 0x52, 0x20,
+  0x66, 0xAC, 0x80, 0x89, 0x78, 0x95, 0xAB, 0x6D, 0xA4, 0x64, 0x73, 0x83,
+  0x00, 0x50, 0xA3, 0x61, 0xAD, 0x20, 0x94, 0x89, 0x72, 0x80, 0xAB, 0x6D,
+  0xA4, 0x8F, 0x74, 0x68, 0x61, 0x95, 0x79, 0xA5, 0x27, 0x8F, 0x6C, 0x69,
+  0x6B, 0x65, 0xA8, 0x65, 0x78, 0x65, 0x63, 0x75, 0x89, 0x9F, 0x83, 0x00,
+  0x83, 0x54, 0x68, 0xB3, 0x70, 0x72, 0x6F, 0x62, 0x65, 0x73, 0x20, 0x9A,
+  0xB3, 0xAB, 0x70, 0x69, 0xA3, 0x8F, 0xA5, 0x95, 0x28, 0x50, 0x45, 0x52,
+  0x46, 0x5F, 0x45, 0x4E, 0x41, 0x42, 0x4C, 0x45, 0x44, 0x29, 0x00, 0x69,
+  0x72, 0x71, 0x87, 0x87, 0x20, 0x82, 0x53, 0xA2, 0xB1, 0x89, 0x72, 0x72,
+  0x75, 0x70, 0x95, 0x6C, 0x61, 0x89, 0x6E, 0x63, 0x79, 0x20, 0xA4, 0x8F,
+  0x6D, 0xBC, 0x6B, 0x65, 0x8F, 0x8D, 0x83, 0x00, 0x6A, 0xA5, 0x72, 0x6E,
+  0xB4, 0x87, 0x82, 0x4C, 0x69, 0x73, 0x74, 0x80, 0x6D, 0x6F, 0x73, 0x95,
+  0xBB, 0x63, 0x94, 0x95, 0x6A, 0xA5, 0x72, 0x6E, 0xB4, 0x20, 0x65, 0x76,
+  0x94, 0x74, 0x73, 0x83, 0x00, 0x73, 0x94, 0x64, 0x89, 0x73, 0x95, 0x20,
+  0x82, 0x53, 0x94, 0x8F, 0x61, 0x20, 0x89, 0x73, 0x95, 0x70, 0x61, 0x74,
+  0x89, 0x72, 0x6E, 0xA8, 0x8D, 0x80, 0x63, 0xB2, 0x73, 0x6F, 0xA3, 0x2E,
+  0x83, 0x00, 0x50, 0xA3, 0x61, 0xAD, 0x20, 0x94, 0x89, 0x72, 0x20, 0x79,
+  0xA5, 0x72, 0x20, 0x70, 0xBC, 0x73, 0x77, 0xAC, 0x8F, 0x75, 0x73, 0xB1,
+  0x67, 0x80, 0x6B, 0x65, 0x79, 0x70, 0x61, 0x64, 0x2E, 0x00, 0x6C, 0x6F,
+  0x67, 0xA5, 0x74, 0x87, 0x20, 0x82, 0x4C, 0x6F, 0x67, 0x20, 0xA5, 0x95,
+  0xA4, 0x8F, 0x77, 0x61, 0x69, 0x95, 0x66, 0xAC, 0x20, 0x61, 0x20, 0x63,
+  0x9A, 0x64, 0x2E, 0x83, 0x00, 0x6D, 0x94, 0x75, 0x87, 0x87, 0x82, 0x47,
+  0x6F, 0x20, 0x62, 0x61, 0x63, 0x6B, 0x20, 0x74, 0x6F, 0x80, 0x6E, 0x75,
+  0x6D, 0x65, 0x72, 0x69, 0x63, 0x20, 0x6D, 0x94, 0x75, 0x2E, 0x83, 0x00,
+  0x72, 0x9D, 0x65, 0x72, 0x73, 0x87, 0x82, 0x53, 0xA2, 0x63, 0x9A, 0x8F,
+  0x72, 0x9D, 0x65, 0x72, 0x20, 0x6C, 0xB1, 0x6B, 0x20, 0x73, 0x74, 0x61,
+  0xBA, 0x73, 0xBA, 0x63, 0x73, 0x83, 0x00, 0x73, 0x74, 0x61, 0x63, 0x6B,
+  0x87, 0x20, 0x20, 0x82, 0x53, 0xA2, 0xA2, 0x64, 0x65, 0x65, 0x70, 0x80,
+  0x73, 0x74, 0x61, 0x63, 0x6B, 0x20, 0x68, 0xBC, 0x20, 0x62, 0x65, 0x94,
+  0x83, 0x00, 0x50, 0xA3, 0x61, 0xAD, 0x20, 0x73, 0x63, 0xA4, 0x20, 0x79,
+  0xA5, 0x72, 0x20, 0x6B, 0x65, 0x79, 0x63, 0x9A, 0x8F, 0x74, 0x6F, 0x20,
+  0x6C, 0x6F, 0x67, 0x20, 0xB1, 0x2E, 0x83, 0x00, 0x73, 0x63, 0xA4, 0x87,
+  0x87, 0x82, 0x53, 0x63, 0xA4, 0x80, 0x94, 0x76, 0x69, 0x72, 0xB2, 0x6D,
+  0x94, 0x95, 0x66, 0xAC, 0x20, 0x68, 0x61, 0x7A, 0x9A, 0x64, 0x73, 0x2E,
+  0x83, 0x00, 0x83, 0x45, 0x6E, 0x89, 0x72, 0x20, 0x64, 0x61, 0x89, 0x20,
+  0xA4, 0x8F, 0x8D, 0x20, 0xBC, 0x20, 0x59, 0x59, 0x4D, 0x4D, 0x44, 0x44,
+  0x68, 0x68, 0x6D, 0x6D, 0x73, 0x73, 0x9F, 0x00, 0x62, 0x61, 0x75, 0x64,
+  0x87, 0x87, 0x82, 0x43, 0x68, 0xA4, 0x67, 0x65, 0x80, 0x63, 0xB2, 0x73,
+  0x6F, 0xA3, 0x20, 0x62, 0x61, 0x75, 0x8F, 0x72, 0x61, 0x89, 0x2E, 0x83,
+  0x00, 0x50, 0x49, 0x4E, 0x20, 0x94, 0x89, 0xBB, 0x8F, 0xBB, 0x63, 0x94,
+  0x74, 0x6C, 0x79, 0x2C, 0x20, 0x6E, 0x6F, 0x95, 0x6E, 0x65, 0x65, 0x64,
+  0x65, 0x64, 0x2E, 0x83, 0x00, 0x70, 0x65, 0x72, 0x66, 0x87, 0x87, 0x82,
+  0x53, 0x68, 0x6F, 0x77, 0x80, 0x70, 0x72, 0x6F, 0x66, 0x69, 0x6C, 0xA1,
+  0x70, 0x72, 0x6F, 0x62, 0xB3, 0x8D, 0x73, 0x83, 0x00, 0xB4, 0x9A, 0x6D,
+  0x5F, 0x6F, 0x66, 0x66, 0x20, 0x82, 0x44, 0x69, 0x73, 0x61, 0x62, 0xA3,
+  0x80, 0xB4, 0x9A, 0x6D, 0x20, 0x73, 0x79, 0x73, 0x89, 0x6D, 0x2E, 0x83,
+  0x00, 0x57, 0x68, 0x61, 0x95, 0x77, 0xA5, 0x6C, 0x8F, 0x79, 0xA5, 0x20,
+  0x6C, 0x69, 0x6B, 0x65, 0xA8, 0x64, 0x6F, 0x20, 0x74, 0x6F, 0x64, 0x61,
+  0x79, 0x3F, 0x83, 0x00, 0x72, 0x9D, 0x6C, 0x9E, 0x95, 0x82, 0x86, 0x80,
+  0xB8, 0x94, 0x95, 0x6C, 0x9E, 0x95, 0xA3, 0x76, 0x65, 0x6C, 0x20, 0xB1,
+  0x80, 0x9A, 0x65, 0x61, 0x2E, 0x83, 0x00, 0x8D, 0x87, 0x87, 0x82, 0x44,
+  0x69, 0x73, 0x70, 0x6C, 0x61, 0x79, 0x80, 0x64, 0x61, 0x89, 0x2C, 0x20,
+  0x8D, 0x20, 0xA4, 0x8F, 0x75, 0x70, 0x8D, 0x2E, 0x83, 0x00, 0xB4, 0x9A,
+  0x6D, 0x5F, 0xB2, 0x20, 0x20, 0x82, 0x41, 0x63, 0xBA, 0x76, 0x61, 0x89,
+  0x80, 0xB4, 0x9A, 0x6D, 0x20, 0x73, 0x79, 0x73, 0x89, 0x6D, 0x2E, 0x83,
+  0x00, 0x6D, 0xB2, 0x69, 0x74, 0xAC, 0x87, 0x82, 0x57, 0x61, 0x74, 0x63,
+  0x68, 0x80, 0x73, 0x94, 0x73, 0xAC, 0x73, 0x20, 0x6C, 0x69, 0x76, 0x65,
+  0x2E, 0x83, 0x00, 0x4D, 0x4F, 0x56, 0x49, 0x4E, 0x47, 0x82, 0x50, 0x4F,
+  0x53, 0x53, 0x49, 0x42, 0x4C, 0x45, 0x20, 0x46, 0x4C, 0x41, 0x53, 0x48,
+  0x4C, 0x8E, 0x54, 0x00, 0x6C, 0x6F, 0x61, 0x64, 0x87, 0x87, 0x82, 0x53,
+  0xA2, 0xA2, 0x62, 0x75, 0x73, 0x79, 0x80, 0x73, 0x79, 0x73, 0x89, 0x6D,
+  0x20, 0x69, 0x73, 0x83, 0x00, 0x53, 0x65, 0x63, 0x75, 0x72, 0x69, 0x74,
+  0x79, 0x20, 0x53, 0x79, 0x73, 0x89, 0x6D, 0x20, 0x76, 0x2E, 0x20, 0x31,
+  0x2E, 0x30, 0x2E, 0x30, 0x00, 0x72, 0x9D, 0x89, 0x6D, 0x70, 0x20, 0x20,
+  0x82, 0x86, 0x80, 0xB8, 0x94, 0x95, 0x89, 0x93, 0x20, 0xB1, 0x80, 0x9A,
+  0x65, 0x61, 0x2E, 0x83, 0x00, 0x72, 0x9D, 0x6D, 0x6F, 0xBA, 0xB2, 0x82,
+  0x86, 0x80, 0xB8, 0x94, 0x95, 0x6D, 0x97, 0x20, 0xB1, 0x80, 0x9A, 0x65,
+  0x61, 0x2E, 0x83, 0x00, 0x88, 0x98, 0x4C, 0x8E, 0x54, 0x84, 0x82, 0x85,
+  0x20, 0x41, 0x44, 0x4D, 0x49, 0x4E, 0x53, 0x49, 0x54, 0x52, 0x41, 0x54,
+  0x4F, 0x52, 0x00, 0x43, 0x68, 0x65, 0x63, 0x6B, 0xA1, 0x66, 0xAC, 0x20,
+  0x61, 0x20, 0x70, 0xBB, 0x73, 0x94, 0x95, 0x63, 0x9A, 0x64, 0xB7, 0x83,
+  0x00, 0x83, 0x45, 0x72, 0x72, 0xAC, 0x9F, 0x49, 0x6E, 0x76, 0xB4, 0x69,
+  0x8F, 0x64, 0x61, 0x89, 0x20, 0xA4, 0x8F, 0x8D, 0x21, 0x00, 0x61, 0xA3,
+  0x72, 0x74, 0x5F, 0x6D, 0x65, 0x8F, 0x82, 0xB9, 0x80, 0x8C, 0x6D, 0x65,
+  0x64, 0x69, 0x75, 0x6D, 0x83, 0x00, 0x66, 0x6C, 0xBC, 0x68, 0x5F, 0xA3,
+  0x8F, 0x82, 0x46, 0x6C, 0xBC, 0x68, 0x80, 0x4C, 0x45, 0x44, 0x73, 0x2E,
+  0x83, 0x00, 0x83, 0x50, 0xBB, 0x73, 0x94, 0x74, 0x80, 0x63, 0x9A, 0x8F,
+  0x74, 0x6F, 0x20, 0x94, 0x72, 0x6F, 0x6C, 0x6C, 0xB7, 0x00, 0x45, 0x72,
+  0x72, 0xAC, 0x88, 0xB0, 0x4E, 0x4F, 0x54, 0x20, 0x57, 0x4F, 0x52, 0x4B,
+  0x49, 0x4E, 0x47, 0x83, 0x00, 0x91, 0x87, 0x20, 0x52, 0x65, 0x6D, 0x6F,
+  0x76, 0xB3, 0xB0, 0x43, 0x9A, 0x64, 0x87, 0x87, 0x20, 0x91, 0x83, 0x00,
+  0x61, 0xA3, 0x72, 0x74, 0x5F, 0x6C, 0x6F, 0x77, 0x20, 0x82, 0xB9, 0x80,
+  0x8C, 0x6C, 0x6F, 0x77, 0x83, 0x00, 0x83, 0x41, 0x45, 0x53, 0x20, 0xAD,
+  0x6C, 0x66, 0x20, 0x89, 0x73, 0x95, 0x66, 0x61, 0x69, 0xA3, 0x64, 0x00,
+  0x43, 0x9A, 0x8F, 0x53, 0x65, 0xA3, 0x63, 0x89, 0x64, 0x2C, 0x20, 0x54,
+  0x79, 0x70, 0x65, 0x9F, 0x00, 0x44, 0x49, 0x53, 0x54, 0x41, 0x4E, 0x43,
+  0x45, 0x20, 0x46, 0x52, 0x4F, 0x4D, 0x20, 0xAA, 0x3A, 0x00, 0x45, 0x72,
+  0x72, 0xAC, 0x9F, 0x49, 0x6E, 0x76, 0xB4, 0x69, 0x8F, 0xAB, 0x6D, 0xA4,
+  0x64, 0x21, 0x00, 0x61, 0xA3, 0x72, 0x74, 0x5F, 0x68, 0x69, 0x67, 0x20,
+  0x82, 0xB9, 0x80, 0x8C, 0x68, 0x9E, 0x83, 0x00, 0x83, 0xA6, 0x43, 0x4C,
+  0x4F, 0x43, 0x4B, 0x20, 0x4D, 0x4F, 0x4E, 0x49, 0x54, 0x4F, 0x52, 0x83,
+  0x00, 0x88, 0x54, 0x4F, 0x4F, 0x20, 0x4D, 0x55, 0x43, 0x48, 0x20, 0x4C,
+  0x8E, 0x54, 0x82, 0x9C, 0x84, 0x00, 0x20, 0x6D, 0x69, 0x73, 0xAD, 0x8F,
+  0x69, 0x74, 0x73, 0x20, 0x64, 0x9D, 0x6C, 0xB1, 0x65, 0x00, 0x53, 0x63,
+  0xA4, 0x6E, 0xA1, 0x94, 0x76, 0x69, 0x72, 0xB2, 0x6D, 0x94, 0x74, 0xB7,
+  0x83, 0x00, 0xAD, 0x74, 0x8D, 0x87, 0x82, 0xB9, 0x80, 0x64, 0x61, 0x89,
+  0x20, 0xA4, 0x8F, 0x8D, 0x83, 0x00, 0x44, 0x61, 0x89, 0x20, 0xA4, 0x8F,
+  0x8D, 0x20, 0x6E, 0x6F, 0x95, 0xAD, 0x74, 0x83, 0x00, 0x74, 0x68, 0xB3,
+  0xBA, 0x63, 0x6B, 0x20, 0x73, 0x74, 0x6F, 0x70, 0x70, 0x65, 0x64, 0x00,
+  0x41, 0x75, 0x74, 0x68, 0x94, 0xBA, 0x63, 0x61, 0x74, 0xB1, 0x67, 0xB7,
+  0x83, 0x00, 0x53, 0x79, 0x73, 0x89, 0x6D, 0x20, 0x53, 0x74, 0x61, 0x74,
+  0x75, 0x73, 0x9F, 0x00, 0x88, 0xAA, 0x20, 0x4D, 0x41, 0x59, 0x20, 0x42,
+  0x45, 0xB6, 0x82, 0x85, 0x81, 0x00, 0x91, 0x91, 0x91, 0x91, 0x91, 0x91,
+  0x91, 0x91, 0x91, 0x91, 0x91, 0x2A, 0x83, 0x00, 0x44, 0x65, 0x89, 0x63,
+  0x89, 0x64, 0x9F, 0x55, 0xAD, 0x72, 0x83, 0x00, 0x44, 0x65, 0x89, 0x63,
+  0x89, 0x64, 0x9F, 0xAF, 0x9A, 0x64, 0x83, 0x00, 0x52, 0x61, 0x89, 0x20,
+  0x6F, 0x66, 0x20, 0x52, 0x69, 0xAD, 0x9F, 0x00, 0x83, 0xA6, 0x57, 0x41,
+  0x54, 0x43, 0x48, 0x44, 0x4F, 0x47, 0x9F, 0x00, 0x88, 0x48, 0x8E, 0x20,
+  0x4C, 0x8E, 0x54, 0x84, 0x82, 0x99, 0x81, 0x00, 0x4C, 0x6F, 0x67, 0x67,
+  0x65, 0x8F, 0xA5, 0x74, 0x2E, 0x83, 0x00, 0x4D, 0x45, 0x41, 0x53, 0x55,
+  0x52, 0x49, 0x4E, 0x47, 0x83, 0x00, 0x4E, 0x6F, 0x95, 0xB2, 0x80, 0x6D,
+  0x94, 0x75, 0x2E, 0x83, 0x00, 0x57, 0x65, 0x6C, 0xAB, 0xB3, 0x75, 0xAD,
+  0x72, 0x2C, 0xA8, 0x00, 0x83, 0x43, 0x9A, 0x8F, 0x94, 0x72, 0x6F, 0x6C,
+  0xA3, 0x64, 0x00, 0x88, 0xAE, 0x82, 0x54, 0x45, 0x4D, 0x50, 0xB5, 0x20,
+  0xA9, 0x00, 0x43, 0x6F, 0x6D, 0x6D, 0xA4, 0x64, 0x73, 0x3A, 0x83, 0x00,
+  0x44, 0x65, 0x89, 0x63, 0x89, 0x64, 0x3A, 0x90, 0x83, 0x00, 0x4C, 0x9E,
+  0x95, 0x4C, 0x65, 0x76, 0x65, 0x6C, 0x9F, 0x00, 0x4C, 0x9E, 0x95, 0x53,
+  0xA5, 0x72, 0x63, 0x65, 0x9F, 0x00, 0xB0, 0x43, 0x9A, 0x8F, 0x66, 0xA5,
+  0x6E, 0x64, 0x83, 0x00, 0x57, 0x65, 0x6C, 0xAB, 0x65, 0x90, 0x2C, 0xA8,
+  0x00, 0x83, 0x52, 0x9D, 0xA1, 0x6C, 0x9E, 0x74, 0xB7, 0x00, 0x83, 0x52,
+  0x9D, 0xA1, 0x6D, 0x97, 0xB7, 0x2E, 0x00, 0x83, 0x52, 0x9D, 0xA1, 0x89,
+  0x93, 0xB7, 0x2E, 0x00, 0x88, 0x48, 0x8E, 0x20, 0xA0, 0x82, 0x99, 0x81,
+  0x00, 0x88, 0x48, 0x8E, 0x20, 0xA0, 0x82, 0x9C, 0x84, 0x00, 0x88, 0x48,
+  0x8E, 0xA7, 0xB5, 0x82, 0x9C, 0x84, 0x00, 0x88, 0x53, 0x41, 0x46, 0x45,
+  0x84, 0x20, 0x20, 0x00, 0x88, 0x9B, 0x48, 0x8E, 0xA7, 0x82, 0x85, 0x81,
+  0x00, 0x83, 0x92, 0x84, 0x9F, 0x4C, 0x4F, 0x57, 0x00, 0x83, 0x92, 0x84,
+  0x9F, 0x4D, 0x45, 0x44, 0x00, 0x88, 0x48, 0x8E, 0xA7, 0x82, 0x99, 0x81,
+  0x00, 0x88, 0x98, 0x4C, 0x8E, 0x54, 0x84, 0x53, 0x00, 0x8B, 0x20, 0x55,
+  0xAD, 0x72, 0x2E, 0x83, 0x00, 0x83, 0x4C, 0x8E, 0x96, 0x46, 0x46, 0x00,
+  0x83, 0x92, 0x84, 0x9F, 0x48, 0x8E, 0x00, 0x88, 0x53, 0x41, 0x46, 0x45,
+  0x84, 0x00, 0x88, 0x9B, 0x48, 0x8E, 0xA7, 0x53, 0x00, 0x88, 0x9B, 0xA0,
+  0x82, 0x85, 0x81, 0x00, 0x88, 0xAA, 0xB6, 0x82, 0x99, 0x81, 0x00, 0x8A,
+  0x8A, 0x8A, 0x8A, 0x8A, 0x83, 0x00, 0x83, 0x4C, 0x8E, 0x96, 0x4E, 0x00,
+  0x88, 0x98, 0xA0, 0x84, 0x53, 0x00, 0x88, 0xAE, 0x82, 0x99, 0x81, 0x00,
+  0x54, 0x65, 0x93, 0x3A, 0x00, 0x54, 0x65, 0x93, 0x9F, 0x00, 0x83, 0xAF,
+  0x9A, 0x64, 0x00, 0x8B, 0x6E, 0x90, 0x2E, 0x00, 0x4D, 0x97, 0x9F, 0x00,
+  0x88, 0xA9, 0x00
+};
+
+const uint16 message_word_offsets[MESSAGE_WORDS] =
+{
+      0,     6,    21,    25,    28,    35,    54,    80,
+     84,    88,    91,   101,   134,   151,   156,   160,
+    163,   178,   182,   196,   206,   209,   212,   234,
+    246,   258,   265,   268,   278,   288,   292,   296,
+    299,   306,   311,   316,   319,   322,   325,   339,
+    345,   350,   362,   369,   373,   376,   379,   390,
+    400,   406,   409,   412,   415,   418,   426,   434,
+    437,   442,   446,   449,   452
+};
+
+const uint8 message_words[455] =
+{
+  0x20, 0x74, 0x68, 0x65, 0x20, 0x00, 0x20, 0x41, 0x44, 0x4D, 0x49, 0x4E,
+  0x49, 0x53, 0x54, 0x52, 0x41, 0x54, 0x4F, 0x52, 0x00, 0x20, 0x2D, 0x20,
+  0x00, 0x0A, 0x0D, 0x00, 0x20, 0x4C, 0x45, 0x56, 0x45, 0x4C, 0x00, 0x43,
+  0x4F, 0x4E, 0x53, 0x49, 0x44, 0x45, 0x52, 0x20, 0x4E, 0x4F, 0x54, 0x49,
+  0x46, 0x59, 0x49, 0x4E, 0x47, 0x00, 0x44, 0x69, 0x73, 0x70, 0x6C, 0x61,
+  0x79, 0x20, 0x69, 0x6E, 0x66, 0x6F, 0x72, 0x6D, 0x61, 0x74, 0x69, 0x6F,
+  0x6E, 0x20, 0x61, 0x62, 0x6F, 0x75, 0x74, 0x00, 0x20, 0x20, 0x20, 0x00,
+  0x2E, 0x2E, 0x20, 0x00, 0x74, 0x65, 0x00, 0x3D, 0x3D, 0x3D, 0x3D, 0x3D,
+  0x3D, 0x3D, 0x3D, 0x3D, 0x00, 0x59, 0x6F, 0x75, 0x20, 0x61, 0x72, 0x65,
+  0x20, 0x63, 0x75, 0x72, 0x72, 0x65, 0x6E, 0x74, 0x6C, 0x79, 0x20, 0x6C,
+  0x6F, 0x67, 0x67, 0x65, 0x64, 0x20, 0x69, 0x6E, 0x20, 0x61, 0x73, 0x20,
+  0x61, 0x00, 0x61, 0x6C, 0x65, 0x72, 0x74, 0x6E, 0x65, 0x73, 0x73, 0x20,
+  0x6C, 0x65, 0x76, 0x65, 0x6C, 0x20, 0x00, 0x74, 0x69, 0x6D, 0x65, 0x00,
+  0x49, 0x47, 0x48, 0x00, 0x64, 0x20, 0x00, 0x20, 0x41, 0x64, 0x6D, 0x69,
+  0x6E, 0x69, 0x73, 0x74, 0x72, 0x61, 0x74, 0x6F, 0x72, 0x00, 0x2A, 0x2A,
+  0x2A, 0x00, 0x4E, 0x45, 0x57, 0x20, 0x41, 0x4C, 0x45, 0x52, 0x54, 0x4E,
+  0x45, 0x53, 0x53, 0x00, 0x6D, 0x70, 0x65, 0x72, 0x61, 0x74, 0x75, 0x72,
+  0x65, 0x00, 0x65, 0x6E, 0x00, 0x74, 0x20, 0x00, 0x54, 0x20, 0x53, 0x4F,
+  0x55, 0x52, 0x43, 0x45, 0x20, 0x44, 0x45, 0x54, 0x45, 0x43, 0x54, 0x49,
+  0x4F, 0x4E, 0x3A, 0x20, 0x4F, 0x00, 0x6F, 0x74, 0x69, 0x6F, 0x6E, 0x20,
+  0x6C, 0x65, 0x76, 0x65, 0x6C, 0x00, 0x53, 0x55, 0x53, 0x50, 0x49, 0x43,
+  0x49, 0x4F, 0x55, 0x53, 0x20, 0x00, 0x4E, 0x4F, 0x54, 0x49, 0x46, 0x59,
+  0x00, 0x61, 0x72, 0x00, 0x52, 0x45, 0x41, 0x43, 0x48, 0x49, 0x4E, 0x47,
+  0x20, 0x00, 0x44, 0x41, 0x4E, 0x47, 0x45, 0x52, 0x4F, 0x55, 0x53, 0x00,
+  0x65, 0x61, 0x64, 0x00, 0x69, 0x67, 0x68, 0x00, 0x3A, 0x20, 0x00, 0x4D,
+  0x4F, 0x54, 0x49, 0x4F, 0x4E, 0x00, 0x69, 0x6E, 0x67, 0x20, 0x00, 0x68,
+  0x6F, 0x77, 0x20, 0x00, 0x6C, 0x65, 0x00, 0x61, 0x6E, 0x00, 0x6F, 0x75,
+  0x00, 0x52, 0x45, 0x53, 0x45, 0x54, 0x20, 0x42, 0x59, 0x20, 0x54, 0x48,
+  0x45, 0x20, 0x00, 0x20, 0x54, 0x45, 0x4D, 0x50, 0x00, 0x20, 0x74, 0x6F,
+  0x20, 0x00, 0x52, 0x49, 0x53, 0x49, 0x4E, 0x47, 0x20, 0x46, 0x41, 0x53,
+  0x54, 0x00, 0x4F, 0x42, 0x4A, 0x45, 0x43, 0x54, 0x00, 0x63, 0x6F, 0x6D,
+  0x00, 0x6F, 0x72, 0x00, 0x73, 0x65, 0x00, 0x46, 0x49, 0x52, 0x45, 0x20,
+  0x41, 0x4C, 0x45, 0x52, 0x54, 0x00, 0x55, 0x6E, 0x6B, 0x6E, 0x6F, 0x77,
+  0x6E, 0x20, 0x63, 0x00, 0x52, 0x46, 0x49, 0x44, 0x20, 0x00, 0x69, 0x6E,
+  0x00, 0x6F, 0x6E, 0x00, 0x65, 0x20, 0x00, 0x61, 0x6C, 0x00, 0x45, 0x52,
+  0x41, 0x54, 0x55, 0x52, 0x45, 0x00, 0x20, 0x4E, 0x45, 0x41, 0x52, 0x42,
+  0x59, 0x00, 0x2E, 0x2E, 0x00, 0x63, 0x75, 0x72, 0x72, 0x00, 0x53, 0x65,
+  0x74, 0x00, 0x74, 0x69, 0x00, 0x72, 0x65, 0x00, 0x61, 0x73, 0x00
+};
+
+#pragma CONST_SEG DEFAULT
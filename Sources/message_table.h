@@ -0,0 +1,133 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: message_table.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Generated by tools/messages_gen.py from messages.txt; don't edit.
+//    Message numbers for messages_print().
+//
+//*****************************************************************************
+
+#ifndef _MESSAGE_TABLE_H_
+#define _MESSAGE_TABLE_H_
+
+#include "sys_types.h"
+
+#define MSG_AUTHENTICATING         0
+#define MSG_RFID_NOT_WORKING       1
+#define MSG_CHECKING_FOR_CARD      2
+#define MSG_CARD_FOUND             3
+#define MSG_DETECTED_ADMIN         4
+#define MSG_DETECTED_USER          5
+#define MSG_DETECTED_UNKNOWN       6
+#define MSG_CARD_SELECTED          7
+#define MSG_STARS                  8
+#define MSG_REMOVE_CARD            9
+#define MSG_PIN_NOT_NEEDED         10
+#define MSG_ENTER_PIN              11
+#define MSG_DIVIDER                12
+#define MSG_HEADER                 13
+#define MSG_COMMANDS               14
+#define MSG_HELP_READLIGHT         15
+#define MSG_HELP_READTEMP          16
+#define MSG_HELP_READMOTION        17
+#define MSG_HELP_SCAN              18
+#define MSG_HELP_TIME              19
+#define MSG_HELP_LOGOUT            20
+#define MSG_HELP_MENU              21
+#define MSG_HELP_MONITOR           22
+#define MSG_HELP_BAUD              23
+#define MSG_HELP_SENDTEST          24
+#define MSG_HELP_ALARM_ON          25
+#define MSG_HELP_ALARM_OFF         26
+#define MSG_HELP_FLASH_LED         27
+#define MSG_HELP_ALERT_LOW         28
+#define MSG_HELP_ALERT_MED         29
+#define MSG_HELP_ALERT_HIGH        30
+#define MSG_HELP_LIGHTMODE         31
+#define MSG_HELP_JOURNAL           32
+#define MSG_HELP_SETTIME           33
+#define MSG_HELP_READERS           34
+#define MSG_HELP_LOAD              35
+#define MSG_HELP_PERF              36
+#define MSG_HELP_STACK             37
+#define MSG_HELP_IRQ               38
+#define MSG_ENTER_COMMAND          39
+#define MSG_READING_LIGHT          40
+#define MSG_LIGHT_LEVEL            41
+#define MSG_LIGHT_HIGH             42
+#define MSG_LIGHT_SUSPICIOUS       43
+#define MSG_SAFE_LEVEL             44
+#define MSG_READING_TEMP           45
+#define MSG_TEMPERATURE            46
+#define MSG_TEMP_HIGH              47
+#define MSG_TEMP_REACHING          48
+#define MSG_READING_MOTION         49
+#define MSG_MOTION_LEVEL           50
+#define MSG_MOTION_HIGH            51
+#define MSG_MOTION_REACHING        52
+#define MSG_ALERTNESS_LOW          53
+#define MSG_ALERTNESS_MED          54
+#define MSG_ALERTNESS_HIGH         55
+#define MSG_LIGHT_SOURCE_ON        56
+#define MSG_LIGHT_SOURCE_OFF       57
+#define MSG_INVALID_COMMAND        58
+#define MSG_NOT_ON_MENU            59
+#define MSG_MENU_PROMPT            60
+#define MSG_SCANNING               61
+#define MSG_SCAN_LIGHT_DANGEROUS   62
+#define MSG_SCAN_LIGHT_SUSPICIOUS  63
+#define MSG_SCAN_LIGHT_SAFE        64
+#define MSG_SCAN_TEMPERATURE       65
+#define MSG_SCAN_FIRE              66
+#define MSG_SCAN_TEMP_DANGEROUS    67
+#define MSG_SCAN_TEMP_REACHING     68
+#define MSG_SCAN_MOTION_DANGEROUS  69
+#define MSG_SCAN_MOTION_SUSPICIOUS 70
+#define MSG_SCAN_DISTANCE          71
+#define MSG_SCAN_OBJECT_NEARBY     72
+#define MSG_SCAN_OBJECT_MAYBE      73
+#define MSG_SYSTEM_STATUS          74
+#define MSG_WELCOME_USER           75
+#define MSG_LOGGED_IN_USER         76
+#define MSG_WHAT_TO_DO             77
+#define MSG_WELCOME_ADMIN          78
+#define MSG_LOGGED_IN_ADMIN        79
+#define MSG_SCAN_KEYCARD           80
+#define MSG_TIME_NOT_SET           81
+#define MSG_ENTER_TIME             82
+#define MSG_INVALID_TIME           83
+#define MSG_RATE_OF_RISE           84
+#define MSG_MEASURING              85
+#define MSG_FIRE_ALERT             86
+#define MSG_RISING_FAST            87
+#define MSG_LIGHT_SOURCE           88
+#define MSG_LIGHT_MOVING           89
+#define MSG_AES_FAILED             90
+#define MSG_PRESENT_CARD           91
+#define MSG_UNKNOWN_CARD           92
+#define MSG_CARD_ENROLLED          93
+#define MSG_LOGGED_OUT             94
+#define MSG_RESET_COP              95
+#define MSG_RESET_TICK_STOPPED     96
+#define MSG_RESET_MISSED           97
+#define MSG_RESET_CLOCK            98
+#define MSG_PERF_OFF               99
+
+#define MESSAGES                   100
+#define MESSAGE_WORDS              61
+
+#pragma CONST_SEG __PPAGE_SEG MESSAGE_TABLE
+extern const uint16 message_offsets[MESSAGES];
+extern const uint8  message_text[];
+extern const uint16 message_word_offsets[MESSAGE_WORDS];
+extern const uint8  message_words[];
+#pragma CONST_SEG DEFAULT
+
+#endif /* _MESSAGE_TABLE_H_ */
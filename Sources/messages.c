@@ -0,0 +1,92 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: messages.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file prints the console messages kept in banked flash. As
+//    literals the messages sat in STRINGS in ROM_C000, next to the code,
+//    and a message used in several places could be there several times.
+//    message_table.c holds each message once, packed, in MESSAGE_TABLE on
+//    PAGE_3D.
+//
+//    A message is a string of bytes ending in 0. A byte below 0x80 is a
+//    character; 0x80 + n stands for dictionary word n, itself a string of
+//    characters ending in 0. messages_print() sends each character to
+//    outchar1() as it is decoded, so nothing is copied to RAM.
+//
+//    The tables are declared __far (message_table.h), so the compiler
+//    reads them through the PPAGE routines in datapage.c. That costs tens
+//    of cycles a byte, well under the ~1 ms a character takes at 9600 baud.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include "main_asm.h"               // outchar1()
+#include "messages.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define MESSAGE_END             0
+#define MESSAGE_WORD            0x80    // first dictionary byte
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: messages_print
+//
+// DESCRIPTION:
+//    This function sends a message to the console, unpacking it as it
+//    goes.
+//
+// INPUT:
+//   message - MSG_ number; unknown numbers print nothing
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void messages_print(uint8 message)
+{
+  const uint8* __far text;
+  const uint8* __far word;
+  uint8 symbol;
+
+  if (message >= MESSAGES)
+  {
+    return;
+  } /* if */
+
+  text = &message_text[message_offsets[message]];
+  while ((symbol = *text++) != MESSAGE_END)
+  {
+    if (symbol < MESSAGE_WORD)
+    {
+      outchar1(symbol);
+      continue;
+    } /* if */
+
+    word = &message_words[message_word_offsets[symbol - MESSAGE_WORD]];
+    while (*word != MESSAGE_END)
+    {
+      outchar1(*word++);
+    } /* while */
+  } /* while */
+
+} /* messages_print */
@@ -0,0 +1,29 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: messages.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for printing the console messages
+//    kept in banked flash. The MSG_ numbers come from message_table.h,
+//    which tools/messages_gen.py builds from messages.txt.
+//
+//*****************************************************************************
+
+#ifndef _MESSAGES_H_
+#define _MESSAGES_H_
+
+#include "sys_types.h"
+#include "message_table.h"
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+void messages_print(uint8 message);
+
+#endif /* _MESSAGES_H_ */
@@ -0,0 +1,741 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: mifare.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file implements MIFARE Classic block access on top of the RC522
+//    driver. The card must already be selected (rc522_select_tag()).
+//
+//    Each reader has its own card session, kept in its RC522_READER_t, so
+//    cards on different readers can be served in turn. The session
+//    remembers the sector and key that Crypto1 was last
+//    started with. Reading or writing another block of that sector goes
+//    straight to the READ or WRITE command, so a credential spread over
+//    three blocks of one sector costs one authentication and three reads.
+//    Any error ends the session: the card drops back to IDLE after a
+//    failed command and has to be selected again.
+//
+//    Blocks read or written are kept in a small cache, replaced least
+//    recently used first. Entries are only made after the card proved it
+//    knows the key, and belong to the reader session and key that read
+//    them: mifare_begin() starts a new session, so every tap
+//    authenticates again and a card with a copied UID can't live off the
+//    genuine card's data. Entries also expire after MIFARE_CACHE_TTL_MS.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include <stddef.h>                 // NULL
+#include "mifare.h"
+#include "timebase.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// 1K cards and the first 2K of 4K cards have 4 block sectors, the rest
+// of a 4K card has 16 block sectors
+#define SMALL_SECTOR_BLOCKS     4
+#define LARGE_SECTOR_BLOCKS     16
+#define LARGE_SECTOR_FIRST      128
+#define SMALL_SECTORS           (LARGE_SECTOR_FIRST / SMALL_SECTOR_BLOCKS)
+
+#define MANUFACTURER_BLOCK      0
+
+// Sector trailer layout: key A, access bits, user byte, key B
+#define TRAILER_KEY_A           0
+#define TRAILER_ACCESS          6
+#define TRAILER_ACCESS_SIZE     4
+#define TRAILER_KEY_B           10
+
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  const RC522_READER_t* reader; // the session that read the block
+  uint8  session;
+  uint8  uid[MIFARE_UID_SIZE];
+  uint8  key_type;              // the key it was read with
+  uint8  key[MIFARE_KEY_SIZE];
+  uint8  block;
+  bool   valid;
+  uint32 loaded_ms;     // when the block came from the card
+  uint32 used_ms;       // for least recently used replacement
+  uint8  data[MIFARE_BLOCK_SIZE];
+} MIFARE_CACHE_t;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+static MIFARE_CACHE_t cache[MIFARE_CACHE_ENTRIES];
+
+// Transport configuration access bits (FF 07 80) and user byte: key A
+// reads and writes the data blocks and can change key A
+static const uint8 transport_access[TRAILER_ACCESS_SIZE] = { 0xFF, 0x07, 0x80, 0x69 };
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+static uint8 mifare_sector(uint8 block);
+static bool  mifare_is_trailer(uint8 block);
+static uint8 mifare_trailer(uint8 block);
+static uint8 mifare_authenticate(RC522_READER_t* reader, uint8 block,
+                                 const uint8* key, uint8 key_type);
+static void  mifare_abort(RC522_READER_t* reader);
+static bool  mifare_cache_owns(const MIFARE_CACHE_t* entry,
+                               const RC522_READER_t* reader, uint8 block);
+static MIFARE_CACHE_t* mifare_cache_find(const RC522_READER_t* reader, uint8 block,
+                                         const uint8* key, uint8 key_type, uint32 now);
+static void  mifare_cache_store(const RC522_READER_t* reader, uint8 block,
+                                const uint8* key, uint8 key_type,
+                                const uint8* data, uint32 now);
+static bool  mifare_bytes_equal(const uint8* first, const uint8* second, uint8 length);
+static void  mifare_copy(uint8* destination, const uint8* source, uint8 length);
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: mifare_begin
+//
+// DESCRIPTION:
+//    This function starts a session with a selected card. Any session with
+//    another card is ended first, and blocks cached by earlier sessions
+//    aren't used.
+//
+// INPUT:
+//   reader - the reader the card is on
+//   uid    - the 4 byte UID from MFRC522_Anticoll()
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void mifare_begin(RC522_READER_t* reader, const uint8* uid)
+{
+
+  if (reader->authenticated)
+  {
+    rc522_stop_crypto1(reader);
+  } /* if */
+
+  mifare_copy(reader->uid, uid, MIFARE_UID_SIZE);
+  reader->card = TRUE;
+  reader->session++;
+  reader->authenticated = FALSE;
+
+} /* mifare_begin */
+
+
+//----------------------------------------------------------------------------
+// NAME: mifare_read_blocks
+//
+// DESCRIPTION:
+//    This function reads consecutive data blocks. Blocks this session
+//    already read with the same key are not read again, and the card is
+//    only authenticated when the sector or key differs from the last one
+//    used.
+//
+// INPUT:
+//   reader   - the reader the card is on
+//   block    - the first block to read
+//   count    - the number of blocks
+//   key      - the 6 byte sector key
+//   key_type - MIFARE_KEY_A or MIFARE_KEY_B
+//
+// OUTPUT:
+//   data     - count * MIFARE_BLOCK_SIZE bytes
+//
+// RETURN:
+//   MIFARE_OK or the reason the read failed
+//----------------------------------------------------------------------------
+uint8 mifare_read_blocks(RC522_READER_t* reader, uint8 block, uint8 count,
+                         const uint8* key, uint8 key_type, uint8* data)
+{
+  uint8  frame[MIFARE_BLOCK_SIZE + MIFARE_CRC_SIZE];
+  uint8  status;
+  uint32 now;
+  MIFARE_CACHE_t* entry;
+
+  if (!reader->card)
+  {
+    return (MIFARE_NO_CARD);
+  } /* if */
+
+  now = timebase_ms();
+
+  for (; count > 0; count--, block++, data += MIFARE_BLOCK_SIZE)
+  {
+    entry = mifare_cache_find(reader, block, key, key_type, now);
+    if (entry != NULL)
+    {
+      mifare_copy(data, entry->data, MIFARE_BLOCK_SIZE);
+      continue;
+    } /* if */
+
+    status = mifare_authenticate(reader, block, key, key_type);
+    if (status != MIFARE_OK)
+    {
+      return (status);
+    } /* if */
+
+    if (MFRC522_Read(reader, block, frame) != MI_OK)
+    {
+      mifare_abort(reader);
+      return (MIFARE_IO_ERROR);
+    } /* if */
+
+    mifare_copy(data, frame, MIFARE_BLOCK_SIZE);
+    mifare_cache_store(reader, block, key, key_type, frame, now);
+  } /* for */
+
+  return (MIFARE_OK);
+
+} /* mifare_read_blocks */
+
+
+//----------------------------------------------------------------------------
+// NAME: mifare_write_block
+//
+// DESCRIPTION:
+//    This function writes one data block and updates the cache. Block 0
+//    and the sector trailers are refused: a bad trailer locks the sector
+//    for good. mifare_set_key_a() is the one way to write a trailer.
+//
+// INPUT:
+//   reader   - the reader the card is on
+//   block    - the block to write
+//   key      - the 6 byte sector key
+//   key_type - MIFARE_KEY_A or MIFARE_KEY_B
+//   data     - MIFARE_BLOCK_SIZE bytes
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   MIFARE_OK or the reason the write failed
+//----------------------------------------------------------------------------
+uint8 mifare_write_block(RC522_READER_t* reader, uint8 block, const uint8* key,
+                         uint8 key_type, const uint8* data)
+{
+  uint8 status;
+
+  if (!reader->card)
+  {
+    return (MIFARE_NO_CARD);
+  } /* if */
+
+  if ((block == MANUFACTURER_BLOCK) || mifare_is_trailer(block))
+  {
+    return (MIFARE_DENIED);
+  } /* if */
+
+  status = mifare_authenticate(reader, block, key, key_type);
+  if (status != MIFARE_OK)
+  {
+    return (status);
+  } /* if */
+
+  if (MFRC522_Write(reader, block, (uint8*)data) != MI_OK)
+  {
+    mifare_abort(reader);
+    return (MIFARE_IO_ERROR);
+  } /* if */
+
+  mifare_cache_store(reader, block, key, key_type, data, timebase_ms());
+
+  return (MIFARE_OK);
+
+} /* mifare_write_block */
+
+
+//----------------------------------------------------------------------------
+// NAME: mifare_set_key_a
+//
+// DESCRIPTION:
+//    This function gives a sector a new key A by writing its trailer with
+//    the transport access bits, so the new key reads and writes the data
+//    blocks like the transport key did. Key B is left at all 0xFF: those
+//    access bits make it readable, so it can't be a secret. The session
+//    stays authenticated with the old key until it ends.
+//
+// INPUT:
+//   reader    - the reader the card is on
+//   block     - a block of the sector
+//   key       - the sector's current key
+//   key_type  - MIFARE_KEY_A or MIFARE_KEY_B
+//   new_key_a - the 6 byte key to set
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   MIFARE_OK or the reason the write failed
+//----------------------------------------------------------------------------
+uint8 mifare_set_key_a(RC522_READER_t* reader, uint8 block, const uint8* key,
+                       uint8 key_type, const uint8* new_key_a)
+{
+  uint8 trailer[MIFARE_BLOCK_SIZE];
+  uint8 idx;
+  uint8 status;
+
+  if (!reader->card)
+  {
+    return (MIFARE_NO_CARD);
+  } /* if */
+
+  status = mifare_authenticate(reader, block, key, key_type);
+  if (status != MIFARE_OK)
+  {
+    return (status);
+  } /* if */
+
+  mifare_copy(&trailer[TRAILER_KEY_A], new_key_a, MIFARE_KEY_SIZE);
+  mifare_copy(&trailer[TRAILER_ACCESS], transport_access, TRAILER_ACCESS_SIZE);
+  for (idx = 0; idx < MIFARE_KEY_SIZE; idx++)
+  {
+    trailer[TRAILER_KEY_B + idx] = 0xFF;
+  } /* for */
+
+  if (MFRC522_Write(reader, mifare_trailer(block), trailer) != MI_OK)
+  {
+    mifare_abort(reader);
+    return (MIFARE_IO_ERROR);
+  } /* if */
+
+  return (MIFARE_OK);
+
+} /* mifare_set_key_a */
+
+
+//----------------------------------------------------------------------------
+// NAME: mifare_end
+//
+// DESCRIPTION:
+//    This function ends the session and halts the card, so it isn't read
+//    again until it is taken away and presented again.
+//
+// INPUT:
+//   reader - the reader the card is on
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void mifare_end(RC522_READER_t* reader)
+{
+
+  if (reader->card)
+  {
+    rc522_send_halt(reader);
+  } /* if */
+
+  mifare_abort(reader);
+  reader->card = FALSE;
+
+} /* mifare_end */
+
+
+//----------------------------------------------------------------------------
+// NAME: mifare_cache_flush
+//
+// DESCRIPTION:
+//    This function throws away every cached block.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void mifare_cache_flush(void)
+{
+  uint8 idx;
+
+  for (idx = 0; idx < MIFARE_CACHE_ENTRIES; idx++)
+  {
+    cache[idx].valid = FALSE;
+  } /* for */
+
+} /* mifare_cache_flush */
+
+
+//-----------------------------------------------------------------------------
+//                             Private functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: mifare_sector
+//
+// DESCRIPTION:
+//    This function returns the sector a block belongs to.
+//
+// INPUT:
+//   block - the block number
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the sector number
+//----------------------------------------------------------------------------
+static uint8 mifare_sector(uint8 block)
+{
+
+  if (block < LARGE_SECTOR_FIRST)
+  {
+    return (block / SMALL_SECTOR_BLOCKS);
+  } /* if */
+
+  return (SMALL_SECTORS + (block - LARGE_SECTOR_FIRST) / LARGE_SECTOR_BLOCKS);
+
+} /* mifare_sector */
+
+
+//----------------------------------------------------------------------------
+// NAME: mifare_is_trailer
+//
+// DESCRIPTION:
+//    This function checks for the last block of a sector, which holds the
+//    keys and access bits.
+//
+// INPUT:
+//   block - the block number
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE for a sector trailer
+//----------------------------------------------------------------------------
+static bool mifare_is_trailer(uint8 block)
+{
+
+  if (block < LARGE_SECTOR_FIRST)
+  {
+    return ((block % SMALL_SECTOR_BLOCKS) == SMALL_SECTOR_BLOCKS - 1);
+  } /* if */
+
+  return ((block % LARGE_SECTOR_BLOCKS) == LARGE_SECTOR_BLOCKS - 1);
+
+} /* mifare_is_trailer */
+
+
+//----------------------------------------------------------------------------
+// NAME: mifare_trailer
+//
+// DESCRIPTION:
+//    This function returns the trailer of the sector holding a block.
+//
+// INPUT:
+//   block - the block number
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the sector trailer's block number
+//----------------------------------------------------------------------------
+static uint8 mifare_trailer(uint8 block)
+{
+
+  if (block < LARGE_SECTOR_FIRST)
+  {
+    return ((uint8)(block | (SMALL_SECTOR_BLOCKS - 1)));
+  } /* if */
+
+  return ((uint8)(block | (LARGE_SECTOR_BLOCKS - 1)));
+
+} /* mifare_trailer */
+
+
+//----------------------------------------------------------------------------
+// NAME: mifare_authenticate
+//
+// DESCRIPTION:
+//    This function starts Crypto1 for the sector holding a block, unless
+//    it is already running for that sector with the same key.
+//
+// INPUT:
+//   reader   - the reader the card is on
+//   block    - a block of the sector
+//   key      - the 6 byte sector key
+//   key_type - MIFARE_KEY_A or MIFARE_KEY_B
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   MIFARE_OK or MIFARE_AUTH_ERROR
+//----------------------------------------------------------------------------
+static uint8 mifare_authenticate(RC522_READER_t* reader, uint8 block,
+                                 const uint8* key, uint8 key_type)
+{
+  uint8 sector = mifare_sector(block);
+
+  if (reader->authenticated && (sector == reader->sector) &&
+      (key_type == reader->key_type) &&
+      mifare_bytes_equal(key, reader->key, MIFARE_KEY_SIZE))
+  {
+    return (MIFARE_OK);
+  } /* if */
+
+  if (MFRC522_Auth(reader, key_type, block, (uint8*)key, reader->uid) != MI_OK)
+  {
+    mifare_abort(reader);
+    return (MIFARE_AUTH_ERROR);
+  } /* if */
+
+  reader->authenticated = TRUE;
+  reader->sector = sector;
+  reader->key_type = key_type;
+  mifare_copy(reader->key, key, MIFARE_KEY_SIZE);
+
+  return (MIFARE_OK);
+
+} /* mifare_authenticate */
+
+
+//----------------------------------------------------------------------------
+// NAME: mifare_abort
+//
+// DESCRIPTION:
+//    This function turns Crypto1 off and forgets the authenticated sector.
+//
+// INPUT:
+//   reader - the reader the card is on
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void mifare_abort(RC522_READER_t* reader)
+{
+
+  rc522_stop_crypto1(reader);
+  reader->authenticated = FALSE;
+
+} /* mifare_abort */
+
+
+//----------------------------------------------------------------------------
+// NAME: mifare_cache_owns
+//
+// DESCRIPTION:
+//    This function checks that a valid entry holds a block read in the
+//    reader's current session.
+//
+// INPUT:
+//   entry  - the cache entry
+//   reader - the reader the card is on
+//   block  - the block number
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if the entry belongs to the session
+//----------------------------------------------------------------------------
+static bool mifare_cache_owns(const MIFARE_CACHE_t* entry,
+                              const RC522_READER_t* reader, uint8 block)
+{
+
+  return (entry->valid && (entry->block == block) &&
+          (entry->reader == reader) && (entry->session == reader->session) &&
+          mifare_bytes_equal(entry->uid, reader->uid, MIFARE_UID_SIZE));
+
+} /* mifare_cache_owns */
+
+
+//----------------------------------------------------------------------------
+// NAME: mifare_cache_find
+//
+// DESCRIPTION:
+//    This function looks up a block the session read with the same key.
+//    Expired entries are dropped on the way.
+//
+// INPUT:
+//   reader   - the reader the card is on
+//   block    - the block number
+//   key      - the 6 byte sector key
+//   key_type - MIFARE_KEY_A or MIFARE_KEY_B
+//   now      - the current time in ms
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the cache entry, or NULL if the block isn't cached
+//----------------------------------------------------------------------------
+static MIFARE_CACHE_t* mifare_cache_find(const RC522_READER_t* reader, uint8 block,
+                                         const uint8* key, uint8 key_type, uint32 now)
+{
+  uint8 idx;
+
+  for (idx = 0; idx < MIFARE_CACHE_ENTRIES; idx++)
+  {
+    if (cache[idx].valid && (now - cache[idx].loaded_ms >= MIFARE_CACHE_TTL_MS))
+    {
+      cache[idx].valid = FALSE;
+    } /* if */
+
+    if (mifare_cache_owns(&cache[idx], reader, block) &&
+        (cache[idx].key_type == key_type) &&
+        mifare_bytes_equal(cache[idx].key, key, MIFARE_KEY_SIZE))
+    {
+      cache[idx].used_ms = now;
+      return (&cache[idx]);
+    } /* if */
+  } /* for */
+
+  return (NULL);
+
+} /* mifare_cache_find */
+
+
+//----------------------------------------------------------------------------
+// NAME: mifare_cache_store
+//
+// DESCRIPTION:
+//    This function caches a block for the session, replacing its old
+//    copy, a free entry or the least recently used one.
+//
+// INPUT:
+//   reader   - the reader the card is on
+//   block    - the block number
+//   key      - the key the card accepted for it
+//   key_type - MIFARE_KEY_A or MIFARE_KEY_B
+//   data     - MIFARE_BLOCK_SIZE bytes
+//   now      - the current time in ms
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void mifare_cache_store(const RC522_READER_t* reader, uint8 block,
+                               const uint8* key, uint8 key_type,
+                               const uint8* data, uint32 now)
+{
+  uint8 idx;
+  uint8 victim = 0;
+
+  for (idx = 0; idx < MIFARE_CACHE_ENTRIES; idx++)
+  {
+    if (!cache[idx].valid)
+    {
+      victim = idx;
+    } /* if */
+    else if (mifare_cache_owns(&cache[idx], reader, block))
+    {
+      victim = idx;
+      break;
+    } /* else if */
+    else if (cache[victim].valid &&
+             (now - cache[idx].used_ms > now - cache[victim].used_ms))
+    {
+      victim = idx;
+    } /* else if */
+  } /* for */
+
+  cache[victim].reader = reader;
+  cache[victim].session = reader->session;
+  mifare_copy(cache[victim].uid, reader->uid, MIFARE_UID_SIZE);
+  cache[victim].key_type = key_type;
+  mifare_copy(cache[victim].key, key, MIFARE_KEY_SIZE);
+  mifare_copy(cache[victim].data, data, MIFARE_BLOCK_SIZE);
+  cache[victim].block = block;
+  cache[victim].loaded_ms = now;
+  cache[victim].used_ms = now;
+  cache[victim].valid = TRUE;
+
+} /* mifare_cache_store */
+
+
+//----------------------------------------------------------------------------
+// NAME: mifare_bytes_equal
+//
+// DESCRIPTION:
+//    This function compares two byte arrays.
+//
+// INPUT:
+//   first  - the first array
+//   second - the second array
+//   length - the number of bytes
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if they are the same
+//----------------------------------------------------------------------------
+static bool mifare_bytes_equal(const uint8* first, const uint8* second, uint8 length)
+{
+
+  while (length-- > 0)
+  {
+    if (*first++ != *second++)
+    {
+      return (FALSE);
+    } /* if */
+  } /* while */
+
+  return (TRUE);
+
+} /* mifare_bytes_equal */
+
+
+//----------------------------------------------------------------------------
+// NAME: mifare_copy
+//
+// DESCRIPTION:
+//    This function copies a byte array.
+//
+// INPUT:
+//   source      - the bytes to copy
+//   length      - the number of bytes
+//
+// OUTPUT:
+//   destination - the copy
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void mifare_copy(uint8* destination, const uint8* source, uint8 length)
+{
+
+  while (length-- > 0)
+  {
+    *destination++ = *source++;
+  } /* while */
+
+} /* mifare_copy */
@@ -0,0 +1,58 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: mifare.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for reading and writing MIFARE
+//    Classic 1K and 4K data blocks through the RC522. A card session per
+//    reader keeps Crypto1 running between blocks of the same sector and
+//    blocks read in the session are cached for it.
+//
+//*****************************************************************************
+
+#ifndef _MIFARE_H_
+#define _MIFARE_H_
+
+#include "sys_types.h"
+#include "RFID_rc522.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// Key types
+#define MIFARE_KEY_A            PICC_AUTHENT1A
+#define MIFARE_KEY_B            PICC_AUTHENT1B
+
+// Results
+#define MIFARE_OK               0
+#define MIFARE_AUTH_ERROR       1       // wrong key, or no card
+#define MIFARE_IO_ERROR         2       // no answer, bad CRC or no ACK
+#define MIFARE_DENIED           3       // block 0 or a sector trailer
+#define MIFARE_NO_CARD          4       // mifare_begin() wasn't called
+
+// Block cache: blocks read in the last MIFARE_CACHE_TTL_MS of the same
+// card session, with the same key, are returned without touching the card
+#define MIFARE_CACHE_ENTRIES    8
+#define MIFARE_CACHE_TTL_MS     2000
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+void  mifare_begin(RC522_READER_t* reader, const uint8* uid);
+uint8 mifare_read_blocks(RC522_READER_t* reader, uint8 block, uint8 count,
+                         const uint8* key, uint8 key_type, uint8* data);
+uint8 mifare_write_block(RC522_READER_t* reader, uint8 block, const uint8* key,
+                         uint8 key_type, const uint8* data);
+uint8 mifare_set_key_a(RC522_READER_t* reader, uint8 block, const uint8* key,
+                       uint8 key_type, const uint8* new_key_a);
+void  mifare_end(RC522_READER_t* reader);
+void  mifare_cache_flush(void);
+
+#endif /* _MIFARE_H_ */
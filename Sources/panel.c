@@ -0,0 +1,632 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: panel.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file implements the control panel. The menus are const tables
+//    of items, each of which opens a submenu, runs an action or just shows
+//    a readout. The LCD shows one item at a time:
+//
+//      line 1: the item's number and label, '>' if it opens a submenu
+//      line 2: its readout, refreshed every PANEL_REFRESH_MS, a message
+//              from the last action, or what SELECT does
+//
+//    A and B step through the items the user level allows, # opens or
+//    runs one, * goes back up, and the digits 1-9 pick an item directly.
+//
+//    Key presses keep the login session alive. Nothing here waits. panel_service() reads the keypad queue, builds
+//    the wanted screen in a frame buffer and writes only the characters
+//    that differ from what the LCD shows, at most PANEL_CELLS_PER_SERVICE
+//    per call, so a readout ticking over costs one or two LCD writes.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include <stddef.h>                 // NULL
+#include "main_asm.h"               // LCD routines
+#include "panel.h"
+#include "session.h"
+#include "timebase.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define PANEL_CELLS             (PANEL_ROWS * PANEL_COLUMNS)
+#define PANEL_NO_CELL           0xFF
+#define LCD_LINE_2_ADDR         0x40
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+static const PANEL_MENU_t* root_menu;
+static const PANEL_MENU_t* menu[PANEL_DEPTH];
+static uint8  selected[PANEL_DEPTH];
+static uint8  depth;
+static uint8  user_level;
+static bool   active;
+
+static char   frame[PANEL_CELLS];       // what the LCD should show
+static char   screen[PANEL_CELLS];      // what it shows, 0 if unknown
+static uint8  lcd_cell;                 // cell the LCD writes next
+static bool   dirty;                    // frame has to be built again
+static uint32 composed_ms;
+
+static char   message[PANEL_COLUMNS + 1];
+static bool   message_shown;
+static uint32 message_ms;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+static bool  panel_is_visible(const PANEL_MENU_t* list, uint8 index);
+static uint8 panel_step(uint8 index, sint8 step);
+static void  panel_select(void);
+static void  panel_compose(void);
+static void  panel_put(uint8 cell, const char* text);
+static void  panel_draw(void);
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: panel_init
+//
+// DESCRIPTION:
+//    This function sets the menu tree. The panel stays off until
+//    panel_start().
+//
+// INPUT:
+//   root - the top menu
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void panel_init(const PANEL_MENU_t* root)
+{
+
+  root_menu = root;
+  active = FALSE;
+
+} /* panel_init */
+
+
+//----------------------------------------------------------------------------
+// NAME: panel_start
+//
+// DESCRIPTION:
+//    This function takes over the LCD and keypad at the top menu, showing
+//    the items a user level allows. Whatever is on the LCD is redrawn.
+//
+// INPUT:
+//   level - the user level logged in
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void panel_start(uint8 level)
+{
+
+  user_level = level;
+  depth = 0;
+  menu[0] = root_menu;
+  selected[0] = panel_step(root_menu->count - 1, 1);
+  message_shown = FALSE;
+
+  keypad_flush();
+  panel_invalidate();
+  active = TRUE;
+
+} /* panel_start */
+
+
+//----------------------------------------------------------------------------
+// NAME: panel_stop
+//
+// DESCRIPTION:
+//    This function hands the LCD and keypad back, e.g. on a logout. The
+//    LCD is left as it is.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void panel_stop(void)
+{
+
+  active = FALSE;
+
+} /* panel_stop */
+
+
+//----------------------------------------------------------------------------
+// NAME: panel_is_active
+//
+// DESCRIPTION:
+//    This function tells if the panel owns the LCD and keypad.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE between panel_start() and panel_stop()
+//----------------------------------------------------------------------------
+bool panel_is_active(void)
+{
+
+  return (active);
+
+} /* panel_is_active */
+
+
+//----------------------------------------------------------------------------
+// NAME: panel_key
+//
+// DESCRIPTION:
+//    This function handles a key press. panel_service() calls it for the
+//    keypad; it can also be fed keys from elsewhere.
+//
+// INPUT:
+//   key - the key value, 0x0 - 0xF
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void panel_key(uint8 key)
+{
+  const PANEL_MENU_t* list = menu[depth];
+  uint8 index;
+  uint8 number;
+
+  message_shown = FALSE;
+  dirty = TRUE;
+
+  switch (key)
+  {
+    case PANEL_KEY_UP:
+      selected[depth] = panel_step(selected[depth], -1);
+      break;
+
+    case PANEL_KEY_DOWN:
+      selected[depth] = panel_step(selected[depth], 1);
+      break;
+
+    case PANEL_KEY_BACK:
+      if (depth > 0)
+      {
+        depth--;
+      } /* if */
+      break;
+
+    case PANEL_KEY_SELECT:
+      panel_select();
+      break;
+
+    default:
+      // The digits count the visible items only
+      if ((key == 0) || (key > 9))
+      {
+        break;
+      } /* if */
+
+      number = 0;
+      for (index = 0; index < list->count; index++)
+      {
+        if (panel_is_visible(list, index) && (++number == key))
+        {
+          selected[depth] = index;
+          panel_select();
+          break;
+        } /* if */
+      } /* for */
+      break;
+  } /* switch */
+
+} /* panel_key */
+
+
+//----------------------------------------------------------------------------
+// NAME: panel_message
+//
+// DESCRIPTION:
+//    This function shows a message on the second line for
+//    PANEL_MESSAGE_MS or until the next key, e.g. the outcome of an
+//    action.
+//
+// INPUT:
+//   text - the message, cut to PANEL_COLUMNS characters
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void panel_message(const char* text)
+{
+  uint8 idx;
+
+  for (idx = 0; (idx < PANEL_COLUMNS) && (text[idx] != '\0'); idx++)
+  {
+    message[idx] = text[idx];
+  } /* for */
+  message[idx] = '\0';
+
+  message_shown = TRUE;
+  message_ms = timebase_ms();
+  dirty = TRUE;
+
+} /* panel_message */
+
+
+//----------------------------------------------------------------------------
+// NAME: panel_invalidate
+//
+// DESCRIPTION:
+//    This function forgets what the LCD shows, so every character is
+//    written again. Call it after writing to the LCD behind the panel's
+//    back.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void panel_invalidate(void)
+{
+  uint8 cell;
+
+  for (cell = 0; cell < PANEL_CELLS; cell++)
+  {
+    screen[cell] = '\0';
+  } /* for */
+
+  lcd_cell = PANEL_NO_CELL;
+  dirty = TRUE;
+
+} /* panel_invalidate */
+
+
+//----------------------------------------------------------------------------
+// NAME: panel_service
+//
+// DESCRIPTION:
+//    This function handles the queued key presses, refreshes the screen
+//    and writes some of the characters that changed. It is meant to be
+//    called from the main loop.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void panel_service(void)
+{
+  KEYPAD_EVENT_t event;
+  uint32 now;
+
+  // An action may stop the panel, e.g. a logout
+  while (active && keypad_get_event(&event))
+  {
+    if (event.type == KEYPAD_PRESS)
+    {
+      session_touch();
+      panel_key(event.key);
+    } /* if */
+  } /* while */
+
+  if (!active)
+  {
+    return;
+  } /* if */
+
+  now = timebase_ms();
+  if (message_shown && ((now - message_ms) >= PANEL_MESSAGE_MS))
+  {
+    message_shown = FALSE;
+    dirty = TRUE;
+  } /* if */
+
+  if (dirty || ((now - composed_ms) >= PANEL_REFRESH_MS))
+  {
+    panel_compose();
+    composed_ms = now;
+    dirty = FALSE;
+  } /* if */
+
+  panel_draw();
+
+} /* panel_service */
+
+
+//-----------------------------------------------------------------------------
+//                             Private functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: panel_is_visible
+//
+// DESCRIPTION:
+//    This function tells if the user level allows a menu item.
+//
+// INPUT:
+//   list  - the menu
+//   index - the item
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if the item is shown
+//----------------------------------------------------------------------------
+static bool panel_is_visible(const PANEL_MENU_t* list, uint8 index)
+{
+
+  return ((bool)(list->items[index].level <= user_level));
+
+} /* panel_is_visible */
+
+
+//----------------------------------------------------------------------------
+// NAME: panel_step
+//
+// DESCRIPTION:
+//    This function finds the next or previous visible item of the
+//    current menu, wrapping around at the ends.
+//
+// INPUT:
+//   index - the item to start from
+//   step  - 1 for the next item, -1 for the previous one
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the item, or index if no other item is visible
+//----------------------------------------------------------------------------
+static uint8 panel_step(uint8 index, sint8 step)
+{
+  const PANEL_MENU_t* list = menu[depth];
+  uint8 next = index;
+  uint8 tries;
+
+  for (tries = 0; tries < list->count; tries++)
+  {
+    next = (uint8)((next + list->count + step) % list->count);
+    if (panel_is_visible(list, next))
+    {
+      return (next);
+    } /* if */
+  } /* for */
+
+  return (index);
+
+} /* panel_step */
+
+
+//----------------------------------------------------------------------------
+// NAME: panel_select
+//
+// DESCRIPTION:
+//    This function opens the submenu of the selected item or runs its
+//    action.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void panel_select(void)
+{
+  const PANEL_ITEM_t* item = &menu[depth]->items[selected[depth]];
+
+  if (!panel_is_visible(menu[depth], selected[depth]))
+  {
+    return;
+  } /* if */
+
+  if ((item->submenu != NULL) && (depth < PANEL_DEPTH - 1))
+  {
+    depth++;
+    menu[depth] = item->submenu;
+    selected[depth] = panel_step(item->submenu->count - 1, 1);
+  } /* if */
+  else if (item->action != NULL)
+  {
+    item->action();
+  } /* else if */
+
+} /* panel_select */
+
+
+//----------------------------------------------------------------------------
+// NAME: panel_compose
+//
+// DESCRIPTION:
+//    This function builds the frame for the selected item.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void panel_compose(void)
+{
+  const PANEL_MENU_t* list = menu[depth];
+  const PANEL_ITEM_t* item = &list->items[selected[depth]];
+  char   text[PANEL_COLUMNS + 1];
+  uint8  number = 0;
+  uint8  index;
+  uint8  cell;
+
+  for (cell = 0; cell < PANEL_CELLS; cell++)
+  {
+    frame[cell] = ' ';
+  } /* for */
+
+  if (!panel_is_visible(list, selected[depth]))
+  {
+    return;
+  } /* if */
+
+  // Line 1: "3 Alertness    >"
+  for (index = 0; index <= selected[depth]; index++)
+  {
+    if (panel_is_visible(list, index))
+    {
+      number++;
+    } /* if */
+  } /* for */
+  if (number <= 9)
+  {
+    frame[0] = (char)('0' + number);
+  } /* if */
+  panel_put(2, item->label);
+  if (item->submenu != NULL)
+  {
+    frame[PANEL_COLUMNS - 1] = '>';
+  } /* if */
+
+  // Line 2
+  if (message_shown)
+  {
+    panel_put(PANEL_COLUMNS, message);
+  } /* if */
+  else if (item->readout != NULL)
+  {
+    text[0] = '\0';
+    item->readout(text);
+    text[PANEL_COLUMNS] = '\0';
+    panel_put(PANEL_COLUMNS, text);
+  } /* else if */
+  else if (item->submenu != NULL)
+  {
+    panel_put(PANEL_COLUMNS, "# open  * back");
+  } /* else if */
+  else if (item->action != NULL)
+  {
+    panel_put(PANEL_COLUMNS, "# run   * back");
+  } /* else if */
+
+} /* panel_compose */
+
+
+//----------------------------------------------------------------------------
+// NAME: panel_put
+//
+// DESCRIPTION:
+//    This function copies text into the frame, stopping at the end of the
+//    line.
+//
+// INPUT:
+//   cell - where the text starts
+//   text - the text
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void panel_put(uint8 cell, const char* text)
+{
+  uint8 end = (uint8)((cell / PANEL_COLUMNS + 1) * PANEL_COLUMNS);
+
+  while ((cell < end) && (*text != '\0'))
+  {
+    frame[cell++] = *text++;
+  } /* while */
+
+} /* panel_put */
+
+
+//----------------------------------------------------------------------------
+// NAME: panel_draw
+//
+// DESCRIPTION:
+//    This function writes up to PANEL_CELLS_PER_SERVICE characters that
+//    differ between the frame and the LCD. The LCD moves on by itself
+//    after each character, so the address is only set after a gap.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void panel_draw(void)
+{
+  uint8 cell;
+  uint8 writes = 0;
+
+  for (cell = 0; (cell < PANEL_CELLS) && (writes < PANEL_CELLS_PER_SERVICE); cell++)
+  {
+    if (frame[cell] == screen[cell])
+    {
+      continue;
+    } /* if */
+
+    if (cell != lcd_cell)
+    {
+      set_lcd_addr((char)((cell < PANEL_COLUMNS) ? cell : LCD_LINE_2_ADDR + cell - PANEL_COLUMNS));
+    } /* if */
+    data8(frame[cell]);
+    screen[cell] = frame[cell];
+    writes++;
+
+    // The second line doesn't follow on from the first in the LCD
+    lcd_cell = (cell == PANEL_COLUMNS - 1) ? PANEL_NO_CELL : cell + 1;
+  } /* for */
+
+} /* panel_draw */
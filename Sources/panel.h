@@ -0,0 +1,85 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: panel.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for the control panel: menus on
+//    the 2x16 LCD driven from the keypad, so the system can be run
+//    without the PC terminal.
+//
+//*****************************************************************************
+
+#ifndef _PANEL_H_
+#define _PANEL_H_
+
+#include "sys_types.h"
+#include "keypad.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define PANEL_COLUMNS           16
+#define PANEL_ROWS              2
+#define PANEL_DEPTH             4       // menu levels, the top one included
+
+// Live readouts are refreshed this often and messages stay up this long
+#define PANEL_REFRESH_MS        500
+#define PANEL_MESSAGE_MS        2000
+
+// Changed characters written to the LCD per panel_service() call, ~50 us
+// each, so a full redraw is spread over a few calls
+#define PANEL_CELLS_PER_SERVICE 8
+
+// Keys; 1-9 open or run the item with that number straight away
+#define PANEL_KEY_UP            KEYPAD_KEY_A
+#define PANEL_KEY_DOWN          KEYPAD_KEY_B
+#define PANEL_KEY_BACK          KEYPAD_KEY_STAR
+#define PANEL_KEY_SELECT        KEYPAD_KEY_HASH
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+// Actions run from panel_service() and must not wait on the user
+typedef void (*PANEL_ACTION_t)(void);
+
+// Fills in the second line, up to PANEL_COLUMNS characters
+typedef void (*PANEL_READOUT_t)(char text[PANEL_COLUMNS + 1]);
+
+struct PANEL_ITEM_s;
+
+typedef struct
+{
+  const struct PANEL_ITEM_s* items;
+  uint8 count;
+} PANEL_MENU_t;
+
+typedef struct PANEL_ITEM_s
+{
+  const char*         label;    // first line, after the item number
+  uint8               level;    // lowest user level that sees the item
+  const PANEL_MENU_t* submenu;  // opened by SELECT, or NULL
+  PANEL_ACTION_t      action;   // run by SELECT, or NULL
+  PANEL_READOUT_t     readout;  // second line, or NULL
+} PANEL_ITEM_t;
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+void panel_init(const PANEL_MENU_t* root);
+void panel_start(uint8 level);
+void panel_stop(void);
+bool panel_is_active(void);
+void panel_key(uint8 key);
+void panel_message(const char* text);
+void panel_invalidate(void);
+void panel_service(void);
+
+#endif /* _PANEL_H_ */
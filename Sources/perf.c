@@ -0,0 +1,337 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: perf.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file keeps the statistics for the profiling probes in perf.h.
+//
+//    The probe macros only store and subtract TCNT and the probe tick
+//    count; perf_record() does the rest. The bucket for a time under a
+//    TCNT wrap is found from its top set bit with two tests and a 16
+//    entry table rather than a loop, so a probe pair costs about the same
+//    whatever it measures. perf_init() times empty probe pairs so the
+//    cost can be taken off by eye when reading short times.
+//
+//    The timer counts in 16 bus cycle steps, so a time is only good to a
+//    count, and an ISR's time leaves out the interrupt entry itself. The
+//    ISRs record into the same table as the main loop, so the table is
+//    read and cleared in critical sections.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include <mc9s12dg256.h>            // derivative information
+#include "perf.h"
+#include "critical.h"
+
+#if PERF_ENABLED
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// Up to this many ticks apart, TCNT can't have wrapped past the start
+// (41 ticks is 62976 counts), so its difference is the exact time
+#define PERF_EXACT_TICKS        40
+
+// Empty probe pairs timed by perf_init()
+#define PERF_CALIBRATE_PAIRS    PERF_CYCLES_PER_COUNT
+
+
+//-----------------------------------------------------------------------------
+//                        Define public variables
+//-----------------------------------------------------------------------------
+volatile uint16 perf_ticks;
+uint16 perf_start_counts[PERF_PROBES];
+uint16 perf_start_ticks[PERF_PROBES];
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+static PERF_PROBE_t perf_probes[PERF_PROBES];
+static uint16       perf_pair_cycles;
+
+// Top set bit of 0 - 15
+static const uint8 perf_top_bit[16] =
+{
+  0, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3
+};
+
+// Padded to one width for the perf command's table
+static const char* const perf_names[PERF_PROBES] =
+{
+  "rti isr        ",
+  "echo isr       ",
+  "switch isr     ",
+  "speaker isr    ",
+  "scanEnvironment",
+  "rc522_exchange ",
+  "readers_service",
+  "background     "
+};
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+static void perf_clear_probe(PERF_PROBE_t* stats);
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: perf_init
+//
+// DESCRIPTION:
+//    This function measures what an empty probe pair costs, then clears
+//    every probe. The timer must be running and interrupts still masked,
+//    so nothing stretches the measurement.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void perf_init(void)
+{
+  uint16 start;
+  uint8  pair;
+
+  // PERF_CALIBRATE_PAIRS pairs of 16 cycle counts: the difference is
+  // the cycles for one pair, loop included
+  start = TCNT;
+  for (pair = 0; pair < PERF_CALIBRATE_PAIRS; pair++)
+  {
+    PERF_ENTER(PERF_RTI_ISR);
+    PERF_EXIT(PERF_RTI_ISR);
+  } /* for */
+  perf_pair_cycles = TCNT - start;
+
+  perf_clear();
+
+} /* perf_init */
+
+
+//----------------------------------------------------------------------------
+// NAME: perf_record
+//
+// DESCRIPTION:
+//    This function adds a time to a probe. PERF_EXIT() calls it.
+//
+// INPUT:
+//   probe  - PERF_RTI_ISR ... PERF_BACKGROUND
+//   counts - TCNT now less TCNT at PERF_ENTER()
+//   ticks  - probe ticks since PERF_ENTER()
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void perf_record(uint8 probe, uint16 counts, uint16 ticks)
+{
+  PERF_PROBE_t* stats = &perf_probes[probe];
+  uint32 time;
+  uint8  bucket;
+
+  if (ticks <= PERF_EXACT_TICKS)
+  {
+    time = counts;
+    bucket = 0;
+    if (counts & 0xFF00)
+    {
+      bucket = 8;
+      counts >>= 8;
+    } /* if */
+    if (counts & 0x00F0)
+    {
+      bucket += 4;
+      counts >>= 4;
+    } /* if */
+    bucket += perf_top_bit[counts];
+  }
+  else
+  {
+    time = (uint32)ticks * PERF_COUNTS_PER_TICK;
+    bucket = 15;
+    while ((bucket < PERF_BUCKETS - 1) && ((time >> (bucket + 1)) != 0))
+    {
+      bucket++;
+    } /* while */
+  } /* if */
+
+  stats->count++;
+  stats->total += time;
+  if (time < stats->min)
+  {
+    stats->min = time;
+  } /* if */
+  if (time > stats->max)
+  {
+    stats->max = time;
+  } /* if */
+  if (stats->buckets[bucket] != 0xFFFF)
+  {
+    stats->buckets[bucket]++;
+  } /* if */
+
+} /* perf_record */
+
+
+//----------------------------------------------------------------------------
+// NAME: perf_get
+//
+// DESCRIPTION:
+//    This function copies a probe's statistics. An ISR can't update them
+//    halfway through the copy.
+//
+// INPUT:
+//   probe - PERF_RTI_ISR ... PERF_BACKGROUND
+//
+// OUTPUT:
+//   stats - the probe's statistics; min is 0xFFFFFFFF if count is 0
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void perf_get(uint8 probe, PERF_PROBE_t* stats)
+{
+  CRITICAL_t saved;
+
+  saved = critical_enter();
+  *stats = perf_probes[probe];
+  critical_exit(saved);
+
+} /* perf_get */
+
+
+//----------------------------------------------------------------------------
+// NAME: perf_clear
+//
+// DESCRIPTION:
+//    This function starts every probe's statistics over.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void perf_clear(void)
+{
+  uint8 probe;
+  CRITICAL_t saved;
+
+  for (probe = 0; probe < PERF_PROBES; probe++)
+  {
+    saved = critical_enter();
+    perf_clear_probe(&perf_probes[probe]);
+    critical_exit(saved);
+  } /* for */
+
+} /* perf_clear */
+
+
+//----------------------------------------------------------------------------
+// NAME: perf_name
+//
+// DESCRIPTION:
+//    This function gives a probe's name for printing.
+//
+// INPUT:
+//   probe - PERF_RTI_ISR ... PERF_BACKGROUND
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the name
+//----------------------------------------------------------------------------
+const char* perf_name(uint8 probe)
+{
+
+  return (perf_names[probe]);
+
+} /* perf_name */
+
+
+//----------------------------------------------------------------------------
+// NAME: perf_overhead
+//
+// DESCRIPTION:
+//    This function gives what an empty probe pair costs, as measured by
+//    perf_init().
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   bus cycles, to within PERF_CYCLES_PER_COUNT / PERF_CALIBRATE_PAIRS
+//----------------------------------------------------------------------------
+uint16 perf_overhead(void)
+{
+
+  return (perf_pair_cycles);
+
+} /* perf_overhead */
+
+
+//-----------------------------------------------------------------------------
+//                               Private functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: perf_clear_probe
+//
+// DESCRIPTION:
+//    This function empties one probe's statistics.
+//
+// INPUT:
+//   stats - the probe
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void perf_clear_probe(PERF_PROBE_t* stats)
+{
+  uint8 bucket;
+
+  stats->count = 0;
+  stats->total = 0;
+  stats->min = 0xFFFFFFFFUL;
+  stats->max = 0;
+  for (bucket = 0; bucket < PERF_BUCKETS; bucket++)
+  {
+    stats->buckets[bucket] = 0;
+  } /* for */
+
+} /* perf_clear_probe */
+
+#endif /* PERF_ENABLED */
@@ -0,0 +1,111 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: perf.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for the profiling probes. A piece
+//    of code is timed by putting PERF_ENTER() and PERF_EXIT() around it
+//    with one of the probe numbers below. Each probe keeps a count, the
+//    shortest, longest and total time and a histogram with a bucket per
+//    power of two. The times are in timer counts of 16 bus cycles.
+//
+//    With PERF_ENABLED set to 0 the probes compile to nothing.
+//
+//*****************************************************************************
+
+#ifndef _PERF_H_
+#define _PERF_H_
+
+#include "sys_types.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#ifndef PERF_ENABLED
+#define PERF_ENABLED            1
+#endif
+
+// Probe numbers; each probe must only be entered from one place, and not
+// again before it exits
+#define PERF_RTI_ISR            0       // tick_handler()
+#define PERF_ECHO_ISR           1       // echo_handler(), the ultrasonic sensor
+#define PERF_SWITCH_ISR         2       // switch_handler()
+#define PERF_SPEAKER_ISR        3       // the speaker's output compare
+#define PERF_SCAN_ENVIRONMENT   4       // scanEnvironment(), console output and all
+#define PERF_RC522_EXCHANGE     5       // rc522_exchange(), under rc522_to_card()
+#define PERF_READERS_SERVICE    6       // readers_service()
+#define PERF_BACKGROUND         7       // background_service()
+#define PERF_PROBES             8
+
+// Timer counts; bus clock / TIMEBASE_PRESCALER
+#define PERF_CYCLES_PER_COUNT   16
+#define PERF_COUNTS_PER_TICK    1536    // 1.024 ms real-time interrupt
+
+// Bucket n counts times of 2^n to 2^(n+1) - 1 timer counts: bucket 0 is
+// under 1.3 us, bucket 1 under 2.7 us and so on; the last one takes
+// anything from 350 ms up
+#define PERF_BUCKETS            20
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  uint32 count;
+  uint32 total;                 // timer counts, for the average
+  uint32 min;
+  uint32 max;
+  uint16 buckets[PERF_BUCKETS]; // stop at 65535
+} PERF_PROBE_t;
+
+//-----------------------------------------------------------------------------
+//                        Define probe macros
+//-----------------------------------------------------------------------------
+
+#if PERF_ENABLED
+
+#include <mc9s12dg256.h>            // TCNT
+
+extern volatile uint16 perf_ticks;
+extern uint16 perf_start_counts[PERF_PROBES];
+extern uint16 perf_start_ticks[PERF_PROBES];
+
+// A probe reads TCNT at both ends. TCNT wraps every 43.7 ms, so the
+// real-time interrupt also counts ticks for the probes; a longer time is
+// measured to the tick.
+#define PERF_ENTER(probe)   (perf_start_ticks[probe] = perf_ticks, \
+                             perf_start_counts[probe] = TCNT)
+#define PERF_EXIT(probe)    perf_record((probe), (uint16)(TCNT - perf_start_counts[probe]), \
+                                        (uint16)(perf_ticks - perf_start_ticks[probe]))
+#define PERF_TICK()         (perf_ticks++)
+
+#else
+
+#define PERF_ENTER(probe)   ((void)0)
+#define PERF_EXIT(probe)    ((void)0)
+#define PERF_TICK()         ((void)0)
+#define perf_init()         ((void)0)
+
+#endif /* PERF_ENABLED */
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+#if PERF_ENABLED
+void perf_init(void);
+void perf_record(uint8 probe, uint16 counts, uint16 ticks);
+void perf_get(uint8 probe, PERF_PROBE_t* stats);
+void perf_clear(void);
+const char* perf_name(uint8 probe);
+uint16 perf_overhead(void);
+#endif /* PERF_ENABLED */
+
+#endif /* _PERF_H_ */
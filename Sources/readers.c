@@ -0,0 +1,932 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: readers.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file polls the RC522 readers. Each reader runs a small state
+//    machine that steps through the ISO 14443-3 wake up of a card:
+//
+//      IDLE -> REQA -> ANTICOLL -> SELECT -> CLAIMED
+//
+//    A step starts a command with rc522_command_start() and the next call
+//    picks up the answer with rc522_command_poll(), so readers_service()
+//    never waits for a card. The readers are visited in turn and the first
+//    one visited moves along by one on every call, so no door is always
+//    served last.
+//
+//    A selected card is queued as a tap and its reader stays CLAIMED,
+//    leaving the card alone for the application, until readers_release()
+//    halts the card. A halted card doesn't answer REQA, so it is reported
+//    once each time it is brought to a reader.
+//
+//    Between polls an IDLE reader is checked with rc522_check() every
+//    READERS_CHECK_MS, or sooner after a run of card errors. A failed
+//    check or a stuck command starts a recovery that escalates each time
+//    it is needed again before a check passes:
+//
+//      soft reset -> SPI and RC522 re-init -> OFFLINE, retried
+//
+//    Every action is queued for readers_get_fault() and the driver's
+//    counters (RC522_STATS_t) are kept across recoveries.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include "readers.h"
+#include "mifare.h"
+#include "timebase.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// Reader states
+#define READER_IDLE             0
+#define READER_REQA             1
+#define READER_ANTICOLL         2
+#define READER_SELECT           3
+#define READER_CLAIMED          4
+#define READER_OFFLINE          5
+
+// Recovery levels
+#define LEVEL_SOFT_RESET        0
+#define LEVEL_REINIT            1
+#define LEVEL_OFFLINE           2
+
+// Answer sizes in bits
+#define ATQA_BITS               0x10
+#define SAK_BITS                0x18
+
+#define SHORT_FRAME_BITS        0x07    // BitFramingReg: REQA is 7 bits
+#define NVB_ANTICOLL            0x20    // no UID bits known yet
+#define NVB_SELECT              0x70    // all 40 UID bits follow
+
+#define FRAME_SIZE              9       // SELECT: cmd, NVB, UID, BCC, CRC
+
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  RC522_READER_t rc522;
+  bool   fitted;                        // port is in READERS_PORTS
+  uint8  state;
+  uint32 state_ms;                      // when the state was entered
+  uint32 check_ms;                      // when rc522_check() last ran
+  uint8  level;                         // next recovery, LEVEL_xx
+  uint8  errors_in_row;
+  uint8  uid[MIFARE_UID_SIZE];
+  uint8  frame[FRAME_SIZE];             // command sent, then the answer
+} READER_SLOT_t;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+static READER_SLOT_t slots[READERS_MAX];
+static uint8 first_slot;                // visited first on the next call
+
+static READER_TAP_t tap_queue[READERS_QUEUE_SIZE];
+static uint8 tap_head;
+static uint8 tap_tail;
+
+static READER_FAULT_t fault_queue[READERS_FAULT_QUEUE_SIZE];
+static uint8 fault_head;
+static uint8 fault_tail;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+static void readers_step(READER_SLOT_t* slot, uint32 now);
+static void readers_answer(READER_SLOT_t* slot, sint8 status, uint16 bits, uint32 now);
+static void readers_enter(READER_SLOT_t* slot, uint8 state, uint32 now);
+static bool readers_queue_tap(READER_SLOT_t* slot, uint32 now);
+static void readers_supervise(READER_SLOT_t* slot, uint32 now);
+static void readers_recover(READER_SLOT_t* slot, uint8 cause, uint32 now);
+static bool readers_start(READER_SLOT_t* slot);
+static void readers_queue_fault(READER_SLOT_t* slot, uint8 action, uint8 cause, uint32 now);
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: readers_init
+//
+// DESCRIPTION:
+//    This function sets up a reader on every port in READERS_PORTS and
+//    empties the tap queue. It takes ~200 ms per reader. A reader that
+//    doesn't answer is left to the supervisor to retry.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the number of readers that answered
+//----------------------------------------------------------------------------
+uint8 readers_init(void)
+{
+  uint8  port;
+  uint32 now = timebase_ms();
+  READER_SLOT_t* slot;
+
+  tap_head = 0;
+  tap_tail = 0;
+  fault_head = 0;
+  fault_tail = 0;
+  first_slot = 0;
+
+  for (port = 0; port < READERS_MAX; port++)
+  {
+    slot = &slots[port];
+    slot->fitted = ((READERS_PORTS & (1 << port)) != 0);
+    slot->level = LEVEL_SOFT_RESET;
+    slot->errors_in_row = 0;
+    slot->check_ms = now;
+
+    if (!slot->fitted)
+    {
+      readers_enter(slot, READER_OFFLINE, now);
+    } /* if */
+    else if (readers_start(slot))
+    {
+      // Poll straight away
+      readers_enter(slot, READER_IDLE, now - READERS_POLL_MS);
+    } /* else if */
+    else
+    {
+      slot->level = LEVEL_OFFLINE;
+      readers_enter(slot, READER_OFFLINE, now);
+      readers_queue_fault(slot, READERS_OFFLINE, READERS_CAUSE_INIT, now);
+    } /* else */
+  } /* for */
+
+  return (readers_present_count());
+
+} /* readers_init */
+
+
+//----------------------------------------------------------------------------
+// NAME: readers_service
+//
+// DESCRIPTION:
+//    This function moves every reader on by at most one step. It is meant
+//    to be called from the main loop as often as possible.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void readers_service(void)
+{
+  uint32 now = timebase_ms();
+  uint8  idx = first_slot;
+  uint8  visited;
+
+  for (visited = 0; visited < READERS_MAX; visited++)
+  {
+    if (slots[idx].fitted)
+    {
+      readers_step(&slots[idx], now);
+    } /* if */
+
+    idx = (idx + 1) % READERS_MAX;
+  } /* for */
+
+  first_slot = (first_slot + 1) % READERS_MAX;
+
+} /* readers_service */
+
+
+//----------------------------------------------------------------------------
+// NAME: readers_get_event
+//
+// DESCRIPTION:
+//    This function removes the oldest tap from the queue. The card is
+//    still selected; call readers_release() once done with it.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   tap - the oldest tap, if there is one
+//
+// RETURN:
+//   TRUE if a tap was returned, FALSE if the queue was empty
+//----------------------------------------------------------------------------
+bool readers_get_event(READER_TAP_t* tap)
+{
+
+  if (tap_tail == tap_head)
+  {
+    return (FALSE);
+  } /* if */
+
+  *tap = tap_queue[tap_tail];
+  tap_tail = (tap_tail + 1) & (READERS_QUEUE_SIZE - 1);
+
+  return (TRUE);
+
+} /* readers_get_event */
+
+
+//----------------------------------------------------------------------------
+// NAME: readers_release
+//
+// DESCRIPTION:
+//    This function ends any card session on a claimed reader, halts the
+//    card and lets the reader look for the next one.
+//
+// INPUT:
+//   reader - the reader from the tap
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void readers_release(RC522_READER_t* reader)
+{
+  uint8 idx;
+
+  for (idx = 0; idx < READERS_MAX; idx++)
+  {
+    if ((&slots[idx].rc522 == reader) && (slots[idx].state == READER_CLAIMED))
+    {
+      // mifare_end() only halts the card if a session was started
+      if (!reader->card)
+      {
+        rc522_send_halt(reader);
+      } /* if */
+
+      mifare_end(reader);
+      readers_enter(&slots[idx], READER_IDLE, timebase_ms());
+    } /* if */
+  } /* for */
+
+} /* readers_release */
+
+
+//----------------------------------------------------------------------------
+// NAME: readers_flush
+//
+// DESCRIPTION:
+//    This function throws away any queued taps and releases their cards,
+//    e.g. cards presented before a prompt was shown.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void readers_flush(void)
+{
+  uint8 idx;
+
+  tap_tail = tap_head;
+
+  for (idx = 0; idx < READERS_MAX; idx++)
+  {
+    readers_release(&slots[idx].rc522);
+  } /* for */
+
+} /* readers_flush */
+
+
+//----------------------------------------------------------------------------
+// NAME: readers_present_count
+//
+// DESCRIPTION:
+//    This function returns how many readers are working.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the number of readers online
+//----------------------------------------------------------------------------
+uint8 readers_present_count(void)
+{
+  uint8 idx;
+  uint8 count = 0;
+
+  for (idx = 0; idx < READERS_MAX; idx++)
+  {
+    if (readers_is_online(idx))
+    {
+      count++;
+    } /* if */
+  } /* for */
+
+  return (count);
+
+} /* readers_present_count */
+
+
+//----------------------------------------------------------------------------
+// NAME: readers_is_fitted
+//
+// DESCRIPTION:
+//    This function tells if a door has a reader wired up (READERS_PORTS).
+//
+// INPUT:
+//   door - 0 - READERS_MAX-1
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if the door has a reader
+//----------------------------------------------------------------------------
+bool readers_is_fitted(uint8 door)
+{
+
+  return ((door < READERS_MAX) && slots[door].fitted);
+
+} /* readers_is_fitted */
+
+
+//----------------------------------------------------------------------------
+// NAME: readers_is_online
+//
+// DESCRIPTION:
+//    This function tells if a door's reader is working.
+//
+// INPUT:
+//   door - 0 - READERS_MAX-1
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if the reader is fitted and not offline
+//----------------------------------------------------------------------------
+bool readers_is_online(uint8 door)
+{
+
+  return (readers_is_fitted(door) && (slots[door].state != READER_OFFLINE));
+
+} /* readers_is_online */
+
+
+//----------------------------------------------------------------------------
+// NAME: readers_get_fault
+//
+// DESCRIPTION:
+//    This function removes the oldest supervisor action from the queue.
+//    Actions are dropped while the queue is full.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   fault - the oldest action, if there is one
+//
+// RETURN:
+//   TRUE if an action was returned, FALSE if the queue was empty
+//----------------------------------------------------------------------------
+bool readers_get_fault(READER_FAULT_t* fault)
+{
+
+  if (fault_tail == fault_head)
+  {
+    return (FALSE);
+  } /* if */
+
+  *fault = fault_queue[fault_tail];
+  fault_tail = (fault_tail + 1) & (READERS_FAULT_QUEUE_SIZE - 1);
+
+  return (TRUE);
+
+} /* readers_get_fault */
+
+
+//----------------------------------------------------------------------------
+// NAME: readers_get
+//
+// DESCRIPTION:
+//    This function gives read access to a door's reader, e.g. for its
+//    version and link statistics.
+//
+// INPUT:
+//   door - 0 - READERS_MAX-1
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the reader
+//----------------------------------------------------------------------------
+const RC522_READER_t* readers_get(uint8 door)
+{
+
+  return (&slots[door % READERS_MAX].rc522);
+
+} /* readers_get */
+
+
+//----------------------------------------------------------------------------
+// NAME: readers_clear_stats
+//
+// DESCRIPTION:
+//    This function zeroes the link statistics of every reader.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void readers_clear_stats(void)
+{
+  uint8  idx;
+  uint8  byte;
+  uint8* stats;
+
+  for (idx = 0; idx < READERS_MAX; idx++)
+  {
+    stats = (uint8*)&slots[idx].rc522.stats;
+    for (byte = 0; byte < sizeof(RC522_STATS_t); byte++)
+    {
+      stats[byte] = 0;
+    } /* for */
+  } /* for */
+
+} /* readers_clear_stats */
+
+
+//-----------------------------------------------------------------------------
+//                             Private functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: readers_step
+//
+// DESCRIPTION:
+//    This function checks or starts the next REQA of an idle reader,
+//    checks on the command a busy reader is running, or retries an
+//    offline reader.
+//
+// INPUT:
+//   slot - the reader
+//   now  - the current time in ms
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void readers_step(READER_SLOT_t* slot, uint32 now)
+{
+  sint8  status;
+  uint16 bits = 0;
+
+  switch (slot->state)
+  {
+    case READER_IDLE:
+    {
+      if ((slot->errors_in_row >= READERS_ERROR_LIMIT) ||
+          (now - slot->check_ms >= READERS_CHECK_MS))
+      {
+        readers_supervise(slot, now);
+      } /* if */
+      else if (now - slot->state_ms >= READERS_POLL_MS)
+      {
+        rc522_write_reg(&slot->rc522, BIT_FRAMING_REG, SHORT_FRAME_BITS);
+        rc522_set_timeout(&slot->rc522, RC522_TIMEOUT_REQA);
+        slot->frame[0] = PICC_REQIDL;
+        rc522_command_start(&slot->rc522, RC522_TRANSCEIVE_CMD, slot->frame, 1);
+        readers_enter(slot, READER_REQA, now);
+      } /* if */
+      break;
+    } /* case */
+
+    case READER_CLAIMED:
+    {
+      break;
+    } /* case */
+
+    case READER_OFFLINE:
+    {
+      if (now - slot->state_ms < READERS_RETRY_MS)
+      {
+        break;
+      } /* if */
+
+      rc522_count(&slot->rc522.stats.reinits);
+      if (readers_start(slot))
+      {
+        slot->level = LEVEL_REINIT;
+        slot->check_ms = now;
+        readers_enter(slot, READER_IDLE, now);
+        readers_queue_fault(slot, READERS_RECOVERED, READERS_CAUSE_RETRY, now);
+      } /* if */
+      else
+      {
+        readers_enter(slot, READER_OFFLINE, now);
+      } /* else */
+      break;
+    } /* case */
+
+    default:
+    {
+      status = rc522_command_poll(&slot->rc522, slot->frame, sizeof(slot->frame), &bits);
+
+      if (status != MI_BUSY)
+      {
+        readers_answer(slot, status, bits, now);
+      } /* if */
+      else if (now - slot->state_ms >= READERS_COMMAND_MS)
+      {
+        rc522_command_abort(&slot->rc522);
+        readers_recover(slot, READERS_CAUSE_STUCK, now);
+      } /* else if */
+      break;
+    } /* default */
+
+  } /* switch */
+
+} /* readers_step */
+
+
+//----------------------------------------------------------------------------
+// NAME: readers_answer
+//
+// DESCRIPTION:
+//    This function handles the end of a REQA, ANTICOLL or SELECT command
+//    and starts the next one. Anything unexpected sends the reader back
+//    to IDLE.
+//
+// INPUT:
+//   slot   - the reader
+//   status - the result from rc522_command_poll()
+//   bits   - the number of bits the card sent
+//   now    - the current time in ms
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void readers_answer(READER_SLOT_t* slot, sint8 status, uint16 bits, uint32 now)
+{
+  uint8 idx;
+  uint8 check = 0;
+
+  if (status != MI_OK)
+  {
+    // No answer is just no card; errors in a row bring a check forward
+    if ((status == MI_ERR) && (slot->errors_in_row < READERS_ERROR_LIMIT))
+    {
+      slot->errors_in_row++;
+    } /* if */
+
+    readers_enter(slot, READER_IDLE, now);
+    return;
+  } /* if */
+
+  switch (slot->state)
+  {
+    case READER_REQA:
+    {
+      if (bits != ATQA_BITS)
+      {
+        readers_enter(slot, READER_IDLE, now);
+        break;
+      } /* if */
+
+      rc522_write_reg(&slot->rc522, BIT_FRAMING_REG, 0x00);
+      rc522_set_timeout(&slot->rc522, RC522_TIMEOUT_ANTICOLL);
+      slot->frame[0] = PICC_ANTICOLL;
+      slot->frame[1] = NVB_ANTICOLL;
+      rc522_command_start(&slot->rc522, RC522_TRANSCEIVE_CMD, slot->frame, 2);
+      readers_enter(slot, READER_ANTICOLL, now);
+      break;
+    } /* case */
+
+    case READER_ANTICOLL:
+    {
+      // UID followed by its check byte
+      for (idx = 0; idx < MIFARE_UID_SIZE; idx++)
+      {
+        slot->uid[idx] = slot->frame[idx];
+        check ^= slot->frame[idx];
+      } /* for */
+
+      if (check != slot->frame[MIFARE_UID_SIZE])
+      {
+        rc522_count(&slot->rc522.stats.bcc_errors);
+        slot->errors_in_row++;
+        readers_enter(slot, READER_IDLE, now);
+        break;
+      } /* if */
+
+      slot->frame[6] = check;
+      for (idx = 0; idx < MIFARE_UID_SIZE; idx++)
+      {
+        slot->frame[2 + idx] = slot->uid[idx];
+      } /* for */
+      slot->frame[0] = PICC_SElECTTAG;
+      slot->frame[1] = NVB_SELECT;
+      rc522_crc_a(slot->frame, 7, &slot->frame[7]);
+      rc522_set_timeout(&slot->rc522, RC522_TIMEOUT_SELECT);
+
+      rc522_command_start(&slot->rc522, RC522_TRANSCEIVE_CMD, slot->frame, FRAME_SIZE);
+      readers_enter(slot, READER_SELECT, now);
+      break;
+    } /* case */
+
+    case READER_SELECT:
+    {
+      if (bits != SAK_BITS)
+      {
+        readers_enter(slot, READER_IDLE, now);
+        break;
+      } /* if */
+
+      slot->errors_in_row = 0;
+
+      if (readers_queue_tap(slot, now))
+      {
+        readers_enter(slot, READER_CLAIMED, now);
+      } /* if */
+      else
+      {
+        rc522_send_halt(&slot->rc522);
+        readers_enter(slot, READER_IDLE, now);
+      } /* else */
+      break;
+    } /* case */
+
+    default:
+    {
+      readers_enter(slot, READER_IDLE, now);
+      break;
+    } /* default */
+
+  } /* switch */
+
+} /* readers_answer */
+
+
+//----------------------------------------------------------------------------
+// NAME: readers_enter
+//
+// DESCRIPTION:
+//    This function moves a reader to a new state.
+//
+// INPUT:
+//   slot  - the reader
+//   state - the new state
+//   now   - the time the state is entered
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void readers_enter(READER_SLOT_t* slot, uint8 state, uint32 now)
+{
+
+  slot->state = state;
+  slot->state_ms = now;
+
+} /* readers_enter */
+
+
+//----------------------------------------------------------------------------
+// NAME: readers_queue_tap
+//
+// DESCRIPTION:
+//    This function queues a tap for the card just selected on a reader.
+//
+// INPUT:
+//   slot - the reader
+//   now  - the current time in ms
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if the tap was queued, FALSE if the queue was full
+//----------------------------------------------------------------------------
+static bool readers_queue_tap(READER_SLOT_t* slot, uint32 now)
+{
+  uint8 next = (tap_head + 1) & (READERS_QUEUE_SIZE - 1);
+  uint8 idx;
+  READER_TAP_t* tap;
+
+  if (next == tap_tail)
+  {
+    return (FALSE);
+  } /* if */
+
+  tap = &tap_queue[tap_head];
+  tap->reader = &slot->rc522;
+  tap->door = slot->rc522.port;
+  tap->sak = slot->frame[0];
+  tap->timestamp = now;
+  for (idx = 0; idx < MIFARE_UID_SIZE; idx++)
+  {
+    tap->uid[idx] = slot->uid[idx];
+  } /* for */
+
+  tap_head = next;
+
+  return (TRUE);
+
+} /* readers_queue_tap */
+
+
+//----------------------------------------------------------------------------
+// NAME: readers_supervise
+//
+// DESCRIPTION:
+//    This function checks an idle reader and starts a recovery if the
+//    check fails. A check that passes clears the recovery level.
+//
+// INPUT:
+//   slot - the reader
+//   now  - the current time in ms
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void readers_supervise(READER_SLOT_t* slot, uint32 now)
+{
+
+  slot->check_ms = now;
+  slot->errors_in_row = 0;
+
+  if (rc522_check(&slot->rc522))
+  {
+    slot->level = LEVEL_SOFT_RESET;
+  } /* if */
+  else
+  {
+    readers_recover(slot, READERS_CAUSE_CHECK, now);
+  } /* else */
+
+} /* readers_supervise */
+
+
+//----------------------------------------------------------------------------
+// NAME: readers_recover
+//
+// DESCRIPTION:
+//    This function takes the next recovery step for a failed reader. The
+//    reader is checked again straight away, so a step that didn't help
+//    is followed by the next one.
+//
+// INPUT:
+//   slot  - the reader
+//   cause - READERS_CAUSE_xx
+//   now   - the current time in ms
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void readers_recover(READER_SLOT_t* slot, uint8 cause, uint32 now)
+{
+
+  switch (slot->level)
+  {
+    case LEVEL_SOFT_RESET:
+    {
+      rc522_count(&slot->rc522.stats.resets);
+      readers_queue_fault(slot, READERS_SOFT_RESET, cause, now);
+      (void)rc522_init(&slot->rc522, 'B');
+      break;
+    } /* case */
+
+    case LEVEL_REINIT:
+    {
+      rc522_count(&slot->rc522.stats.reinits);
+      readers_queue_fault(slot, READERS_REINIT, cause, now);
+      (void)readers_start(slot);
+      break;
+    } /* case */
+
+    default:
+    {
+      readers_queue_fault(slot, READERS_OFFLINE, cause, now);
+      readers_enter(slot, READER_OFFLINE, now);
+      return;
+    } /* default */
+
+  } /* switch */
+
+  slot->level++;
+
+  // Check on the next call
+  slot->check_ms = now - READERS_CHECK_MS;
+  readers_enter(slot, READER_IDLE, now);
+
+} /* readers_recover */
+
+
+//----------------------------------------------------------------------------
+// NAME: readers_start
+//
+// DESCRIPTION:
+//    This function sets up a reader's SPI port and RC522 from scratch.
+//
+// INPUT:
+//   slot - the reader
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if the reader answered and holds its set up
+//----------------------------------------------------------------------------
+static bool readers_start(READER_SLOT_t* slot)
+{
+  uint8 port = (uint8)(slot - slots);
+
+  rc522_reader_init(&slot->rc522, port);
+
+  return ((rc522_init(&slot->rc522, 'B') == MI_OK) && rc522_check(&slot->rc522));
+
+} /* readers_start */
+
+
+//----------------------------------------------------------------------------
+// NAME: readers_queue_fault
+//
+// DESCRIPTION:
+//    This function queues a supervisor action, dropping it if the queue
+//    is full.
+//
+// INPUT:
+//   slot   - the reader
+//   action - READERS_SOFT_RESET ... READERS_RECOVERED
+//   cause  - READERS_CAUSE_xx
+//   now    - the current time in ms
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void readers_queue_fault(READER_SLOT_t* slot, uint8 action, uint8 cause, uint32 now)
+{
+  uint8 next = (fault_head + 1) & (READERS_FAULT_QUEUE_SIZE - 1);
+
+  if (next == fault_tail)
+  {
+    return;
+  } /* if */
+
+  fault_queue[fault_head].timestamp = now;
+  fault_queue[fault_head].door = (uint8)(slot - slots);
+  fault_queue[fault_head].action = action;
+  fault_queue[fault_head].cause = cause;
+  fault_head = next;
+
+} /* readers_queue_fault */
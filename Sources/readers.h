@@ -0,0 +1,104 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: readers.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for polling up to three RC522
+//    readers, one per SPI port, in turn without blocking. A card brought
+//    to any reader is selected and queued as a tap event. A supervisor
+//    checks the readers and resets any that stop working.
+//
+//*****************************************************************************
+
+#ifndef _READERS_H_
+#define _READERS_H_
+
+#include "sys_types.h"
+#include "RFID_rc522.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// SPI ports with a reader wired up. SPI1 and SPI2 take their slave selects
+// from port P (PP3 and PP6), which the board also uses for the 7-segment
+// digit enables (PP0-PP3) and the RGB LED (PP4-PP6): a second reader
+// means giving up digit 3, a third one the green LED.
+#define READERS_PORTS           (1 << RC522_SPI0)
+#define READERS_MAX             3
+
+// An idle reader looks for a card this often
+#define READERS_POLL_MS         50
+
+// Backstop in case a command never ends; the RC522 timer stops a command
+// with no answer after 1-2 ms (rc522_default_profile)
+#define READERS_COMMAND_MS      10
+
+// Each reader has at most one tap waiting, so this never overflows
+#define READERS_QUEUE_SIZE      4       // must be a power of 2
+
+// Supervisor: an idle reader's registers are read back this often, and
+// READERS_ERROR_LIMIT card errors in a row bring the check forward.
+// A reader that fails is soft reset, then has its SPI port and RC522
+// set up again, then is taken offline and retried every
+// READERS_RETRY_MS. A recovery blocks for ~200 ms (rc522_init()).
+#define READERS_CHECK_MS        10000
+#define READERS_ERROR_LIMIT     8
+#define READERS_RETRY_MS        30000
+#define READERS_FAULT_QUEUE_SIZE 8      // must be a power of 2
+
+// Supervisor actions
+#define READERS_SOFT_RESET      1
+#define READERS_REINIT          2
+#define READERS_OFFLINE         3
+#define READERS_RECOVERED       4
+
+// What made the supervisor act
+#define READERS_CAUSE_INIT      1       // no answer to readers_init()
+#define READERS_CAUSE_CHECK     2       // rc522_check() failed
+#define READERS_CAUSE_STUCK     3       // a command never ended
+#define READERS_CAUSE_RETRY     4       // offline retry
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  RC522_READER_t* reader;       // the card stays selected on this reader
+  uint8  door;                  // 0 - READERS_MAX-1, the reader's SPI port
+  uint8  uid[MIFARE_UID_SIZE];
+  uint8  sak;                   // SELECT answer, see MFRC522_ParseType()
+  uint32 timestamp;             // timebase_ms() of the tap
+} READER_TAP_t;
+
+typedef struct
+{
+  uint32 timestamp;             // timebase_ms() of the action
+  uint8  door;
+  uint8  action;                // READERS_SOFT_RESET ... READERS_RECOVERED
+  uint8  cause;                 // READERS_CAUSE_xx
+} READER_FAULT_t;
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+uint8 readers_init(void);
+void  readers_service(void);
+bool  readers_get_event(READER_TAP_t* tap);
+void  readers_release(RC522_READER_t* reader);
+void  readers_flush(void);
+uint8 readers_present_count(void);
+bool  readers_is_fitted(uint8 door);
+bool  readers_is_online(uint8 door);
+bool  readers_get_fault(READER_FAULT_t* fault);
+const RC522_READER_t* readers_get(uint8 door);
+void  readers_clear_stats(void);
+
+#endif /* _READERS_H_ */
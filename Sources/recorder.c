@@ -0,0 +1,673 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: recorder.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file implements the pre-trigger sensor recorder. Samples go into
+//    a ring of RECORDER_BLOCKS blocks of RECORDER_BLOCK_SIZE bytes:
+//
+//      byte  0-1   block sequence number
+//      byte  2-3   tick count of the first sample
+//      byte  4     number of samples in the block
+//      byte  5     number of data bytes used
+//      byte  6     trigger mark: samples recorded before the alarm + 1,
+//                  or 0 if the alarm was not raised in this block
+//      byte  7     reserved (0)
+//      byte  8-15  first sample, four 16-bit values
+//      byte 16-63  following samples as deltas from the previous one
+//
+//    Every value is big endian. A delta sample is a tag byte holding a 2-bit
+//    code per channel (light in bits 7-6 down to distance in bits 1-0)
+//    followed by the channel deltas in order:
+//
+//      0 - unchanged, no bytes
+//      1 - signed 8-bit delta
+//      2 - signed 16-bit delta
+//
+//    Steady sensors cost one byte per sample. A sample that doesn't fit
+//    starts a new block with a full keyframe, so each block decodes on its
+//    own and blocks can be dropped from the ring one at a time.
+//
+//    When an alarm fires, RECORDER_POST_SAMPLES more samples are recorded,
+//    then the block holding the trigger, the RECORDER_PRE_BLOCKS before it
+//    and the blocks after it are frozen. Recording carries on around them
+//    while recorder_service() streams them out a character at a time,
+//    only when the SCI1 transmitter is free, so it never blocks detection.
+//
+//    The dump shares SCI1 with the console, so recorder_dumping is set for
+//    the whole window and outchar1 drops console output until the "#END"
+//    line has gone out. The first line starts with "\r\n" in case the
+//    console was part way through a line when the alarm froze the window.
+//
+//    Skipping a frozen window leaves the ring out of index order for a
+//    while, so the decoder orders blocks by their sequence numbers.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include <mc9s12dg256.h>            // derivative information
+#include "recorder.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// Block header layout
+#define BLOCK_SEQ               0
+#define BLOCK_TIMESTAMP         2
+#define BLOCK_COUNT             4
+#define BLOCK_USED              5
+#define BLOCK_TRIGGER           6
+#define BLOCK_RESERVED          7
+#define BLOCK_BASE              8
+#define BLOCK_HEADER_SIZE       16
+#define BLOCK_DATA_SIZE         (RECORDER_BLOCK_SIZE - BLOCK_HEADER_SIZE)
+#define BLOCK_MAX_COUNT         255
+
+// Delta codes
+#define DELTA_SAME              0
+#define DELTA_BYTE              1
+#define DELTA_WORD              2
+#define DELTA_MAX_SAMPLE_SIZE   (1 + 2 * RECORDER_CHANNELS)
+
+// Recorder states
+#define STATE_RECORDING         0
+#define STATE_POST_TRIGGER      1
+#define STATE_FROZEN            2
+
+// Dump phases
+#define DUMP_BEGIN              0
+#define DUMP_BLOCKS             1
+#define DUMP_END                2
+#define DUMP_DONE               3
+
+// ':' + two hex digits per byte + checksum + "\r\n"
+#define DUMP_LINE_SIZE          (1 + 2 * RECORDER_BLOCK_SIZE + 2 + 2)
+
+#define SCI_TDRE_BITMASK        0x80
+#define RING_MASK               (RECORDER_BLOCKS - 1)
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+// The ring has its own segment so its size is visible in the PRM. It is
+// NO_INIT, so recorder_init() clears it.
+#pragma DATA_SEG RECORDER_DATA
+static uint8 blocks[RECORDER_BLOCKS][RECORDER_BLOCK_SIZE];
+#pragma DATA_SEG DEFAULT
+
+static uint8  head;                     // block being written
+static uint16 block_seq;
+static uint16 previous[RECORDER_CHANNELS];
+
+static uint8  state;
+static uint8  trigger_block;
+static uint16 trigger_time;
+static uint8  post_remaining;
+static uint8  frozen_first;
+static uint8  frozen_last;
+static uint16 missed_triggers;
+
+static uint8  dump_phase;
+static uint8  dump_block;
+static char   dump_line[DUMP_LINE_SIZE];
+static uint8  dump_length;
+static uint8  dump_position;
+
+
+//-----------------------------------------------------------------------------
+//                        Define public variables
+//-----------------------------------------------------------------------------
+uint8 recorder_dumping;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+static void  recorder_keyframe(uint16 timestamp, const uint16 values[RECORDER_CHANNELS]);
+static void  recorder_next_block(void);
+static void  recorder_freeze(void);
+static void  recorder_put16(uint8* destination, uint16 value);
+static uint8 recorder_hex_byte(uint8 position, uint8 value);
+static void  recorder_build_line(void);
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: recorder_init
+//
+// DESCRIPTION:
+//    This function empties the ring and starts recording.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void recorder_init(void)
+{
+  uint8 block;
+
+  for (block = 0; block < RECORDER_BLOCKS; block++)
+  {
+    blocks[block][BLOCK_COUNT] = 0;
+    blocks[block][BLOCK_TRIGGER] = 0;
+  } /* for */
+
+  head = 0;
+  block_seq = 0;
+  state = STATE_RECORDING;
+  missed_triggers = 0;
+  dump_phase = DUMP_DONE;
+  dump_length = 0;
+  dump_position = 0;
+  recorder_dumping = FALSE;
+
+} /* recorder_init */
+
+
+//----------------------------------------------------------------------------
+// NAME: recorder_sample
+//
+// DESCRIPTION:
+//    This function records one sample of every channel.
+//
+// INPUT:
+//   timestamp - the current tick count
+//   values    - one value per channel, RECORDER_LIGHT first
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void recorder_sample(uint16 timestamp, const uint16 values[RECORDER_CHANNELS])
+{
+  uint8* block = blocks[head];
+  uint8  encoded[DELTA_MAX_SAMPLE_SIZE];
+  uint8  length = 1;
+  uint8  tag = 0;
+  uint8  channel;
+  sint16 delta;
+
+  if (block[BLOCK_COUNT] == 0)
+  {
+    recorder_keyframe(timestamp, values);
+  } /* if */
+  else
+  {
+    for (channel = 0; channel < RECORDER_CHANNELS; channel++)
+    {
+      delta = (sint16)(values[channel] - previous[channel]);
+      tag <<= 2;
+
+      if (delta == 0)
+      {
+        tag |= DELTA_SAME;
+      } /* if */
+      else if ((delta >= -128) && (delta <= 127))
+      {
+        tag |= DELTA_BYTE;
+        encoded[length++] = (uint8)delta;
+      } /* else if */
+      else
+      {
+        tag |= DELTA_WORD;
+        recorder_put16(&encoded[length], (uint16)delta);
+        length += 2;
+      } /* else */
+    } /* for */
+    encoded[0] = tag;
+
+    if ((block[BLOCK_USED] + length > BLOCK_DATA_SIZE) ||
+        (block[BLOCK_COUNT] == BLOCK_MAX_COUNT))
+    {
+      // A trigger after the last sample moves with the sample
+      tag = (block[BLOCK_TRIGGER] > block[BLOCK_COUNT]);
+      if (tag)
+      {
+        block[BLOCK_TRIGGER] = 0;
+      } /* if */
+
+      recorder_next_block();
+      recorder_keyframe(timestamp, values);
+      if (tag)
+      {
+        blocks[head][BLOCK_TRIGGER] = 1;
+      } /* if */
+    } /* if */
+    else
+    {
+      for (channel = 0; channel < length; channel++)
+      {
+        block[BLOCK_HEADER_SIZE + block[BLOCK_USED] + channel] = encoded[channel];
+      } /* for */
+      block[BLOCK_USED] += length;
+      block[BLOCK_COUNT]++;
+    } /* else */
+  } /* else */
+
+  for (channel = 0; channel < RECORDER_CHANNELS; channel++)
+  {
+    previous[channel] = values[channel];
+  } /* for */
+
+  if ((state == STATE_POST_TRIGGER) && (--post_remaining == 0))
+  {
+    recorder_freeze();
+  } /* if */
+
+} /* recorder_sample */
+
+
+//----------------------------------------------------------------------------
+// NAME: recorder_trigger
+//
+// DESCRIPTION:
+//    This function marks an alarm. The window around it is frozen once the
+//    post-trigger samples are in. Alarms raised while an earlier window is
+//    still being sent are counted but not recorded separately.
+//
+// INPUT:
+//   timestamp - the tick count of the alarm
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void recorder_trigger(uint16 timestamp)
+{
+
+  if (state == STATE_FROZEN)
+  {
+    missed_triggers++;
+    return;
+  } /* if */
+
+  if (state == STATE_POST_TRIGGER)
+  {
+    // Already inside the window being captured
+    return;
+  } /* if */
+
+  blocks[head][BLOCK_TRIGGER] = blocks[head][BLOCK_COUNT] + 1;
+  trigger_block = head;
+  trigger_time = timestamp;
+  post_remaining = RECORDER_POST_SAMPLES;
+  state = STATE_POST_TRIGGER;
+
+} /* recorder_trigger */
+
+
+//----------------------------------------------------------------------------
+// NAME: recorder_service
+//
+// DESCRIPTION:
+//    This function sends as much of the frozen window as SCI1 will take
+//    without waiting. It is called from the main loop's background work.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void recorder_service(void)
+{
+
+  while (SCI1SR1 & SCI_TDRE_BITMASK)
+  {
+    if (dump_position == dump_length)
+    {
+      if (dump_phase == DUMP_DONE)
+      {
+        // Window sent; its blocks go back into the ring and the
+        // console gets SCI1 back
+        if (state == STATE_FROZEN)
+        {
+          state = STATE_RECORDING;
+          recorder_dumping = FALSE;
+        } /* if */
+        return;
+      } /* if */
+
+      recorder_build_line();
+    } /* if */
+
+    SCI1DRL = dump_line[dump_position++];
+  } /* while */
+
+} /* recorder_service */
+
+
+//----------------------------------------------------------------------------
+// NAME: recorder_is_busy
+//
+// DESCRIPTION:
+//    This function reports whether a window is being captured or sent.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE while an alarm window is not yet fully sent
+//----------------------------------------------------------------------------
+bool recorder_is_busy(void)
+{
+
+  return (state != STATE_RECORDING);
+
+} /* recorder_is_busy */
+
+
+//----------------------------------------------------------------------------
+// NAME: recorder_missed_triggers
+//
+// DESCRIPTION:
+//    This function returns how many alarms arrived while a window was
+//    being sent.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the number of alarms without a window of their own
+//----------------------------------------------------------------------------
+uint16 recorder_missed_triggers(void)
+{
+
+  return (missed_triggers);
+
+} /* recorder_missed_triggers */
+
+
+//-----------------------------------------------------------------------------
+//                             Private functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: recorder_keyframe
+//
+// DESCRIPTION:
+//    This function starts the current block with a full sample.
+//
+// INPUT:
+//   timestamp - the tick count of the sample
+//   values    - one value per channel
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void recorder_keyframe(uint16 timestamp, const uint16 values[RECORDER_CHANNELS])
+{
+  uint8* block = blocks[head];
+  uint8  channel;
+
+  recorder_put16(&block[BLOCK_SEQ], block_seq++);
+  recorder_put16(&block[BLOCK_TIMESTAMP], timestamp);
+  block[BLOCK_COUNT] = 1;
+  block[BLOCK_USED] = 0;
+  block[BLOCK_RESERVED] = 0;
+
+  for (channel = 0; channel < RECORDER_CHANNELS; channel++)
+  {
+    recorder_put16(&block[BLOCK_BASE + 2 * channel], values[channel]);
+  } /* for */
+
+} /* recorder_keyframe */
+
+
+//----------------------------------------------------------------------------
+// NAME: recorder_next_block
+//
+// DESCRIPTION:
+//    This function moves on to the next block, stepping over the frozen
+//    window if there is one. The new block is left empty.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void recorder_next_block(void)
+{
+  uint8 next = (head + 1) & RING_MASK;
+
+  if ((state == STATE_FROZEN) && (next == frozen_first))
+  {
+    next = (frozen_last + 1) & RING_MASK;
+  } /* if */
+
+  head = next;
+  blocks[head][BLOCK_COUNT] = 0;
+  blocks[head][BLOCK_TRIGGER] = 0;
+
+} /* recorder_next_block */
+
+
+//----------------------------------------------------------------------------
+// NAME: recorder_freeze
+//
+// DESCRIPTION:
+//    This function freezes the window around the trigger and queues it to
+//    be sent. At least one block is always left free for recording.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void recorder_freeze(void)
+{
+
+  frozen_last = head;
+  frozen_first = (trigger_block - RECORDER_PRE_BLOCKS) & RING_MASK;
+  if (((frozen_last - frozen_first) & RING_MASK) > RECORDER_BLOCKS - 2)
+  {
+    frozen_first = (frozen_last - (RECORDER_BLOCKS - 2)) & RING_MASK;
+  } /* if */
+
+  state = STATE_FROZEN;
+  recorder_next_block();
+
+  dump_phase = DUMP_BEGIN;
+  dump_block = frozen_first;
+  dump_length = 0;
+  dump_position = 0;
+  recorder_dumping = TRUE;
+
+} /* recorder_freeze */
+
+
+//----------------------------------------------------------------------------
+// NAME: recorder_put16
+//
+// DESCRIPTION:
+//    This function stores a 16-bit value big endian.
+//
+// INPUT:
+//   destination - where to store it
+//   value       - the value
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void recorder_put16(uint8* destination, uint16 value)
+{
+
+  destination[0] = (uint8)(value >> 8);
+  destination[1] = (uint8)value;
+
+} /* recorder_put16 */
+
+
+//----------------------------------------------------------------------------
+// NAME: recorder_hex_byte
+//
+// DESCRIPTION:
+//    This function writes a byte into the dump line as two hex digits.
+//
+// INPUT:
+//   position - where in the line to write
+//   value    - the byte
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the position after the digits
+//----------------------------------------------------------------------------
+static uint8 recorder_hex_byte(uint8 position, uint8 value)
+{
+  static const char digits[] = "0123456789ABCDEF";
+
+  dump_line[position++] = digits[value >> 4];
+  dump_line[position++] = digits[value & 0x0F];
+
+  return (position);
+
+} /* recorder_hex_byte */
+
+
+//----------------------------------------------------------------------------
+// NAME: recorder_build_line
+//
+// DESCRIPTION:
+//    This function prepares the next line of the dump:
+//
+//      #BBOX tttt mmmm     start of a window: trigger ticks, missed alarms
+//      :<block hex><sum>   one line per block, header and used data only;
+//                          sum makes the bytes add up to 0 mod 256
+//      #END                end of the window
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void recorder_build_line(void)
+{
+  uint8* block;
+  uint8  position = 0;
+  uint8  length;
+  uint8  sum = 0;
+  uint8  i;
+
+  dump_position = 0;
+
+  switch (dump_phase)
+  {
+    case DUMP_BEGIN:
+      dump_line[position++] = '\r';
+      dump_line[position++] = '\n';
+      dump_line[position++] = '#';
+      dump_line[position++] = 'B';
+      dump_line[position++] = 'B';
+      dump_line[position++] = 'O';
+      dump_line[position++] = 'X';
+      dump_line[position++] = ' ';
+      position = recorder_hex_byte(position, (uint8)(trigger_time >> 8));
+      position = recorder_hex_byte(position, (uint8)trigger_time);
+      dump_line[position++] = ' ';
+      position = recorder_hex_byte(position, (uint8)(missed_triggers >> 8));
+      position = recorder_hex_byte(position, (uint8)missed_triggers);
+      dump_phase = DUMP_BLOCKS;
+      break;
+
+    case DUMP_BLOCKS:
+      // Skip blocks that never got a sample
+      while (blocks[dump_block][BLOCK_COUNT] == 0)
+      {
+        if (dump_block == frozen_last)
+        {
+          dump_phase = DUMP_END;
+          recorder_build_line();
+          return;
+        } /* if */
+        dump_block = (dump_block + 1) & RING_MASK;
+      } /* while */
+
+      block = blocks[dump_block];
+      length = BLOCK_HEADER_SIZE + block[BLOCK_USED];
+      dump_line[position++] = ':';
+      for (i = 0; i < length; i++)
+      {
+        position = recorder_hex_byte(position, block[i]);
+        sum += block[i];
+      } /* for */
+      position = recorder_hex_byte(position, (uint8)(0 - sum));
+
+      if (dump_block == frozen_last)
+      {
+        dump_phase = DUMP_END;
+      } /* if */
+      dump_block = (dump_block + 1) & RING_MASK;
+      break;
+
+    case DUMP_END:
+      dump_line[position++] = '#';
+      dump_line[position++] = 'E';
+      dump_line[position++] = 'N';
+      dump_line[position++] = 'D';
+      dump_phase = DUMP_DONE;
+      break;
+
+    default:
+      return;
+  } /* switch */
+
+  dump_line[position++] = '\r';
+  dump_line[position++] = '\n';
+  dump_length = position;
+
+} /* recorder_build_line */
@@ -0,0 +1,65 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: recorder.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for the pre-trigger "black box"
+//    sensor recorder. Light, temperature, motion and distance samples are
+//    delta encoded into a ring of fixed size blocks. When an alarm fires
+//    the blocks around it are frozen and streamed out over SCI1 as hex
+//    lines that tools/blackbox_decode.py turns back into samples.
+//
+//*****************************************************************************
+
+#ifndef _RECORDER_H_
+#define _RECORDER_H_
+
+#include "sys_types.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// The block ring fills the RECORDER_RAM segment in the PRM files
+// (0x3000 - 0x3FFF), so the two must be changed together
+#define RECORDER_RAM_SIZE       0x1000
+#define RECORDER_BLOCK_SIZE     64
+#define RECORDER_BLOCKS         (RECORDER_RAM_SIZE / RECORDER_BLOCK_SIZE)
+
+// Channels, in the order they are stored
+#define RECORDER_LIGHT          0
+#define RECORDER_TEMP           1
+#define RECORDER_MOTION         2
+#define RECORDER_DISTANCE       3
+#define RECORDER_CHANNELS       4
+
+// Window kept around an alarm: whole blocks before the trigger, samples
+// after it (5 s at the 10 Hz status rate)
+#define RECORDER_PRE_BLOCKS     24
+#define RECORDER_POST_SAMPLES   50
+
+//-----------------------------------------------------------------------------
+//                        Define public variables
+//-----------------------------------------------------------------------------
+
+// Non-zero while a window is being sent. outchar1 drops console output
+// while it is set so nothing lands in the middle of a dump line.
+extern uint8 recorder_dumping;
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+void   recorder_init(void);
+void   recorder_sample(uint16 timestamp, const uint16 values[RECORDER_CHANNELS]);
+void   recorder_trigger(uint16 timestamp);
+void   recorder_service(void);
+bool   recorder_is_busy(void);
+uint16 recorder_missed_triggers(void);
+
+#endif /* _RECORDER_H_ */
@@ -0,0 +1,57 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: sensors_config.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the tuning of the sensor anomaly detectors and the
+//    status engine: the variance floors, the z thresholds of each
+//    alertness level and the status level table. main.c and the host test
+//    that replays sensor traces (tests/anomaly_test.c) both take them from
+//    here.
+//
+//*****************************************************************************
+
+#ifndef _SENSORS_CONFIG_H_
+#define _SENSORS_CONFIG_H_
+
+#include "status.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// Adaptive baseline variance floors (noise^2 in sensor counts). Light
+// is floored at 16 counts, well above its few counts of noise, because
+// daylight drifts with the clouds: in the quiet week tests/anomaly_test.c
+// replays, a floor of 4 counts went to BAD 5 times a day at medium
+// alertness and 41 times a day at high. At 16 counts it is 0.1 a day at
+// high alertness, and a flashlight still alarms on its first sample.
+#define LIGHT_VARIANCE_FLOOR    256
+#define TEMP_VARIANCE_FLOOR     4
+#define MOTION_VARIANCE_FLOOR   25
+
+// z thresholds of each alertness level in tenths, suspect then alarm
+#define ALERTNESS_LEVELS        3
+#define ALERTNESS_LOW_Z_SUSPECT     30
+#define ALERTNESS_LOW_Z_ALARM       40
+#define ALERTNESS_MEDIUM_Z_SUSPECT  25
+#define ALERTNESS_MEDIUM_Z_ALARM    35
+#define ALERTNESS_HIGH_Z_SUSPECT    20
+#define ALERTNESS_HIGH_Z_ALARM      30
+
+// Status engine levels: entry score, exit score, minimum dwell,
+// escalation time. OK escalates to BAD after 5 minutes.
+#define SENSORS_STATUS_CONFIG                                                  \
+  {                                                                            \
+    { 0,   0,   0,                          0 },                               \
+    { 60,  30,  STATUS_MS_TO_STEPS(2000),   STATUS_MS_TO_STEPS(300000) },      \
+    { 160, 120, STATUS_MS_TO_STEPS(10000),  0 }                                \
+  }
+
+#endif /* _SENSORS_CONFIG_H_ */
@@ -0,0 +1,553 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: serial.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file sets the SCI baud rates. SCI1_init() in main.asm takes the
+//    rate as an int, so it can't go past 32767 baud, and gives no way to
+//    know how far the divisor is from the rate asked for. Here the rates
+//    are a table whose divisors and errors are worked out by the
+//    compiler, and a rate more than SERIAL_MAX_ERROR off is refused.
+//
+//    Moving a terminal to another rate is a handshake:
+//
+//      1) The caller tells the other end which rate is next, at the old
+//         rate, then calls serial_switch(). It waits for the last stop
+//         bit to go out and changes the divisor.
+//      2) The other end changes rate and sends SERIAL_SYNC_COUNT
+//         SERIAL_SYNC_CHAR in a row. serial_get_char() swallows them and
+//         ends the switch once they're all in.
+//      3) If they aren't in within SERIAL_SWITCH_MS, serial_service()
+//         puts the old rate back.
+//
+//    Received characters go through serial_get_char(), which counts
+//    framing, noise and overrun errors. A terminal at the wrong rate makes
+//    framing errors, so SERIAL_FALLBACK_ERRORS of them in a row, or a break
+//    (a framing error with all bits low), put the port back on
+//    SERIAL_DEFAULT_RATE, where a terminal fresh from a reset will be.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include <mc9s12dg256.h>            // derivative information
+#include "serial.h"
+#include "timebase.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// SCI register offsets, the same for SCI0 and SCI1
+#define SCI_BDH                 0
+#define SCI_BDL                 1
+#define SCI_CR1                 2
+#define SCI_CR2                 3
+#define SCI_SR1                 4
+#define SCI_DRL                 7
+
+#define SCI_CR2_TE_RE           0x0C
+#define SCI_SR1_TC              0x40
+#define SCI_SR1_RDRF            0x20
+#define SCI_SR1_OR              0x08
+#define SCI_SR1_NF              0x04
+#define SCI_SR1_FE              0x02
+
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  uint8  rate;                  // index into serial_rates[]
+  uint8  previous;              // rate to go back to if a switch fails
+  bool   switching;
+  uint8  sync;                  // SERIAL_SYNC_CHAR in a row since the switch
+  uint8  bad_frames;            // framing errors in a row
+  uint32 switched_ms;           // timebase_ms() of the switch
+  SERIAL_STATS_t stats;
+} SERIAL_PORT_t;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+// 230400 and 460800 are the usual PC rates past 115200 but the divisor
+// can't get near them from a 24 MHz bus; 250000 and 500000 are exact and
+// FTDI cables can be set to them
+const SERIAL_RATE_t serial_rates[SERIAL_RATES] =
+{
+  {   9600UL, SERIAL_DIVISOR(9600UL),   SERIAL_ERROR(9600UL)   },
+  {  19200UL, SERIAL_DIVISOR(19200UL),  SERIAL_ERROR(19200UL)  },
+  {  38400UL, SERIAL_DIVISOR(38400UL),  SERIAL_ERROR(38400UL)  },
+  {  57600UL, SERIAL_DIVISOR(57600UL),  SERIAL_ERROR(57600UL)  },
+  { 115200UL, SERIAL_DIVISOR(115200UL), SERIAL_ERROR(115200UL) },
+  { 230400UL, SERIAL_DIVISOR(230400UL), SERIAL_ERROR(230400UL) },
+  { 250000UL, SERIAL_DIVISOR(250000UL), SERIAL_ERROR(250000UL) },
+  { 500000UL, SERIAL_DIVISOR(500000UL), SERIAL_ERROR(500000UL) }
+};
+
+static volatile uint8* const sci_registers[SERIAL_PORTS] =
+{
+  &SCI0BDH,
+  &SCI1BDH
+};
+
+static SERIAL_PORT_t ports[SERIAL_PORTS];
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+static void serial_write_divisor(uint8 port, uint8 rate);
+static void serial_fall_back(uint8 port);
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: serial_init
+//
+// DESCRIPTION:
+//    This function sets up an SCI for 8N1 polled transmit and receive at
+//    one of the table rates and clears its error counts. It takes the
+//    place of SCI0_init() and SCI1_init().
+//
+// INPUT:
+//   port - SERIAL_PORT0 or SERIAL_PORT1
+//   rate - index into serial_rates[]; SERIAL_DEFAULT_RATE is used instead
+//          if the rate isn't usable
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void serial_init(uint8 port, uint8 rate)
+{
+  SERIAL_PORT_t* state = &ports[port];
+  volatile uint8* sci = sci_registers[port];
+
+  if (!serial_rate_ok(rate))
+  {
+    rate = SERIAL_DEFAULT_RATE;
+  } /* if */
+
+  state->switching = FALSE;
+  state->sync = 0;
+  state->bad_frames = 0;
+  state->stats.framing_errors = 0;
+  state->stats.noise_errors = 0;
+  state->stats.overruns = 0;
+  state->stats.breaks = 0;
+  state->stats.fallbacks = 0;
+
+  sci[SCI_CR1] = 0;
+  sci[SCI_CR2] = SCI_CR2_TE_RE;
+  serial_write_divisor(port, rate);
+
+} /* serial_init */
+
+
+//----------------------------------------------------------------------------
+// NAME: serial_rate_ok
+//
+// DESCRIPTION:
+//    This function tells if a table rate can be set, i.e. its divisor
+//    gets within SERIAL_MAX_ERROR of it.
+//
+// INPUT:
+//   rate - index into serial_rates[]
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if the rate can be used
+//----------------------------------------------------------------------------
+bool serial_rate_ok(uint8 rate)
+{
+  sint16 error;
+
+  if (rate >= SERIAL_RATES)
+  {
+    return (FALSE);
+  } /* if */
+
+  error = serial_rates[rate].error;
+  return ((error <= SERIAL_MAX_ERROR) && (error >= -SERIAL_MAX_ERROR));
+
+} /* serial_rate_ok */
+
+
+//----------------------------------------------------------------------------
+// NAME: serial_set_rate
+//
+// DESCRIPTION:
+//    This function changes the rate of a port straight away, with no
+//    handshake. Anything still being sent is cut short.
+//
+// INPUT:
+//   port - SERIAL_PORT0 or SERIAL_PORT1
+//   rate - index into serial_rates[]
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   FALSE if the rate can't be used, and the port is left as it was
+//----------------------------------------------------------------------------
+bool serial_set_rate(uint8 port, uint8 rate)
+{
+
+  if (!serial_rate_ok(rate))
+  {
+    return (FALSE);
+  } /* if */
+
+  ports[port].switching = FALSE;
+  serial_write_divisor(port, rate);
+  return (TRUE);
+
+} /* serial_set_rate */
+
+
+//----------------------------------------------------------------------------
+// NAME: serial_rate
+//
+// DESCRIPTION:
+//    This function returns the rate a port is on now.
+//
+// INPUT:
+//   port - SERIAL_PORT0 or SERIAL_PORT1
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   index into serial_rates[]
+//----------------------------------------------------------------------------
+uint8 serial_rate(uint8 port)
+{
+
+  return (ports[port].rate);
+
+} /* serial_rate */
+
+
+//----------------------------------------------------------------------------
+// NAME: serial_switch
+//
+// DESCRIPTION:
+//    This function starts the move to a new rate. It waits for the
+//    transmitter to finish, so the other end gets all of the notice sent
+//    before it at the old rate, then changes the divisor. The move is
+//    confirmed by the other end's sync characters or undone after
+//    SERIAL_SWITCH_MS; serial_is_switching() tells when it's over.
+//
+// INPUT:
+//   port - SERIAL_PORT0 or SERIAL_PORT1
+//   rate - index into serial_rates[]
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   FALSE if the rate can't be used
+//----------------------------------------------------------------------------
+bool serial_switch(uint8 port, uint8 rate)
+{
+  SERIAL_PORT_t* state = &ports[port];
+
+  if (!serial_rate_ok(rate))
+  {
+    return (FALSE);
+  } /* if */
+
+  serial_flush(port);
+
+  state->previous = state->rate;
+  state->sync = 0;
+  state->bad_frames = 0;
+  state->switched_ms = timebase_ms();
+  state->switching = TRUE;
+  serial_write_divisor(port, rate);
+
+  return (TRUE);
+
+} /* serial_switch */
+
+
+//----------------------------------------------------------------------------
+// NAME: serial_is_switching
+//
+// DESCRIPTION:
+//    This function tells if a port is still waiting for the other end to
+//    confirm a new rate. Once it's over, serial_rate() tells if the new
+//    rate stuck.
+//
+// INPUT:
+//   port - SERIAL_PORT0 or SERIAL_PORT1
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE while the switch is waiting
+//----------------------------------------------------------------------------
+bool serial_is_switching(uint8 port)
+{
+
+  return (ports[port].switching);
+
+} /* serial_is_switching */
+
+
+//----------------------------------------------------------------------------
+// NAME: serial_service
+//
+// DESCRIPTION:
+//    This function puts back the old rate on any port whose switch has
+//    not been confirmed in time. It is meant to be called from the main
+//    loop.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void serial_service(void)
+{
+  uint8 port;
+
+  for (port = 0; port < SERIAL_PORTS; port++)
+  {
+    if (ports[port].switching &&
+        (timebase_ms() - ports[port].switched_ms >= SERIAL_SWITCH_MS))
+    {
+      ports[port].switching = FALSE;
+      serial_write_divisor(port, ports[port].previous);
+    } /* if */
+  } /* for */
+
+} /* serial_service */
+
+
+//----------------------------------------------------------------------------
+// NAME: serial_get_char
+//
+// DESCRIPTION:
+//    This function takes a received character from a port, if there is
+//    one, without waiting. Characters with a framing error are counted
+//    and dropped and may make the port fall back to the default rate.
+//    While a switch is waiting, the sync characters are swallowed here.
+//
+// INPUT:
+//   port - SERIAL_PORT0 or SERIAL_PORT1
+//
+// OUTPUT:
+//   character - the character received, if there is one
+//
+// RETURN:
+//   TRUE if a character was returned
+//----------------------------------------------------------------------------
+bool serial_get_char(uint8 port, char* character)
+{
+  SERIAL_PORT_t* state = &ports[port];
+  volatile uint8* sci = sci_registers[port];
+  uint8 status;
+  uint8 data;
+
+  // Reading SR1 then the data register clears the error flags, which are
+  // set along with RDRF
+  status = sci[SCI_SR1];
+  if (!(status & SCI_SR1_RDRF))
+  {
+    return (FALSE);
+  } /* if */
+  data = sci[SCI_DRL];
+
+  if (status & SCI_SR1_OR)
+  {
+    state->stats.overruns++;
+  } /* if */
+
+  if (status & SCI_SR1_NF)
+  {
+    state->stats.noise_errors++;
+  } /* if */
+
+  if (status & SCI_SR1_FE)
+  {
+    state->stats.framing_errors++;
+    if (data == 0)
+    {
+      state->stats.breaks++;
+      serial_fall_back(port);
+    } /* if */
+    else if (++state->bad_frames >= SERIAL_FALLBACK_ERRORS)
+    {
+      serial_fall_back(port);
+    } /* else if */
+    return (FALSE);
+  } /* if */
+
+  state->bad_frames = 0;
+
+  if (state->switching)
+  {
+    if (data != SERIAL_SYNC_CHAR)
+    {
+      state->sync = 0;
+    } /* if */
+    else if (++state->sync >= SERIAL_SYNC_COUNT)
+    {
+      state->switching = FALSE;
+    } /* else if */
+    return (FALSE);
+  } /* if */
+
+  *character = (char)data;
+  return (TRUE);
+
+} /* serial_get_char */
+
+
+//----------------------------------------------------------------------------
+// NAME: serial_flush
+//
+// DESCRIPTION:
+//    This function waits until the last character written to a port has
+//    been sent, stop bit and all.
+//
+// INPUT:
+//   port - SERIAL_PORT0 or SERIAL_PORT1
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void serial_flush(uint8 port)
+{
+  volatile uint8* sci = sci_registers[port];
+
+  while (!(sci[SCI_SR1] & SCI_SR1_TC))
+  {
+  } /* while */
+
+} /* serial_flush */
+
+
+//----------------------------------------------------------------------------
+// NAME: serial_stats
+//
+// DESCRIPTION:
+//    This function returns the receive error counts of a port.
+//
+// INPUT:
+//   port - SERIAL_PORT0 or SERIAL_PORT1
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the port's counts, cleared by serial_init()
+//----------------------------------------------------------------------------
+const SERIAL_STATS_t* serial_stats(uint8 port)
+{
+
+  return (&ports[port].stats);
+
+} /* serial_stats */
+
+
+//-----------------------------------------------------------------------------
+//                             Private functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: serial_write_divisor
+//
+// DESCRIPTION:
+//    This function loads a rate's divisor into the SCI. The new divisor
+//    takes effect when the low byte is written.
+//
+// INPUT:
+//   port - SERIAL_PORT0 or SERIAL_PORT1
+//   rate - index into serial_rates[], already checked
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void serial_write_divisor(uint8 port, uint8 rate)
+{
+  volatile uint8* sci = sci_registers[port];
+  uint16 divisor = serial_rates[rate].divisor;
+
+  sci[SCI_BDH] = (uint8)(divisor >> 8);
+  sci[SCI_BDL] = (uint8)divisor;
+  ports[port].rate = rate;
+
+} /* serial_write_divisor */
+
+
+//----------------------------------------------------------------------------
+// NAME: serial_fall_back
+//
+// DESCRIPTION:
+//    This function gives up on a rate the other end isn't using: a switch
+//    still waiting goes back to the old rate, otherwise the port goes to
+//    SERIAL_DEFAULT_RATE.
+//
+// INPUT:
+//   port - SERIAL_PORT0 or SERIAL_PORT1
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void serial_fall_back(uint8 port)
+{
+  SERIAL_PORT_t* state = &ports[port];
+  uint8 rate = SERIAL_DEFAULT_RATE;
+
+  if (state->switching)
+  {
+    state->switching = FALSE;
+    rate = state->previous;
+  } /* if */
+
+  state->bad_frames = 0;
+  if (state->rate != rate)
+  {
+    state->stats.fallbacks++;
+    serial_write_divisor(port, rate);
+  } /* if */
+
+} /* serial_fall_back */
@@ -0,0 +1,94 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: serial.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for the SCI baud rate control: a
+//    table of rates with their precomputed divisors, a handshake to move a
+//    terminal to another rate, and a receiver that falls back to the
+//    default rate when it sees framing errors.
+//
+//*****************************************************************************
+
+#ifndef _SERIAL_H_
+#define _SERIAL_H_
+
+#include "sys_types.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define SERIAL_PORT0            0       // SCI0
+#define SERIAL_PORT1            1       // SCI1, the console
+#define SERIAL_PORTS            2
+
+// SCIBD = bus clock / (16 * baud), rounded to the nearest divisor
+#define SERIAL_BUS_CLOCK        24000000UL
+#define SERIAL_DIVISOR(baud)    ((SERIAL_BUS_CLOCK + 8UL * (baud)) / (16UL * (baud)))
+#define SERIAL_ACTUAL(baud)     (SERIAL_BUS_CLOCK / (16UL * SERIAL_DIVISOR(baud)))
+#define SERIAL_ERROR(baud)      ((sint16)(((sint32)SERIAL_ACTUAL(baud) - (sint32)(baud)) * 10000L / (sint32)(baud)))
+
+// A receiver samples the middle of each bit and is off by half a bit at
+// the stop bit when the two ends differ by ~5%. Each end gets half of
+// that, less a margin for the host's own clock.
+#define SERIAL_MAX_ERROR        200     // 0.01 %, so 2 %
+
+// Index into serial_rates[]
+#define SERIAL_RATES            8
+#define SERIAL_DEFAULT_RATE     0       // 9600, what a terminal expects at reset
+
+// After serial_switch() the other end must send SERIAL_SYNC_COUNT
+// SERIAL_SYNC_CHAR in a row at the new rate within SERIAL_SWITCH_MS,
+// or the port goes back to the rate it had
+#define SERIAL_SYNC_CHAR        'U'     // 0x55, alternate bits show a bad rate
+#define SERIAL_SYNC_COUNT       4
+#define SERIAL_SWITCH_MS        10000
+
+// This many framing errors in a row, or one break, put the port back on
+// SERIAL_DEFAULT_RATE
+#define SERIAL_FALLBACK_ERRORS  3
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  uint32 baud;
+  uint16 divisor;       // SCIBD
+  sint16 error;         // actual - nominal rate, 0.01 %
+} SERIAL_RATE_t;
+
+typedef struct
+{
+  uint16 framing_errors;
+  uint16 noise_errors;
+  uint16 overruns;
+  uint16 breaks;
+  uint16 fallbacks;     // times the port went back to the default rate
+} SERIAL_STATS_t;
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+extern const SERIAL_RATE_t serial_rates[SERIAL_RATES];
+
+void  serial_init(uint8 port, uint8 rate);
+bool  serial_rate_ok(uint8 rate);
+bool  serial_set_rate(uint8 port, uint8 rate);
+uint8 serial_rate(uint8 port);
+bool  serial_switch(uint8 port, uint8 rate);
+bool  serial_is_switching(uint8 port);
+void  serial_service(void);
+bool  serial_get_char(uint8 port, char* character);
+void  serial_flush(uint8 port);
+const SERIAL_STATS_t* serial_stats(uint8 port);
+
+#endif /* _SERIAL_H_ */
@@ -0,0 +1,396 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: session.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file keeps track of who is logged in. session_start() begins a
+//    session after a card (and for an administrator, the PIN) has been
+//    accepted and starts an idle timer on the timebase timer wheel. Every
+//    console character or key press restarts the timer with
+//    session_touch(); when it runs out the session is over and the main
+//    loop goes back to asking for a card.
+//
+//    Each login is also kept in a small cache, replacing the least
+//    recently used entry. session_is_recent() tells if a card was last
+//    logged in with its PIN less than SESSION_GRACE_MS ago, so the PIN
+//    step can be skipped.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include <stddef.h>                 // NULL
+#include "session.h"
+#include "timebase.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  uint8  uid[MIFARE_UID_SIZE];
+  uint8  level;                 // 0 while the entry is free
+  bool   pin_entered;           // pin_ms is valid
+  uint32 pin_ms;                // timebase_ms() of the last login with the PIN
+  uint32 used_ms;               // timebase_ms() of the last login
+} SESSION_ENTRY_t;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+static SESSION_ENTRY_t cache[SESSION_CACHE_ENTRIES];
+static TIMER_t idle_timer;
+static bool active;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+static SESSION_ENTRY_t* session_find(const uint8 uid[MIFARE_UID_SIZE]);
+static SESSION_ENTRY_t* session_replace(uint32 now);
+static void session_idle(void* context);
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: session_init
+//
+// DESCRIPTION:
+//    This function empties the cache and sets up the idle timer. The
+//    timebase must have been initialized.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void session_init(void)
+{
+
+  timer_init(&idle_timer, session_idle, NULL);
+  active = FALSE;
+  session_forget_all();
+
+} /* session_init */
+
+
+//----------------------------------------------------------------------------
+// NAME: session_start
+//
+// DESCRIPTION:
+//    This function begins a session for a card that has just been
+//    accepted and records the login in the cache.
+//
+// INPUT:
+//   uid         - the card UID
+//   level       - the user level the card was accepted at, not 0
+//   pin_entered - TRUE if the PIN was entered for this login, which
+//                 restarts the grace period
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void session_start(const uint8 uid[MIFARE_UID_SIZE], uint8 level, bool pin_entered)
+{
+  SESSION_ENTRY_t* entry;
+  uint32 now = timebase_ms();
+  uint8 idx;
+
+  entry = session_find(uid);
+  if ((entry == NULL) || (entry->level != level))
+  {
+    if (entry == NULL)
+    {
+      entry = session_replace(now);
+    } /* if */
+
+    for (idx = 0; idx < MIFARE_UID_SIZE; idx++)
+    {
+      entry->uid[idx] = uid[idx];
+    } /* for */
+    entry->level = level;
+    entry->pin_entered = FALSE;
+  } /* if */
+
+  if (pin_entered)
+  {
+    entry->pin_entered = TRUE;
+    entry->pin_ms = now;
+  } /* if */
+  entry->used_ms = now;
+
+  active = TRUE;
+  timer_start(&idle_timer, SESSION_IDLE_MS);
+
+} /* session_start */
+
+
+//----------------------------------------------------------------------------
+// NAME: session_is_recent
+//
+// DESCRIPTION:
+//    This function tells if a card was logged in at this level with its
+//    PIN less than SESSION_GRACE_MS ago.
+//
+// INPUT:
+//   uid   - the card UID
+//   level - the user level the card was accepted at
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if the PIN can be skipped
+//----------------------------------------------------------------------------
+bool session_is_recent(const uint8 uid[MIFARE_UID_SIZE], uint8 level)
+{
+  SESSION_ENTRY_t* entry = session_find(uid);
+
+  if ((entry == NULL) || (entry->level != level) || !entry->pin_entered)
+  {
+    return (FALSE);
+  } /* if */
+
+  return ((bool)((timebase_ms() - entry->pin_ms) < SESSION_GRACE_MS));
+
+} /* session_is_recent */
+
+
+//----------------------------------------------------------------------------
+// NAME: session_touch
+//
+// DESCRIPTION:
+//    This function restarts the idle timer. It is called for every input
+//    and does nothing while no one is logged in.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void session_touch(void)
+{
+
+  if (active)
+  {
+    timer_start(&idle_timer, SESSION_IDLE_MS);
+  } /* if */
+
+} /* session_touch */
+
+
+//----------------------------------------------------------------------------
+// NAME: session_end
+//
+// DESCRIPTION:
+//    This function logs out now. The cache is kept.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void session_end(void)
+{
+
+  timer_cancel(&idle_timer);
+  active = FALSE;
+
+} /* session_end */
+
+
+//----------------------------------------------------------------------------
+// NAME: session_is_active
+//
+// DESCRIPTION:
+//    This function tells if someone is logged in.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   FALSE before the first login and once the session has ended
+//----------------------------------------------------------------------------
+bool session_is_active(void)
+{
+
+  return (active);
+
+} /* session_is_active */
+
+
+//----------------------------------------------------------------------------
+// NAME: session_forget_all
+//
+// DESCRIPTION:
+//    This function empties the cache so every administrator has to enter
+//    the PIN again, e.g. once the alarm has gone off. The session of the
+//    user logged in now isn't ended.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void session_forget_all(void)
+{
+  uint8 idx;
+
+  for (idx = 0; idx < SESSION_CACHE_ENTRIES; idx++)
+  {
+    cache[idx].level = 0;
+    cache[idx].pin_entered = FALSE;
+  } /* for */
+
+} /* session_forget_all */
+
+
+//-----------------------------------------------------------------------------
+//                             Private functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: session_find
+//
+// DESCRIPTION:
+//    This function looks a card up in the cache.
+//
+// INPUT:
+//   uid - the card UID
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the card's entry, or NULL if it isn't cached
+//----------------------------------------------------------------------------
+static SESSION_ENTRY_t* session_find(const uint8 uid[MIFARE_UID_SIZE])
+{
+  uint8 idx;
+  uint8 byte;
+
+  for (idx = 0; idx < SESSION_CACHE_ENTRIES; idx++)
+  {
+    if (cache[idx].level == 0)
+    {
+      continue;
+    } /* if */
+
+    for (byte = 0; byte < MIFARE_UID_SIZE; byte++)
+    {
+      if (cache[idx].uid[byte] != uid[byte])
+      {
+        break;
+      } /* if */
+    } /* for */
+
+    if (byte == MIFARE_UID_SIZE)
+    {
+      return (&cache[idx]);
+    } /* if */
+  } /* for */
+
+  return (NULL);
+
+} /* session_find */
+
+
+//----------------------------------------------------------------------------
+// NAME: session_replace
+//
+// DESCRIPTION:
+//    This function picks the entry for a new card: a free one if there is
+//    one, otherwise the least recently used.
+//
+// INPUT:
+//   now - timebase_ms()
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the entry to overwrite
+//----------------------------------------------------------------------------
+static SESSION_ENTRY_t* session_replace(uint32 now)
+{
+  SESSION_ENTRY_t* oldest = &cache[0];
+  uint8 idx;
+
+  for (idx = 0; idx < SESSION_CACHE_ENTRIES; idx++)
+  {
+    if (cache[idx].level == 0)
+    {
+      return (&cache[idx]);
+    } /* if */
+
+    // Ages rather than timestamps, so the ms counter wrapping is harmless
+    if ((now - cache[idx].used_ms) > (now - oldest->used_ms))
+    {
+      oldest = &cache[idx];
+    } /* if */
+  } /* for */
+
+  return (oldest);
+
+} /* session_replace */
+
+
+//----------------------------------------------------------------------------
+// NAME: session_idle
+//
+// DESCRIPTION:
+//    This function is the idle timer callback; it ends the session.
+//
+// INPUT:
+//   context - unused
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void session_idle(void* context)
+{
+
+  (void)context;
+  active = FALSE;
+
+} /* session_idle */
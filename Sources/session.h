@@ -0,0 +1,54 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: session.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for the login session: the
+//    session of the user logged in now, which ends after a while with no
+//    input, and a small cache of recent logins that lets an administrator
+//    tap back in without the PIN for a short while.
+//
+//*****************************************************************************
+
+#ifndef _SESSION_H_
+#define _SESSION_H_
+
+#include "sys_types.h"
+#include "RFID_rc522.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// Recent logins kept, the least recently used one is replaced
+#define SESSION_CACHE_ENTRIES   4
+
+// A card tapped again within this long of its last PIN entry doesn't need
+// the PIN; taps without the PIN don't extend it
+#define SESSION_GRACE_MS        300000  // 5 minutes
+
+// The session ends after this long with no console or keypad input
+#define SESSION_IDLE_MS         120000  // 2 minutes
+
+// Why a session ended
+#define SESSION_END_IDLE        1
+#define SESSION_END_COMMAND     2
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+void session_init(void);
+void session_start(const uint8 uid[MIFARE_UID_SIZE], uint8 level, bool pin_entered);
+bool session_is_recent(const uint8 uid[MIFARE_UID_SIZE], uint8 level);
+void session_touch(void);
+void session_end(void);
+bool session_is_active(void);
+void session_forget_all(void);
+
+#endif /* _SESSION_H_ */
@@ -0,0 +1,193 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: stack.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file measures how much of the SSTACK segment the program uses.
+//    _Startup() in Start12.c calls stack_paint() as soon as the stack
+//    pointer is set, before Init() and main(), so every byte of the stack
+//    below its own frame starts out as STACK_PAINT. The linker gives the
+//    segment's bounds as __SEG_START_SSTACK and __SEG_END_SSTACK, so the
+//    size follows STACKSIZE in the PRM files.
+//
+//    A byte that happens to be pushed as STACK_PAINT reads as unused, so
+//    the high water mark can be low by a byte or two; size the stack with
+//    a margin over it.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include <hidef.h>                  // __SEG_START_DEF, __SEG_END_DEF
+#include "stack.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// Left unpainted below stack_paint()'s local, for its own frame
+#define STACK_PAINT_MARGIN      4
+
+#define STACK_BOTTOM            ((uint8*)__SEG_START_REF(SSTACK))
+#define STACK_TOP               ((uint8*)__SEG_END_REF(SSTACK))
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+__SEG_START_DEF(SSTACK);
+__SEG_END_DEF(SSTACK);
+
+static volatile bool stack_guard_hit;
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: stack_paint
+//
+// DESCRIPTION:
+//    This function fills the unused stack with STACK_PAINT. It runs before
+//    Init(), so it mustn't rely on any global variable.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void stack_paint(void)
+{
+  uint8  here;                      // the deepest the stack is now
+  uint8* byte;
+
+  for (byte = STACK_BOTTOM; byte < &here - STACK_PAINT_MARGIN; byte++)
+  {
+    *byte = STACK_PAINT;
+  } /* for */
+
+} /* stack_paint */
+
+
+//----------------------------------------------------------------------------
+// NAME: stack_size
+//
+// DESCRIPTION:
+//    This function gives the size of the SSTACK segment.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   bytes, STACKSIZE in the PRM file
+//----------------------------------------------------------------------------
+uint16 stack_size(void)
+{
+
+  return ((uint16)(STACK_TOP - STACK_BOTTOM));
+
+} /* stack_size */
+
+
+//----------------------------------------------------------------------------
+// NAME: stack_used
+//
+// DESCRIPTION:
+//    This function finds the deepest the stack has been since reset, by
+//    counting the painted bytes left at the bottom.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   bytes used at most
+//----------------------------------------------------------------------------
+uint16 stack_used(void)
+{
+  const uint8* byte = STACK_BOTTOM;
+
+  while ((byte < STACK_TOP) && (*byte == STACK_PAINT))
+  {
+    byte++;
+  } /* while */
+
+  return ((uint16)(STACK_TOP - byte));
+
+} /* stack_used */
+
+
+//----------------------------------------------------------------------------
+// NAME: stack_check
+//
+// DESCRIPTION:
+//    This function looks at the guard bytes at the bottom of the stack
+//    and remembers if any was written. The tick ISR calls it, so an
+//    overflow is seen within a tick of the code that caused it.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void stack_check(void)
+{
+  uint8 i;
+
+  for (i = 0; i < STACK_GUARD_SIZE; i++)
+  {
+    if (STACK_BOTTOM[i] != STACK_PAINT)
+    {
+      stack_guard_hit = TRUE;
+    } /* if */
+  } /* for */
+
+} /* stack_check */
+
+
+//----------------------------------------------------------------------------
+// NAME: stack_overflowed
+//
+// DESCRIPTION:
+//    This function tells if the stack has reached its guard bytes. It
+//    also looks at them itself, for when the tick ISR doesn't.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if a guard byte was written since reset
+//----------------------------------------------------------------------------
+bool stack_overflowed(void)
+{
+
+  return (stack_guard_hit ||
+          (stack_used() > stack_size() - STACK_GUARD_SIZE));
+
+} /* stack_overflowed */
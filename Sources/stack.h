@@ -0,0 +1,53 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: stack.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for measuring the stack. The start
+//    up code paints the SSTACK segment with a known byte; the deepest the
+//    stack has been is then found by looking for the first byte that
+//    isn't paint any more. A guard at the bottom of the stack can be
+//    checked from the tick ISR to catch an overflow when it happens.
+//
+//*****************************************************************************
+
+#ifndef _STACK_H_
+#define _STACK_H_
+
+#include "sys_types.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define STACK_PAINT             0xA5
+
+// Bytes at the bottom of SSTACK that must never be written. The stack
+// grows down towards them, and below SSTACK is EEPROM, so a write past
+// the bottom is lost without a trace.
+#define STACK_GUARD_SIZE        8
+
+// Set to 0 to leave the guard check out of the tick ISR
+#ifndef STACK_GUARD_CHECK
+#define STACK_GUARD_CHECK       1
+#endif
+
+// Deeper than this share of SSTACK is reported as a warning
+#define STACK_WARN_PERCENT      75
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+void   stack_paint(void);
+uint16 stack_size(void);
+uint16 stack_used(void);
+void   stack_check(void);
+bool   stack_overflowed(void);
+
+#endif /* _STACK_H_ */
@@ -0,0 +1,307 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: status.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file implements the system status engine. Reacting to single
+//    samples made borderline readings flap between levels, so each step:
+//
+//      1) The threat score moves towards demand * STATUS_SCORE_PER_LEVEL,
+//         quickly when rising and slowly when falling.
+//      2) The engine steps up to the highest level whose entry score has
+//         been reached.
+//      3) If the demand has held at the current level for that level's
+//         escalation time, the engine steps up one level anyway.
+//      4) Once the score falls below the current level's exit score and
+//         the minimum dwell time has passed, the engine steps down one
+//         level. Each level has its own dwell, so de-escalating all the
+//         way takes the sum of the dwell times.
+//
+//    The engine only keeps state; the caller acts on the level whenever a
+//    step reports a transition.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include "status.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define STATUS_SCORE_MAX        255
+#define STATUS_DWELL_MAX        0xFFFF
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+static void status_enter(STATUS_ENGINE_t* engine, uint8 level);
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: status_init
+//
+// DESCRIPTION:
+//    This function starts the engine at STATUS_LEVEL_GOOD.
+//
+// INPUT:
+//   engine - the engine to initialize
+//   config - STATUS_LEVELS entries, indexed by level
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void status_init(STATUS_ENGINE_t* engine, const STATUS_LEVEL_CONFIG_t* config)
+{
+
+  engine->config = config;
+  engine->score = 0;
+  status_enter(engine, STATUS_LEVEL_GOOD);
+
+} /* status_init */
+
+
+//----------------------------------------------------------------------------
+// NAME: status_step
+//
+// DESCRIPTION:
+//    This function advances the engine by one step.
+//
+// INPUT:
+//   engine - the engine
+//   demand - the worst level the sensors are asking for right now
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if the level changed
+//----------------------------------------------------------------------------
+bool status_step(STATUS_ENGINE_t* engine, uint8 demand)
+{
+  const STATUS_LEVEL_CONFIG_t* config = engine->config;
+  uint16 target;
+  uint8  level;
+
+  if (demand >= STATUS_LEVELS)
+  {
+    demand = STATUS_LEVELS - 1;
+  } /* if */
+
+  // 1) Move the score towards the demand
+  target = (uint16)demand * STATUS_SCORE_PER_LEVEL;
+  if (target > STATUS_SCORE_MAX)
+  {
+    target = STATUS_SCORE_MAX;
+  } /* if */
+
+  if (engine->score < target)
+  {
+    engine->score = (target - engine->score > STATUS_SCORE_ATTACK)
+                  ? (engine->score + STATUS_SCORE_ATTACK) : (uint8)target;
+  } /* if */
+  else if (engine->score > target)
+  {
+    engine->score = (engine->score - target > STATUS_SCORE_RELEASE)
+                  ? (engine->score - STATUS_SCORE_RELEASE) : (uint8)target;
+  } /* else if */
+
+  if (engine->dwell < STATUS_DWELL_MAX)
+  {
+    engine->dwell++;
+  } /* if */
+
+  // 2) Step up on score
+  for (level = STATUS_LEVELS - 1; level > engine->level; level--)
+  {
+    if (engine->score >= config[level].enter_score)
+    {
+      status_enter(engine, level);
+      return (TRUE);
+    } /* if */
+  } /* for */
+
+  // 3) Step up on time
+  if ((demand >= engine->level) && (engine->level > STATUS_LEVEL_GOOD))
+  {
+    engine->sustain++;
+    if ((config[engine->level].escalate_after != 0) &&
+        (engine->sustain >= config[engine->level].escalate_after) &&
+        (engine->level < STATUS_LEVELS - 1))
+    {
+      level = engine->level + 1;
+      if (engine->score < config[level].enter_score)
+      {
+        engine->score = config[level].enter_score;
+      } /* if */
+      status_enter(engine, level);
+      return (TRUE);
+    } /* if */
+  } /* if */
+  else
+  {
+    engine->sustain = 0;
+  } /* else */
+
+  // 4) Step down once the score has cleared the exit level and dwelt
+  if ((engine->level > STATUS_LEVEL_GOOD) &&
+      (engine->score < config[engine->level].exit_score) &&
+      (engine->dwell >= config[engine->level].min_dwell))
+  {
+    status_enter(engine, engine->level - 1);
+    return (TRUE);
+  } /* if */
+
+  return (FALSE);
+
+} /* status_step */
+
+
+//----------------------------------------------------------------------------
+// NAME: status_force
+//
+// DESCRIPTION:
+//    This function raises the engine straight to a level for events that
+//    must not wait for the score (a knock, a command). It never lowers the
+//    level; forcing the current level restarts its dwell time.
+//
+// INPUT:
+//   engine - the engine
+//   level  - the level to raise to
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if the level changed
+//----------------------------------------------------------------------------
+bool status_force(STATUS_ENGINE_t* engine, uint8 level)
+{
+  uint16 score;
+
+  if (level >= STATUS_LEVELS)
+  {
+    level = STATUS_LEVELS - 1;
+  } /* if */
+
+  if (level < engine->level)
+  {
+    return (FALSE);
+  } /* if */
+
+  score = (uint16)level * STATUS_SCORE_PER_LEVEL;
+  if (score > STATUS_SCORE_MAX)
+  {
+    score = STATUS_SCORE_MAX;
+  } /* if */
+  if (engine->score < score)
+  {
+    engine->score = (uint8)score;
+  } /* if */
+
+  if (level == engine->level)
+  {
+    engine->dwell = 0;
+    return (FALSE);
+  } /* if */
+
+  status_enter(engine, level);
+
+  return (TRUE);
+
+} /* status_force */
+
+
+//----------------------------------------------------------------------------
+// NAME: status_level
+//
+// DESCRIPTION:
+//    This function returns the current level.
+//
+// INPUT:
+//   engine - the engine
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   STATUS_LEVEL_GOOD, STATUS_LEVEL_OK or STATUS_LEVEL_BAD
+//----------------------------------------------------------------------------
+uint8 status_level(const STATUS_ENGINE_t* engine)
+{
+
+  return (engine->level);
+
+} /* status_level */
+
+
+//----------------------------------------------------------------------------
+// NAME: status_score
+//
+// DESCRIPTION:
+//    This function returns the current threat score.
+//
+// INPUT:
+//   engine - the engine
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the score, 0 to 255
+//----------------------------------------------------------------------------
+uint8 status_score(const STATUS_ENGINE_t* engine)
+{
+
+  return (engine->score);
+
+} /* status_score */
+
+
+//-----------------------------------------------------------------------------
+//                             Private functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: status_enter
+//
+// DESCRIPTION:
+//    This function moves the engine to a level and restarts its timers.
+//
+// INPUT:
+//   engine - the engine
+//   level  - the new level
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void status_enter(STATUS_ENGINE_t* engine, uint8 level)
+{
+
+  engine->level = level;
+  engine->dwell = 0;
+  engine->sustain = 0;
+
+} /* status_enter */
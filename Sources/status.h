@@ -0,0 +1,76 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: status.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for the system status engine. The
+//    engine turns a stream of per step sensor demands into a stable status
+//    level using a threat score with per level entry/exit hysteresis,
+//    minimum dwell times and an escalation timer.
+//
+//*****************************************************************************
+
+#ifndef _STATUS_H_
+#define _STATUS_H_
+
+#include "sys_types.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// Status levels, in order of severity
+#define STATUS_LEVEL_GOOD       0
+#define STATUS_LEVEL_OK         1
+#define STATUS_LEVEL_BAD        2
+#define STATUS_LEVELS           3
+
+// The engine is stepped at a fixed period; times are given in steps
+#define STATUS_STEP_MS          100
+#define STATUS_MS_TO_STEPS(ms)  ((ms) / STATUS_STEP_MS)
+
+// Score each demand level pulls the threat score towards
+#define STATUS_SCORE_PER_LEVEL  100
+
+// Score change per step while rising (fast) and falling (slow)
+#define STATUS_SCORE_ATTACK     25
+#define STATUS_SCORE_RELEASE    5
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  uint8  enter_score;       // score needed to enter the level
+  uint8  exit_score;        // score must fall below this to leave the level
+  uint16 min_dwell;         // steps before the level may be left
+  uint16 escalate_after;    // steps of sustained demand before stepping up,
+                            // 0 to never escalate on time alone
+} STATUS_LEVEL_CONFIG_t;
+
+typedef struct
+{
+  const STATUS_LEVEL_CONFIG_t* config;  // one entry per level
+  uint8  level;             // current STATUS_LEVEL_*
+  uint8  score;             // threat score, 0 to 255
+  uint16 dwell;             // steps spent at the current level
+  uint16 sustain;           // steps the demand has held at the current level
+} STATUS_ENGINE_t;
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+void  status_init(STATUS_ENGINE_t* engine, const STATUS_LEVEL_CONFIG_t* config);
+bool  status_step(STATUS_ENGINE_t* engine, uint8 demand);
+bool  status_force(STATUS_ENGINE_t* engine, uint8 level);
+uint8 status_level(const STATUS_ENGINE_t* engine);
+uint8 status_score(const STATUS_ENGINE_t* engine);
+
+#endif /* _STATUS_H_ */
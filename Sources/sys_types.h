@@ -0,0 +1,52 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: sys_types.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the embedded data types shared by the security
+//    system modules. The definitions are identical to the ones found in
+//    csc202_lab_support.h and RFID_rc522.h so the headers can be mixed.
+//
+//*****************************************************************************
+
+#ifndef _SYS_TYPES_H_
+#define _SYS_TYPES_H_
+
+//-----------------------------------------------------------------------------
+//                        Define Embedded Data Types
+//-----------------------------------------------------------------------------
+
+//  Integer Types
+typedef   signed char       sint8;      // signed 8 bit values
+typedef unsigned char       uint8;      // unsigned 8 bit values
+typedef   signed short int  sint16;     // signed 16 bit values
+typedef unsigned short int  uint16;     // unsigned 16 bit values
+#ifdef HOST_TEST
+typedef   signed int        sint32;     // long is 64 bits on the test host
+typedef unsigned int        uint32;
+#else
+typedef   signed long  int  sint32;     // signed 32 bit values
+typedef unsigned long  int  uint32;     // unsigned 32 bit values
+#endif
+
+typedef unsigned short bool;            // Boolean
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#ifndef FALSE
+#define FALSE     0
+#endif
+
+#ifndef TRUE
+#define TRUE      1
+#endif
+
+#endif /* _SYS_TYPES_H_ */
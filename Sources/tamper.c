@@ -0,0 +1,362 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: tamper.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file implements the accelerometer tamper detection pipeline. It is
+//    called from the tick interrupt a few hundred times a second and does
+//    the following for each sample:
+//
+//      1) Reads X, Y and Z from the AD1 sequence started on the previous
+//         call and immediately starts the next one, so the interrupt never
+//         waits on the converter.
+//      2) Tracks the static gravity vector with a slow low pass filter and
+//         subtracts it (high pass), leaving only the dynamic acceleration.
+//      3) Computes the squared magnitude of the dynamic acceleration (tilt)
+//         and of its sample to sample difference (jerk, a knock).
+//      4) Queues a time stamped event when either crosses its threshold.
+//
+//    All filter state is 16-bit; only the squared magnitudes use 32 bits.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include <mc9s12dg256.h>            // derivative information
+#include "tamper.h"
+#include "timebase.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// Gravity estimate is kept in Q5 so a 10-bit reading fits a sint16
+#define GRAVITY_FRAC_BITS       5
+
+// Low pass weight 1/128: time constant of about half a second at 244 Hz
+#define GRAVITY_SHIFT           7
+
+// Samples ignored after start up while the gravity estimate settles
+#define SETTLE_SAMPLES          64
+
+// Samples to wait after an event before raising another (~250 ms)
+#define HOLDOFF_SAMPLES         61
+
+// ATD1CTL5: right justified, multichannel, starting at channel X
+#define ATD_START_XYZ           (0x90 | TAMPER_X_CHANNEL)
+#define ATD_SEQUENCE_DONE       0x80
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+static sint16 gravity[3];           // Q5 gravity estimate per axis
+static sint16 previous[3];          // previous dynamic acceleration
+static uint8  settle_count;
+static uint8  holdoff_count;
+static uint16 peak_level;           // largest |x|+|y|+|z| since last read
+static uint16 dropped_events;
+
+static TAMPER_EVENT_t event_queue[TAMPER_QUEUE_SIZE];
+static volatile uint8 event_head;   // written by the interrupt only
+static volatile uint8 event_tail;   // written by the main loop only
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+static void   tamper_queue_event(uint8 type, uint32 magnitude);
+static uint16 tamper_abs(sint16 value);
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: tamper_init
+//
+// DESCRIPTION:
+//    This function resets the detector and starts the first AD1 conversion
+//    sequence. ad1_enable() must have been called first.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void tamper_init(void)
+{
+  uint8 axis;
+
+  for (axis = 0; axis < 3; axis++)
+  {
+    gravity[axis] = 0;
+    previous[axis] = 0;
+  } /* for */
+
+  settle_count = 0;
+  holdoff_count = 0;
+  peak_level = 0;
+  dropped_events = 0;
+  event_head = 0;
+  event_tail = 0;
+
+  ATD1CTL5 = ATD_START_XYZ;
+
+} /* tamper_init */
+
+
+//----------------------------------------------------------------------------
+// NAME: tamper_sample
+//
+// DESCRIPTION:
+//    This function runs one step of the pipeline. It is meant to be called
+//    from the tick interrupt at a fixed rate.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void tamper_sample(void)
+{
+  sint16 reading[3];
+  sint16 dynamic;
+  sint16 jerk;
+  uint32 tilt2 = 0;
+  uint32 jerk2 = 0;
+  uint16 level = 0;
+  uint8  axis;
+
+  // The sequence started last time is long finished; if not, skip a sample
+  if (!(ATD1STAT0 & ATD_SEQUENCE_DONE))
+  {
+    return;
+  } /* if */
+
+  reading[0] = (sint16)ATD1DR0;
+  reading[1] = (sint16)ATD1DR1;
+  reading[2] = (sint16)ATD1DR2;
+  ATD1CTL5 = ATD_START_XYZ;
+
+  for (axis = 0; axis < 3; axis++)
+  {
+    // Seed the gravity estimate with the first reading
+    if (settle_count == 0)
+    {
+      gravity[axis] = reading[axis] << GRAVITY_FRAC_BITS;
+    } /* if */
+
+    gravity[axis] += ((reading[axis] << GRAVITY_FRAC_BITS) - gravity[axis]) >> GRAVITY_SHIFT;
+
+    dynamic = reading[axis] - (gravity[axis] >> GRAVITY_FRAC_BITS);
+    jerk = dynamic - previous[axis];
+    previous[axis] = dynamic;
+
+    tilt2 += (uint32)((sint32)dynamic * dynamic);
+    jerk2 += (uint32)((sint32)jerk * jerk);
+    level += tamper_abs(dynamic);
+  } /* for */
+
+  if (level > peak_level)
+  {
+    peak_level = level;
+  } /* if */
+
+  if (settle_count < SETTLE_SAMPLES)
+  {
+    settle_count++;
+    return;
+  } /* if */
+
+  if (holdoff_count > 0)
+  {
+    holdoff_count--;
+  } /* if */
+  else if (jerk2 > TAMPER_KNOCK_THRESHOLD)
+  {
+    tamper_queue_event(TAMPER_KNOCK, jerk2);
+    holdoff_count = HOLDOFF_SAMPLES;
+  } /* else if */
+  else if (tilt2 > TAMPER_TILT_THRESHOLD)
+  {
+    tamper_queue_event(TAMPER_TILT, tilt2);
+    holdoff_count = HOLDOFF_SAMPLES;
+  } /* else if */
+
+} /* tamper_sample */
+
+
+//----------------------------------------------------------------------------
+// NAME: tamper_get_event
+//
+// DESCRIPTION:
+//    This function removes the oldest tamper event from the queue. The queue
+//    has a single producer (the interrupt) and a single consumer (the main
+//    loop) so no interrupt masking is needed.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   event - the oldest event, if there is one
+//
+// RETURN:
+//   TRUE if an event was returned, FALSE if the queue was empty
+//----------------------------------------------------------------------------
+bool tamper_get_event(TAMPER_EVENT_t* event)
+{
+  uint8 tail = event_tail;
+
+  if (tail == event_head)
+  {
+    return (FALSE);
+  } /* if */
+
+  *event = event_queue[tail];
+  event_tail = (tail + 1) & (TAMPER_QUEUE_SIZE - 1);
+
+  return (TRUE);
+
+} /* tamper_get_event */
+
+
+//----------------------------------------------------------------------------
+// NAME: tamper_motion_level
+//
+// DESCRIPTION:
+//    This function returns the largest dynamic acceleration (|x|+|y|+|z|
+//    with gravity removed) seen since the previous call, then restarts the
+//    peak. Unlike a raw sum of the axes it does not depend on how the board
+//    is oriented.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the peak motion level in ADC counts
+//----------------------------------------------------------------------------
+uint16 tamper_motion_level(void)
+{
+  uint16 level = peak_level;
+
+  peak_level = 0;
+
+  return (level);
+
+} /* tamper_motion_level */
+
+
+//----------------------------------------------------------------------------
+// NAME: tamper_dropped_events
+//
+// DESCRIPTION:
+//    This function returns how many events were lost to a full queue.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the number of dropped events
+//----------------------------------------------------------------------------
+uint16 tamper_dropped_events(void)
+{
+
+  return (dropped_events);
+
+} /* tamper_dropped_events */
+
+
+//-----------------------------------------------------------------------------
+//                             Private functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: tamper_queue_event
+//
+// DESCRIPTION:
+//    This function adds an event to the queue, stamped with the
+//    millisecond clock, dropping it if the queue is full.
+//
+// INPUT:
+//   type      - TAMPER_KNOCK or TAMPER_TILT
+//   magnitude - the squared magnitude that crossed the threshold
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void tamper_queue_event(uint8 type, uint32 magnitude)
+{
+  uint8 head = event_head;
+  uint8 next = (head + 1) & (TAMPER_QUEUE_SIZE - 1);
+
+  if (next == event_tail)
+  {
+    dropped_events++;
+    return;
+  } /* if */
+
+  magnitude >>= 4;
+  if (magnitude > 0xFFFF)
+  {
+    magnitude = 0xFFFF;
+  } /* if */
+
+  event_queue[head].timestamp = timebase_ms();
+  event_queue[head].type = type;
+  event_queue[head].magnitude = (uint16)magnitude;
+  event_head = next;
+
+} /* tamper_queue_event */
+
+
+//----------------------------------------------------------------------------
+// NAME: tamper_abs
+//
+// DESCRIPTION:
+//    This function returns the absolute value of a 16-bit value.
+//
+// INPUT:
+//   value - a signed value
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the absolute value
+//----------------------------------------------------------------------------
+static uint16 tamper_abs(sint16 value)
+{
+
+  return ((value < 0) ? (uint16)(-value) : (uint16)value);
+
+} /* tamper_abs */
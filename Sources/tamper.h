@@ -0,0 +1,62 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: tamper.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for the accelerometer tamper
+//    detector. The detector runs from the periodic tick interrupt and
+//    queues time stamped knock and tilt events for the main loop.
+//
+//*****************************************************************************
+
+#ifndef _TAMPER_H_
+#define _TAMPER_H_
+
+#include "sys_types.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// Tamper event types
+#define TAMPER_KNOCK            1       // sharp change in acceleration (jerk)
+#define TAMPER_TILT             2       // board moved away from rest position
+
+// Accelerometer channels on AD1
+#define TAMPER_X_CHANNEL        0
+#define TAMPER_Y_CHANNEL        1
+#define TAMPER_Z_CHANNEL        2
+
+// Squared magnitude thresholds in ADC counts^2 (about 160 counts per g)
+#define TAMPER_KNOCK_THRESHOLD  2304UL  // |jerk| > 48 counts per sample
+#define TAMPER_TILT_THRESHOLD   4096UL  // |dynamic accel| > 64 counts
+
+#define TAMPER_QUEUE_SIZE       8       // must be a power of 2
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  uint32 timestamp;     // timebase_ms() when the event was detected
+  uint8  type;          // TAMPER_KNOCK or TAMPER_TILT
+  uint16 magnitude;     // squared magnitude / 16, saturated
+} TAMPER_EVENT_t;
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+void   tamper_init(void);
+void   tamper_sample(void);
+bool   tamper_get_event(TAMPER_EVENT_t* event);
+uint16 tamper_motion_level(void);
+uint16 tamper_dropped_events(void);
+
+#endif /* _TAMPER_H_ */
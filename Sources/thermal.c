@@ -0,0 +1,396 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: thermal.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file implements the temperature subsystem. The LM35 on AD0
+//    channel 5 gives 10 mV per degree C, about 2 counts per degree with a
+//    5 V reference. The old conversion, (raw / 2) * 9 / 5 + 32 in a uint8,
+//    wrapped above about 124 F; here every reading is a sint16 in tenths of
+//    a degree F, which holds the sensor's whole range (32 F to 932 F).
+//
+//    The tick interrupt hands every cached temperature reading to
+//    thermal_sample(), which:
+//
+//      1) Averages THERMAL_SAMPLE_TICKS readings into one window sample,
+//         keeping four extra bits of resolution.
+//      2) Converts it with a precomputed lookup table and linear
+//         interpolation, so no division or floating point is needed.
+//      3) Fits a least squares line through the last THERMAL_WINDOW
+//         samples (about 34 s) and stores its slope as the rate of rise.
+//
+//    With the window centred the fit reduces to one weighted sum:
+//
+//      slope = 2 * sum(w[k] * y[k]) / sum(w[k]^2),  w[k] = 2k - (N - 1)
+//
+//    The slope and temperature are single 16-bit values, so the main loop
+//    reads them without masking interrupts.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include "thermal.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// Averaged samples carry 4 fractional bits: sum of 1024 readings >> 6
+#define SAMPLE_SUM_SHIFT        6
+#define SAMPLE_FRAC_BITS        4
+
+// Lookup table spacing: one entry every 32 counts (512 in 1/16 counts)
+#define TABLE_STEP_SHIFT        9
+#define TABLE_STEP_MASK         0x1FF
+
+// sum(w[k]^2) = N(N^2 - 1)/3 for N = 32, times the 1.049 s sample period
+// so that 120 * sum(w[k] * y[k]) / RATE_DIVISOR is tenths of a degree per
+// minute (2 for the slope formula times 60 s per minute)
+#define RATE_NUMERATOR          120L
+#define RATE_DIVISOR            11442L
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+// Tenths of a degree F for raw = 0, 32, 64, ... 1024:
+// (raw * 500 / 1024) degrees C converted to F, rounded
+static const sint16 tenths_table[33] =
+{
+    320,   601,   882,  1164,  1445,  1726,  2008,  2289,
+   2570,  2851,  3132,  3414,  3695,  3976,  4258,  4539,
+   4820,  5101,  5382,  5664,  5945,  6226,  6508,  6789,
+   7070,  7351,  7632,  7914,  8195,  8476,  8758,  9039,
+   9320
+};
+
+static uint32 sample_sum;
+static uint16 sample_count;
+
+static sint16 window[THERMAL_WINDOW];   // tenths of a degree F
+static uint8  window_head;              // next slot, also the oldest sample
+static uint8  window_fill;
+
+static volatile sint16 temperature;     // latest window sample
+static volatile sint16 rate;            // tenths of a degree F per minute
+static volatile bool   rate_ready;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+static sint16 thermal_interpolate(uint16 sixteenths);
+static sint16 thermal_slope(void);
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: thermal_init
+//
+// DESCRIPTION:
+//    This function clears the averaging and the slope window.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void thermal_init(void)
+{
+
+  rate_ready = FALSE;
+  rate = 0;
+  temperature = 0;
+  sample_sum = 0;
+  sample_count = 0;
+  window_head = 0;
+  window_fill = 0;
+
+} /* thermal_init */
+
+
+//----------------------------------------------------------------------------
+// NAME: thermal_sample
+//
+// DESCRIPTION:
+//    This function adds one raw reading to the running average and, once a
+//    full average is collected, pushes it into the window and updates the
+//    rate of rise. It is called from the tick interrupt on every tick.
+//
+// INPUT:
+//   raw - the temperature channel reading (10-bit ADC counts)
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void thermal_sample(uint16 raw)
+{
+  sint16 tenths;
+
+  sample_sum += raw;
+  if (++sample_count < THERMAL_SAMPLE_TICKS)
+  {
+    return;
+  } /* if */
+
+  tenths = thermal_interpolate((uint16)(sample_sum >> SAMPLE_SUM_SHIFT));
+  sample_sum = 0;
+  sample_count = 0;
+
+  window[window_head] = tenths;
+  window_head = (window_head + 1) & (THERMAL_WINDOW - 1);
+  temperature = tenths;
+
+  if (window_fill < THERMAL_WINDOW)
+  {
+    window_fill++;
+    if (window_fill < THERMAL_WINDOW)
+    {
+      return;
+    } /* if */
+  } /* if */
+
+  rate = thermal_slope();
+  rate_ready = TRUE;
+
+} /* thermal_sample */
+
+
+//----------------------------------------------------------------------------
+// NAME: thermal_convert
+//
+// DESCRIPTION:
+//    This function converts a single raw reading to tenths of a degree F.
+//
+// INPUT:
+//   raw - the temperature channel reading (10-bit ADC counts)
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the temperature in tenths of a degree F
+//----------------------------------------------------------------------------
+sint16 thermal_convert(uint16 raw)
+{
+
+  return (thermal_interpolate(raw << SAMPLE_FRAC_BITS));
+
+} /* thermal_convert */
+
+
+//----------------------------------------------------------------------------
+// NAME: thermal_temperature
+//
+// DESCRIPTION:
+//    This function returns the most recent averaged temperature. It is 0
+//    until the first average (about a second after start up) is ready.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the temperature in tenths of a degree F
+//----------------------------------------------------------------------------
+sint16 thermal_temperature(void)
+{
+
+  return (temperature);
+
+} /* thermal_temperature */
+
+
+//----------------------------------------------------------------------------
+// NAME: thermal_rate
+//
+// DESCRIPTION:
+//    This function returns the rate of rise over the last window.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the rate in tenths of a degree F per minute (negative when cooling)
+//----------------------------------------------------------------------------
+sint16 thermal_rate(void)
+{
+
+  return (rate);
+
+} /* thermal_rate */
+
+
+//----------------------------------------------------------------------------
+// NAME: thermal_rate_ready
+//
+// DESCRIPTION:
+//    This function reports whether the window has filled since start up.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE once thermal_rate() is meaningful
+//----------------------------------------------------------------------------
+bool thermal_rate_ready(void)
+{
+
+  return (rate_ready);
+
+} /* thermal_rate_ready */
+
+
+//----------------------------------------------------------------------------
+// NAME: thermal_rate_status
+//
+// DESCRIPTION:
+//    This function classifies the current rate of rise.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   THERMAL_ROR_NONE, THERMAL_ROR_SUSPECT or THERMAL_ROR_ALARM
+//----------------------------------------------------------------------------
+uint8 thermal_rate_status(void)
+{
+  sint16 current = rate;
+
+  if (!rate_ready)
+  {
+    return (THERMAL_ROR_NONE);
+  } /* if */
+
+  if (current >= THERMAL_ROR_ALARM_RATE)
+  {
+    return (THERMAL_ROR_ALARM);
+  } /* if */
+
+  if (current >= THERMAL_ROR_SUSPECT_RATE)
+  {
+    return (THERMAL_ROR_SUSPECT);
+  } /* if */
+
+  return (THERMAL_ROR_NONE);
+
+} /* thermal_rate_status */
+
+
+//-----------------------------------------------------------------------------
+//                             Private functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: thermal_interpolate
+//
+// DESCRIPTION:
+//    This function looks a reading up in the table and interpolates between
+//    the two nearest entries.
+//
+// INPUT:
+//   sixteenths - the reading in 1/16 ADC counts (0 to 16368)
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the temperature in tenths of a degree F
+//----------------------------------------------------------------------------
+static sint16 thermal_interpolate(uint16 sixteenths)
+{
+  uint8  index = (uint8)(sixteenths >> TABLE_STEP_SHIFT);
+  uint16 frac = sixteenths & TABLE_STEP_MASK;
+  sint16 step;
+
+  if (index >= 32)
+  {
+    return (tenths_table[32]);
+  } /* if */
+
+  step = tenths_table[index + 1] - tenths_table[index];
+
+  return (tenths_table[index] + (sint16)(((sint32)step * frac) >> TABLE_STEP_SHIFT));
+
+} /* thermal_interpolate */
+
+
+//----------------------------------------------------------------------------
+// NAME: thermal_slope
+//
+// DESCRIPTION:
+//    This function fits a line through the window and returns its slope.
+//    Each term is at most 31 * 9320, so the sum fits easily in 32 bits.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the slope in tenths of a degree F per minute, saturated to 16 bits
+//----------------------------------------------------------------------------
+static sint16 thermal_slope(void)
+{
+  sint32 weighted = 0;
+  sint16 weight = -(THERMAL_WINDOW - 1);
+  uint8  slot = window_head;
+  uint8  k;
+
+  // Oldest sample first, weights -31, -29, ... 29, 31
+  for (k = 0; k < THERMAL_WINDOW; k++)
+  {
+    weighted += (sint32)weight * window[slot];
+    weight += 2;
+    slot = (slot + 1) & (THERMAL_WINDOW - 1);
+  } /* for */
+
+  weighted = (weighted * RATE_NUMERATOR) / RATE_DIVISOR;
+
+  if (weighted > 32767L)
+  {
+    return (32767);
+  } /* if */
+
+  if (weighted < -32767L)
+  {
+    return (-32767);
+  } /* if */
+
+  return ((sint16)weighted);
+
+} /* thermal_slope */
@@ -0,0 +1,53 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: thermal.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for the temperature subsystem. The
+//    temperature is kept in tenths of a degree Fahrenheit in a sint16, and
+//    a sliding window slope estimator reports how fast it is rising so a
+//    fire can be caught before the absolute threshold is reached.
+//
+//*****************************************************************************
+
+#ifndef _THERMAL_H_
+#define _THERMAL_H_
+
+#include "sys_types.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// Rate of rise classes
+#define THERMAL_ROR_NONE        0       // steady or falling
+#define THERMAL_ROR_SUSPECT     1       // rising faster than normal heating
+#define THERMAL_ROR_ALARM       2       // rising like a fire
+
+// Rate of rise thresholds in tenths of a degree F per minute. The alarm
+// sits a little under the 15 F per minute commercial heat detectors use.
+#define THERMAL_ROR_SUSPECT_RATE  60
+#define THERMAL_ROR_ALARM_RATE    120
+
+// Ticks averaged into one window sample (1.049 s) and samples per window
+#define THERMAL_SAMPLE_TICKS    1024
+#define THERMAL_WINDOW          32
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+void   thermal_init(void);
+void   thermal_sample(uint16 raw);
+sint16 thermal_convert(uint16 raw);
+sint16 thermal_temperature(void);
+sint16 thermal_rate(void);
+bool   thermal_rate_ready(void);
+uint8  thermal_rate_status(void);
+
+#endif /* _THERMAL_H_ */
@@ -0,0 +1,686 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: timebase.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file implements the system timebase.
+//
+//    Clock: the 16-bit timer counter (TCNT) free runs at 1.5 MHz and wraps
+//    every 43.7 ms. timebase_tick() is called from the 1.024 ms real-time
+//    interrupt and folds the counts since the last call into 32-bit
+//    microsecond and millisecond totals, carrying the 2/3 us per count
+//    remainder so no time is lost. A read adds the counts since the last
+//    tick, so both clocks have the resolution of the counter. The us clock
+//    wraps every 71 minutes and the ms clock every 49 days; compare them
+//    by subtraction.
+//
+//    Wall clock: rtc_set() pins a date and time to the ms clock. Reading
+//    it is the set time plus the ms elapsed since. Until it is set it
+//    counts from the epoch at start up.
+//
+//    Timer wheel: running timers hang off one of 64 slots, one slot per
+//    10 ms. Starting and cancelling a timer is O(1) whatever the number of
+//    timers; timebase_service() visits one slot per 10 ms and runs the
+//    callbacks that are due. Callbacks run in the main loop, not in an
+//    interrupt, and may restart or cancel any timer.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include <stddef.h>                 // NULL
+#include <mc9s12dg256.h>            // derivative information
+#include "timebase.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define TIMER_ENABLE            0x80    // TSCR1 TEN
+#define PRESCALER_MASK          0x07    // TSCR2 PR2:PR0
+
+#define US_PER_MS               1000
+#define MS_PER_SECOND           1000UL
+#define SECONDS_PER_DAY         86400UL
+
+// The wall clock is moved up to the ms clock every hour so that the ms
+// difference never gets near its wrap
+#define RTC_REANCHOR_MS         3600000UL
+
+#define WHEEL_MASK              (TIMER_WHEEL_SLOTS - 1)
+#define MAX_ROUNDS              0xFFFF
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+// Written by timebase_tick() only
+static volatile uint32 clock_us;
+static volatile uint32 clock_ms;
+static volatile uint16 clock_ms_us;     // us past clock_ms
+static volatile uint16 clock_count;     // TCNT at the last tick
+static volatile uint8  clock_thirds;    // 1/3 us not yet in clock_us
+
+static bool   rtc_valid;
+static uint32 rtc_anchor_seconds;       // wall clock at rtc_anchor_ms
+static uint32 rtc_anchor_ms;
+
+static TIMER_t* wheel[TIMER_WHEEL_SLOTS];
+static uint8    wheel_slot;             // last slot visited
+static uint32   wheel_time;             // ms when it was visited
+static TIMER_t* wheel_next;             // next timer in the slot being run
+
+static const uint8 days_in_month[12] =
+{
+  31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+};
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+static void  timebase_expire(uint8 slot);
+static bool  rtc_is_leap(uint16 year);
+static uint8 rtc_month_days(uint16 year, uint8 month);
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: timebase_init
+//
+// DESCRIPTION:
+//    This function starts the timer counter and zeroes the clocks. It must
+//    be called before the real-time interrupt is enabled.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void timebase_init(void)
+{
+  uint8 slot;
+
+  TSCR2 = (TSCR2 & ~PRESCALER_MASK) | TIMEBASE_PRESCALER;
+  TSCR1 |= TIMER_ENABLE;
+
+  clock_us = 0;
+  clock_ms = 0;
+  clock_ms_us = 0;
+  clock_thirds = 0;
+  clock_count = TCNT;
+
+  rtc_valid = FALSE;
+  rtc_anchor_seconds = 0;
+  rtc_anchor_ms = 0;
+
+  for (slot = 0; slot < TIMER_WHEEL_SLOTS; slot++)
+  {
+    wheel[slot] = NULL;
+  } /* for */
+  wheel_slot = 0;
+  wheel_time = 0;
+  wheel_next = NULL;
+
+} /* timebase_init */
+
+
+//----------------------------------------------------------------------------
+// NAME: timebase_tick
+//
+// DESCRIPTION:
+//    This function adds the timer counts since the last call to the
+//    clocks. It is called from the real-time interrupt and must run at
+//    least once per counter wrap (43.7 ms).
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void timebase_tick(void)
+{
+  uint16 count = TCNT;
+  uint32 thirds;
+  uint16 us;
+
+  // 1.5 counts per us, so each count is 2/3 us
+  thirds = (uint32)(uint16)(count - clock_count) * 2 + clock_thirds;
+  us = (uint16)(thirds / 3);
+  clock_thirds = (uint8)(thirds % 3);
+  clock_count = count;
+
+  clock_ms_us += us;
+  while (clock_ms_us >= US_PER_MS)
+  {
+    clock_ms_us -= US_PER_MS;
+    clock_ms++;
+  } /* while */
+
+  // Last, so a reader that sees it unchanged saw a consistent set
+  clock_us += us;
+
+} /* timebase_tick */
+
+
+//----------------------------------------------------------------------------
+// NAME: timebase_us
+//
+// DESCRIPTION:
+//    This function returns the microsecond clock. It is safe to call from
+//    both the main loop and interrupts.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   us since start up, wrapping every 71 minutes
+//----------------------------------------------------------------------------
+uint32 timebase_us(void)
+{
+  uint32 us;
+  uint16 count;
+  uint8  thirds;
+
+  // Read again if the interrupt updated the clock part way through
+  do
+  {
+    us = clock_us;
+    count = clock_count;
+    thirds = clock_thirds;
+  } while (us != clock_us);
+
+  return (us + ((uint32)(uint16)(TCNT - count) * 2 + thirds) / 3);
+
+} /* timebase_us */
+
+
+//----------------------------------------------------------------------------
+// NAME: timebase_ms
+//
+// DESCRIPTION:
+//    This function returns the millisecond clock. It is safe to call from
+//    both the main loop and interrupts.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   ms since start up, wrapping every 49 days
+//----------------------------------------------------------------------------
+uint32 timebase_ms(void)
+{
+  uint32 us;
+  uint32 ms;
+  uint16 ms_us;
+  uint16 count;
+  uint8  thirds;
+
+  do
+  {
+    us = clock_us;
+    ms = clock_ms;
+    ms_us = clock_ms_us;
+    count = clock_count;
+    thirds = clock_thirds;
+  } while (us != clock_us);
+
+  return (ms + (ms_us + ((uint32)(uint16)(TCNT - count) * 2 + thirds) / 3) / US_PER_MS);
+
+} /* timebase_ms */
+
+
+//----------------------------------------------------------------------------
+// NAME: timebase_service
+//
+// DESCRIPTION:
+//    This function runs the timer wheel up to the current time and keeps
+//    the wall clock anchored. It is called from the main loop.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void timebase_service(void)
+{
+  uint32 now = timebase_ms();
+  uint32 seconds;
+
+  if ((now - rtc_anchor_ms) >= RTC_REANCHOR_MS)
+  {
+    seconds = (now - rtc_anchor_ms) / MS_PER_SECOND;
+    rtc_anchor_seconds += seconds;
+    rtc_anchor_ms += seconds * MS_PER_SECOND;
+  } /* if */
+
+  while ((now - wheel_time) >= TIMER_TICK_MS)
+  {
+    wheel_time += TIMER_TICK_MS;
+    wheel_slot = (wheel_slot + 1) & WHEEL_MASK;
+    timebase_expire(wheel_slot);
+  } /* while */
+
+} /* timebase_service */
+
+
+//----------------------------------------------------------------------------
+// NAME: rtc_is_set
+//
+// DESCRIPTION:
+//    This function tells whether the wall clock has been set since start
+//    up.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if rtc_set() has been called
+//----------------------------------------------------------------------------
+bool rtc_is_set(void)
+{
+
+  return (rtc_valid);
+
+} /* rtc_is_set */
+
+
+//----------------------------------------------------------------------------
+// NAME: rtc_set
+//
+// DESCRIPTION:
+//    This function sets the wall clock. The time is not range checked.
+//
+// INPUT:
+//   time - the current date and time
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void rtc_set(const RTC_TIME_t* time)
+{
+  uint32 days = 0;
+  uint16 year;
+  uint8  month;
+
+  for (year = TIMEBASE_EPOCH_YEAR; year < time->year; year++)
+  {
+    days += rtc_is_leap(year) ? 366 : 365;
+  } /* for */
+
+  for (month = 1; month < time->month; month++)
+  {
+    days += rtc_month_days(time->year, month);
+  } /* for */
+
+  days += time->day - 1;
+
+  rtc_anchor_ms = timebase_ms();
+  rtc_anchor_seconds = days * SECONDS_PER_DAY +
+                       (uint32)time->hour * 3600 +
+                       (uint16)time->minute * 60 +
+                       time->second;
+  rtc_valid = TRUE;
+
+} /* rtc_set */
+
+
+//----------------------------------------------------------------------------
+// NAME: rtc_get
+//
+// DESCRIPTION:
+//    This function returns the wall clock as a date and time.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   time - the current date and time
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void rtc_get(RTC_TIME_t* time)
+{
+  uint32 seconds = rtc_seconds();
+  uint16 days = (uint16)(seconds / SECONDS_PER_DAY);
+  uint32 of_day = seconds % SECONDS_PER_DAY;
+  uint16 length;
+
+  time->hour = (uint8)(of_day / 3600);
+  time->minute = (uint8)((of_day / 60) % 60);
+  time->second = (uint8)(of_day % 60);
+
+  time->year = TIMEBASE_EPOCH_YEAR;
+  length = 366;
+  while (days >= length)
+  {
+    days -= length;
+    time->year++;
+    length = rtc_is_leap(time->year) ? 366 : 365;
+  } /* while */
+
+  time->month = 1;
+  while (days >= rtc_month_days(time->year, time->month))
+  {
+    days -= rtc_month_days(time->year, time->month);
+    time->month++;
+  } /* while */
+
+  time->day = (uint8)(days + 1);
+
+} /* rtc_get */
+
+
+//----------------------------------------------------------------------------
+// NAME: rtc_seconds
+//
+// DESCRIPTION:
+//    This function returns the wall clock as seconds since the start of
+//    TIMEBASE_EPOCH_YEAR.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   seconds since the epoch
+//----------------------------------------------------------------------------
+uint32 rtc_seconds(void)
+{
+
+  return (rtc_anchor_seconds + (timebase_ms() - rtc_anchor_ms) / MS_PER_SECOND);
+
+} /* rtc_seconds */
+
+
+//----------------------------------------------------------------------------
+// NAME: timer_init
+//
+// DESCRIPTION:
+//    This function sets up a stopped timer.
+//
+// INPUT:
+//   callback - called from timebase_service() when the timer expires
+//   context  - passed to the callback
+//
+// OUTPUT:
+//   timer - the timer
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void timer_init(TIMER_t* timer, TIMER_CALLBACK_t callback, void* context)
+{
+
+  timer->next = NULL;
+  timer->previous = NULL;
+  timer->active = FALSE;
+  timer->callback = callback;
+  timer->context = context;
+
+} /* timer_init */
+
+
+//----------------------------------------------------------------------------
+// NAME: timer_start
+//
+// DESCRIPTION:
+//    This function (re)starts a timer. It expires no sooner than delay_ms
+//    from now and within one wheel slot (10 ms) after that, given that
+//    timebase_service() keeps being called.
+//
+// INPUT:
+//   timer    - the timer
+//   delay_ms - the timeout, clamped to about 11 hours
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void timer_start(TIMER_t* timer, uint32 delay_ms)
+{
+  uint32 slots;
+  uint32 rounds;
+
+  timer_cancel(timer);
+
+  // Count from the last slot visited, not from now
+  slots = (delay_ms + (timebase_ms() - wheel_time) + TIMER_TICK_MS - 1) / TIMER_TICK_MS;
+  if (slots == 0)
+  {
+    slots = 1;
+  } /* if */
+
+  rounds = (slots - 1) >> TIMER_WHEEL_BITS;
+  if (rounds > MAX_ROUNDS)
+  {
+    rounds = MAX_ROUNDS;
+  } /* if */
+
+  timer->rounds = (uint16)rounds;
+  timer->slot = (uint8)((wheel_slot + slots) & WHEEL_MASK);
+  timer->active = TRUE;
+
+  timer->previous = NULL;
+  timer->next = wheel[timer->slot];
+  if (timer->next != NULL)
+  {
+    timer->next->previous = timer;
+  } /* if */
+  wheel[timer->slot] = timer;
+
+} /* timer_start */
+
+
+//----------------------------------------------------------------------------
+// NAME: timer_cancel
+//
+// DESCRIPTION:
+//    This function stops a timer. Stopping a stopped timer does nothing.
+//
+// INPUT:
+//   timer - the timer
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void timer_cancel(TIMER_t* timer)
+{
+
+  if (!timer->active)
+  {
+    return;
+  } /* if */
+
+  if (timer == wheel_next)
+  {
+    wheel_next = timer->next;
+  } /* if */
+
+  if (timer->previous != NULL)
+  {
+    timer->previous->next = timer->next;
+  } /* if */
+  else
+  {
+    wheel[timer->slot] = timer->next;
+  } /* else */
+
+  if (timer->next != NULL)
+  {
+    timer->next->previous = timer->previous;
+  } /* if */
+
+  timer->next = NULL;
+  timer->previous = NULL;
+  timer->active = FALSE;
+
+} /* timer_cancel */
+
+
+//----------------------------------------------------------------------------
+// NAME: timer_is_active
+//
+// DESCRIPTION:
+//    This function tells whether a timer is running.
+//
+// INPUT:
+//   timer - the timer
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if started and not yet expired or cancelled
+//----------------------------------------------------------------------------
+bool timer_is_active(const TIMER_t* timer)
+{
+
+  return (timer->active);
+
+} /* timer_is_active */
+
+
+//-----------------------------------------------------------------------------
+//                             Private functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: timebase_expire
+//
+// DESCRIPTION:
+//    This function visits one wheel slot: timers with turns left count one
+//    off, the rest are stopped and their callbacks run.
+//
+// INPUT:
+//   slot - the slot to visit
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void timebase_expire(uint8 slot)
+{
+  TIMER_t* timer = wheel[slot];
+
+  while (timer != NULL)
+  {
+    // A callback may cancel the next timer; timer_cancel() moves this on
+    wheel_next = timer->next;
+
+    if (timer->rounds > 0)
+    {
+      timer->rounds--;
+    } /* if */
+    else
+    {
+      timer_cancel(timer);
+      timer->callback(timer->context);
+    } /* else */
+
+    timer = wheel_next;
+  } /* while */
+
+  wheel_next = NULL;
+
+} /* timebase_expire */
+
+
+//----------------------------------------------------------------------------
+// NAME: rtc_is_leap
+//
+// DESCRIPTION:
+//    This function tells whether a year is a leap year.
+//
+// INPUT:
+//   year - the year
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE for a leap year
+//----------------------------------------------------------------------------
+static bool rtc_is_leap(uint16 year)
+{
+
+  return (((year % 4) == 0) && (((year % 100) != 0) || ((year % 400) == 0)));
+
+} /* rtc_is_leap */
+
+
+//----------------------------------------------------------------------------
+// NAME: rtc_month_days
+//
+// DESCRIPTION:
+//    This function returns the number of days in a month.
+//
+// INPUT:
+//   year  - the year
+//   month - the month, 1 - 12
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the number of days
+//----------------------------------------------------------------------------
+static uint8 rtc_month_days(uint16 year, uint8 month)
+{
+
+  if ((month == 2) && rtc_is_leap(year))
+  {
+    return (29);
+  } /* if */
+
+  return (days_in_month[month - 1]);
+
+} /* rtc_month_days */
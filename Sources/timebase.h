@@ -0,0 +1,88 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: timebase.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for the system timebase: a
+//    monotonic microsecond and millisecond clock kept from the free running
+//    timer counter, a settable wall clock and a timer wheel for software
+//    timeouts.
+//
+//*****************************************************************************
+
+#ifndef _TIMEBASE_H_
+#define _TIMEBASE_H_
+
+#include "sys_types.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// The timer counter runs at 24 MHz / 16 = 1.5 MHz; every module that
+// touches TSCR2 must keep this prescaler
+#define TIMEBASE_PRESCALER      0x04
+
+// Wall clock epoch
+#define TIMEBASE_EPOCH_YEAR     2000
+
+// Timer wheel: 64 slots of 10 ms, so one turn is 640 ms. Longer
+// timeouts wait out whole turns, up to about 11 hours.
+#define TIMER_TICK_MS           10
+#define TIMER_WHEEL_BITS        6
+#define TIMER_WHEEL_SLOTS       (1 << TIMER_WHEEL_BITS)
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  uint16 year;          // 2000 - 2135
+  uint8  month;         // 1 - 12
+  uint8  day;           // 1 - 31
+  uint8  hour;          // 0 - 23
+  uint8  minute;        // 0 - 59
+  uint8  second;        // 0 - 59
+} RTC_TIME_t;
+
+typedef void (*TIMER_CALLBACK_t)(void* context);
+
+// Owned by the caller; the wheel only links it in while it is running
+typedef struct TIMER_s
+{
+  struct TIMER_s*  next;
+  struct TIMER_s*  previous;
+  uint16           rounds;      // wheel turns left before it expires
+  uint8            slot;
+  bool             active;
+  TIMER_CALLBACK_t callback;
+  void*            context;
+} TIMER_t;
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+void   timebase_init(void);
+void   timebase_tick(void);
+uint32 timebase_us(void);
+uint32 timebase_ms(void);
+void   timebase_service(void);
+
+bool   rtc_is_set(void);
+void   rtc_set(const RTC_TIME_t* time);
+void   rtc_get(RTC_TIME_t* time);
+uint32 rtc_seconds(void);
+
+void   timer_init(TIMER_t* timer, TIMER_CALLBACK_t callback, void* context);
+void   timer_start(TIMER_t* timer, uint32 delay_ms);
+void   timer_cancel(TIMER_t* timer);
+bool   timer_is_active(const TIMER_t* timer);
+
+#endif /* _TIMEBASE_H_ */
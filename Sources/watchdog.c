@@ -0,0 +1,390 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: watchdog.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file runs the COP watchdog. Once watchdog_start() has enabled
+//    it, the COP resets the board unless ARMCOP is written 0x55 then 0xAA
+//    every WATCHDOG_COPCTL timeout. Only watchdog_tick() does that, from
+//    the tick ISR, and only while no registered task is past its
+//    deadline. Each task's deadline counts down in ticks and
+//    watchdog_checkin() winds it back up, so the tick ISR stopping and a
+//    task hanging both end in a reset. Deadlines are given in ms and
+//    kept in ticks of 1.024 ms.
+//
+//    The HCS12 has no register that says why it reset; the COP and the
+//    clock monitor each have a reset vector of their own instead. Their
+//    entries here note the cause and go on to _Startup(). The cause and
+//    the task that missed its deadline are kept in the WATCHDOG_RAM
+//    segment, which is NO_INIT in the PRM files so Init() leaves it
+//    alone. A pattern and its complement tell whether the RAM held
+//    through the reset; if not, the board was powered up.
+//
+//*****************************************************************************
+
+//-----------------------------------------------------------------------------
+//                       Required user support files below
+//-----------------------------------------------------------------------------
+#include <mc9s12dg256.h>            // derivative information
+#include "watchdog.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define WATCHDOG_MAGIC          0xC09D
+
+// A tick is 1.024 ms, so ms * 125 / 128 ticks
+#define MS_TO_TICKS(ms)         ((uint16)(((uint32)(ms) * 125) / 128))
+
+// Reset vector numbers: 0 is the reset pin and power on
+#define CLOCK_MONITOR_VECTOR    1
+#define COP_VECTOR              2
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+// Kept through a reset; watchdog_init() checks them
+#pragma DATA_SEG WATCHDOG_DATA
+static uint16 saved_magic;
+static uint16 saved_check;              // ~saved_magic
+static uint8  saved_cause;              // set by the reset entries below
+static uint8  saved_task;               // set when a task misses
+static uint16 saved_cop_resets;         // since power on
+#pragma DATA_SEG DEFAULT
+
+static uint8  boot_cause;
+static uint8  boot_task;
+
+static uint16 deadline[WATCHDOG_TASKS]; // ticks, 0 if not registered
+static volatile uint16 left[WATCHDOG_TASKS];
+static bool   started;
+static bool   expired;
+
+extern void _Startup(void);             // Start12.c
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: watchdog_init
+//
+// DESCRIPTION:
+//    This function takes in why the board reset and sets the saved RAM
+//    up for the next reset. It must run before anything else looks at
+//    the reset cause, and the COP stays off until watchdog_start().
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void watchdog_init(void)
+{
+  uint8 task;
+
+  if ((saved_magic == WATCHDOG_MAGIC) && (saved_check == (uint16)~WATCHDOG_MAGIC))
+  {
+    boot_cause = saved_cause;
+    boot_task = saved_task;
+    if (boot_cause == WATCHDOG_RESET_COP)
+    {
+      saved_cop_resets++;
+    } /* if */
+  }
+  else
+  {
+    boot_cause = WATCHDOG_RESET_POWER_ON;
+    boot_task = WATCHDOG_NO_TASK;
+    saved_cop_resets = 0;
+    saved_magic = WATCHDOG_MAGIC;
+    saved_check = (uint16)~WATCHDOG_MAGIC;
+  } /* if */
+
+  // Unless a reset entry below says otherwise
+  saved_cause = WATCHDOG_RESET_EXTERNAL;
+  saved_task = WATCHDOG_NO_TASK;
+
+  for (task = 0; task < WATCHDOG_TASKS; task++)
+  {
+    deadline[task] = 0;
+    left[task] = 0;
+  } /* for */
+  started = FALSE;
+  expired = FALSE;
+
+} /* watchdog_init */
+
+
+//----------------------------------------------------------------------------
+// NAME: watchdog_register
+//
+// DESCRIPTION:
+//    This function adds a task that must check in. It must be called
+//    before watchdog_start().
+//
+// INPUT:
+//   task        - WATCHDOG_BACKGROUND ... WATCHDOG_TASKS-1
+//   deadline_ms - the longest the task may go between check ins
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void watchdog_register(uint8 task, uint16 deadline_ms)
+{
+
+  deadline[task] = MS_TO_TICKS(deadline_ms);
+  left[task] = deadline[task];
+
+} /* watchdog_register */
+
+
+//----------------------------------------------------------------------------
+// NAME: watchdog_start
+//
+// DESCRIPTION:
+//    This function turns the COP on. COPCTL can only be written once, so
+//    from here on only a reset turns it off. Start up should be over and
+//    the tick ISR running.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void watchdog_start(void)
+{
+
+  ARMCOP = 0x55;
+  ARMCOP = 0xAA;
+  COPCTL = WATCHDOG_COPCTL;
+  started = TRUE;
+
+} /* watchdog_start */
+
+
+//----------------------------------------------------------------------------
+// NAME: watchdog_checkin
+//
+// DESCRIPTION:
+//    This function tells the supervisor a task is still running, which
+//    gives it its whole deadline again.
+//
+// INPUT:
+//   task - WATCHDOG_BACKGROUND ... WATCHDOG_TASKS-1
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void watchdog_checkin(uint8 task)
+{
+
+  left[task] = deadline[task];  // one store, so the tick ISR can't split it
+
+} /* watchdog_checkin */
+
+
+//----------------------------------------------------------------------------
+// NAME: watchdog_tick
+//
+// DESCRIPTION:
+//    This function counts down each task's deadline and services the COP
+//    if none has run out. The tick ISR calls it. The first task found
+//    out of time is saved, and the COP is then left to reset the board.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void watchdog_tick(void)
+{
+  uint8 task;
+
+  if (!started || expired)
+  {
+    return;
+  } /* if */
+
+  for (task = 0; task < WATCHDOG_TASKS; task++)
+  {
+    if (deadline[task] != 0)
+    {
+      if (left[task] == 0)
+      {
+        saved_task = task;
+        expired = TRUE;
+        return;
+      } /* if */
+      left[task]--;
+    } /* if */
+  } /* for */
+
+  ARMCOP = 0x55;
+  ARMCOP = 0xAA;
+
+} /* watchdog_tick */
+
+
+//----------------------------------------------------------------------------
+// NAME: watchdog_reset_cause
+//
+// DESCRIPTION:
+//    This function gives why the board last reset.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   WATCHDOG_RESET_POWER_ON ... WATCHDOG_RESET_CLOCK
+//----------------------------------------------------------------------------
+uint8 watchdog_reset_cause(void)
+{
+
+  return (boot_cause);
+
+} /* watchdog_reset_cause */
+
+
+//----------------------------------------------------------------------------
+// NAME: watchdog_missed_task
+//
+// DESCRIPTION:
+//    This function gives the task that missed its deadline before a COP
+//    reset.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the task, or WATCHDOG_NO_TASK if the tick ISR stopped servicing the
+//   COP or the reset wasn't a COP reset
+//----------------------------------------------------------------------------
+uint8 watchdog_missed_task(void)
+{
+
+  return (boot_task);
+
+} /* watchdog_missed_task */
+
+
+//----------------------------------------------------------------------------
+// NAME: watchdog_cop_resets
+//
+// DESCRIPTION:
+//    This function gives how many COP resets there have been since the
+//    board was powered up.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the count
+//----------------------------------------------------------------------------
+uint16 watchdog_cop_resets(void)
+{
+
+  return (saved_cop_resets);
+
+} /* watchdog_cop_resets */
+
+
+//-----------------------------------------------------------------------------
+//                               Reset entries
+//-----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// NAME: watchdog_cop_reset
+//
+// DESCRIPTION:
+//    This function is the COP reset entry. It runs before the stack
+//    pointer is set, so it only notes the cause and goes on to the normal
+//    start up.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none, it doesn't return
+//----------------------------------------------------------------------------
+void interrupt COP_VECTOR watchdog_cop_reset(void)
+{
+
+  __asm
+  {
+    MOVB #WATCHDOG_RESET_COP, saved_cause
+    JMP  _Startup
+  }
+
+} /* watchdog_cop_reset */
+
+
+//----------------------------------------------------------------------------
+// NAME: watchdog_clock_reset
+//
+// DESCRIPTION:
+//    This function is the clock monitor reset entry, the same as
+//    watchdog_cop_reset().
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none, it doesn't return
+//----------------------------------------------------------------------------
+void interrupt CLOCK_MONITOR_VECTOR watchdog_clock_reset(void)
+{
+
+  __asm
+  {
+    MOVB #WATCHDOG_RESET_CLOCK, saved_cause
+    JMP  _Startup
+  }
+
+} /* watchdog_clock_reset */
@@ -0,0 +1,59 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: watchdog.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the definitions for the COP watchdog supervisor.
+//    Tasks check in with watchdog_checkin(); the tick ISR only services
+//    the COP while every registered task has checked in within its
+//    deadline, so a task that hangs, or interrupts that stay masked,
+//    reset the board. Why the board last reset, and which task missed
+//    its deadline, are kept in RAM that start up doesn't clear.
+//
+//*****************************************************************************
+
+#ifndef _WATCHDOG_H_
+#define _WATCHDOG_H_
+
+#include "sys_types.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// Tasks
+#define WATCHDOG_BACKGROUND     0       // background_service() ran
+#define WATCHDOG_READERS        1       // readers_service() returned
+#define WATCHDOG_TASKS          2
+#define WATCHDOG_NO_TASK        0xFF    // the tick itself stopped
+
+// Reset causes
+#define WATCHDOG_RESET_POWER_ON 0       // the saved RAM didn't survive
+#define WATCHDOG_RESET_EXTERNAL 1       // reset pin or debugger
+#define WATCHDOG_RESET_COP      2
+#define WATCHDOG_RESET_CLOCK    3       // clock monitor
+
+// COPCTL: RSBCK stops the COP while the debugger has the CPU, CR = 4
+// times out after 2^20 OSCCLK cycles, 131 ms at 8 MHz. The tick ISR
+// services it every 1.024 ms.
+#define WATCHDOG_COPCTL         0x44
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+void  watchdog_init(void);
+void  watchdog_register(uint8 task, uint16 deadline_ms);
+void  watchdog_start(void);
+void  watchdog_checkin(uint8 task);
+void  watchdog_tick(void);
+uint8 watchdog_reset_cause(void);
+uint8 watchdog_missed_task(void);
+uint16 watchdog_cop_resets(void);
+
+#endif /* _WATCHDOG_H_ */
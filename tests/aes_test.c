@@ -0,0 +1,529 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: aes_test.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file checks aes.c on the host. It is built twice, with and
+//    without AES_USE_TTABLES, and each build:
+//
+//      - encrypts and decrypts the FIPS-197 appendix B and C.1 vectors
+//      - computes the four RFC 4493 example MACs, and checks that
+//        aes_cmac_verify() takes a truncated MAC and refuses a changed
+//        one or a changed message
+//      - derives keys with the SP 800-108 CMAC KDF and checks labels
+//        give unrelated keys
+//      - compares random keys, blocks, messages of every length up to
+//        four blocks and derived keys against OpenSSL (left out with
+//        AES_TEST_OPENSSL=0)
+//      - times encryption, decryption and CMAC per block
+//
+//    Host timings only compare the two builds; the board's own figures
+//    come from its aes command.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "test.h"
+#include "aes.h"
+
+#ifndef AES_TEST_OPENSSL
+#define AES_TEST_OPENSSL        1
+#endif
+
+#if (AES_TEST_OPENSSL)
+#include <openssl/core_names.h>
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+#endif
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define RANDOM_KEYS             200
+#define RANDOM_BLOCKS           20
+#define MAX_MESSAGE             (4 * AES_BLOCK_SIZE)
+
+#define BENCHMARK_BLOCKS        200000L
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+// FIPS-197 appendix B
+static const uint8 fips_b_key[AES_KEY_SIZE] =
+{
+  0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+  0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C
+};
+static const uint8 fips_b_plain[AES_BLOCK_SIZE] =
+{
+  0x32, 0x43, 0xF6, 0xA8, 0x88, 0x5A, 0x30, 0x8D,
+  0x31, 0x31, 0x98, 0xA2, 0xE0, 0x37, 0x07, 0x34
+};
+static const uint8 fips_b_cipher[AES_BLOCK_SIZE] =
+{
+  0x39, 0x25, 0x84, 0x1D, 0x02, 0xDC, 0x09, 0xFB,
+  0xDC, 0x11, 0x85, 0x97, 0x19, 0x6A, 0x0B, 0x32
+};
+
+// FIPS-197 appendix C.1
+static const uint8 fips_c_key[AES_KEY_SIZE] =
+{
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+  0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F
+};
+static const uint8 fips_c_plain[AES_BLOCK_SIZE] =
+{
+  0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+  0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF
+};
+static const uint8 fips_c_cipher[AES_BLOCK_SIZE] =
+{
+  0x69, 0xC4, 0xE0, 0xD8, 0x6A, 0x7B, 0x04, 0x30,
+  0xD8, 0xCD, 0xB7, 0x80, 0x70, 0xB4, 0xC5, 0x5A
+};
+
+// RFC 4493 section 4, with the appendix B key
+static const uint8 rfc_message[MAX_MESSAGE] =
+{
+  0x6B, 0xC1, 0xBE, 0xE2, 0x2E, 0x40, 0x9F, 0x96,
+  0xE9, 0x3D, 0x7E, 0x11, 0x73, 0x93, 0x17, 0x2A,
+  0xAE, 0x2D, 0x8A, 0x57, 0x1E, 0x03, 0xAC, 0x9C,
+  0x9E, 0xB7, 0x6F, 0xAC, 0x45, 0xAF, 0x8E, 0x51,
+  0x30, 0xC8, 0x1C, 0x46, 0xA3, 0x5C, 0xE4, 0x11,
+  0xE5, 0xFB, 0xC1, 0x19, 0x1A, 0x0A, 0x52, 0xEF,
+  0xF6, 0x9F, 0x24, 0x45, 0xDF, 0x4F, 0x9B, 0x17,
+  0xAD, 0x2B, 0x41, 0x7B, 0xE6, 0x6C, 0x37, 0x10
+};
+static const uint16 rfc_length[4] = { 0, 16, 40, 64 };
+static const uint8 rfc_mac[4][AES_BLOCK_SIZE] =
+{
+  { 0xBB, 0x1D, 0x69, 0x29, 0xE9, 0x59, 0x37, 0x28,
+    0x7F, 0xA3, 0x7D, 0x12, 0x9B, 0x75, 0x67, 0x46 },
+  { 0x07, 0x0A, 0x16, 0xB4, 0x6B, 0x4D, 0x41, 0x44,
+    0xF7, 0x9B, 0xDD, 0x9D, 0xD0, 0x4A, 0x28, 0x7C },
+  { 0xDF, 0xA6, 0x67, 0x47, 0xDE, 0x9A, 0xE6, 0x30,
+    0x30, 0xCA, 0x32, 0x61, 0x14, 0x97, 0xC8, 0x27 },
+  { 0x51, 0xF0, 0xBE, 0xBF, 0x7E, 0x3B, 0x9D, 0x92,
+    0xFC, 0x49, 0x74, 0x17, 0x79, 0x36, 0x3C, 0xFE }
+};
+
+// SP 800-108 CMAC KDF with the appendix B key, from OpenSSL's KBKDF
+static const uint8 kdf_cipher_key[AES_KEY_SIZE] =
+{
+  0x0D, 0x35, 0x35, 0x9C, 0xC1, 0x92, 0xD7, 0x18,
+  0x0F, 0x4F, 0xB5, 0x74, 0xAE, 0x06, 0xDA, 0xDE
+};
+static const uint8 kdf_mac_key[AES_KEY_SIZE] =
+{
+  0x29, 0x75, 0x7A, 0x92, 0x61, 0x0A, 0x9C, 0xB2,
+  0xA2, 0x12, 0xC7, 0x91, 0x17, 0x12, 0x35, 0xF5
+};
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+
+#if (AES_TEST_OPENSSL)
+//----------------------------------------------------------------------------
+// NAME: fill_random
+//
+// DESCRIPTION:
+//    This function fills a buffer from the fixed seed generator.
+//
+// INPUT:
+//   length - the number of bytes
+//
+// OUTPUT:
+//   buffer - the random bytes
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void fill_random(uint8* buffer, int length)
+{
+  int idx;
+
+  for (idx = 0; idx < length; idx++)
+  {
+    buffer[idx] = (uint8)(test_random() * 256.0);
+  } /* for */
+
+} /* fill_random */
+#endif
+
+
+//----------------------------------------------------------------------------
+// NAME: seconds
+//
+// DESCRIPTION:
+//    This function reads the host's monotonic clock.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the time in seconds
+//----------------------------------------------------------------------------
+static double seconds(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec + now.tv_nsec / 1e9);
+
+} /* seconds */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_fips
+//
+// DESCRIPTION:
+//    This function checks the cipher against FIPS-197, switching keys
+//    between the vectors so a stale key schedule would show.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_fips(void)
+{
+  uint8 block[AES_BLOCK_SIZE];
+
+  aes_set_key(fips_b_key);
+  aes_encrypt_block(fips_b_plain, block);
+  CHECK(memcmp(block, fips_b_cipher, sizeof(block)) == 0);
+
+  aes_set_key(fips_c_key);
+  aes_encrypt_block(fips_c_plain, block);
+  CHECK(memcmp(block, fips_c_cipher, sizeof(block)) == 0);
+  aes_decrypt_block(fips_c_cipher, block);
+  CHECK(memcmp(block, fips_c_plain, sizeof(block)) == 0);
+
+  // In place, as main.c does
+  memcpy(block, fips_b_cipher, sizeof(block));
+  aes_set_key(fips_b_key);
+  aes_decrypt_block(block, block);
+  CHECK(memcmp(block, fips_b_plain, sizeof(block)) == 0);
+  aes_encrypt_block(block, block);
+  CHECK(memcmp(block, fips_b_cipher, sizeof(block)) == 0);
+
+  // Loading the same key again keeps the schedule
+  aes_set_key(fips_b_key);
+  aes_encrypt_block(fips_b_plain, block);
+  CHECK(memcmp(block, fips_b_cipher, sizeof(block)) == 0);
+
+  CHECK(aes_self_test());
+
+} /* test_fips */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_cmac
+//
+// DESCRIPTION:
+//    This function checks the MAC against RFC 4493 and checks what
+//    aes_cmac_verify() accepts.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_cmac(void)
+{
+  uint8 mac[AES_BLOCK_SIZE];
+  uint8 changed[MAX_MESSAGE];
+  int   example;
+
+  // A CMAC with another key first, so the subkeys have to follow the key
+  aes_set_key(fips_c_key);
+  aes_cmac(rfc_message, MAX_MESSAGE, mac);
+
+  aes_set_key(fips_b_key);
+  for (example = 0; example < 4; example++)
+  {
+    aes_cmac(rfc_message, rfc_length[example], mac);
+    CHECK(memcmp(mac, rfc_mac[example], sizeof(mac)) == 0);
+    CHECK(aes_cmac_verify(rfc_message, rfc_length[example], rfc_mac[example],
+                          AES_BLOCK_SIZE));
+  } /* for */
+
+  // Truncated MACs are the leading bytes
+  CHECK(aes_cmac_verify(rfc_message, 40, rfc_mac[2], 8));
+  CHECK(aes_cmac_verify(rfc_message, 40, rfc_mac[2], 4));
+
+  // One bit off in the MAC or the message, or the wrong length
+  memcpy(mac, rfc_mac[3], sizeof(mac));
+  mac[15] ^= 0x01;
+  CHECK(!aes_cmac_verify(rfc_message, 64, mac, AES_BLOCK_SIZE));
+  CHECK(aes_cmac_verify(rfc_message, 64, mac, 8));
+  mac[0] ^= 0x80;
+  CHECK(!aes_cmac_verify(rfc_message, 64, mac, 8));
+
+  memcpy(changed, rfc_message, sizeof(changed));
+  changed[37] ^= 0x10;
+  CHECK(!aes_cmac_verify(changed, 40, rfc_mac[2], AES_BLOCK_SIZE));
+  CHECK(!aes_cmac_verify(rfc_message, 39, rfc_mac[2], AES_BLOCK_SIZE));
+  CHECK(!aes_cmac_verify(rfc_message, 0, rfc_mac[1], AES_BLOCK_SIZE));
+
+} /* test_cmac */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_kdf
+//
+// DESCRIPTION:
+//    This function checks aes_derive_key() against known answers and
+//    checks the label is all that tells two derived keys apart.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_kdf(void)
+{
+  static const uint8 long_label[AES_KDF_LABEL_MAX + 1] = "0123456789abcdefX";
+  uint8 first[AES_KEY_SIZE];
+  uint8 second[AES_KEY_SIZE];
+
+  aes_derive_key(fips_b_key, (const uint8*)"card cipher", 11, first);
+  CHECK(memcmp(first, kdf_cipher_key, sizeof(first)) == 0);
+  aes_derive_key(fips_b_key, (const uint8*)"card mac", 8, second);
+  CHECK(memcmp(second, kdf_mac_key, sizeof(second)) == 0);
+
+  // The master key is left loaded
+  aes_cmac(rfc_message, rfc_length[1], second);
+  CHECK(memcmp(second, rfc_mac[1], sizeof(second)) == 0);
+
+  // Labels longer than AES_KDF_LABEL_MAX are cut short
+  aes_derive_key(fips_c_key, long_label, sizeof(long_label), first);
+  aes_derive_key(fips_c_key, long_label, AES_KDF_LABEL_MAX, second);
+  CHECK(memcmp(first, second, sizeof(first)) == 0);
+  aes_derive_key(fips_c_key, long_label, AES_KDF_LABEL_MAX - 1, second);
+  CHECK(memcmp(first, second, sizeof(first)) != 0);
+
+} /* test_kdf */
+
+
+#if (AES_TEST_OPENSSL)
+//----------------------------------------------------------------------------
+// NAME: test_openssl
+//
+// DESCRIPTION:
+//    This function compares random keys, blocks and messages against
+//    OpenSSL's AES-128 ECB and CMAC.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_openssl(void)
+{
+  EVP_CIPHER_CTX* cipher;
+  EVP_MAC*        cmac;
+  EVP_MAC_CTX*    context;
+  EVP_KDF*        kbkdf;
+  EVP_KDF_CTX*    kdf_context;
+  OSSL_PARAM      params[2];
+  OSSL_PARAM      kdf_params[6];
+  char            mac_name[] = "CMAC";
+  char            mode_name[] = "counter";
+  char            cipher_name[] = "AES-128-CBC";
+  uint8  key[AES_KEY_SIZE];
+  uint8  plain[AES_BLOCK_SIZE];
+  uint8  ours[AES_BLOCK_SIZE];
+  uint8  theirs[AES_BLOCK_SIZE];
+  uint8  message[MAX_MESSAGE];
+  size_t mac_length;
+  int    out_length;
+  int    keys;
+  int    blocks;
+  int    length;
+  int    mismatches = 0;
+
+  cipher = EVP_CIPHER_CTX_new();
+  cmac = EVP_MAC_fetch(NULL, "CMAC", NULL);
+  kbkdf = EVP_KDF_fetch(NULL, "KBKDF", NULL);
+  CHECK(cipher != NULL);
+  CHECK(cmac != NULL);
+  CHECK(kbkdf != NULL);
+  if ((cipher == NULL) || (cmac == NULL) || (kbkdf == NULL))
+  {
+    return;
+  } /* if */
+  context = EVP_MAC_CTX_new(cmac);
+  kdf_context = EVP_KDF_CTX_new(kbkdf);
+  params[0] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_CIPHER, cipher_name, 0);
+  params[1] = OSSL_PARAM_construct_end();
+
+  for (keys = 0; keys < RANDOM_KEYS; keys++)
+  {
+    fill_random(key, sizeof(key));
+    aes_set_key(key);
+
+    EVP_EncryptInit_ex(cipher, EVP_aes_128_ecb(), NULL, key, NULL);
+    EVP_CIPHER_CTX_set_padding(cipher, 0);
+    for (blocks = 0; blocks < RANDOM_BLOCKS; blocks++)
+    {
+      fill_random(plain, sizeof(plain));
+      aes_encrypt_block(plain, ours);
+      EVP_EncryptUpdate(cipher, theirs, &out_length, plain, sizeof(plain));
+      mismatches += (out_length != AES_BLOCK_SIZE) ||
+                    (memcmp(ours, theirs, sizeof(ours)) != 0);
+
+      aes_decrypt_block(ours, ours);
+      mismatches += (memcmp(ours, plain, sizeof(ours)) != 0);
+    } /* for */
+
+    // Every length, so each padding case and partial last block is covered
+    for (length = 0; length <= MAX_MESSAGE; length++)
+    {
+      fill_random(message, length);
+      aes_cmac(message, (uint16)length, ours);
+      EVP_MAC_init(context, key, sizeof(key), params);
+      EVP_MAC_update(context, message, length);
+      EVP_MAC_final(context, theirs, &mac_length, sizeof(theirs));
+      mismatches += (mac_length != AES_BLOCK_SIZE) ||
+                    (memcmp(ours, theirs, sizeof(ours)) != 0);
+    } /* for */
+
+    // Every label length; OpenSSL calls the label the salt
+    for (length = 1; length <= AES_KDF_LABEL_MAX; length++)
+    {
+      fill_random(message, length);
+      aes_derive_key(key, message, (uint8)length, ours);
+      kdf_params[0] = OSSL_PARAM_construct_utf8_string(OSSL_KDF_PARAM_MODE, mode_name, 0);
+      kdf_params[1] = OSSL_PARAM_construct_utf8_string(OSSL_KDF_PARAM_MAC, mac_name, 0);
+      kdf_params[2] = OSSL_PARAM_construct_utf8_string(OSSL_KDF_PARAM_CIPHER, cipher_name, 0);
+      kdf_params[3] = OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_KEY, key, sizeof(key));
+      kdf_params[4] = OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_SALT, message, length);
+      kdf_params[5] = OSSL_PARAM_construct_end();
+      mismatches += (EVP_KDF_derive(kdf_context, theirs, sizeof(theirs), kdf_params) != 1) ||
+                    (memcmp(ours, theirs, sizeof(ours)) != 0);
+    } /* for */
+  } /* for */
+
+  CHECK_EQUAL(0, mismatches);
+
+  EVP_KDF_CTX_free(kdf_context);
+  EVP_KDF_free(kbkdf);
+  EVP_MAC_CTX_free(context);
+  EVP_MAC_free(cmac);
+  EVP_CIPHER_CTX_free(cipher);
+
+} /* test_openssl */
+#endif
+
+
+//----------------------------------------------------------------------------
+// NAME: benchmark
+//
+// DESCRIPTION:
+//    This function prints the host time per block for encryption,
+//    decryption and a CMAC of a credential's two blocks.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void benchmark(void)
+{
+  uint8  block[AES_BLOCK_SIZE];
+  uint8  mac[AES_BLOCK_SIZE];
+  double begin;
+  double encrypt_ns;
+  double decrypt_ns;
+  double cmac_ns;
+  long   count;
+
+  aes_set_key(fips_c_key);
+  memcpy(block, fips_c_plain, sizeof(block));
+
+  begin = seconds();
+  for (count = 0; count < BENCHMARK_BLOCKS; count++)
+  {
+    aes_encrypt_block(block, block);
+  } /* for */
+  encrypt_ns = (seconds() - begin) * 1e9 / BENCHMARK_BLOCKS;
+
+  begin = seconds();
+  for (count = 0; count < BENCHMARK_BLOCKS; count++)
+  {
+    aes_decrypt_block(block, block);
+  } /* for */
+  decrypt_ns = (seconds() - begin) * 1e9 / BENCHMARK_BLOCKS;
+
+  // BENCHMARK_BLOCKS encryptions and decryptions cancel out
+  CHECK(memcmp(block, fips_c_plain, sizeof(block)) == 0);
+
+  begin = seconds();
+  for (count = 0; count < BENCHMARK_BLOCKS / 2; count++)
+  {
+    aes_cmac(rfc_message, 2 * AES_BLOCK_SIZE, mac);
+  } /* for */
+  cmac_ns = (seconds() - begin) * 1e9 / BENCHMARK_BLOCKS;
+
+  printf("aes_test: %s, per block: encrypt %.0f ns, decrypt %.0f ns, cmac %.0f ns\n",
+         AES_USE_TTABLES ? "T-tables" : "S-boxes", encrypt_ns, decrypt_ns, cmac_ns);
+
+} /* benchmark */
+
+
+//-----------------------------------------------------------------------------
+//                               Main
+//-----------------------------------------------------------------------------
+
+int main(void)
+{
+
+  test_fips();
+  test_cmac();
+  test_kdf();
+#if (AES_TEST_OPENSSL)
+  test_openssl();
+#endif
+  benchmark();
+
+  return (test_report(AES_USE_TTABLES ? "aes_test (T-tables)" : "aes_test (S-boxes)"));
+
+} /* main */
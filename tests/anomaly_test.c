@@ -0,0 +1,720 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: anomaly_test.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file replays sensor traces through anomaly.c on the host. The
+//    traces are fed at the 10 Hz status rate with the variance floors and
+//    z thresholds main.c uses, both taken from sensors_config.h, and the
+//    test reports how many alarms each alertness level raises on quiet
+//    days and checks that real events (a flashlight, a fire, the board
+//    being moved) still alarm.
+//
+//    A single alarming sample does not sound the siren; the status engine
+//    needs a run of them to reach BAD. The detector's results are fed
+//    through status.c with the same level table, so both the raw alarm
+//    rate and the rate of false BAD escalations are reported.
+//
+//    The built in traces are synthetic with a fixed seed. A window decoded
+//    by tools/blackbox_decode.py can be replayed as well:
+//
+//      anomaly_test window.csv
+//
+//*****************************************************************************
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "anomaly.h"
+#include "status.h"
+#include "sensors_config.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define PI                      3.14159265358979
+
+// Status steps
+#define STEPS_PER_SECOND        10
+#define STEPS_PER_HOUR          (3600L * STEPS_PER_SECOND)
+#define STEPS_PER_DAY           (24 * STEPS_PER_HOUR)
+
+// Sensors
+#define LIGHT                   0
+#define TEMP                    1
+#define MOTION                  2
+#define SENSORS                 3
+
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  long alarms;          // alarm events (runs of alarming samples)
+  long suspects;        // suspect events
+  long alarm_samples;   // samples scored as an alarm
+  long first_alarm;     // step of the first alarm, -1 if none
+  long escalations;     // times the status engine entered BAD
+  long night_escalations; // of those, how many between 18:00 and 06:00
+  long first_bad;       // step of the first BAD entry, -1 if none
+  uint8 previous;       // level of the last sample
+  STATUS_ENGINE_t engine;
+} REPLAY_t;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+// Suspect and alarm z of each level set_alertness() picks
+static const uint8 z_tenths[ALERTNESS_LEVELS][2] =
+{
+  { ALERTNESS_LOW_Z_SUSPECT,    ALERTNESS_LOW_Z_ALARM },
+  { ALERTNESS_MEDIUM_Z_SUSPECT, ALERTNESS_MEDIUM_Z_ALARM },
+  { ALERTNESS_HIGH_Z_SUSPECT,   ALERTNESS_HIGH_Z_ALARM }
+};
+
+static const STATUS_LEVEL_CONFIG_t status_config[STATUS_LEVELS] =
+  SENSORS_STATUS_CONFIG;
+
+static const char* const sensor_names[SENSORS] = { "light", "temp", "motion" };
+
+// Detector setup for each sensor, as in main.c
+static const uint16 var_floors[SENSORS] =
+{
+  LIGHT_VARIANCE_FLOOR, TEMP_VARIANCE_FLOOR, MOTION_VARIANCE_FLOOR
+};
+static const uint8 detector_flags[SENSORS] =
+{
+  ANOMALY_ONE_SIDED, ANOMALY_ONE_SIDED, 0
+};
+
+// Slowly varying state of the synthetic scene
+static double cloud;
+
+
+//-----------------------------------------------------------------------------
+//                        Synthetic traces
+//-----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
+// NAME: day_light
+//
+// DESCRIPTION:
+//    This function returns the light level of a window over a day: dark
+//    with sensor noise at night, a daylight curve from 06:00 to 18:00 and
+//    clouds drifting across it.
+//
+// INPUT:
+//   step - the status step since midnight
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the light reading
+//----------------------------------------------------------------------------
+static double day_light(long step)
+{
+  double hours = (double)step / STEPS_PER_HOUR;
+  double sun = 0.0;
+
+  if ((hours > 6.0) && (hours < 18.0))
+  {
+    sun = sin(PI * (hours - 6.0) / 12.0);
+  } /* if */
+
+  cloud += test_gauss(0.002);
+  if (cloud < 0.4)
+  {
+    cloud = 0.4;
+  } /* if */
+  else if (cloud > 1.0)
+  {
+    cloud = 1.0;
+  } /* else if */
+
+  return (25.0 + 750.0 * sun * cloud + test_gauss(3.0));
+
+} /* day_light */
+
+
+//----------------------------------------------------------------------------
+// NAME: day_temp
+//
+// DESCRIPTION:
+//    This function returns the room temperature in degrees F over a day:
+//    a daily swing with the heating cycling every 20 minutes on top.
+//
+// INPUT:
+//   step - the status step since midnight
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the temperature
+//----------------------------------------------------------------------------
+static double day_temp(long step)
+{
+  double hours = (double)step / STEPS_PER_HOUR;
+  double cycle = fmod(hours * 3.0, 1.0);
+
+  return (68.0 + 3.0 * sin(2.0 * PI * (hours - 9.0) / 24.0) +
+          2.0 * fabs(cycle - 0.5) + test_gauss(0.3));
+
+} /* day_temp */
+
+
+//----------------------------------------------------------------------------
+// NAME: day_motion
+//
+// DESCRIPTION:
+//    This function returns the motion level of a board at rest: the peak
+//    of the accelerometer noise over the ten samples of a status step.
+//
+// INPUT:
+//   step - the status step since midnight
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the motion reading
+//----------------------------------------------------------------------------
+static double day_motion(long step)
+{
+  double peak = 0.0;
+  double sample;
+  int    i;
+
+  (void)step;
+  for (i = 0; i < 10; i++)
+  {
+    sample = fabs(test_gauss(2.0));
+    if (sample > peak)
+    {
+      peak = sample;
+    } /* if */
+  } /* for */
+
+  return (peak);
+
+} /* day_motion */
+
+
+//----------------------------------------------------------------------------
+// NAME: day_reading
+//
+// DESCRIPTION:
+//    This function returns a sensor reading of the quiet day trace rounded
+//    the way the firmware delivers it.
+//
+// INPUT:
+//   sensor - LIGHT, TEMP or MOTION
+//   step   - the status step since midnight
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the reading
+//----------------------------------------------------------------------------
+static sint16 day_reading(int sensor, long step)
+{
+  double value;
+
+  switch (sensor)
+  {
+    case LIGHT:
+      value = day_light(step);
+      break;
+
+    case TEMP:
+      value = day_temp(step);
+      break;
+
+    default:
+      value = day_motion(step);
+      break;
+  } /* switch */
+
+  if (value < 0.0)
+  {
+    value = 0.0;
+  } /* if */
+  else if (value > 1023.0)
+  {
+    value = 1023.0;
+  } /* else if */
+
+  return ((sint16)floor(value + 0.5));
+
+} /* day_reading */
+
+
+//-----------------------------------------------------------------------------
+//                        Replay helpers
+//-----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
+// NAME: replay_start
+//
+// DESCRIPTION:
+//    This function prepares a detector and a tally for a replay.
+//
+// INPUT:
+//   sensor - LIGHT, TEMP or MOTION
+//
+// OUTPUT:
+//   detector - the sensor's detector, initialized as main.c does
+//   replay   - the cleared tally
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void replay_start(int sensor, ANOMALY_t* detector, REPLAY_t* replay)
+{
+
+  anomaly_init(detector, var_floors[sensor], detector_flags[sensor]);
+  memset(replay, 0, sizeof(*replay));
+  replay->first_alarm = -1;
+  replay->first_bad = -1;
+  status_init(&replay->engine, status_config);
+
+} /* replay_start */
+
+
+//----------------------------------------------------------------------------
+// NAME: replay_sample
+//
+// DESCRIPTION:
+//    This function feeds one sample to a detector and tallies the result.
+//    An event is counted when the level rises into suspect or alarm. The
+//    result then steps the status engine as the sensor's demand; the
+//    ANOMALY_* values line up with the STATUS_LEVEL_* ones just as the
+//    sensor statuses do in main.c.
+//
+// INPUT:
+//   detector  - the sensor's detector
+//   replay    - the tally
+//   step      - the sample's status step
+//   sample    - the reading
+//   alertness - index into z_tenths
+//
+// OUTPUT:
+//   replay - the updated tally
+//
+// RETURN:
+//   the level returned by anomaly_update()
+//----------------------------------------------------------------------------
+static uint8 replay_sample(ANOMALY_t* detector, REPLAY_t* replay, long step,
+                           sint16 sample, int alertness)
+{
+  uint8 level;
+
+  level = anomaly_update(detector, sample,
+                         ANOMALY_Z2(z_tenths[alertness][0]),
+                         ANOMALY_Z2(z_tenths[alertness][1]));
+
+  if (level == ANOMALY_ALARM)
+  {
+    replay->alarm_samples++;
+    if (replay->previous != ANOMALY_ALARM)
+    {
+      replay->alarms++;
+    } /* if */
+    if (replay->first_alarm < 0)
+    {
+      replay->first_alarm = step;
+    } /* if */
+  } /* if */
+  else if ((level == ANOMALY_SUSPECT) && (replay->previous == ANOMALY_NONE))
+  {
+    replay->suspects++;
+  } /* else if */
+
+  if (status_step(&replay->engine, level) &&
+      (status_level(&replay->engine) == STATUS_LEVEL_BAD))
+  {
+    replay->escalations++;
+    if (replay->first_bad < 0)
+    {
+      replay->first_bad = step;
+    } /* if */
+  } /* if */
+
+  replay->previous = level;
+  return (level);
+
+} /* replay_sample */
+
+
+//----------------------------------------------------------------------------
+// NAME: replay_day
+//
+// DESCRIPTION:
+//    This function replays a quiet day for one sensor and alertness level.
+//
+// INPUT:
+//   sensor    - LIGHT, TEMP or MOTION
+//   alertness - index into z_tenths
+//   days      - number of days to replay
+//
+// OUTPUT:
+//   replay - the tally
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void replay_day(int sensor, int alertness, int days, REPLAY_t* replay)
+{
+  ANOMALY_t detector;
+  long      step;
+  long      escalations;
+  long      time_of_day;
+
+  test_seed = 12345 + sensor;
+  cloud = 1.0;
+  replay_start(sensor, &detector, replay);
+
+  for (step = 0; step < days * STEPS_PER_DAY; step++)
+  {
+    time_of_day = step % STEPS_PER_DAY;
+    escalations = replay->escalations;
+    replay_sample(&detector, replay, step, day_reading(sensor, time_of_day),
+                  alertness);
+
+    if ((replay->escalations != escalations) &&
+        ((time_of_day < 6 * STEPS_PER_HOUR) ||
+         (time_of_day >= 18 * STEPS_PER_HOUR)))
+    {
+      replay->night_escalations++;
+    } /* if */
+  } /* for */
+
+} /* replay_day */
+
+
+//-----------------------------------------------------------------------------
+//                               Tests
+//-----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
+// NAME: test_false_alarms
+//
+// DESCRIPTION:
+//    This function prints, for each sensor and alertness level, how often a
+//    week of quiet days makes the detector alarm and how often that takes
+//    the status engine to BAD. At the default alertness a quiet night must
+//    never reach BAD. At every alertness, clouds clearing in the day, the
+//    brightening the one sided light detector is most exposed to, must
+//    cost less than one false BAD a day.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_false_alarms(void)
+{
+  REPLAY_t replay;
+  int      sensor;
+  int      alertness;
+
+  printf("quiet week, per day: detector alarms / BAD escalations (at night)\n");
+  printf("  %-8s %21s %21s %21s\n", "sensor", "z 3.0/4.0", "z 2.5/3.5",
+         "z 2.0/3.0");
+  for (sensor = 0; sensor < SENSORS; sensor++)
+  {
+    printf("  %-8s", sensor_names[sensor]);
+    for (alertness = 0; alertness < ALERTNESS_LEVELS; alertness++)
+    {
+      replay_day(sensor, alertness, 7, &replay);
+      printf("   %6.1f / %4.1f (%4.1f)", replay.alarms / 7.0,
+             replay.escalations / 7.0, replay.night_escalations / 7.0);
+
+      if (alertness == 0)
+      {
+        CHECK_EQUAL(0, replay.night_escalations);
+      } /* if */
+      CHECK(replay.escalations < 7);
+    } /* for */
+    printf("\n");
+  } /* for */
+
+} /* test_false_alarms */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_events
+//
+// DESCRIPTION:
+//    This function checks that each sensor takes the status engine to BAD
+//    promptly on the event it is there for, after an hour of quiet night
+//    at the default alertness:
+//
+//      light  - a flashlight adds 200 counts for 5 s
+//      temp   - a flame under the sensor adds 2 F per step up to 20 F.
+//               A ramp slow enough for the baseline to follow is learned
+//               as variance; slow fires are left to the rate of rise
+//               check in thermal.c
+//      motion - the board is lifted, 40 counts for 2 s
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_events(void)
+{
+  ANOMALY_t detector;
+  REPLAY_t  replay;
+  long      step;
+  long      start = STEPS_PER_HOUR;
+  sint16    sample;
+  int       sensor;
+
+  for (sensor = 0; sensor < SENSORS; sensor++)
+  {
+    test_seed = 777 + sensor;
+    cloud = 1.0;
+    replay_start(sensor, &detector, &replay);
+
+    for (step = 0; step < start + 60 * STEPS_PER_SECOND; step++)
+    {
+      sample = day_reading(sensor, step);
+      if (step >= start)
+      {
+        if ((sensor == LIGHT) && (step < start + 5 * STEPS_PER_SECOND))
+        {
+          sample += 200;
+        } /* if */
+        else if (sensor == TEMP)
+        {
+          sample += (sint16)((step - start < 10) ? 2 * (step - start + 1) : 20);
+        } /* else if */
+        else if ((sensor == MOTION) && (step < start + 2 * STEPS_PER_SECOND))
+        {
+          sample += 40;
+        } /* else if */
+      } /* if */
+
+      replay_sample(&detector, &replay, step, sample, 0);
+    } /* for */
+
+    printf("%-6s event: alarm after %.1f s, BAD after %.1f s\n",
+           sensor_names[sensor],
+           (double)(replay.first_alarm - start) / STEPS_PER_SECOND,
+           (double)(replay.first_bad - start) / STEPS_PER_SECOND);
+    CHECK(replay.first_alarm >= start);
+    CHECK(replay.first_bad >= start);
+    if (sensor == TEMP)
+    {
+      CHECK(replay.first_bad < start + 5 * STEPS_PER_SECOND);
+    } /* if */
+    else
+    {
+      CHECK_EQUAL(start, replay.first_alarm);
+      CHECK(replay.first_bad < start + STEPS_PER_SECOND);
+    } /* else */
+  } /* for */
+
+} /* test_events */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_baseline
+//
+// DESCRIPTION:
+//    This function checks the detector's rules on a clean signal:
+//
+//      - nothing is scored during the warm up
+//      - a one sided detector ignores drops
+//      - an alarm does not teach the detector to accept itself, but a
+//        lasting change is learned through the slow drift
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_baseline(void)
+{
+  ANOMALY_t detector;
+  long      step;
+  long      alarms = 0;
+  long      cleared = -1;
+  uint8     level;
+
+  // 12 bytes per sensor on the target
+  CHECK_EQUAL(12, sizeof(ANOMALY_t));
+
+  anomaly_init(&detector, LIGHT_VARIANCE_FLOOR, ANOMALY_ONE_SIDED);
+  for (step = 0; step < ANOMALY_WARMUP; step++)
+  {
+    level = anomaly_update(&detector, (step & 1) ? 1000 : 0, 36, 64);
+    CHECK_EQUAL(ANOMALY_NONE, level);
+  } /* for */
+  CHECK(anomaly_is_ready(&detector));
+
+  anomaly_init(&detector, LIGHT_VARIANCE_FLOOR, ANOMALY_ONE_SIDED);
+  for (step = 0; step < 1000; step++)
+  {
+    anomaly_update(&detector, 500, 36, 64);
+  } /* for */
+  CHECK_EQUAL(500, anomaly_mean(&detector));
+  CHECK_EQUAL(ANOMALY_NONE, anomaly_update(&detector, 0, 36, 64));
+  CHECK_EQUAL(ANOMALY_ALARM, anomaly_update(&detector, 700, 36, 64));
+
+  // Hold the step: the first minute must keep alarming, then the mean
+  // catches up within half an hour
+  for (step = 0; step < 30L * 60 * STEPS_PER_SECOND; step++)
+  {
+    level = anomaly_update(&detector, 700, 36, 64);
+    if (level == ANOMALY_ALARM)
+    {
+      alarms++;
+    } /* if */
+    else if (cleared < 0)
+    {
+      cleared = step;
+    } /* else if */
+  } /* for */
+
+  printf("a held +200 step alarmed for %.0f s\n",
+         (double)cleared / STEPS_PER_SECOND);
+  CHECK(cleared > 60 * STEPS_PER_SECOND);
+  CHECK(cleared < 30L * 60 * STEPS_PER_SECOND);
+  CHECK_EQUAL(ANOMALY_NONE, anomaly_update(&detector, 700, 36, 64));
+
+} /* test_baseline */
+
+
+//----------------------------------------------------------------------------
+// NAME: replay_csv
+//
+// DESCRIPTION:
+//    This function replays a window decoded by tools/blackbox_decode.py
+//    and prints the alarms each sensor raises at each alertness level. The
+//    temperature column is in tenths and is rounded to whole degrees as
+//    getTempLevel() does.
+//
+// INPUT:
+//   path - the CSV file
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   0 on success, 1 if the file can't be read
+//----------------------------------------------------------------------------
+static int replay_csv(const char* path)
+{
+  FILE*     file;
+  char      line[256];
+  ANOMALY_t detectors[ALERTNESS_LEVELS][SENSORS];
+  REPLAY_t  replays[ALERTNESS_LEVELS][SENSORS];
+  int       window, seq, light, temp, motion, distance;
+  double    time_ms;
+  long      step = 0;
+  sint16    samples[SENSORS];
+  int       sensor;
+  int       alertness;
+
+  file = fopen(path, "r");
+  if (file == NULL)
+  {
+    perror(path);
+    return (1);
+  } /* if */
+
+  for (alertness = 0; alertness < ALERTNESS_LEVELS; alertness++)
+  {
+    for (sensor = 0; sensor < SENSORS; sensor++)
+    {
+      replay_start(sensor, &detectors[alertness][sensor],
+                   &replays[alertness][sensor]);
+    } /* for */
+  } /* for */
+
+  while (fgets(line, sizeof(line), file) != NULL)
+  {
+    if (sscanf(line, "%d,%d,%lf,%d,%d,%d,%d", &window, &seq, &time_ms,
+               &light, &temp, &motion, &distance) != 7)
+    {
+      continue;
+    } /* if */
+
+    samples[LIGHT] = (sint16)light;
+    samples[TEMP] = (sint16)((temp + 5) / 10);
+    samples[MOTION] = (sint16)motion;
+    for (alertness = 0; alertness < ALERTNESS_LEVELS; alertness++)
+    {
+      for (sensor = 0; sensor < SENSORS; sensor++)
+      {
+        replay_sample(&detectors[alertness][sensor],
+                      &replays[alertness][sensor], step, samples[sensor],
+                      alertness);
+      } /* for */
+    } /* for */
+    step++;
+  } /* while */
+  fclose(file);
+
+  printf("%s: %ld samples (alarms, suspects)\n", path, step);
+  for (sensor = 0; sensor < SENSORS; sensor++)
+  {
+    printf("  %-8s", sensor_names[sensor]);
+    for (alertness = 0; alertness < ALERTNESS_LEVELS; alertness++)
+    {
+      printf("   %4ld %4ld", replays[alertness][sensor].alarms,
+             replays[alertness][sensor].suspects);
+    } /* for */
+    printf("\n");
+  } /* for */
+
+  return (0);
+
+} /* replay_csv */
+
+
+int main(int argc, char* argv[])
+{
+
+  if (argc > 1)
+  {
+    return (replay_csv(argv[1]));
+  } /* if */
+
+  test_baseline();
+  test_events();
+  test_false_alarms();
+
+  return (test_report("anomaly_test"));
+
+} /* main */
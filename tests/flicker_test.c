@@ -0,0 +1,584 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: flicker_test.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file validates the Goertzel filter bank in flicker.c on the host.
+//    Synthetic light waveforms are fed through the ATD0 register model one
+//    tick at a time, exactly as the tick interrupt would, and the test
+//    checks:
+//
+//      - the response of the mains and sweep bins to pure tones
+//      - the classification of steady light, lamps on 50 and 60 Hz mains,
+//        a flashlight swept across the sensor, slow dimming and a light
+//        being switched on
+//      - that full scale input does not overflow the fixed point state
+//
+//    A recorded waveform, one 10-bit reading per line at the tick rate,
+//    can be classified as well:
+//
+//      flicker_test light.txt
+//
+//*****************************************************************************
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <mc9s12dg256.h>
+#include "test.h"
+#include "flicker.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define PI                      3.14159265358979
+
+// Tick rate the interrupt samples at
+#define SAMPLE_RATE             976.5625
+#define SAMPLES(seconds)        ((long)((seconds) * SAMPLE_RATE))
+
+#define ATD_SEQUENCE_DONE       0x80
+
+// Waveforms
+#define WAVE_STEADY             0
+#define WAVE_TONE               1       // sine at the given frequency
+#define WAVE_RECTIFIED          2       // lamp on mains: |sin| at line freq
+#define WAVE_SWEEP              3       // beam swinging across the sensor
+#define WAVE_RAMP               4       // dimming over many seconds
+#define WAVE_STEP               5       // light switched on at 1 s
+#define WAVE_SQUARE             6       // full scale square wave
+
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  int    wave;
+  double level;         // DC level, counts
+  double amplitude;     // AC amplitude, counts
+  double frequency;     // Hz
+  double noise;         // standard deviation, counts
+  double width;         // sweep only: beam width, smaller is narrower
+} WAVE_t;
+
+typedef struct
+{
+  long  samples;
+  long  count[4];       // blocks classified as each LIGHT_SOURCE_
+  uint8 last;           // last classification
+  uint8 mains_peak;     // highest mains percent seen
+  uint8 sweep_peak;     // highest sweep percent seen
+} RUN_t;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+static const char* const source_names[4] =
+{
+  "unknown", "ambient", "artificial", "moving"
+};
+
+
+//-----------------------------------------------------------------------------
+//                        Waveforms
+//-----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
+// NAME: wave_value
+//
+// DESCRIPTION:
+//    This function returns a waveform's light reading at a tick, rounded
+//    and clipped to the 10-bit converter range.
+//
+// INPUT:
+//   wave - the waveform
+//   tick - the sample number
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the reading
+//----------------------------------------------------------------------------
+static uint16 wave_value(const WAVE_t* wave, long tick)
+{
+  double t = tick / SAMPLE_RATE;
+  double value = wave->level;
+  double phase;
+
+  switch (wave->wave)
+  {
+    case WAVE_TONE:
+      value += wave->amplitude * sin(2.0 * PI * wave->frequency * t);
+      break;
+
+    case WAVE_RECTIFIED:
+      value += wave->amplitude * fabs(sin(2.0 * PI * wave->frequency * t));
+      break;
+
+    case WAVE_SWEEP:
+      // The beam passes the sensor twice per swing, back and forth
+      phase = sin(2.0 * PI * wave->frequency * t);
+      value += wave->amplitude * exp(-phase * phase / wave->width);
+      break;
+
+    case WAVE_RAMP:
+      value += wave->amplitude * sin(2.0 * PI * wave->frequency * t);
+      break;
+
+    case WAVE_STEP:
+      if (t >= 1.0)
+      {
+        value += wave->amplitude;
+      } /* if */
+      break;
+
+    case WAVE_SQUARE:
+      value += (sin(2.0 * PI * wave->frequency * t) >= 0.0)
+             ? wave->amplitude : -wave->amplitude;
+      break;
+
+    default:
+      break;
+  } /* switch */
+
+  value += test_gauss(wave->noise);
+
+  if (value < 0.0)
+  {
+    value = 0.0;
+  } /* if */
+  else if (value > 1023.0)
+  {
+    value = 1023.0;
+  } /* else if */
+
+  return ((uint16)floor(value + 0.5));
+
+} /* wave_value */
+
+
+//----------------------------------------------------------------------------
+// NAME: run_start
+//
+// DESCRIPTION:
+//    This function restarts the filter bank for a new waveform.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   run - the cleared tally
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void run_start(RUN_t* run)
+{
+  int source;
+
+  flicker_init();
+  flicker_set_enabled(TRUE);
+
+  run->samples = 0;
+  for (source = 0; source < 4; source++)
+  {
+    run->count[source] = 0;
+  } /* for */
+  run->last = LIGHT_SOURCE_UNKNOWN;
+  run->mains_peak = 0;
+  run->sweep_peak = 0;
+
+} /* run_start */
+
+
+//----------------------------------------------------------------------------
+// NAME: run_sample
+//
+// DESCRIPTION:
+//    This function converts one reading the way the tick interrupt sees it
+//    and lets the main loop analyse any block that finished.
+//
+// INPUT:
+//   run   - the tally
+//   light - the light reading
+//
+// OUTPUT:
+//   run - the updated tally
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void run_sample(RUN_t* run, uint16 light)
+{
+
+  ATD0DR0 = light;
+  ATD0DR1 = 512;
+  ATD0STAT0 = ATD_SEQUENCE_DONE;
+  flicker_sample();
+  run->samples++;
+
+  if (flicker_poll())
+  {
+    run->last = flicker_source();
+    run->count[run->last]++;
+    if (flicker_mains_percent() > run->mains_peak)
+    {
+      run->mains_peak = flicker_mains_percent();
+    } /* if */
+    if (flicker_sweep_percent() > run->sweep_peak)
+    {
+      run->sweep_peak = flicker_sweep_percent();
+    } /* if */
+  } /* if */
+
+} /* run_sample */
+
+
+//----------------------------------------------------------------------------
+// NAME: run_wave
+//
+// DESCRIPTION:
+//    This function feeds a waveform through the filter bank. The first
+//    skip seconds are fed but not tallied, so the bank settles first.
+//
+// INPUT:
+//   wave    - the waveform
+//   seconds - how long to run
+//   skip    - seconds to settle before tallying
+//
+// OUTPUT:
+//   run - the tally of the blocks after the settling time
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void run_wave(const WAVE_t* wave, double seconds, double skip,
+                     RUN_t* run)
+{
+  long tick;
+  long settle = SAMPLES(skip);
+
+  test_seed = 4242;
+  run_start(run);
+
+  for (tick = 0; tick < SAMPLES(seconds); tick++)
+  {
+    if (tick == settle)
+    {
+      run->count[LIGHT_SOURCE_AMBIENT] = 0;
+      run->count[LIGHT_SOURCE_ARTIFICIAL] = 0;
+      run->count[LIGHT_SOURCE_MOVING] = 0;
+      run->mains_peak = 0;
+      run->sweep_peak = 0;
+    } /* if */
+    run_sample(run, wave_value(wave, tick));
+  } /* for */
+
+} /* run_wave */
+
+
+//-----------------------------------------------------------------------------
+//                               Tests
+//-----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
+// NAME: test_tones
+//
+// DESCRIPTION:
+//    This function prints the share of a pure tone each bank reports
+//    across the band and checks the bins pick out their own frequencies:
+//    over 80% at 100 and 120 Hz and under 20% an octave away, and the
+//    sweep band covering 1-3 Hz but not 0.2 Hz or 8 Hz.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_tones(void)
+{
+  static const double mains_tones[] = { 25, 50, 60, 80, 100, 110, 120, 150, 240 };
+  static const double sweep_tones[] = { 0.2, 0.5, 1, 1.5, 2, 2.5, 3, 5, 8 };
+  WAVE_t wave = { WAVE_TONE, 500.0, 20.0, 0.0, 0.0, 0.0 };
+  RUN_t  run;
+  size_t i;
+
+  printf("tone response, %% of AC energy in the bank\n  mains:");
+  for (i = 0; i < sizeof(mains_tones) / sizeof(mains_tones[0]); i++)
+  {
+    wave.frequency = mains_tones[i];
+    run_wave(&wave, 2.0, 0.5, &run);
+    printf(" %g Hz %u%%", mains_tones[i], run.mains_peak);
+
+    if ((mains_tones[i] == 100) || (mains_tones[i] == 120))
+    {
+      CHECK(run.mains_peak >= 80);
+      CHECK_EQUAL(LIGHT_SOURCE_ARTIFICIAL, run.last);
+    } /* if */
+    else if ((mains_tones[i] <= 50) || (mains_tones[i] >= 240))
+    {
+      CHECK(run.mains_peak < 20);
+    } /* else if */
+  } /* for */
+
+  wave.amplitude = 100.0;
+  printf("\n  sweep:");
+  for (i = 0; i < sizeof(sweep_tones) / sizeof(sweep_tones[0]); i++)
+  {
+    wave.frequency = sweep_tones[i];
+    run_wave(&wave, 12.0, 4.0, &run);
+    printf(" %g Hz %u%%", sweep_tones[i], run.sweep_peak);
+
+    if ((sweep_tones[i] >= 1.0) && (sweep_tones[i] <= 3.0))
+    {
+      CHECK(run.sweep_peak >= 80);
+      CHECK_EQUAL(LIGHT_SOURCE_MOVING, run.last);
+    } /* if */
+    else if ((sweep_tones[i] <= 0.2) || (sweep_tones[i] >= 8.0))
+    {
+      CHECK(run.sweep_peak < 50);
+      CHECK(run.last != LIGHT_SOURCE_MOVING);
+    } /* else if */
+  } /* for */
+  printf("\n");
+
+} /* test_tones */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_scenes
+//
+// DESCRIPTION:
+//    This function checks the classification of the scenes the detector is
+//    meant to tell apart. Each runs for 10 s and every block after the
+//    settling time must agree. The flashlights swing once or twice a
+//    second; a narrow beam only lights the sensor for a tenth of the time.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_scenes(void)
+{
+  static const struct
+  {
+    const char* name;
+    WAVE_t      wave;
+    uint8       expected;
+  } scenes[] =
+  {
+    { "dark room",            { WAVE_STEADY,     20.0,   0.0,  0.0, 1.0, 0.0  }, LIGHT_SOURCE_AMBIENT },
+    { "daylight",             { WAVE_STEADY,    600.0,   0.0,  0.0, 2.0, 0.0  }, LIGHT_SOURCE_AMBIENT },
+    { "fluorescent, 50 Hz",   { WAVE_RECTIFIED, 400.0,  60.0, 50.0, 2.0, 0.0  }, LIGHT_SOURCE_ARTIFICIAL },
+    { "LED, 60 Hz",           { WAVE_RECTIFIED, 300.0,  40.0, 60.0, 2.0, 0.0  }, LIGHT_SOURCE_ARTIFICIAL },
+    { "incandescent, 60 Hz",  { WAVE_RECTIFIED, 500.0,  12.0, 60.0, 1.0, 0.0  }, LIGHT_SOURCE_ARTIFICIAL },
+    { "flashlight, wide",     { WAVE_SWEEP,      30.0, 400.0,  1.0, 2.0, 0.1  }, LIGHT_SOURCE_MOVING },
+    { "flashlight, narrow",   { WAVE_SWEEP,      30.0, 400.0,  1.0, 2.0, 0.02 }, LIGHT_SOURCE_MOVING },
+    { "flashlight, slow",     { WAVE_SWEEP,      30.0, 200.0,  0.5, 2.0, 0.05 }, LIGHT_SOURCE_MOVING },
+    { "flashlight, fast",     { WAVE_SWEEP,      30.0, 200.0,  1.5, 2.0, 0.05 }, LIGHT_SOURCE_MOVING },
+    { "slow dimming",         { WAVE_RAMP,      300.0, 200.0, 0.05, 2.0, 0.0  }, LIGHT_SOURCE_AMBIENT },
+    { "faster dimming",       { WAVE_RAMP,      300.0, 200.0, 0.2,  2.0, 0.0  }, LIGHT_SOURCE_AMBIENT },
+  };
+  RUN_t  run;
+  size_t i;
+  int    source;
+
+  for (i = 0; i < sizeof(scenes) / sizeof(scenes[0]); i++)
+  {
+    run_wave(&scenes[i].wave, 10.0, 2.0, &run);
+
+    printf("%-20s ->", scenes[i].name);
+    for (source = LIGHT_SOURCE_AMBIENT; source <= LIGHT_SOURCE_MOVING; source++)
+    {
+      printf(" %s %ld", source_names[source], run.count[source]);
+    } /* for */
+    printf("\n");
+
+    for (source = LIGHT_SOURCE_AMBIENT; source <= LIGHT_SOURCE_MOVING; source++)
+    {
+      if (source != scenes[i].expected)
+      {
+        CHECK_EQUAL(0, run.count[source]);
+      } /* if */
+    } /* for */
+    CHECK(run.count[scenes[i].expected] > 0);
+  } /* for */
+
+} /* test_scenes */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_switch_on
+//
+// DESCRIPTION:
+//    This function switches a 60 Hz lamp on after a second of darkness.
+//    The step must not read as moving, and the lamp must end up classified
+//    as artificial.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_switch_on(void)
+{
+  WAVE_t wave = { WAVE_STEP, 20.0, 300.0, 0.0, 1.0, 0.0 };
+  RUN_t  run;
+  long   tick;
+  long   moving_ticks = 0;
+  uint16 light;
+
+  test_seed = 99;
+  run_start(&run);
+
+  for (tick = 0; tick < SAMPLES(6.0); tick++)
+  {
+    light = wave_value(&wave, tick);
+    if (tick >= SAMPLES(1.0))
+    {
+      light += (uint16)(30.0 * fabs(sin(2.0 * PI * 60.0 * tick / SAMPLE_RATE)));
+    } /* if */
+    run_sample(&run, light);
+
+    if (flicker_source() == LIGHT_SOURCE_MOVING)
+    {
+      moving_ticks++;
+    } /* if */
+  } /* for */
+
+  printf("switch on: moving for %.2f s, then %s\n",
+         moving_ticks / SAMPLE_RATE, source_names[run.last]);
+  CHECK_EQUAL(0, moving_ticks);
+  CHECK_EQUAL(LIGHT_SOURCE_ARTIFICIAL, run.last);
+
+} /* test_switch_on */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_full_scale
+//
+// DESCRIPTION:
+//    This function drives the converter rail to rail at the lowest
+//    frequency of each bank, where the filter state grows the most, and
+//    checks the shares still come out as a square wave's should.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_full_scale(void)
+{
+  WAVE_t wave = { WAVE_SQUARE, 512.0, 511.0, 100.0, 0.0, 0.0 };
+  RUN_t  run;
+
+  // A square wave has 81% of its energy in the fundamental
+  run_wave(&wave, 2.0, 0.5, &run);
+  printf("full scale square: 100 Hz %u%%", run.mains_peak);
+  CHECK(run.mains_peak >= 70);
+  CHECK(run.mains_peak <= 90);
+
+  wave.frequency = 1.0;
+  run_wave(&wave, 12.0, 4.0, &run);
+  printf(", 1 Hz %u%%\n", run.sweep_peak);
+  CHECK(run.sweep_peak >= 70);
+  CHECK_EQUAL(LIGHT_SOURCE_MOVING, run.last);
+
+} /* test_full_scale */
+
+
+//----------------------------------------------------------------------------
+// NAME: classify_file
+//
+// DESCRIPTION:
+//    This function classifies a recorded waveform and prints how many
+//    blocks fell in each class.
+//
+// INPUT:
+//   path - a text file with one reading per line at the tick rate
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   0 on success, 1 if the file can't be read
+//----------------------------------------------------------------------------
+static int classify_file(const char* path)
+{
+  FILE*    file;
+  RUN_t    run;
+  unsigned light;
+  int      source;
+
+  file = fopen(path, "r");
+  if (file == NULL)
+  {
+    perror(path);
+    return (1);
+  } /* if */
+
+  run_start(&run);
+  while (fscanf(file, "%u", &light) == 1)
+  {
+    run_sample(&run, (uint16)(light & 0x3FF));
+  } /* while */
+  fclose(file);
+
+  printf("%s: %.1f s,", path, run.samples / SAMPLE_RATE);
+  for (source = LIGHT_SOURCE_AMBIENT; source <= LIGHT_SOURCE_MOVING; source++)
+  {
+    printf(" %s %ld", source_names[source], run.count[source]);
+  } /* for */
+  printf(", peak mains %u%% sweep %u%%\n", run.mains_peak, run.sweep_peak);
+
+  return (0);
+
+} /* classify_file */
+
+
+int main(int argc, char* argv[])
+{
+
+  if (argc > 1)
+  {
+    return (classify_file(argv[1]));
+  } /* if */
+
+  test_tones();
+  test_scenes();
+  test_switch_on();
+  test_full_scale();
+
+  return (test_report("flicker_test"));
+
+} /* main */
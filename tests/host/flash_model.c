@@ -0,0 +1,419 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: flash_model.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file implements the host flash model described in flash_model.h
+//    behind the flash.h interface, so journal.c runs on it unchanged.
+//
+//    The model knows the journal's record layout only to report the last
+//    record that was committed: one whose CRC word, the last of its 16
+//    bytes, finished programming.
+//
+//*****************************************************************************
+
+#include <string.h>
+#include "flash.h"
+#include "flash_model.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define MODEL_SIZE              ((uint32)FLASH_MODEL_PAGES * FLASH_PAGE_SIZE)
+#define RECORD_SIZE             16
+
+#define COMMAND_NONE            0
+#define COMMAND_PROGRAM         1
+#define COMMAND_ERASE           2
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+static uint8  memory[MODEL_SIZE];
+static uint8  command;              // COMMAND_* in progress
+static uint32 address;              // its byte address in memory
+static uint16 data;                 // word being programmed
+static uint16 polls_left;
+static uint32 cut_at;               // command to cut the power in, 0 for none
+static bool   off;
+static uint32 seed = 1;
+static FLASH_MODEL_STATS_t stats;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
+// NAME: model_random
+//
+// DESCRIPTION:
+//    This function returns a random byte (xorshift32) for torn commands.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the byte
+//----------------------------------------------------------------------------
+static uint8 model_random(void)
+{
+
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+
+  return ((uint8)(seed >> 24));
+
+} /* model_random */
+
+
+//----------------------------------------------------------------------------
+// NAME: model_address
+//
+// DESCRIPTION:
+//    This function maps a page and offset to a byte of the model.
+//
+// INPUT:
+//   page   - the flash page, 0x30 - 0x33
+//   offset - the offset within the page
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the byte address, the first byte if page and offset are outside
+//   the model
+//----------------------------------------------------------------------------
+static uint32 model_address(uint8 page, uint16 offset)
+{
+
+  if ((page < FLASH_MODEL_FIRST_PAGE) ||
+      (page >= FLASH_MODEL_FIRST_PAGE + FLASH_MODEL_PAGES) ||
+      (offset >= FLASH_PAGE_SIZE))
+  {
+    stats.bad_addresses++;
+    return (0);
+  } /* if */
+
+  return ((uint32)(page - FLASH_MODEL_FIRST_PAGE) * FLASH_PAGE_SIZE + offset);
+
+} /* model_address */
+
+
+//----------------------------------------------------------------------------
+// NAME: model_finish
+//
+// DESCRIPTION:
+//    This function completes the command in progress.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void model_finish(void)
+{
+  uint32 record;
+
+  if (command == COMMAND_PROGRAM)
+  {
+    memory[address] &= (uint8)(data >> 8);
+    memory[address + 1] &= (uint8)data;
+
+    if ((address % RECORD_SIZE) == RECORD_SIZE - 2)
+    {
+      record = address - (RECORD_SIZE - 2);
+      stats.last_committed = ((uint32)memory[record] << 24) |
+                             ((uint32)memory[record + 1] << 16) |
+                             ((uint32)memory[record + 2] << 8) |
+                             memory[record + 3];
+    } /* if */
+  } /* if */
+  else if (command == COMMAND_ERASE)
+  {
+    memset(&memory[address], 0xFF, FLASH_SECTOR_SIZE);
+  } /* else if */
+
+  command = COMMAND_NONE;
+
+} /* model_finish */
+
+
+//----------------------------------------------------------------------------
+// NAME: model_tear
+//
+// DESCRIPTION:
+//    This function cuts the power in the middle of the command in
+//    progress: a program clears only some of its bits. An erase may not
+//    have started, may have set only some bits, or may have finished.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void model_tear(void)
+{
+  uint16 i;
+  uint8  progress = model_random() % 3;
+
+  if (command == COMMAND_PROGRAM)
+  {
+    memory[address] &= (uint8)(data >> 8) | model_random();
+    memory[address + 1] &= (uint8)data | model_random();
+  } /* if */
+  else if (command == COMMAND_ERASE)
+  {
+    for (i = 0; (progress > 0) && (i < FLASH_SECTOR_SIZE); i++)
+    {
+      memory[address + i] |= (progress == 1) ? model_random() : 0xFF;
+    } /* for */
+  } /* else if */
+
+  command = COMMAND_NONE;
+  off = TRUE;
+
+} /* model_tear */
+
+
+//----------------------------------------------------------------------------
+// NAME: model_start
+//
+// DESCRIPTION:
+//    This function starts a command, or cuts the power in it if it is the
+//    one chosen by flash_model_cut_at().
+//
+// INPUT:
+//   kind  - COMMAND_PROGRAM or COMMAND_ERASE
+//   where - the byte address
+//   word  - the word to program
+//   polls - how long it keeps the block busy
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   FLASH_OK, FLASH_BUSY or FLASH_ERROR
+//----------------------------------------------------------------------------
+static uint8 model_start(uint8 kind, uint32 where, uint16 word, uint16 polls)
+{
+
+  if (off)
+  {
+    return (FLASH_ERROR);
+  } /* if */
+  if (command != COMMAND_NONE)
+  {
+    return (FLASH_BUSY);
+  } /* if */
+
+  command = kind;
+  address = where;
+  data = word;
+  polls_left = polls;
+
+  if (++stats.commands == cut_at)
+  {
+    model_tear();
+  } /* if */
+
+  return (FLASH_OK);
+
+} /* model_start */
+
+
+//-----------------------------------------------------------------------------
+//                               Model controls
+//-----------------------------------------------------------------------------
+
+void flash_model_erase_all(void)
+{
+
+  memset(memory, 0xFF, sizeof(memory));
+  flash_model_power_on();
+
+} /* flash_model_erase_all */
+
+
+void flash_model_power_on(void)
+{
+
+  command = COMMAND_NONE;
+  cut_at = 0;
+  off = FALSE;
+  memset(&stats, 0, sizeof(stats));
+
+} /* flash_model_power_on */
+
+
+void flash_model_cut_at(uint32 number)
+{
+
+  cut_at = number;
+
+} /* flash_model_cut_at */
+
+
+bool flash_model_is_off(void)
+{
+
+  return (off);
+
+} /* flash_model_is_off */
+
+
+void flash_model_save(uint8* image)
+{
+
+  memcpy(image, memory, sizeof(memory));
+
+} /* flash_model_save */
+
+
+void flash_model_restore(const uint8* image)
+{
+
+  memcpy(memory, image, sizeof(memory));
+  flash_model_power_on();
+
+} /* flash_model_restore */
+
+
+uint32 flash_model_size(void)
+{
+
+  return (MODEL_SIZE);
+
+} /* flash_model_size */
+
+
+FLASH_MODEL_STATS_t* flash_model_stats(void)
+{
+
+  return (&stats);
+
+} /* flash_model_stats */
+
+
+//-----------------------------------------------------------------------------
+//                               flash.h
+//-----------------------------------------------------------------------------
+
+void flash_init(void)
+{
+} /* flash_init */
+
+
+uint8 flash_start_program(uint8 page, uint16 offset, uint16 word)
+{
+  uint32 where = model_address(page, offset);
+
+  if ((offset & 1) != 0)
+  {
+    stats.bad_addresses++;
+  } /* if */
+  if (!off && (command == COMMAND_NONE) &&
+      ((memory[where] != 0xFF) || (memory[where + 1] != 0xFF)))
+  {
+    stats.overprograms++;
+  } /* if */
+
+  stats.programs++;
+  return (model_start(COMMAND_PROGRAM, where, word, FLASH_MODEL_PROGRAM_POLLS));
+
+} /* flash_start_program */
+
+
+uint8 flash_start_erase(uint8 page, uint16 offset)
+{
+  uint32 where = model_address(page, offset & ~(FLASH_SECTOR_SIZE - 1));
+
+  stats.erases++;
+  return (model_start(COMMAND_ERASE, where, 0xFFFF, FLASH_MODEL_ERASE_POLLS));
+
+} /* flash_start_erase */
+
+
+bool flash_is_busy(uint8 page)
+{
+
+  if (off || (command == COMMAND_NONE))
+  {
+    return (FALSE);
+  } /* if */
+
+  if (polls_left > 0)
+  {
+    polls_left--;
+    return (TRUE);
+  } /* if */
+
+  model_finish();
+  return (FALSE);
+
+} /* flash_is_busy */
+
+
+uint8 flash_result(uint8 page)
+{
+
+  if (command != COMMAND_NONE)
+  {
+    return (FLASH_BUSY);
+  } /* if */
+
+  return (off ? FLASH_ERROR : FLASH_OK);
+
+} /* flash_result */
+
+
+uint16 flash_read_word(uint8 page, uint16 offset)
+{
+  uint32 where = model_address(page, offset);
+
+  stats.reads++;
+  if (command != COMMAND_NONE)
+  {
+    stats.busy_reads++;
+  } /* if */
+
+  return (((uint16)memory[where] << 8) | memory[where + 1]);
+
+} /* flash_read_word */
+
+
+void flash_read(uint8 page, uint16 offset, uint8* destination, uint16 length)
+{
+  uint32 where = model_address(page, offset);
+
+  stats.reads++;
+  if (command != COMMAND_NONE)
+  {
+    stats.busy_reads++;
+  } /* if */
+
+  memcpy(destination, &memory[where], length);
+
+} /* flash_read */
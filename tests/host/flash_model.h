@@ -0,0 +1,73 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: flash_model.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the controls of the host flash model, which
+//    implements flash.h for flash block 3 (pages 0x30 - 0x33) in RAM:
+//
+//      - Programming can only clear bits and erasing sets a whole sector
+//        to 0xFF, as on the part.
+//      - A command keeps the block busy for a number of flash_is_busy()
+//        polls, so an erase takes a while to finish.
+//      - Power can be cut while the Nth command runs. A cut program leaves
+//        only some of its bits cleared. A cut erase may leave the sector
+//        untouched, partly erased or fully erased. After the cut every call is ignored until
+//        flash_model_power_on().
+//      - Misuse the driver would not catch is counted: programming a word
+//        that isn't erased, reading the block while it is busy.
+//
+//*****************************************************************************
+
+#ifndef _FLASH_MODEL_H_
+#define _FLASH_MODEL_H_
+
+#include "sys_types.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define FLASH_MODEL_FIRST_PAGE  0x30
+#define FLASH_MODEL_PAGES       4
+
+// Polls a command keeps the block busy for
+#define FLASH_MODEL_PROGRAM_POLLS   1
+#define FLASH_MODEL_ERASE_POLLS     20
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  uint32 commands;          // commands started since power on
+  uint32 programs;
+  uint32 erases;
+  uint32 reads;             // flash_read() and flash_read_word() calls
+  uint32 overprograms;      // programs of a word that was not 0xFFFF
+  uint32 busy_reads;        // reads while the block was busy
+  uint32 bad_addresses;     // accesses outside the block or to odd words
+  uint32 last_committed;    // sequence of the last record whose CRC word
+                            // finished programming, 0 if none
+} FLASH_MODEL_STATS_t;
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+void   flash_model_erase_all(void);
+void   flash_model_power_on(void);
+void   flash_model_cut_at(uint32 command);
+bool   flash_model_is_off(void);
+void   flash_model_save(uint8* image);
+void   flash_model_restore(const uint8* image);
+uint32 flash_model_size(void);
+FLASH_MODEL_STATS_t* flash_model_stats(void);
+
+#endif /* _FLASH_MODEL_H_ */
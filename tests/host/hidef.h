@@ -0,0 +1,24 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: hidef.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file stands in for the CodeWarrior hidef.h in host builds of the
+//    unit tests. There are no interrupts on the host, so the macros that
+//    mask them do nothing.
+//
+//*****************************************************************************
+
+#ifndef _HIDEF_H_
+#define _HIDEF_H_
+
+#define EnableInterrupts
+#define DisableInterrupts
+
+#endif /* _HIDEF_H_ */
@@ -0,0 +1,33 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: mc9s12dg256.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file stands in for the derivative header in host builds of the
+//    unit tests. Each register a tested module uses is a plain variable,
+//    defined in registers.c, which the test sets up before calling the
+//    module and checks afterwards. Registers are added here as modules
+//    come under test.
+//
+//*****************************************************************************
+
+#ifndef _MC9S12DG256_H_
+#define _MC9S12DG256_H_
+
+#include "sys_types.h"
+
+//-----------------------------------------------------------------------------
+//                        ATD0
+//-----------------------------------------------------------------------------
+extern volatile uint8  ATD0CTL5;
+extern volatile uint8  ATD0STAT0;
+extern volatile uint16 ATD0DR0;
+extern volatile uint16 ATD0DR1;
+
+#endif /* _MC9S12DG256_H_ */
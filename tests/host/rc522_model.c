@@ -0,0 +1,1105 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: rc522_model.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file implements the host RC522 and MIFARE Classic card model
+//    described in rc522_model.h, and the main.asm, idle.c and timebase.c
+//    routines the RC522 driver and mifare.c call.
+//
+//    The card does not run Crypto1. The model only tracks whether the
+//    RC522 and the card both have it on, which is all a frame needs to be
+//    understood.
+//
+//*****************************************************************************
+
+#include <string.h>
+#include "rc522_model.h"
+#include "main_asm.h"
+#include "idle.h"
+#include "timebase.h"
+#include "RFID_rc522.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// RC522 commands
+#define CMD_CALC_CRC            0x03
+#define CMD_TRANSCEIVE          0x0C
+#define CMD_AUTHENT             0x0E
+#define CMD_RESET               0x0F
+#define CMD_MASK                0x0F
+
+// ComIrqReg
+#define IRQ_SET1                0x80
+#define IRQ_TX                  0x40
+#define IRQ_RX                  0x20
+#define IRQ_IDLE                0x10
+#define IRQ_ERR                 0x02
+#define IRQ_TIMER               0x01
+
+#define DIV_IRQ_CRC             0x04
+#define ERROR_PARITY            0x02
+#define BIT_FRAMING_START_SEND  0x80
+#define FIFO_LEVEL_FLUSH        0x80
+#define T_MODE_AUTO             0x80
+#define STATUS2_CRYPTO1         0x08
+
+// One bit at 106 kbit/s is 128 carrier cycles, 9.44 us
+#define AIR_BIT_NS              9440
+#define CARRIER_KHZ             13560
+
+#define NEVER                   0xFFFFFFFFUL
+#define NO_ANSWER               (-1L)
+
+#define MIFARE_ACK              0x0A
+#define MIFARE_NAK              0x04
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+static RC522_MODEL_t chips[RC522_MODEL_PORTS];
+static uint32        clock_us;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
+// NAME: crc_a
+//
+// DESCRIPTION:
+//    This function computes the ISO/IEC 14443-3 CRC_A the card checks and
+//    sends, independently of the driver's rc522_crc_a().
+//
+// INPUT:
+//   data   - the bytes
+//   length - the number of bytes
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the CRC, low byte first on the air
+//----------------------------------------------------------------------------
+static uint16 crc_a(const uint8* data, uint8 length)
+{
+  uint16 crc = 0x6363;
+  uint8  bit;
+
+  while (length-- > 0)
+  {
+    crc ^= *data++;
+    for (bit = 0; bit < 8; bit++)
+    {
+      crc = (crc & 1) ? (uint16)((crc >> 1) ^ 0x8408) : (uint16)(crc >> 1);
+    } /* for */
+  } /* while */
+
+  return (crc);
+
+} /* crc_a */
+
+
+//----------------------------------------------------------------------------
+// NAME: crc_ok
+//
+// DESCRIPTION:
+//    This function checks the CRC_A at the end of a frame.
+//
+// INPUT:
+//   frame  - the frame
+//   length - its length with the CRC
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if it matches
+//----------------------------------------------------------------------------
+static bool crc_ok(const uint8* frame, uint8 length)
+{
+  uint16 crc;
+
+  if (length < 3)
+  {
+    return (FALSE);
+  } /* if */
+
+  crc = crc_a(frame, length - 2);
+  return ((frame[length - 2] == (uint8)crc) && (frame[length - 1] == (uint8)(crc >> 8)));
+
+} /* crc_ok */
+
+
+//----------------------------------------------------------------------------
+// NAME: air_us
+//
+// DESCRIPTION:
+//    This function returns how long a frame is on the air: 9 bits a byte
+//    with parity, or the bits of a short frame.
+//
+// INPUT:
+//   bytes     - whole bytes
+//   last_bits - bits of the last byte, 0 for all 8
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the time in us
+//----------------------------------------------------------------------------
+static uint32 air_us(uint8 bytes, uint8 last_bits)
+{
+  uint32 bits = (uint32)bytes * 9;
+
+  if ((bytes > 0) && (last_bits != 0))
+  {
+    bits -= 9 - last_bits;
+  } /* if */
+
+  return ((bits * AIR_BIT_NS + 999) / 1000);
+
+} /* air_us */
+
+
+//----------------------------------------------------------------------------
+// NAME: timer_us
+//
+// DESCRIPTION:
+//    This function returns how long the RC522 timer runs as set up in its
+//    registers.
+//
+// INPUT:
+//   chip - the RC522
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the time in us
+//----------------------------------------------------------------------------
+static uint32 timer_us(const RC522_MODEL_t* chip)
+{
+  uint32 prescaler = ((uint32)(chip->regs[T_MODE_REG] & 0x0F) << 8) |
+                     chip->regs[T_PRESCALER_REG];
+  uint32 reload = ((uint32)chip->regs[T_RELOAD_REG_H] << 8) | chip->regs[T_RELOAD_REG_L];
+  uint32 cycles = (reload + 1) * (2 * prescaler + 1);
+
+  return ((cycles * 1000 + CARRIER_KHZ / 2) / CARRIER_KHZ);
+
+} /* timer_us */
+
+
+//----------------------------------------------------------------------------
+// NAME: chip_reset
+//
+// DESCRIPTION:
+//    This function puts the registers back to their reset values.
+//
+// INPUT:
+//   chip - the RC522
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void chip_reset(RC522_MODEL_t* chip)
+{
+
+  memset(chip->regs, 0, sizeof(chip->regs));
+  chip->regs[COMMAND_REG] = 0x20;
+  chip->regs[COM_IEN_REG] = 0x80;
+  chip->regs[COM_IRQ_REG] = 0x14;
+  chip->regs[STATUS1_REG] = 0x21;
+  chip->regs[WATER_LEVEL_REG] = 0x08;
+  chip->regs[CONTROL_REG] = 0x10;
+  chip->regs[MODE_REG] = 0x3F;
+  chip->regs[TX_CONTROL_REG] = 0x80;
+  chip->regs[TX_SEL_REG] = 0x10;
+  chip->regs[RX_SEL_REG] = 0x84;
+  chip->regs[RX_THRESHOLD_REG] = 0x84;
+  chip->regs[DEMOD_REG] = 0x4D;
+  chip->regs[RF_CFG_REG] = 0x48;
+  chip->regs[GSN_REG] = 0x88;
+  chip->regs[CWGSP_REG] = 0x20;
+  chip->regs[MODGSP_REG] = 0x20;
+  chip->regs[VERSION_REG] = RC522_MODEL_VERSION;
+  chip->fifo_count = 0;
+  chip->running = FALSE;
+
+} /* chip_reset */
+
+
+//----------------------------------------------------------------------------
+// NAME: card_sector
+//
+// DESCRIPTION:
+//    This function returns the sector of a block and its trailer block.
+//
+// INPUT:
+//   block - the block
+//
+// OUTPUT:
+//   trailer - the sector trailer
+//
+// RETURN:
+//   the sector
+//----------------------------------------------------------------------------
+static uint8 card_sector(uint8 block, uint8* trailer)
+{
+
+  if (block < 128)
+  {
+    *trailer = (uint8)(block | 3);
+    return (block / 4);
+  } /* if */
+
+  *trailer = (uint8)(block | 15);
+  return ((uint8)(32 + (block - 128) / 16));
+
+} /* card_sector */
+
+
+//----------------------------------------------------------------------------
+// NAME: card_answer
+//
+// DESCRIPTION:
+//    This function puts a card answer, with its CRC_A if asked for, in the
+//    RC522's answer buffer.
+//
+// INPUT:
+//   chip      - the RC522
+//   data      - the answer
+//   length    - its length
+//   last_bits - bits of the last byte, 0 for all 8
+//   crc       - TRUE to append the CRC
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void card_answer(RC522_MODEL_t* chip, const uint8* data, uint8 length,
+                        uint8 last_bits, bool crc)
+{
+  uint16 value;
+
+  memcpy(chip->answer, data, length);
+  if (crc)
+  {
+    value = crc_a(data, length);
+    chip->answer[length++] = (uint8)value;
+    chip->answer[length++] = (uint8)(value >> 8);
+  } /* if */
+
+  chip->answer_length = length;
+  chip->answer_last_bits = last_bits;
+
+} /* card_answer */
+
+
+//----------------------------------------------------------------------------
+// NAME: card_nak
+//
+// DESCRIPTION:
+//    This function answers NAK. The card drops back to IDLE and forgets
+//    its authentication.
+//
+// INPUT:
+//   chip - the RC522 the card is on
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the card's processing time
+//----------------------------------------------------------------------------
+static long card_nak(RC522_MODEL_t* chip)
+{
+  uint8 nak = MIFARE_NAK;
+
+  chip->card.naks++;
+  chip->card.state = CARD_IDLE;
+  chip->card.write_block = -1;
+  card_answer(chip, &nak, 1, 4, FALSE);
+
+  return (RC522_MODEL_CARD_US);
+
+} /* card_nak */
+
+
+//----------------------------------------------------------------------------
+// NAME: card_frame
+//
+// DESCRIPTION:
+//    This function lets the card handle a frame and works out its answer.
+//
+// INPUT:
+//   chip      - the RC522 the card is on
+//   frame     - the frame
+//   length    - its length in bytes
+//   last_bits - bits of the last byte, 0 for all 8
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the card's processing time in us, or NO_ANSWER
+//----------------------------------------------------------------------------
+static long card_frame(RC522_MODEL_t* chip, const uint8* frame, uint8 length, uint8 last_bits)
+{
+  RC522_MODEL_CARD_t* card = &chip->card;
+  bool  encrypted = (chip->regs[STATUS2_REG] & STATUS2_CRYPTO1) != 0;
+  uint8 answer[18];
+  uint8 trailer;
+  uint8 sector;
+
+  if (!card->present || (length == 0))
+  {
+    return (NO_ANSWER);
+  } /* if */
+  card->frames++;
+
+  // A frame the card can't decipher, or a plain one while it expects
+  // Crypto1, is noise to it
+  if (encrypted != (card->state == CARD_AUTHENTICATED))
+  {
+    if (card->state != CARD_HALT)
+    {
+      card->state = CARD_IDLE;
+    } /* if */
+    return (NO_ANSWER);
+  } /* if */
+
+  if ((length == 1) && (last_bits == 7))
+  {
+    if (((frame[0] == PICC_REQIDL) && (card->state == CARD_IDLE)) ||
+        ((frame[0] == PICC_REQALL) && ((card->state == CARD_IDLE) || (card->state == CARD_HALT))))
+    {
+      answer[0] = (card->blocks == RC522_MODEL_BLOCKS) ? 0x02 : 0x04;
+      answer[1] = 0x00;
+      card->state = CARD_READY;
+      card_answer(chip, answer, 2, 0, FALSE);
+      return (RC522_MODEL_CARD_US);
+    } /* if */
+    return (NO_ANSWER);
+  } /* if */
+
+  if (card->state == CARD_READY)
+  {
+    if ((length == 2) && (frame[0] == PICC_ANTICOLL) && (frame[1] == 0x20))
+    {
+      memcpy(answer, card->uid, 4);
+      answer[4] = card->uid[0] ^ card->uid[1] ^ card->uid[2] ^ card->uid[3];
+      card_answer(chip, answer, 5, 0, FALSE);
+      return (RC522_MODEL_CARD_US);
+    } /* if */
+
+    if ((length == 9) && (frame[0] == PICC_SElECTTAG) && (frame[1] == 0x70) &&
+        (memcmp(&frame[2], card->uid, 4) == 0) && crc_ok(frame, length))
+    {
+      answer[0] = card->sak;
+      card->state = CARD_ACTIVE;
+      card_answer(chip, answer, 1, 0, TRUE);
+      return (RC522_MODEL_CARD_US);
+    } /* if */
+
+    card->state = CARD_IDLE;
+    return (NO_ANSWER);
+  } /* if */
+
+  if ((card->state != CARD_ACTIVE) && (card->state != CARD_AUTHENTICATED))
+  {
+    return (NO_ANSWER);
+  } /* if */
+
+  if (!crc_ok(frame, length))
+  {
+    return (card_nak(chip));
+  } /* if */
+
+  // Second part of a WRITE: the block
+  if (card->write_block >= 0)
+  {
+    if (length != 18)
+    {
+      return (card_nak(chip));
+    } /* if */
+    memcpy(card->data[card->write_block], frame, 16);
+    card->write_block = -1;
+    card->writes++;
+    answer[0] = MIFARE_ACK;
+    card_answer(chip, answer, 1, 4, FALSE);
+    return (RC522_MODEL_WRITE_US);
+  } /* if */
+
+  switch (frame[0])
+  {
+    case PICC_HALT:
+    {
+      card->halts++;
+      card->state = CARD_HALT;
+      return (NO_ANSWER);
+    } /* case */
+
+    case PICC_READ:
+    case PICC_WRITE:
+    {
+      sector = card_sector(frame[1], &trailer);
+      if ((length != 4) || (frame[1] >= card->blocks) ||
+          (card->state != CARD_AUTHENTICATED) || (sector != card->sector))
+      {
+        return (card_nak(chip));
+      } /* if */
+
+      if (frame[0] == PICC_WRITE)
+      {
+        card->write_block = frame[1];
+        answer[0] = MIFARE_ACK;
+        card_answer(chip, answer, 1, 4, FALSE);
+        return (RC522_MODEL_CARD_US);
+      } /* if */
+
+      card->reads++;
+      memcpy(answer, card->data[frame[1]], 16);
+      if (frame[1] == trailer)
+      {
+        // Key A never reads back
+        memset(answer, 0, 6);
+      } /* if */
+      card_answer(chip, answer, 16, 0, TRUE);
+      return (RC522_MODEL_CARD_US);
+    } /* case */
+
+    default:
+    {
+      return (card_nak(chip));
+    } /* default */
+
+  } /* switch */
+
+} /* card_frame */
+
+
+//----------------------------------------------------------------------------
+// NAME: card_authenticate
+//
+// DESCRIPTION:
+//    This function runs MFAuthent with the card: FIFO holds the key type,
+//    block, key and UID.
+//
+// INPUT:
+//   chip - the RC522 the card is on
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if the card accepted the key
+//----------------------------------------------------------------------------
+static bool card_authenticate(RC522_MODEL_t* chip)
+{
+  RC522_MODEL_CARD_t* card = &chip->card;
+  bool  encrypted = (chip->regs[STATUS2_REG] & STATUS2_CRYPTO1) != 0;
+  const uint8* key;
+  uint8 trailer;
+  uint8 sector;
+
+  if (!card->present || (chip->fifo_count != 12))
+  {
+    return (FALSE);
+  } /* if */
+  card->frames++;
+
+  if (((card->state != CARD_ACTIVE) && (card->state != CARD_AUTHENTICATED)) ||
+      (encrypted != (card->state == CARD_AUTHENTICATED)) ||
+      (chip->fifo[1] >= card->blocks) ||
+      (memcmp(&chip->fifo[8], card->uid, 4) != 0))
+  {
+    card->failed_auths++;
+    card->state = CARD_IDLE;
+    return (FALSE);
+  } /* if */
+
+  sector = card_sector(chip->fifo[1], &trailer);
+  key = (chip->fifo[0] == PICC_AUTHENT1A) ? &card->data[trailer][0] : &card->data[trailer][10];
+  if (((chip->fifo[0] != PICC_AUTHENT1A) && (chip->fifo[0] != PICC_AUTHENT1B)) ||
+      (memcmp(&chip->fifo[2], key, 6) != 0))
+  {
+    card->failed_auths++;
+    card->state = CARD_IDLE;
+    return (FALSE);
+  } /* if */
+
+  card->auths++;
+  card->state = CARD_AUTHENTICATED;
+  card->sector = sector;
+  card->write_block = -1;
+
+  return (TRUE);
+
+} /* card_authenticate */
+
+
+//----------------------------------------------------------------------------
+// NAME: chip_start
+//
+// DESCRIPTION:
+//    This function puts the FIFO on the air for Transceive or MFAuthent
+//    and works out when and how the command ends.
+//
+// INPUT:
+//   chip    - the RC522
+//   command - CMD_TRANSCEIVE or CMD_AUTHENT
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void chip_start(RC522_MODEL_t* chip, uint8 command)
+{
+  uint8  last_bits = chip->regs[BIT_FRAMING_REG] & 0x07;
+  uint32 sent_us = clock_us + air_us(chip->fifo_count, last_bits);
+  uint32 timeout_us = timer_us(chip);
+  bool   timer = (chip->regs[T_MODE_REG] & T_MODE_AUTO) != 0;
+  long   delay;
+
+  chip->regs[ERROR_REG] = 0;
+  chip->answer_length = 0;
+  chip->running = TRUE;
+  chip->start_us = clock_us;
+
+  if (command == CMD_AUTHENT)
+  {
+    chip->crypto1_result = card_authenticate(chip);
+    delay = chip->crypto1_result ? RC522_MODEL_AUTH_US + chip->card.extra_delay_us : NO_ANSWER;
+  } /* if */
+  else
+  {
+    delay = card_frame(chip, chip->fifo, chip->fifo_count, last_bits);
+    if (delay != NO_ANSWER)
+    {
+      delay += chip->card.extra_delay_us;
+    } /* if */
+  } /* else */
+  chip->fifo_count = 0;
+
+  if ((delay != NO_ANSWER) && (!timer || ((uint32)delay < timeout_us)))
+  {
+    chip->done_us = sent_us + (uint32)delay + air_us(chip->answer_length, chip->answer_last_bits);
+    chip->done_irq = (command == CMD_AUTHENT) ? IRQ_IDLE : IRQ_TX | IRQ_RX;
+    if (chip->card.noise && (command != CMD_AUTHENT))
+    {
+      chip->done_irq |= IRQ_ERR;
+    } /* if */
+  } /* if */
+  else if (timer)
+  {
+    chip->done_us = sent_us + timeout_us;
+    chip->done_irq = IRQ_TX | IRQ_TIMER;
+    chip->answer_length = 0;
+    chip->crypto1_result = FALSE;
+    chip->last_timeout_us = timeout_us;
+  } /* else if */
+  else
+  {
+    // Without the timer nothing ends a command the card doesn't answer
+    chip->done_us = NEVER;
+    chip->done_irq = 0;
+  } /* else */
+
+} /* chip_start */
+
+
+//----------------------------------------------------------------------------
+// NAME: chip_update
+//
+// DESCRIPTION:
+//    This function ends the command on the air once its time is up.
+//
+// INPUT:
+//   chip - the RC522
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void chip_update(RC522_MODEL_t* chip)
+{
+  uint8 command = chip->regs[COMMAND_REG] & CMD_MASK;
+
+  if (!chip->running || (chip->done_us == NEVER) || (clock_us < chip->done_us))
+  {
+    return;
+  } /* if */
+
+  chip->running = FALSE;
+  chip->regs[COM_IRQ_REG] |= chip->done_irq;
+
+  if (command == CMD_AUTHENT)
+  {
+    if (chip->crypto1_result)
+    {
+      chip->regs[STATUS2_REG] |= STATUS2_CRYPTO1;
+      chip->regs[COMMAND_REG] &= ~CMD_MASK;
+    } /* if */
+    else
+    {
+      chip->regs[STATUS2_REG] &= ~STATUS2_CRYPTO1;
+    } /* else */
+    return;
+  } /* if */
+
+  if (chip->done_irq & IRQ_ERR)
+  {
+    chip->regs[ERROR_REG] |= ERROR_PARITY;
+  } /* if */
+
+  memcpy(chip->fifo, chip->answer, chip->answer_length);
+  chip->fifo_count = chip->answer_length;
+  chip->regs[CONTROL_REG] = (chip->regs[CONTROL_REG] & ~0x07) | chip->answer_last_bits;
+
+} /* chip_update */
+
+
+//----------------------------------------------------------------------------
+// NAME: chip_read
+//
+// DESCRIPTION:
+//    This function reads an RC522 register.
+//
+// INPUT:
+//   chip - the RC522
+//   reg  - the register
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the value
+//----------------------------------------------------------------------------
+static uint8 chip_read(RC522_MODEL_t* chip, uint8 reg)
+{
+  uint8 value;
+
+  switch (reg)
+  {
+    case FIFO_DATA_REG:
+    {
+      if (chip->fifo_count == 0)
+      {
+        return (0);
+      } /* if */
+      value = chip->fifo[0];
+      memmove(chip->fifo, &chip->fifo[1], --chip->fifo_count);
+      return (value);
+    } /* case */
+
+    case FIFO_LEVEL_REG:
+    {
+      return (chip->fifo_count);
+    } /* case */
+
+    default:
+    {
+      return (chip->regs[reg]);
+    } /* default */
+
+  } /* switch */
+
+} /* chip_read */
+
+
+//----------------------------------------------------------------------------
+// NAME: chip_write
+//
+// DESCRIPTION:
+//    This function writes an RC522 register.
+//
+// INPUT:
+//   chip  - the RC522
+//   reg   - the register
+//   value - the value
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void chip_write(RC522_MODEL_t* chip, uint8 reg, uint8 value)
+{
+  uint16 crc;
+
+  switch (reg)
+  {
+    case COMMAND_REG:
+    {
+      chip->running = FALSE;
+      chip->regs[COMMAND_REG] = (chip->regs[COMMAND_REG] & ~CMD_MASK) | (value & CMD_MASK);
+
+      switch (value & CMD_MASK)
+      {
+        case CMD_RESET:
+        {
+          chip->resets++;
+          chip_reset(chip);
+          break;
+        } /* case */
+
+        case CMD_AUTHENT:
+        {
+          chip_start(chip, CMD_AUTHENT);
+          break;
+        } /* case */
+
+        case CMD_CALC_CRC:
+        {
+          crc = crc_a(chip->fifo, chip->fifo_count);
+          chip->regs[CRC_RESULT_REG_L] = (uint8)crc;
+          chip->regs[CRC_RESULT_REG_M] = (uint8)(crc >> 8);
+          chip->regs[DIV_IRQ_REG] |= DIV_IRQ_CRC;
+          break;
+        } /* case */
+
+        default:
+        {
+          break;
+        } /* default */
+
+      } /* switch */
+      break;
+    } /* case */
+
+    case COM_IRQ_REG:
+    case DIV_IRQ_REG:
+    {
+      if (value & IRQ_SET1)
+      {
+        chip->regs[reg] |= value & ~IRQ_SET1;
+      } /* if */
+      else
+      {
+        chip->regs[reg] &= ~value;
+      } /* else */
+      break;
+    } /* case */
+
+    case FIFO_DATA_REG:
+    {
+      if (chip->fifo_count < sizeof(chip->fifo))
+      {
+        chip->fifo[chip->fifo_count++] = value;
+      } /* if */
+      else
+      {
+        chip->fifo_overruns++;
+      } /* else */
+      break;
+    } /* case */
+
+    case FIFO_LEVEL_REG:
+    {
+      if (value & FIFO_LEVEL_FLUSH)
+      {
+        chip->fifo_count = 0;
+      } /* if */
+      break;
+    } /* case */
+
+    case BIT_FRAMING_REG:
+    {
+      chip->regs[reg] = value;
+      if ((value & BIT_FRAMING_START_SEND) && !chip->running &&
+          ((chip->regs[COMMAND_REG] & CMD_MASK) == CMD_TRANSCEIVE))
+      {
+        chip_start(chip, CMD_TRANSCEIVE);
+      } /* if */
+      break;
+    } /* case */
+
+    case T_RELOAD_REG_H:
+    case T_RELOAD_REG_L:
+    {
+      chip->timer_reload_writes++;
+      chip->regs[reg] = value;
+      break;
+    } /* case */
+
+    case VERSION_REG:
+    {
+      break;
+    } /* case */
+
+    default:
+    {
+      chip->regs[reg] = value;
+      break;
+    } /* default */
+
+  } /* switch */
+
+} /* chip_write */
+
+
+//----------------------------------------------------------------------------
+// NAME: chip_spi
+//
+// DESCRIPTION:
+//    This function moves one byte over an RC522's SPI. The first byte after
+//    SS goes low is an address: bit 7 set to read, bits 6:1 the register.
+//    When reading, each later byte is the next address and the register
+//    comes back on MISO; when writing, each later byte is data.
+//
+// INPUT:
+//   port - the SPI port
+//   out  - the byte on MOSI
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the byte on MISO
+//----------------------------------------------------------------------------
+static char chip_spi(uint8 port, char out)
+{
+  RC522_MODEL_t* chip = &chips[port];
+  uint8 byte = (uint8)out;
+  uint8 in = 0;
+
+  clock_us += RC522_MODEL_SPI_BYTE_US;
+  chip_update(chip);
+
+  if (!chip->selected)
+  {
+    return (0);
+  } /* if */
+
+  if (chip->first_byte)
+  {
+    chip->first_byte = FALSE;
+    chip->address = byte;
+    return (0);
+  } /* if */
+
+  if (chip->address & 0x80)
+  {
+    in = chip_read(chip, (chip->address >> 1) & 0x3F);
+    chip->address = byte;
+  } /* if */
+  else
+  {
+    chip_write(chip, (chip->address >> 1) & 0x3F, byte);
+  } /* else */
+
+  return ((char)in);
+
+} /* chip_spi */
+
+
+static void chip_select(uint8 port)
+{
+
+  chips[port].selected = TRUE;
+  chips[port].first_byte = TRUE;
+  chips[port].transactions++;
+
+} /* chip_select */
+
+
+static void chip_deselect(uint8 port)
+{
+
+  chips[port].selected = FALSE;
+
+} /* chip_deselect */
+
+
+//-----------------------------------------------------------------------------
+//                               Model controls
+//-----------------------------------------------------------------------------
+
+void rc522_model_init(void)
+{
+  uint8 port;
+
+  memset(chips, 0, sizeof(chips));
+  for (port = 0; port < RC522_MODEL_PORTS; port++)
+  {
+    chip_reset(&chips[port]);
+    chips[port].card.write_block = -1;
+  } /* for */
+
+} /* rc522_model_init */
+
+
+RC522_MODEL_t* rc522_model(uint8 port)
+{
+
+  return (&chips[port]);
+
+} /* rc522_model */
+
+
+//----------------------------------------------------------------------------
+// NAME: rc522_model_brown_out
+//
+// DESCRIPTION:
+//    This function resets an RC522 behind the driver's back, as a dip in
+//    its supply would. The card stays in the field.
+//
+// INPUT:
+//   port - the SPI port
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void rc522_model_brown_out(uint8 port)
+{
+
+  chip_reset(&chips[port]);
+
+} /* rc522_model_brown_out */
+
+
+//----------------------------------------------------------------------------
+// NAME: rc522_model_card
+//
+// DESCRIPTION:
+//    This function puts a fresh card in a reader's field: transport keys
+//    (all 0xFF) in every trailer and every data block numbered by its
+//    block and UID.
+//
+// INPUT:
+//   port   - the SPI port
+//   uid    - the 4 byte UID
+//   blocks - RC522_MODEL_BLOCKS_1K or RC522_MODEL_BLOCKS
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+void rc522_model_card(uint8 port, const uint8* uid, uint16 blocks)
+{
+  RC522_MODEL_CARD_t* card = &chips[port].card;
+  static const uint8 access[4] = { 0xFF, 0x07, 0x80, 0x69 };
+  uint16 block;
+  uint8  trailer;
+  uint8  i;
+
+  memset(card, 0, sizeof(*card));
+  card->present = TRUE;
+  memcpy(card->uid, uid, 4);
+  card->sak = (blocks == RC522_MODEL_BLOCKS) ? 0x18 : 0x08;
+  card->blocks = blocks;
+  card->state = CARD_IDLE;
+  card->write_block = -1;
+
+  for (block = 0; block < blocks; block++)
+  {
+    (void)card_sector((uint8)block, &trailer);
+    if (block == trailer)
+    {
+      memset(card->data[block], 0xFF, 16);
+      memcpy(&card->data[block][6], access, 4);
+    } /* if */
+    else
+    {
+      for (i = 0; i < 16; i++)
+      {
+        card->data[block][i] = (uint8)(block * 16 + i) ^ uid[i % 4];
+      } /* for */
+    } /* else */
+  } /* for */
+
+} /* rc522_model_card */
+
+
+void rc522_model_set_keys(uint8 port, uint8 sector, const uint8* key_a, const uint8* key_b)
+{
+  RC522_MODEL_CARD_t* card = &chips[port].card;
+  uint8 trailer = (sector < 32) ? (uint8)(sector * 4 + 3) : (uint8)(128 + (sector - 32) * 16 + 15);
+
+  memcpy(&card->data[trailer][0], key_a, 6);
+  memcpy(&card->data[trailer][10], key_b, 6);
+
+} /* rc522_model_set_keys */
+
+
+uint32 rc522_model_us(void)
+{
+
+  return (clock_us);
+
+} /* rc522_model_us */
+
+
+void rc522_model_wait(uint32 us)
+{
+
+  clock_us += us;
+
+} /* rc522_model_wait */
+
+
+//-----------------------------------------------------------------------------
+//                main.asm, idle.c and timebase.c routines
+//-----------------------------------------------------------------------------
+
+void SPI0_init(void) { }
+void SPI1_init(void) { }
+void SPI2_init(void) { }
+
+char send_SPI0(char out) { return (chip_spi(RC522_SPI0, out)); }
+char send_SPI1(char out) { return (chip_spi(RC522_SPI1, out)); }
+char send_SPI2(char out) { return (chip_spi(RC522_SPI2, out)); }
+
+void SS0_LO(void) { chip_select(RC522_SPI0); }
+void SS1_LO(void) { chip_select(RC522_SPI1); }
+void SS2_LO(void) { chip_select(RC522_SPI2); }
+void SS0_HI(void) { chip_deselect(RC522_SPI0); }
+void SS1_HI(void) { chip_deselect(RC522_SPI1); }
+void SS2_HI(void) { chip_deselect(RC522_SPI2); }
+
+void set_lcd_addr(char address) { }
+void write_int_lcd(int value) { }
+void outchar1(unsigned char value) { }
+
+void sleep_ms(uint16 ms)
+{
+
+  clock_us += (uint32)ms * 1000;
+
+} /* sleep_ms */
+
+
+uint32 timebase_ms(void)
+{
+
+  return (clock_us / 1000);
+
+} /* timebase_ms */
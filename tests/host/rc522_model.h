@@ -0,0 +1,128 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: rc522_model.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the controls of the host RC522 model. It stands in
+//    for send_SPIn() and SSn_HI/LO() of main.asm, so RFID_rc522.c and
+//    mifare.c run unchanged on top of it. Each SPI port has an RC522 with
+//    its registers, FIFO and timer, and a field a MIFARE Classic card can
+//    be placed in:
+//
+//      - Transceive and MFAuthent run in model time: SPI bytes, frames on
+//        the air at 106 kbit/s and the card's own processing all take
+//        time, and ComIrqReg only shows the result once it is due.
+//      - With TAuto set, the timer starts at the end of the frame sent and
+//        sets TimerIRq if no answer has started by then; it runs
+//        (TReload + 1) * (2 * TPrescaler + 1) / 13.56 MHz.
+//      - The card goes IDLE - READY - ACTIVE - authenticated as in
+//        ISO/IEC 14443-3 and the MIFARE Classic data sheet. Its keys come
+//        from the sector trailers. Frames sent with Crypto1 in the wrong
+//        state, or with a bad CRC, get no answer.
+//
+//    The model clock also drives timebase_ms() and sleep_ms().
+//
+//*****************************************************************************
+
+#ifndef _RC522_MODEL_H_
+#define _RC522_MODEL_H_
+
+#include "sys_types.h"
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define RC522_MODEL_PORTS       3
+#define RC522_MODEL_VERSION     0x92    // MFRC522 version 2.0
+
+#define RC522_MODEL_BLOCKS      256     // a 4K card
+#define RC522_MODEL_BLOCKS_1K   64
+
+// Model time, us
+#define RC522_MODEL_SPI_BYTE_US 40      // 8 bits at 250 kHz and the call
+#define RC522_MODEL_CARD_US     100     // answer to a short command
+#define RC522_MODEL_AUTH_US     1000    // the three pass authentication
+#define RC522_MODEL_WRITE_US    5000    // EEPROM programming
+
+// Card states
+#define CARD_IDLE               0
+#define CARD_READY              1
+#define CARD_ACTIVE             2
+#define CARD_AUTHENTICATED      3
+#define CARD_HALT               4
+
+//-----------------------------------------------------------------------------
+//                        Define types
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  bool   present;               // in the reader's field
+  uint8  uid[4];
+  uint8  sak;
+  uint16 blocks;                // RC522_MODEL_BLOCKS_1K or RC522_MODEL_BLOCKS
+  uint8  data[RC522_MODEL_BLOCKS][16];
+  uint16 extra_delay_us;        // added to every answer
+  bool   noise;                 // answers arrive with a parity error
+
+  uint8  state;                 // CARD_*
+  uint8  sector;                // authenticated sector
+  int    write_block;           // block a WRITE was accepted for, or -1
+
+  // Counts
+  int    frames;
+  int    auths;
+  int    failed_auths;
+  int    reads;
+  int    writes;
+  int    naks;
+  int    halts;
+} RC522_MODEL_CARD_t;
+
+typedef struct
+{
+  uint8  regs[64];
+  uint8  fifo[64];
+  uint8  fifo_count;
+  bool   selected;              // SS low
+  bool   first_byte;            // next byte is the address byte
+  uint8  address;
+  bool   running;               // transceive or authentication on the air
+  uint32 start_us;              // when it was started
+  uint32 done_us;               // when it ends
+  uint8  done_irq;              // ComIrqReg bits it sets
+  uint8  answer[20];
+  uint8  answer_length;
+  uint8  answer_last_bits;
+  bool   crypto1_result;        // authentication result
+
+  // Counts
+  int    transactions;          // SPI transfers with SS low
+  int    timer_reload_writes;   // TReloadReg writes
+  int    fifo_overruns;
+  int    resets;
+  uint32 last_timeout_us;       // timer length of the last frame with no answer
+
+  RC522_MODEL_CARD_t card;
+} RC522_MODEL_t;
+
+//-----------------------------------------------------------------------------
+//                      Define Public Functions
+//-----------------------------------------------------------------------------
+void           rc522_model_init(void);
+RC522_MODEL_t* rc522_model(uint8 port);
+void           rc522_model_brown_out(uint8 port);
+void           rc522_model_card(uint8 port, const uint8* uid, uint16 blocks);
+void           rc522_model_set_keys(uint8 port, uint8 sector, const uint8* key_a,
+                                    const uint8* key_b);
+uint32         rc522_model_us(void);
+void           rc522_model_wait(uint32 us);
+
+#endif /* _RC522_MODEL_H_ */
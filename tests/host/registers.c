@@ -0,0 +1,59 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: registers.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file holds the registers declared by the host mc9s12dg256.h and
+//    the host versions of the critical section calls. With a single thread
+//    there is nothing to mask, so a critical section only has to nest.
+//
+//*****************************************************************************
+
+#include <mc9s12dg256.h>
+#include "critical.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define public variables
+//-----------------------------------------------------------------------------
+
+// ATD0
+volatile uint8  ATD0CTL5;
+volatile uint8  ATD0STAT0;
+volatile uint16 ATD0DR0;
+volatile uint16 ATD0DR1;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+static CRITICAL_t ccr;
+
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+CRITICAL_t critical_enter(void)
+{
+  CRITICAL_t saved = ccr;
+
+  ccr |= CRITICAL_CCR_I;
+  return (saved);
+
+} /* critical_enter */
+
+
+void critical_exit(CRITICAL_t saved)
+{
+
+  ccr = saved;
+
+} /* critical_exit */
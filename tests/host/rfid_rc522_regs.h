@@ -0,0 +1,13 @@
+//*****************************************************************************
+//
+//     FILE NAME: rfid_rc522_regs.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    RFID_rc522.h includes its register header in lower case, which only
+//    finds it on a case insensitive file system.
+//
+//*****************************************************************************
+
+#include "../../Sources/RFID_rc522_regs.h"
@@ -0,0 +1,616 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: journal_test.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file checks that the event journal survives power loss. journal.c
+//    runs unchanged on the host flash model (host/flash_model.c) in place
+//    of flash.c, and the test checks:
+//
+//      - a blank journal, records read back while still queued, and a full
+//        ring wrapped one and a half times
+//      - that every record from the first to the last sequence number reads
+//        back intact, with at most 40 flash reads per lookup
+//      - power cut in every flash command of a start up and 70 records, on
+//        a blank journal and on a wrapped one: after the restart no
+//        committed record is lost, no sequence number is reused and the
+//        journal carries on normally
+//      - a run of random power cuts one after another
+//      - that no word is programmed twice and the block is never read
+//        while it is busy
+//
+//    A record is committed once its CRC word has finished programming.
+//    Records still queued in RAM are lost by a power cut, as on the board.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include "test.h"
+#include "journal.h"
+#include "flash.h"
+#include "flash_model.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define SECTORS                 128
+#define SLOTS_PER_SECTOR        32
+#define RING_RECORDS            ((uint32)SECTORS * SLOTS_PER_SECTOR)
+
+// Records the journal always holds once it has wrapped: all but the head
+// sector and the one erased ahead of it. Each power cut can cost one more,
+// the slot it tore.
+#define HELD_RECORDS            ((uint32)(SECTORS - 2) * SLOTS_PER_SECTOR)
+
+// Binary search over the sectors, then a scan of one
+#define MAX_READS_PER_LOOKUP    (7 + 1 + SLOTS_PER_SECTOR)
+
+// The main loop appends a record every so many calls, with a burst that
+// fills the queue now and then
+#define APPEND_EVERY            20
+#define BURST_EVERY             97
+
+#define CUT_RECORDS             70      // records run per power cut
+#define AFTER_CUT_RECORDS       40      // records run after the restart
+#define RANDOM_CUTS             300
+#define RANDOM_CUT_RANGE        400     // commands
+
+#define SERVICE_LIMIT           1000000L
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+static uint8 blank_image[(uint32)JOURNAL_PAGES * FLASH_PAGE_SIZE];
+static uint8 wrapped_image[(uint32)JOURNAL_PAGES * FLASH_PAGE_SIZE];
+
+static int   multiple_commands;         // service calls that started two
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
+// NAME: record_expected
+//
+// DESCRIPTION:
+//    This function returns the record the test appends with a sequence
+//    number. Every field depends on the sequence, so a record read back
+//    from the wrong slot or a stale sector doesn't match.
+//
+// INPUT:
+//   sequence - the sequence number
+//
+// OUTPUT:
+//   record - the record
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void record_expected(uint32 sequence, JOURNAL_RECORD_t* record)
+{
+
+  record->sequence = sequence;
+  record->timestamp = sequence * 1000 + 7;
+  record->type = (uint8)(sequence % JOURNAL_STACK + 1);
+  record->detail = (uint8)(sequence * 31);
+  record->value = sequence * 2654435761U;
+
+} /* record_expected */
+
+
+//----------------------------------------------------------------------------
+// NAME: record_append
+//
+// DESCRIPTION:
+//    This function appends the next record.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if it was queued
+//----------------------------------------------------------------------------
+static bool record_append(void)
+{
+  JOURNAL_RECORD_t record;
+
+  record_expected(journal_next_sequence(), &record);
+  return (journal_append(record.timestamp, record.type, record.detail, record.value));
+
+} /* record_append */
+
+
+//----------------------------------------------------------------------------
+// NAME: journal_run
+//
+// DESCRIPTION:
+//    This function runs the main loop until a number of records have been
+//    appended and committed, or the power is cut.
+//
+// INPUT:
+//   records - records to append
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if they were all committed, FALSE if the power was cut
+//----------------------------------------------------------------------------
+static bool journal_run(uint32 records)
+{
+  FLASH_MODEL_STATS_t* stats = flash_model_stats();
+  uint32 last = journal_next_sequence() + records - 1;
+  uint32 commands;
+  uint8  burst;
+  long   call;
+
+  for (call = 0; call < SERVICE_LIMIT; call++)
+  {
+    if (flash_model_is_off())
+    {
+      return (FALSE);
+    } /* if */
+    if ((records == 0) || (stats->last_committed == last))
+    {
+      return (TRUE);
+    } /* if */
+
+    if ((journal_next_sequence() <= last) && (call % APPEND_EVERY == 0))
+    {
+      burst = (call % (APPEND_EVERY * BURST_EVERY) == 0) ? JOURNAL_QUEUE_SIZE / 2 : 1;
+      while ((burst-- > 0) && (journal_next_sequence() <= last) && record_append())
+      {
+      } /* while */
+    } /* if */
+
+    commands = stats->commands;
+    journal_service();
+    if (stats->commands > commands + 1)
+    {
+      multiple_commands++;
+    } /* if */
+  } /* for */
+
+  printf("journal_run: records not committed after %ld calls\n", SERVICE_LIMIT);
+  return (FALSE);
+
+} /* journal_run */
+
+
+//----------------------------------------------------------------------------
+// NAME: journal_lookup
+//
+// DESCRIPTION:
+//    This function reads a record back, letting the journal finish a flash
+//    command if it is busy.
+//
+// INPUT:
+//   sequence - the sequence number
+//
+// OUTPUT:
+//   record - the record, if found
+//   reads  - flash reads the lookup took
+//
+// RETURN:
+//   JOURNAL_OK or JOURNAL_NOT_FOUND
+//----------------------------------------------------------------------------
+static uint8 journal_lookup(uint32 sequence, JOURNAL_RECORD_t* record, uint32* reads)
+{
+  FLASH_MODEL_STATS_t* stats = flash_model_stats();
+  uint32 before;
+  uint8  result;
+
+  do
+  {
+    before = stats->reads;
+    result = journal_read(sequence, record);
+    *reads = stats->reads - before;
+    if (result == JOURNAL_BUSY)
+    {
+      journal_service();
+    } /* if */
+  } while (result == JOURNAL_BUSY);
+
+  return (result);
+
+} /* journal_lookup */
+
+
+//----------------------------------------------------------------------------
+// NAME: check_contents
+//
+// DESCRIPTION:
+//    This function checks that records from the first sequence number to
+//    the last read back intact, and that nothing after them does. The
+//    oldest and newest sectors are always checked record by record,
+//    the rest every stride records.
+//
+// INPUT:
+//   label  - what is being checked, for failures
+//   stride - 1 to check every record
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the most flash reads a lookup took
+//----------------------------------------------------------------------------
+static uint32 check_contents(const char* label, uint32 stride)
+{
+  JOURNAL_RECORD_t expected;
+  JOURNAL_RECORD_t record;
+  uint32 first = journal_first_sequence();
+  uint32 next = journal_next_sequence();
+  uint32 sequence;
+  uint32 reads;
+  uint32 most = 0;
+  uint32 bad = 0;
+  uint32 first_bad = 0;
+
+  CHECK(first >= 1);
+  CHECK(first <= next);
+
+  for (sequence = first; sequence < next; sequence++)
+  {
+    if ((stride > 1) && (sequence >= first + SLOTS_PER_SECTOR) &&
+        (sequence + 2 * SLOTS_PER_SECTOR < next) && ((sequence - first) % stride != 0))
+    {
+      continue;
+    } /* if */
+
+    record_expected(sequence, &expected);
+    memset(&record, 0, sizeof(record));
+    if ((journal_lookup(sequence, &record, &reads) != JOURNAL_OK) ||
+        (record.sequence != expected.sequence) ||
+        (record.timestamp != expected.timestamp) ||
+        (record.type != expected.type) ||
+        (record.detail != expected.detail) ||
+        (record.value != expected.value))
+    {
+      if (bad++ == 0)
+      {
+        first_bad = sequence;
+      } /* if */
+    } /* if */
+
+    if (reads > most)
+    {
+      most = reads;
+    } /* if */
+  } /* for */
+
+  if (bad > 0)
+  {
+    printf("%s: %u of records %u - %u wrong, first %u\n",
+           label, bad, first, next - 1, first_bad);
+  } /* if */
+  CHECK_EQUAL(0, bad);
+
+  CHECK_EQUAL(JOURNAL_NOT_FOUND, journal_lookup(next, &record, &reads));
+
+  return (most);
+
+} /* check_contents */
+
+
+//----------------------------------------------------------------------------
+// NAME: check_flash_use
+//
+// DESCRIPTION:
+//    This function checks the journal used the flash correctly since power
+//    on: no word programmed twice, no read of a busy block, no address
+//    outside the block.
+//
+// INPUT:
+//   label - what is being checked, for failures
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void check_flash_use(const char* label)
+{
+  FLASH_MODEL_STATS_t* stats = flash_model_stats();
+
+  if ((stats->overprograms > 0) || (stats->busy_reads > 0) || (stats->bad_addresses > 0))
+  {
+    printf("%s: %u overprograms, %u busy reads, %u bad addresses\n", label,
+           stats->overprograms, stats->busy_reads, stats->bad_addresses);
+  } /* if */
+  CHECK_EQUAL(0, stats->overprograms);
+  CHECK_EQUAL(0, stats->busy_reads);
+  CHECK_EQUAL(0, stats->bad_addresses);
+
+} /* check_flash_use */
+
+
+//----------------------------------------------------------------------------
+// NAME: power_cycle
+//
+// DESCRIPTION:
+//    This function restarts the board after a power cut and checks that
+//    nothing committed before it was lost.
+//
+// INPUT:
+//   label     - what is being checked, for failures
+//   committed - the last record committed before the cut, 0 if none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void power_cycle(const char* label, uint32 committed)
+{
+
+  flash_model_power_on();
+  journal_init();
+
+  if (journal_next_sequence() <= committed)
+  {
+    printf("%s: record %u committed but next sequence is %u\n",
+           label, committed, journal_next_sequence());
+  } /* if */
+  CHECK(journal_next_sequence() > committed);
+
+} /* power_cycle */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_blank
+//
+// DESCRIPTION:
+//    This function checks a journal started on blank flash, and that
+//    records can be read back while they are still queued.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_blank(void)
+{
+  JOURNAL_RECORD_t record;
+  uint8 i;
+
+  flash_model_erase_all();
+  flash_model_save(blank_image);
+  journal_init();
+
+  CHECK_EQUAL(1, journal_first_sequence());
+  CHECK_EQUAL(1, journal_next_sequence());
+  CHECK_EQUAL(JOURNAL_NOT_FOUND, journal_read(1, &record));
+
+  for (i = 0; i < JOURNAL_QUEUE_SIZE; i++)
+  {
+    CHECK(record_append());
+  } /* for */
+  CHECK(!record_append());
+  CHECK_EQUAL(1, journal_dropped());
+
+  CHECK_EQUAL(JOURNAL_OK, journal_read(3, &record));
+  CHECK_EQUAL(3, record.sequence);
+  CHECK_EQUAL(3007, record.timestamp);
+
+  // A dropped record doesn't use up a sequence number
+  CHECK_EQUAL(JOURNAL_QUEUE_SIZE + 1, journal_next_sequence());
+  while (flash_model_stats()->last_committed < JOURNAL_QUEUE_SIZE)
+  {
+    journal_service();
+  } /* while */
+  check_contents("blank", 1);
+
+  power_cycle("blank", JOURNAL_QUEUE_SIZE);
+  CHECK_EQUAL(JOURNAL_QUEUE_SIZE + 1, journal_next_sequence());
+  check_contents("blank restarted", 1);
+  check_flash_use("blank");
+  CHECK_EQUAL(0, journal_errors());
+
+} /* test_blank */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_wrap
+//
+// DESCRIPTION:
+//    This function fills the ring one and a half times, checks every
+//    record and how many reads a lookup takes, and keeps the flash image
+//    for the power cut tests.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_wrap(void)
+{
+  JOURNAL_RECORD_t record;
+  uint32 first;
+  uint32 next;
+  uint32 reads;
+
+  flash_model_restore(blank_image);
+  journal_init();
+
+  CHECK(journal_run(RING_RECORDS + RING_RECORDS / 2));
+  CHECK_EQUAL(0, journal_dropped());
+  CHECK_EQUAL(0, journal_errors());
+  CHECK_EQUAL(0, multiple_commands);
+  check_flash_use("wrap");
+
+  first = journal_first_sequence();
+  next = journal_next_sequence();
+  CHECK(next - first >= HELD_RECORDS);
+  CHECK(next - first <= RING_RECORDS);
+
+  reads = check_contents("wrap", 1);
+  CHECK_EQUAL(JOURNAL_NOT_FOUND, journal_read(first - 1, &record));
+  printf("journal_test: %u records held, at most %u reads per lookup\n",
+         next - first, reads);
+  CHECK(reads <= MAX_READS_PER_LOOKUP);
+
+  // A clean restart finds the same records
+  flash_model_save(wrapped_image);
+  power_cycle("wrap", next - 1);
+  CHECK_EQUAL(next, journal_next_sequence());
+  CHECK(journal_first_sequence() >= first);
+  CHECK(journal_next_sequence() - journal_first_sequence() >= HELD_RECORDS);
+  check_contents("wrap restarted", 1);
+  check_flash_use("wrap restarted");
+
+} /* test_wrap */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_cut_sweep
+//
+// DESCRIPTION:
+//    This function cuts the power in each flash command of a start up and
+//    CUT_RECORDS records in turn, restarts, and checks the journal.
+//
+// INPUT:
+//   label - which image, for failures
+//   image - the flash to start from
+//   held  - records the journal must hold after the restart, less the
+//           torn one
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_cut_sweep(const char* label, const uint8* image, uint32 held)
+{
+  FLASH_MODEL_STATS_t* stats = flash_model_stats();
+  char   name[64];
+  uint32 cut;
+  uint32 cuts = 0;
+  uint32 committed;
+
+  for (cut = 1; ; cut++)
+  {
+    sprintf(name, "%s cut in command %u", label, cut);
+
+    flash_model_restore(image);
+    flash_model_cut_at(cut);
+    journal_init();
+    if (journal_run(CUT_RECORDS))
+    {
+      break;
+    } /* if */
+    cuts++;
+
+    check_flash_use(name);
+    committed = stats->last_committed;
+    power_cycle(name, committed);
+    CHECK(journal_next_sequence() - journal_first_sequence() + 1 >= held);
+    check_contents(name, 61);
+
+    CHECK(journal_run(AFTER_CUT_RECORDS));
+    CHECK_EQUAL(0, journal_errors());
+    check_contents(name, 61);
+    check_flash_use(name);
+  } /* for */
+
+  printf("journal_test: %s, %u power cuts\n", label, cuts);
+  CHECK(cuts > CUT_RECORDS * (JOURNAL_RECORD_SIZE / 2));
+
+} /* test_cut_sweep */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_random_cuts
+//
+// DESCRIPTION:
+//    This function cuts the power over and over at random, without ever
+//    letting the journal settle, starting from the wrapped ring.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_random_cuts(void)
+{
+  FLASH_MODEL_STATS_t* stats = flash_model_stats();
+  char   name[64];
+  uint32 committed = 0;
+  int    i;
+
+  flash_model_restore(wrapped_image);
+
+  for (i = 0; i < RANDOM_CUTS; i++)
+  {
+    sprintf(name, "random cut %d", i);
+
+    flash_model_power_on();
+    flash_model_cut_at(1 + (uint32)(test_random() * RANDOM_CUT_RANGE));
+    journal_init();
+    journal_run(CUT_RECORDS);
+    check_flash_use(name);
+    if (stats->last_committed > committed)
+    {
+      committed = stats->last_committed;
+    } /* if */
+
+    // Every record ever committed counts, not just this run's
+    power_cycle(name, committed);
+    CHECK(journal_next_sequence() - journal_first_sequence() + i + 1 >= HELD_RECORDS);
+    check_contents(name, 61);
+  } /* for */
+
+  CHECK(journal_run(AFTER_CUT_RECORDS));
+  CHECK_EQUAL(0, journal_errors());
+  check_contents("random cuts", 1);
+  check_flash_use("random cuts");
+
+} /* test_random_cuts */
+
+
+//-----------------------------------------------------------------------------
+//                               Main
+//-----------------------------------------------------------------------------
+
+int main(void)
+{
+
+  test_blank();
+  test_wrap();
+  test_cut_sweep("blank", blank_image, 0);
+  test_cut_sweep("wrapped", wrapped_image, HELD_RECORDS);
+  test_random_cuts();
+
+  return (test_report("journal_test"));
+
+} /* main */
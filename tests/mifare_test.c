@@ -0,0 +1,500 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: mifare_test.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file checks MIFARE Classic block access (mifare.c) through the
+//    RC522 driver against the host card model (host/rc522_model.c):
+//
+//      - a credential spread over three blocks of one sector is read with
+//        one authentication and three reads, and a whole tap takes under
+//        100 ms
+//      - authentication is only repeated for another sector or key
+//      - wrong keys, noise on the air and blocks 0 and trailers are
+//        refused, and an error ends the session
+//      - cached blocks only serve the reader session and key that read
+//        them: a new tap, a card with a copied UID or another reader goes
+//        back to the card
+//      - cached blocks expire, and written blocks are cached
+//      - a sector moved from the transport key to a site key only opens
+//        with the site key
+//      - a halted card stays quiet until it is presented again
+//
+//*****************************************************************************
+
+#include <string.h>
+#include "test.h"
+#include "mifare.h"
+#include "rc522_model.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+#define CREDENTIAL_SECTOR       1
+#define CREDENTIAL_BLOCK        4       // first of three
+#define CREDENTIAL_BLOCKS       3
+
+#define TAP_LIMIT_US            100000L
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+static const uint8 site_uid[MIFARE_UID_SIZE] = { 0xDE, 0xAD, 0xBE, 0xEF };
+static const uint8 site_key_a[MIFARE_KEY_SIZE] = { 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5 };
+static const uint8 site_key_b[MIFARE_KEY_SIZE] = { 0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5 };
+static const uint8 transport_key[MIFARE_KEY_SIZE] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+
+static RC522_READER_t reader;
+static RC522_READER_t other_reader;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
+// NAME: present_card
+//
+// DESCRIPTION:
+//    This function puts a fresh 1K card in a reader's field with the site
+//    keys on the credential sector.
+//
+// INPUT:
+//   port - the reader's SPI port
+//   uid  - the card's UID
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the card model
+//----------------------------------------------------------------------------
+static RC522_MODEL_CARD_t* present_card(uint8 port, const uint8* uid)
+{
+
+  rc522_model_card(port, uid, RC522_MODEL_BLOCKS_1K);
+  rc522_model_set_keys(port, CREDENTIAL_SECTOR, site_key_a, site_key_b);
+
+  return (&rc522_model(port)->card);
+
+} /* present_card */
+
+
+//----------------------------------------------------------------------------
+// NAME: tap
+//
+// DESCRIPTION:
+//    This function does what readers.c does when a card comes into the
+//    field: REQA, anticollision, select and a new session.
+//
+// INPUT:
+//   handle - the reader
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   TRUE if the card was selected
+//----------------------------------------------------------------------------
+static bool tap(RC522_READER_t* handle)
+{
+  uint8 tag_type[MIFARE_BLOCK_SIZE];
+  uint8 uid[MIFARE_UID_SIZE + 1];
+
+  if ((rc522_is_card_present(handle, PICC_REQIDL, tag_type) != MI_OK) ||
+      (MFRC522_Anticoll(handle, uid) != MI_OK) ||
+      (rc522_select_tag(handle, uid) == 0))
+  {
+    return (FALSE);
+  } /* if */
+
+  mifare_begin(handle, uid);
+  return (TRUE);
+
+} /* tap */
+
+
+//----------------------------------------------------------------------------
+// NAME: start
+//
+// DESCRIPTION:
+//    This function sets up both readers with nothing cached.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void start(void)
+{
+
+  rc522_model_init();
+  rc522_reader_init(&reader, RC522_SPI0);
+  CHECK_EQUAL(MI_OK, rc522_init(&reader, 'A'));
+  rc522_reader_init(&other_reader, RC522_SPI1);
+  CHECK_EQUAL(MI_OK, rc522_init(&other_reader, 'A'));
+  mifare_cache_flush();
+
+} /* start */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_credential
+//
+// DESCRIPTION:
+//    This function reads a three block credential in one tap and checks
+//    what it cost.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_credential(void)
+{
+  RC522_MODEL_CARD_t* card;
+  uint8  data[CREDENTIAL_BLOCKS * MIFARE_BLOCK_SIZE];
+  uint32 begin;
+  uint32 elapsed;
+  int    transactions;
+
+  start();
+  card = present_card(RC522_SPI0, site_uid);
+
+  CHECK_EQUAL(MIFARE_NO_CARD,
+              mifare_read_blocks(&reader, CREDENTIAL_BLOCK, 1, site_key_a, MIFARE_KEY_A, data));
+
+  begin = rc522_model_us();
+  transactions = rc522_model(RC522_SPI0)->transactions;
+  CHECK(tap(&reader));
+  CHECK_EQUAL(MIFARE_OK, mifare_read_blocks(&reader, CREDENTIAL_BLOCK, CREDENTIAL_BLOCKS,
+                                            site_key_a, MIFARE_KEY_A, data));
+  mifare_end(&reader);
+  elapsed = rc522_model_us() - begin;
+  transactions = rc522_model(RC522_SPI0)->transactions - transactions;
+
+  CHECK(memcmp(data, card->data[CREDENTIAL_BLOCK], sizeof(data)) == 0);
+  CHECK_EQUAL(1, card->auths);
+  CHECK_EQUAL(CREDENTIAL_BLOCKS, card->reads);
+  CHECK_EQUAL(1, card->halts);
+  CHECK_EQUAL(CARD_HALT, card->state);
+  CHECK(!reader.card);
+  CHECK(!reader.authenticated);
+  CHECK_EQUAL(0, rc522_model(RC522_SPI0)->regs[STATUS2_REG] & STATUS2_CRYPTO1_ON);
+
+  printf("mifare_test: credential tap %u.%u ms, %d SPI transfers\n",
+         elapsed / 1000, elapsed % 1000 / 100, transactions);
+  CHECK(elapsed < TAP_LIMIT_US);
+
+  // Halted, the card ignores REQA until it leaves the field
+  CHECK(!tap(&reader));
+
+} /* test_credential */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_session_reuse
+//
+// DESCRIPTION:
+//    This function checks authentication is only repeated when the sector
+//    or the key changes.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_session_reuse(void)
+{
+  RC522_MODEL_CARD_t* card;
+  uint8 data[2 * MIFARE_BLOCK_SIZE];
+
+  start();
+  card = present_card(RC522_SPI0, site_uid);
+  CHECK(tap(&reader));
+
+  // Blocks 6 and 8 are in sectors 1 and 2
+  CHECK_EQUAL(MIFARE_OK, mifare_read_blocks(&reader, 6, 1, site_key_a, MIFARE_KEY_A, data));
+  CHECK_EQUAL(MIFARE_OK, mifare_read_blocks(&reader, 5, 1, site_key_a, MIFARE_KEY_A, data));
+  CHECK_EQUAL(1, card->auths);
+
+  CHECK_EQUAL(MIFARE_OK, mifare_read_blocks(&reader, 8, 1, transport_key, MIFARE_KEY_A, data));
+  CHECK_EQUAL(2, card->auths);
+  CHECK(memcmp(data, card->data[8], MIFARE_BLOCK_SIZE) == 0);
+
+  // Same sector, other key
+  CHECK_EQUAL(MIFARE_OK, mifare_read_blocks(&reader, 4, 1, site_key_b, MIFARE_KEY_B, data));
+  CHECK_EQUAL(3, card->auths);
+  CHECK_EQUAL(4, card->reads);
+
+  // Spanning two sectors
+  CHECK_EQUAL(MIFARE_OK, mifare_read_blocks(&reader, 9, 2, transport_key, MIFARE_KEY_A, data));
+  CHECK_EQUAL(4, card->auths);
+  CHECK(memcmp(data, card->data[9], 2 * MIFARE_BLOCK_SIZE) == 0);
+
+} /* test_session_reuse */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_errors
+//
+// DESCRIPTION:
+//    This function checks refused keys, noise and forbidden blocks.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_errors(void)
+{
+  RC522_MODEL_CARD_t* card;
+  uint8 data[MIFARE_BLOCK_SIZE];
+  uint8 block[MIFARE_BLOCK_SIZE];
+
+  start();
+  card = present_card(RC522_SPI0, site_uid);
+  memcpy(block, card->data[0], sizeof(block));
+
+  // Wrong key: the card drops out and has to be selected again
+  CHECK(tap(&reader));
+  CHECK_EQUAL(MIFARE_AUTH_ERROR,
+              mifare_read_blocks(&reader, CREDENTIAL_BLOCK, 1, transport_key, MIFARE_KEY_A, data));
+  CHECK(!reader.authenticated);
+  CHECK_EQUAL(1, card->failed_auths);
+  CHECK_EQUAL(CARD_IDLE, card->state);
+  CHECK_EQUAL(MIFARE_AUTH_ERROR,
+              mifare_read_blocks(&reader, CREDENTIAL_BLOCK, 1, site_key_a, MIFARE_KEY_A, data));
+  CHECK(tap(&reader));
+  CHECK_EQUAL(MIFARE_OK,
+              mifare_read_blocks(&reader, CREDENTIAL_BLOCK, 1, site_key_a, MIFARE_KEY_A, data));
+
+  // A read garbled on the air ends the session
+  card->noise = TRUE;
+  CHECK_EQUAL(MIFARE_IO_ERROR,
+              mifare_read_blocks(&reader, CREDENTIAL_BLOCK + 1, 1, site_key_a, MIFARE_KEY_A, data));
+  CHECK(!reader.authenticated);
+  card->noise = FALSE;
+  CHECK(reader.stats.errors[RC522_TIMEOUT_READ] > 0);
+
+  // The card only finds out on the next frame, which it can't decipher,
+  // so the first poll after an error goes unanswered
+  CHECK(!tap(&reader));
+  CHECK(tap(&reader));
+
+  // A card that answers too slowly for the profile
+  card->extra_delay_us = reader.profile->timeout_us[RC522_TIMEOUT_READ];
+  CHECK_EQUAL(MIFARE_IO_ERROR,
+              mifare_read_blocks(&reader, CREDENTIAL_BLOCK + 1, 1, site_key_a, MIFARE_KEY_A, data));
+  CHECK(reader.stats.no_answer[RC522_TIMEOUT_READ] > 0);
+  card->extra_delay_us = 0;
+
+  // Block 0 and trailers are never written, so the card isn't touched
+  CHECK(!tap(&reader));
+  CHECK(tap(&reader));
+  CHECK_EQUAL(MIFARE_DENIED, mifare_write_block(&reader, 0, transport_key, MIFARE_KEY_A, data));
+  CHECK_EQUAL(MIFARE_DENIED, mifare_write_block(&reader, 7, site_key_b, MIFARE_KEY_B, data));
+  CHECK_EQUAL(MIFARE_DENIED, mifare_write_block(&reader, 255, site_key_b, MIFARE_KEY_B, data));
+  CHECK_EQUAL(0, card->writes);
+  CHECK(memcmp(block, card->data[0], sizeof(block)) == 0);
+
+} /* test_errors */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_cache
+//
+// DESCRIPTION:
+//    This function checks the block cache only serves the reader session
+//    and key that filled it, and that entries expire.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_cache(void)
+{
+  RC522_MODEL_CARD_t* card;
+  RC522_MODEL_CARD_t* clone;
+  RC522_MODEL_CARD_t* other;
+  uint8 data[CREDENTIAL_BLOCKS * MIFARE_BLOCK_SIZE];
+  uint8 genuine[CREDENTIAL_BLOCKS * MIFARE_BLOCK_SIZE];
+  uint8 written[MIFARE_BLOCK_SIZE];
+
+  start();
+  card = present_card(RC522_SPI0, site_uid);
+  CHECK(tap(&reader));
+  CHECK_EQUAL(MIFARE_OK, mifare_read_blocks(&reader, CREDENTIAL_BLOCK, CREDENTIAL_BLOCKS,
+                                            site_key_a, MIFARE_KEY_A, genuine));
+
+  // Again in the same session: from the cache
+  CHECK_EQUAL(MIFARE_OK, mifare_read_blocks(&reader, CREDENTIAL_BLOCK, CREDENTIAL_BLOCKS,
+                                            site_key_a, MIFARE_KEY_A, data));
+  CHECK_EQUAL(CREDENTIAL_BLOCKS, card->reads);
+  CHECK(memcmp(data, genuine, sizeof(data)) == 0);
+
+  // With another key the card has to prove it knows that one too
+  CHECK_EQUAL(MIFARE_AUTH_ERROR, mifare_read_blocks(&reader, CREDENTIAL_BLOCK, 1,
+                                                    transport_key, MIFARE_KEY_A, data));
+  CHECK_EQUAL(CREDENTIAL_BLOCKS, card->reads);
+
+  // Written blocks are cached as written
+  CHECK(tap(&reader));
+  memset(written, 0x5A, sizeof(written));
+  CHECK_EQUAL(MIFARE_OK, mifare_write_block(&reader, CREDENTIAL_BLOCK + 1,
+                                            site_key_b, MIFARE_KEY_B, written));
+  CHECK_EQUAL(1, card->writes);
+  CHECK(memcmp(card->data[CREDENTIAL_BLOCK + 1], written, sizeof(written)) == 0);
+  CHECK_EQUAL(MIFARE_OK, mifare_read_blocks(&reader, CREDENTIAL_BLOCK + 1, 1,
+                                            site_key_b, MIFARE_KEY_B, data));
+  CHECK_EQUAL(CREDENTIAL_BLOCKS, card->reads);
+  CHECK(memcmp(data, written, sizeof(written)) == 0);
+  memcpy(&genuine[MIFARE_BLOCK_SIZE], written, sizeof(written));
+
+  // A new tap of the same card reads and authenticates again
+  mifare_end(&reader);
+  card->state = CARD_IDLE;              // out of the field and back
+  CHECK(tap(&reader));
+  card->auths = 0;
+  card->reads = 0;
+  CHECK_EQUAL(MIFARE_OK, mifare_read_blocks(&reader, CREDENTIAL_BLOCK, CREDENTIAL_BLOCKS,
+                                            site_key_a, MIFARE_KEY_A, data));
+  CHECK_EQUAL(1, card->auths);
+  CHECK_EQUAL(CREDENTIAL_BLOCKS, card->reads);
+  CHECK(memcmp(data, genuine, sizeof(data)) == 0);
+
+  // Entries expire within the session
+  rc522_model_wait((uint32)MIFARE_CACHE_TTL_MS * 1000);
+  CHECK_EQUAL(MIFARE_OK, mifare_read_blocks(&reader, CREDENTIAL_BLOCK, 1,
+                                            site_key_a, MIFARE_KEY_A, data));
+  CHECK_EQUAL(CREDENTIAL_BLOCKS + 1, card->reads);
+  mifare_end(&reader);
+
+  // A card with a copied UID but not the key gets nothing from the cache
+  CHECK(tap(&reader) == FALSE);
+  clone = present_card(RC522_SPI0, site_uid);
+  rc522_model_set_keys(RC522_SPI0, CREDENTIAL_SECTOR, transport_key, transport_key);
+  CHECK(tap(&reader));
+  CHECK_EQUAL(MIFARE_AUTH_ERROR, mifare_read_blocks(&reader, CREDENTIAL_BLOCK, CREDENTIAL_BLOCKS,
+                                                    site_key_a, MIFARE_KEY_A, data));
+  CHECK_EQUAL(1, clone->failed_auths);
+
+  // Nor does the same card on another reader
+  other = present_card(RC522_SPI1, site_uid);
+  CHECK(tap(&other_reader));
+  CHECK_EQUAL(MIFARE_OK, mifare_read_blocks(&other_reader, CREDENTIAL_BLOCK, CREDENTIAL_BLOCKS,
+                                            site_key_a, MIFARE_KEY_A, data));
+  CHECK_EQUAL(1, other->auths);
+  CHECK_EQUAL(CREDENTIAL_BLOCKS, other->reads);
+  CHECK(memcmp(data, other->data[CREDENTIAL_BLOCK], sizeof(data)) == 0);
+
+} /* test_cache */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_set_key
+//
+// DESCRIPTION:
+//    This function moves the credential sector of a new card from the
+//    transport key to the site key, as enrolling a card does.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_set_key(void)
+{
+  static const uint8 access[4] = { 0xFF, 0x07, 0x80, 0x69 };
+  RC522_MODEL_CARD_t* card;
+  uint8 written[MIFARE_BLOCK_SIZE];
+  uint8 data[MIFARE_BLOCK_SIZE];
+  uint8 trailer = CREDENTIAL_SECTOR * 4 + 3;
+
+  start();
+  rc522_model_card(RC522_SPI0, site_uid, RC522_MODEL_BLOCKS_1K);
+  card = &rc522_model(RC522_SPI0)->card;
+  memset(written, 0x5A, sizeof(written));
+
+  CHECK_EQUAL(MIFARE_NO_CARD, mifare_set_key_a(&reader, CREDENTIAL_BLOCK,
+                                               transport_key, MIFARE_KEY_A, site_key_a));
+
+  // Credential first, then the key, all in one session
+  CHECK(tap(&reader));
+  CHECK_EQUAL(MIFARE_OK, mifare_write_block(&reader, CREDENTIAL_BLOCK, transport_key,
+                                            MIFARE_KEY_A, written));
+  CHECK_EQUAL(MIFARE_OK, mifare_set_key_a(&reader, CREDENTIAL_BLOCK + 1, transport_key,
+                                          MIFARE_KEY_A, site_key_a));
+  CHECK_EQUAL(1, card->auths);
+  CHECK(memcmp(&card->data[trailer][0], site_key_a, MIFARE_KEY_SIZE) == 0);
+  CHECK(memcmp(&card->data[trailer][6], access, sizeof(access)) == 0);
+  CHECK(memcmp(&card->data[trailer][10], transport_key, MIFARE_KEY_SIZE) == 0);
+  mifare_end(&reader);
+
+  // The transport key no longer opens the sector, the site key does
+  card->state = CARD_IDLE;              // out of the field and back
+  CHECK(tap(&reader));
+  CHECK_EQUAL(MIFARE_AUTH_ERROR, mifare_read_blocks(&reader, CREDENTIAL_BLOCK, 1,
+                                                    transport_key, MIFARE_KEY_A, data));
+  CHECK(tap(&reader));
+  CHECK_EQUAL(MIFARE_OK, mifare_read_blocks(&reader, CREDENTIAL_BLOCK, 1,
+                                            site_key_a, MIFARE_KEY_A, data));
+  CHECK(memcmp(data, written, sizeof(data)) == 0);
+
+  // The other sectors keep the transport key
+  CHECK_EQUAL(MIFARE_OK, mifare_read_blocks(&reader, 8, 1, transport_key, MIFARE_KEY_A, data));
+
+} /* test_set_key */
+
+
+//-----------------------------------------------------------------------------
+//                               Main
+//-----------------------------------------------------------------------------
+
+int main(void)
+{
+
+  test_credential();
+  test_session_reuse();
+  test_errors();
+  test_cache();
+  test_set_key();
+
+  return (test_report("mifare_test"));
+
+} /* main */
@@ -0,0 +1,420 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: panel_test.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file checks that the control panel only takes keys while a user
+//    is logged in. panel.c runs unchanged on a fake key queue, LCD and
+//    clock, and the test walks through the login sequence of main():
+//
+//      - a started panel runs the item of a digit key, and a panel started
+//        at no user level would swallow the PIN digits
+//      - after a logout, a wrong PIN reaches the PIN reader digit by digit,
+//        runs no item and draws nothing on the LCD
+//      - the next login with the right PIN reaches the PIN reader too, and
+//        the panel it starts throws away stale keys and takes new ones
+//
+//*****************************************************************************
+
+#include <string.h>
+#include "test.h"
+#include "panel.h"
+#include "session.h"
+#include "timebase.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// User levels, as in main.c
+#define NO_AUTHENTICATION       0
+#define AUTHENTICATED_USER      1
+#define AUTHENTICATED_ADMIN     2
+
+#define QUEUE_SIZE              32
+#define NO_KEY                  0xFF
+#define PIN_LENGTH              4
+#define LCD_SIZE                0x80
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+static KEYPAD_EVENT_t queue[QUEUE_SIZE];
+static int    queue_head;
+static int    queue_count;
+
+static char   lcd[LCD_SIZE];
+static int    lcd_addr;
+static int    lcd_writes;
+
+static int    touches;
+static uint32 now_ms;
+
+static int    user_runs;
+static int    admin_runs;
+
+static const uint8 admin_pin[PIN_LENGTH] = { 1, 2, 3, 4 };
+static const uint8 wrong_pin[PIN_LENGTH] = { 1, 1, 1, 1 };
+static uint8  pin_read[PIN_LENGTH];     // what the PIN reader got
+
+
+//-----------------------------------------------------------------------------
+//                        Fakes of the panel's neighbours
+//-----------------------------------------------------------------------------
+
+bool keypad_get_event(KEYPAD_EVENT_t* event)
+{
+
+  if (queue_count == 0)
+  {
+    return (FALSE);
+  } /* if */
+
+  *event = queue[queue_head];
+  queue_head = (queue_head + 1) % QUEUE_SIZE;
+  queue_count--;
+  return (TRUE);
+
+} /* keypad_get_event */
+
+
+void keypad_flush(void)
+{
+
+  queue_count = 0;
+
+} /* keypad_flush */
+
+
+void set_lcd_addr(char addr)
+{
+
+  lcd_addr = (uint8)addr % LCD_SIZE;
+
+} /* set_lcd_addr */
+
+
+void data8(char c)
+{
+
+  lcd[lcd_addr] = c;
+  lcd_addr = (lcd_addr + 1) % LCD_SIZE;
+  lcd_writes++;
+
+} /* data8 */
+
+
+void session_touch(void)
+{
+
+  touches++;
+
+} /* session_touch */
+
+
+uint32 timebase_ms(void)
+{
+
+  return (now_ms);
+
+} /* timebase_ms */
+
+
+//-----------------------------------------------------------------------------
+//                        Menu
+//-----------------------------------------------------------------------------
+
+static void run_user_item(void)
+{
+
+  user_runs++;
+
+} /* run_user_item */
+
+
+static void run_admin_item(void)
+{
+
+  admin_runs++;
+
+} /* run_admin_item */
+
+
+static const PANEL_ITEM_t root_items[] =
+{
+  { "Status", AUTHENTICATED_USER,  NULL, run_user_item,  NULL },
+  { "Arm",    AUTHENTICATED_ADMIN, NULL, run_admin_item, NULL }
+};
+
+static const PANEL_MENU_t root_menu =
+{
+  root_items, sizeof(root_items) / sizeof(root_items[0])
+};
+
+
+//-----------------------------------------------------------------------------
+//                        Helpers
+//-----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
+// NAME: press
+//
+// DESCRIPTION:
+//    This function queues a key press and its release, as the keypad scan
+//    does.
+//
+// INPUT:
+//   key - the key
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void press(uint8 key)
+{
+  int tail;
+
+  tail = (queue_head + queue_count) % QUEUE_SIZE;
+  queue[tail].timestamp = (uint16)now_ms;
+  queue[tail].type = KEYPAD_PRESS;
+  queue[tail].key = key;
+  queue_count++;
+
+  tail = (tail + 1) % QUEUE_SIZE;
+  queue[tail] = queue[(tail + QUEUE_SIZE - 1) % QUEUE_SIZE];
+  queue[tail].type = KEYPAD_RELEASE;
+  queue_count++;
+
+} /* press */
+
+
+//----------------------------------------------------------------------------
+// NAME: read_key
+//
+// DESCRIPTION:
+//    This function waits for a key press like read_key() in main.c: the
+//    background services, the panel among them, run while it waits. The
+//    keys are queued before the call, so they arrive while the panel runs.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the key, or NO_KEY if the queue ran dry
+//----------------------------------------------------------------------------
+static uint8 read_key(void)
+{
+  KEYPAD_EVENT_t event;
+
+  now_ms += 10;
+  panel_service();
+
+  while (keypad_get_event(&event))
+  {
+    if (event.type == KEYPAD_PRESS)
+    {
+      return (event.key);
+    } /* if */
+  } /* while */
+
+  return (NO_KEY);
+
+} /* read_key */
+
+
+//----------------------------------------------------------------------------
+// NAME: log_in
+//
+// DESCRIPTION:
+//    This function enters a PIN the way main() does after a card: the
+//    panel is stopped, the PIN is read from the keypad into pin_read and
+//    the panel is only started again for a user level.
+//
+// INPUT:
+//   pin - the PIN keyed in
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the user level granted
+//----------------------------------------------------------------------------
+static uint8 log_in(const uint8 pin[PIN_LENGTH])
+{
+  uint8 level = AUTHENTICATED_ADMIN;
+  uint8 index;
+
+  panel_stop();
+
+  for (index = 0; index < PIN_LENGTH; index++)
+  {
+    press(pin[index]);
+  } /* for */
+
+  for (index = 0; index < PIN_LENGTH; index++)
+  {
+    pin_read[index] = read_key();
+    if (pin_read[index] != admin_pin[index])
+    {
+      level = NO_AUTHENTICATION;
+    } /* if */
+  } /* for */
+
+  if (level != NO_AUTHENTICATION)
+  {
+    panel_start(level);
+  } /* if */
+
+  return (level);
+
+} /* log_in */
+
+
+//-----------------------------------------------------------------------------
+//                        Tests
+//-----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
+// NAME: test_started_panel
+//
+// DESCRIPTION:
+//    This function checks that a started panel runs the item of a digit
+//    key, and that one started at no user level takes the keys a PIN
+//    reader waits for.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_started_panel(void)
+{
+
+  panel_init(&root_menu);
+  CHECK(!panel_is_active());
+
+  // Logged in: a digit runs the item it numbers
+  panel_start(AUTHENTICATED_ADMIN);
+  CHECK(panel_is_active());
+  press(2);
+  panel_service();
+  CHECK_EQUAL(1, admin_runs);
+  CHECK_EQUAL(0, queue_count);
+  CHECK(memcmp(lcd, "2 Arm", 5) == 0);
+
+  // What a panel left on at no user level did to the next PIN: every
+  // digit is taken by the panel and none runs an item
+  touches = 0;
+  panel_start(NO_AUTHENTICATION);
+  press(1);
+  CHECK_EQUAL(NO_KEY, read_key());
+  CHECK_EQUAL(1, touches);
+  CHECK_EQUAL(0, user_runs);
+  panel_stop();
+
+} /* test_started_panel */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_failed_pin_then_login
+//
+// DESCRIPTION:
+//    This function logs in, logs out, enters a wrong PIN and logs in
+//    again, checking that the PIN digits reach the PIN reader and no panel
+//    item runs until a login succeeds.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_failed_pin_then_login(void)
+{
+  int writes;
+
+  panel_init(&root_menu);
+  user_runs = 0;
+  admin_runs = 0;
+
+  // The first login
+  CHECK_EQUAL(AUTHENTICATED_ADMIN, log_in(admin_pin));
+  CHECK(memcmp(pin_read, admin_pin, PIN_LENGTH) == 0);
+  CHECK(panel_is_active());
+  press(1);
+  panel_service();
+  CHECK_EQUAL(1, user_runs);
+
+  // A logout, then a wrong PIN: every digit reaches the PIN reader and
+  // the panel keeps off the LCD
+  panel_stop();
+  touches = 0;
+  writes = lcd_writes;
+  CHECK_EQUAL(NO_AUTHENTICATION, log_in(wrong_pin));
+  CHECK(memcmp(pin_read, wrong_pin, PIN_LENGTH) == 0);
+  CHECK(!panel_is_active());
+  CHECK_EQUAL(0, touches);
+  CHECK_EQUAL(writes, lcd_writes);
+  CHECK_EQUAL(1, user_runs);
+  CHECK_EQUAL(0, admin_runs);
+
+  // The panel is not started, so a key pressed before the next card
+  // is left for the PIN reader
+  press(2);
+  panel_service();
+  CHECK_EQUAL(2, read_key());
+  CHECK_EQUAL(0, admin_runs);
+  keypad_flush();
+
+  // The next login reaches the PIN reader too
+  CHECK_EQUAL(AUTHENTICATED_ADMIN, log_in(admin_pin));
+  CHECK(memcmp(pin_read, admin_pin, PIN_LENGTH) == 0);
+  CHECK(panel_is_active());
+  CHECK_EQUAL(0, touches);
+  CHECK_EQUAL(1, user_runs);
+  CHECK_EQUAL(0, admin_runs);
+
+  // Its panel drops a key queued before it started and takes a new one
+  panel_stop();
+  press(2);
+  panel_start(AUTHENTICATED_ADMIN);
+  panel_service();
+  CHECK_EQUAL(0, admin_runs);
+  press(2);
+  panel_service();
+  CHECK_EQUAL(1, admin_runs);
+  CHECK_EQUAL(1, touches);
+
+} /* test_failed_pin_then_login */
+
+
+int main(void)
+{
+
+  test_started_panel();
+  test_failed_pin_then_login();
+
+  return (test_report("panel_test"));
+
+} /* main */
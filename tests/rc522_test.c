@@ -0,0 +1,296 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: rc522_test.c
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file checks the RC522 timer and gain set up of RFID_rc522.c
+//    against the host register model (host/rc522_model.c), for the default
+//    profile, the max gain profile and a custom one:
+//
+//      - rc522_init() leaves TPrescalerReg at 0xA9, TModeReg with TAuto
+//        and the profile's gain in RFCfgReg
+//      - every command type loads TReloadReg with its timeout in 25 us
+//        ticks, rounded up, and a command nobody answers is ended by
+//        TimerIRq after that long and counted as no answer
+//      - a REQA with no card in the field is ended by the timer within a
+//        tick of the profile's REQA timeout, and the driver's SPI traffic
+//        before and after it stays within a fixed number of bytes
+//      - TReloadReg is only written when the timeout changes
+//      - rc522_check() notices an RC522 that reset itself, and
+//        rc522_init() brings it back
+//
+//*****************************************************************************
+
+#include <string.h>
+#include "test.h"
+#include "RFID_rc522.h"
+#include "rc522_model.h"
+
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// Frames on the air at 106 kbit/s, 9 bits a byte: the two byte test
+// frame and the 7 bit REQA
+#define FRAME_AIR_US            170
+#define REQA_AIR_US             67
+
+// SPI bytes the driver spends around the RC522 timer, at
+// RC522_MODEL_SPI_BYTE_US each. Starting a command takes BitFramingReg,
+// ComIEnReg, two read-modify-writes to clear the IRQs and flush the
+// FIFO, the FIFO, CommandReg twice and a read-modify-write for
+// StartSend, plus TReloadReg when the timeout changes. Finishing it
+// takes the ComIrqReg poll that sees TimerIRq, up to one poll late, a
+// read-modify-write to clear StartSend and reading ErrorReg,
+// FIFOLevelReg, ControlReg and the empty FIFO. At 250 kHz that is about
+// 1.6 ms on top of a 1 ms REQA timeout: an empty REQA poll takes about
+// 2.6 ms, and most of that is SPI traffic, not waiting for a card.
+#define START_SPI_BYTES         28
+#define FINISH_SPI_BYTES        14
+
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+// Timeouts that are not whole ticks, and a gain between the two built in
+static const RC522_PROFILE_t custom_profile =
+  {
+    {
+      1010,             // RC522_TIMEOUT_REQA
+      1500,             // RC522_TIMEOUT_ANTICOLL
+      2490,             // RC522_TIMEOUT_SELECT
+      8001,             // RC522_TIMEOUT_AUTH
+      4000,             // RC522_TIMEOUT_READ
+      30000,            // RC522_TIMEOUT_WRITE
+      24                // RC522_TIMEOUT_HALT
+    },
+    RC522_RX_GAIN_43DB
+  };
+
+static RC522_READER_t reader;
+
+
+//-----------------------------------------------------------------------------
+//                        Define private functions
+//-----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
+// NAME: reload_of
+//
+// DESCRIPTION:
+//    This function reads the TReloadReg value out of the model.
+//
+// INPUT:
+//   chip - the RC522 model
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the reload value
+//----------------------------------------------------------------------------
+static uint16 reload_of(const RC522_MODEL_t* chip)
+{
+
+  return ((uint16)((chip->regs[T_RELOAD_REG_H] << 8) | chip->regs[T_RELOAD_REG_L]));
+
+} /* reload_of */
+
+
+//----------------------------------------------------------------------------
+// NAME: send_unanswered
+//
+// DESCRIPTION:
+//    This function sends a frame with a command type's timeout to an
+//    empty field.
+//
+// INPUT:
+//   timeout - RC522_TIMEOUT_xx
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the status of the exchange
+//----------------------------------------------------------------------------
+static sint8 send_unanswered(uint8 timeout)
+{
+  uint8  frame[MIFARE_BLOCK_SIZE + MIFARE_CRC_SIZE];
+  uint16 bits;
+
+  memset(frame, 0, sizeof(frame));
+  rc522_write_reg(&reader, BIT_FRAMING_REG, 0x00);
+  rc522_set_timeout(&reader, timeout);
+
+  // Two bytes, as short as a HLTA
+  return (rc522_exchange(&reader, RC522_TRANSCEIVE_CMD, frame, 2,
+                         frame, sizeof(frame), &bits));
+
+} /* send_unanswered */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_profile
+//
+// DESCRIPTION:
+//    This function checks the registers and timeouts one profile sets.
+//
+// INPUT:
+//   name    - the profile's name, for messages
+//   profile - the profile
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_profile(const char* name, const RC522_PROFILE_t* profile)
+{
+  RC522_MODEL_t* chip;
+  uint8  tag_type[MIFARE_BLOCK_SIZE];
+  uint8  timeout;
+  uint16 ticks;
+  uint32 begin;
+  uint32 elapsed;
+  int    writes;
+
+  rc522_model_init();
+  chip = rc522_model(RC522_SPI0);
+  memset(&reader, 0, sizeof(reader));   // the statistics outlive a re-init
+  rc522_reader_init(&reader, RC522_SPI0);
+  CHECK_EQUAL(MI_OK, rc522_init(&reader, 'B'));
+  rc522_set_profile(&reader, profile);
+
+  CHECK_EQUAL(RC522_TIMER_PRESCALER, chip->regs[T_PRESCALER_REG]);
+  CHECK_EQUAL(RC522_TIMER_MODE, chip->regs[T_MODE_REG]);
+  CHECK_EQUAL(profile->rx_gain, chip->regs[RF_CFG_REG] & RC522_RX_GAIN_MASK);
+  CHECK(rc522_check(&reader));
+
+  for (timeout = 0; timeout < RC522_TIMEOUTS; timeout++)
+  {
+    ticks = (uint16)((profile->timeout_us[timeout] + RC522_TIMER_TICK_US - 1) /
+                     RC522_TIMER_TICK_US);
+    if (ticks == 0)
+    {
+      ticks = 1;
+    } /* if */
+
+    begin = rc522_model_us();
+    CHECK_EQUAL(MI_NOTAGERR, send_unanswered(timeout));
+    elapsed = rc522_model_us() - begin;
+
+    CHECK_EQUAL(ticks - 1, reload_of(chip));
+    CHECK_EQUAL((uint32)ticks * RC522_TIMER_TICK_US, chip->last_timeout_us);
+    CHECK(chip->start_us - begin <= START_SPI_BYTES * RC522_MODEL_SPI_BYTE_US);
+    CHECK(chip->done_us - chip->start_us <= chip->last_timeout_us + FRAME_AIR_US);
+    CHECK(begin + elapsed - chip->done_us <= FINISH_SPI_BYTES * RC522_MODEL_SPI_BYTE_US);
+    CHECK_EQUAL(1, reader.stats.commands[timeout]);
+    CHECK_EQUAL(1, reader.stats.no_answer[timeout]);
+    CHECK_EQUAL(0, reader.stats.errors[timeout]);
+  } /* for */
+  CHECK_EQUAL(0, reader.stats.stuck);
+
+  // A REQA poll of an empty field
+  begin = rc522_model_us();
+  CHECK_EQUAL(MI_NOTAGERR, rc522_is_card_present(&reader, PICC_REQIDL, tag_type));
+  elapsed = rc522_model_us() - begin;
+  printf("rc522_test: %s profile, empty REQA %u us (SPI %u, air and timer %u, SPI %u)\n",
+         name, elapsed, chip->start_us - begin, chip->done_us - chip->start_us,
+         begin + elapsed - chip->done_us);
+  CHECK(chip->last_timeout_us >= profile->timeout_us[RC522_TIMEOUT_REQA]);
+  CHECK(chip->last_timeout_us < (uint32)profile->timeout_us[RC522_TIMEOUT_REQA] + RC522_TIMER_TICK_US);
+  CHECK(chip->start_us - begin <= START_SPI_BYTES * RC522_MODEL_SPI_BYTE_US);
+  CHECK(chip->done_us - chip->start_us <= chip->last_timeout_us + REQA_AIR_US);
+  CHECK(begin + elapsed - chip->done_us <= FINISH_SPI_BYTES * RC522_MODEL_SPI_BYTE_US);
+  CHECK(elapsed <= chip->last_timeout_us + REQA_AIR_US +
+                   (START_SPI_BYTES + FINISH_SPI_BYTES) * RC522_MODEL_SPI_BYTE_US);
+  CHECK_EQUAL(2, reader.stats.no_answer[RC522_TIMEOUT_REQA]);
+
+  // The timer is only reloaded for another timeout
+  writes = chip->timer_reload_writes;
+  CHECK_EQUAL(MI_NOTAGERR, rc522_is_card_present(&reader, PICC_REQIDL, tag_type));
+  CHECK_EQUAL(MI_NOTAGERR, send_unanswered(RC522_TIMEOUT_REQA));
+  CHECK_EQUAL(writes, chip->timer_reload_writes);
+  CHECK_EQUAL(MI_NOTAGERR, send_unanswered(RC522_TIMEOUT_HALT));
+  CHECK_EQUAL(writes + 2, chip->timer_reload_writes);
+
+  // and for any timeout after a profile change
+  rc522_set_profile(&reader, profile);
+  CHECK_EQUAL(MI_NOTAGERR, send_unanswered(RC522_TIMEOUT_HALT));
+  CHECK_EQUAL(writes + 4, chip->timer_reload_writes);
+
+} /* test_profile */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_brown_out
+//
+// DESCRIPTION:
+//    This function resets the RC522 under the driver and checks it is
+//    noticed and recovered from.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   none
+//----------------------------------------------------------------------------
+static void test_brown_out(void)
+{
+  RC522_MODEL_t* chip;
+  uint8 tag_type[MIFARE_BLOCK_SIZE];
+
+  rc522_model_init();
+  chip = rc522_model(RC522_SPI0);
+  memset(&reader, 0, sizeof(reader));   // the statistics outlive a re-init
+  rc522_reader_init(&reader, RC522_SPI0);
+  CHECK_EQUAL(MI_OK, rc522_init(&reader, 'A'));
+  CHECK(rc522_check(&reader));
+  CHECK_EQUAL(MI_NOTAGERR, rc522_is_card_present(&reader, PICC_REQIDL, tag_type));
+
+  // Without TAuto nothing ends the command, so the driver gives up on it
+  rc522_model_brown_out(RC522_SPI0);
+  CHECK(!rc522_check(&reader));
+  CHECK_EQUAL(1, reader.stats.check_failures);
+  CHECK_EQUAL(MI_ERR, rc522_is_card_present(&reader, PICC_REQIDL, tag_type));
+  CHECK_EQUAL(1, reader.stats.stuck);
+
+  CHECK_EQUAL(MI_OK, rc522_init(&reader, 'A'));
+  CHECK(rc522_check(&reader));
+  CHECK_EQUAL(rc522_max_gain_profile.rx_gain, chip->regs[RF_CFG_REG] & RC522_RX_GAIN_MASK);
+  CHECK_EQUAL(MI_NOTAGERR, rc522_is_card_present(&reader, PICC_REQIDL, tag_type));
+  CHECK_EQUAL(rc522_timer_reload(rc522_max_gain_profile.timeout_us[RC522_TIMEOUT_REQA]),
+              reload_of(chip));
+  CHECK_EQUAL(1, reader.stats.stuck);
+  CHECK_EQUAL(1, reader.stats.check_failures);
+
+} /* test_brown_out */
+
+
+//-----------------------------------------------------------------------------
+//                               Main
+//-----------------------------------------------------------------------------
+
+int main(void)
+{
+
+  test_profile("default", &rc522_default_profile);
+  test_profile("max gain", &rc522_max_gain_profile);
+  test_profile("custom", &custom_profile);
+  test_brown_out();
+
+  return (test_report("rc522_test"));
+
+} /* main */
@@ -0,0 +1,149 @@
+//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: test.h
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    This file contains the checks shared by the host unit tests. The tests
+//    build the firmware modules with the host compiler (see Makefile), so
+//    only modules that do not touch the HCS12 registers directly, or whose
+//    registers are modelled by the test, can be tested this way.
+//
+//*****************************************************************************
+
+#ifndef _TEST_H_
+#define _TEST_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+//                        Define symbolic constants
+//-----------------------------------------------------------------------------
+
+// Records a failure without stopping the test so one run shows them all
+#define CHECK(condition)                                                      \
+  do                                                                          \
+  {                                                                           \
+    test_checks++;                                                            \
+    if (!(condition))                                                         \
+    {                                                                         \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);    \
+      test_failures++;                                                        \
+    } /* if */                                                                \
+  } while (0)
+
+#define CHECK_EQUAL(expected, actual)                                         \
+  do                                                                          \
+  {                                                                           \
+    long check_expected = (long)(expected);                                   \
+    long check_actual = (long)(actual);                                       \
+    test_checks++;                                                            \
+    if (check_expected != check_actual)                                       \
+    {                                                                         \
+      printf("%s:%d: %s is %ld, expected %ld\n", __FILE__, __LINE__,          \
+             #actual, check_actual, check_expected);                          \
+      test_failures++;                                                        \
+    } /* if */                                                                \
+  } while (0)
+
+//-----------------------------------------------------------------------------
+//                        Define private variables
+//-----------------------------------------------------------------------------
+
+static int test_checks;
+static int test_failures;
+static uint32_t test_seed = 1;
+
+//-----------------------------------------------------------------------------
+//                               Public functions
+//-----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
+// NAME: test_report
+//
+// DESCRIPTION:
+//    This function prints the result of a test program.
+//
+// INPUT:
+//   name - the test program's name
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   the exit status for main(): 0 if every check passed, otherwise 1
+//----------------------------------------------------------------------------
+static int test_report(const char* name)
+{
+
+  printf("%s: %d checks, %d failed\n", name, test_checks, test_failures);
+  return (test_failures != 0);
+
+} /* test_report */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_random
+//
+// DESCRIPTION:
+//    This function returns the next value of a fixed seed generator, so a
+//    synthetic trace is the same on every run and every host.
+//
+// INPUT:
+//   none
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   a uniform value in [0, 1)
+//----------------------------------------------------------------------------
+static inline double test_random(void)
+{
+
+  // xorshift32
+  test_seed ^= test_seed << 13;
+  test_seed ^= test_seed >> 17;
+  test_seed ^= test_seed << 5;
+  return (test_seed / 4294967296.0);
+
+} /* test_random */
+
+
+//----------------------------------------------------------------------------
+// NAME: test_gauss
+//
+// DESCRIPTION:
+//    This function returns approximately normal noise, the sum of twelve
+//    uniform values.
+//
+// INPUT:
+//   sd - the standard deviation
+//
+// OUTPUT:
+//   none
+//
+// RETURN:
+//   a sample of zero mean noise
+//----------------------------------------------------------------------------
+static inline double test_gauss(double sd)
+{
+  double sum = 0.0;
+  int    i;
+
+  for (i = 0; i < 12; i++)
+  {
+    sum += test_random();
+  } /* for */
+
+  return ((sum - 6.0) * sd);
+
+} /* test_gauss */
+
+#endif /* _TEST_H_ */
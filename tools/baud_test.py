@@ -0,0 +1,338 @@
+#!/usr/bin/env python3
+"""Step the security system's console through its baud rates and time each.
+
+Log in, press ENTER to leave the numeric menu so the console takes text
+commands, close the terminal program, then run:
+
+    python3 baud_test.py /dev/ttyUSB0
+
+For each rate the board says it can use, the script types "baud" and the
+rate's number at the current rate, moves the port to the new rate, sends
+the sync characters and waits for the board to confirm. It then types
+"sendtest" and times the 4096 byte pattern that comes back, which gives
+the effective throughput at that rate. The console is left at 9600. If
+anything goes wrong the script sends a break, which puts the board back on
+9600 too. A real port needs pyserial; 250000 and 500000 baud need an FTDI
+or similar adapter that takes custom rates.
+
+    python3 baud_test.py --pty
+
+runs the same against a model of the board on a pseudo terminal. The model
+follows the handshake in Sources/serial.c, drops characters sent at the
+wrong rate as framing errors and paces its output at 10 bits per character,
+so the script can be checked without hardware. A pty has no real baud
+rate: the figures it prints only show the model's pacing.
+"""
+
+import argparse
+import os
+import re
+import select
+import sys
+import threading
+import time
+
+DEFAULT_BAUD = 9600
+SYNC = b"UUUU"                  # SERIAL_SYNC_CHAR x SERIAL_SYNC_COUNT
+SWITCH_S = 10.0                 # SERIAL_SWITCH_MS
+FALLBACK_ERRORS = 3             # SERIAL_FALLBACK_ERRORS
+PATTERN_LINES = 64              # SEND_TEST_LINES in main.c
+PATTERN_LINE_CHARS = 62         # SEND_TEST_LINE_CHARS in main.c
+
+BUS_CLOCK = 24000000
+MAX_ERROR = 200                 # SERIAL_MAX_ERROR, 0.01 %
+BOARD_RATES = (9600, 19200, 38400, 57600, 115200, 230400, 250000, 500000)
+
+RATE_ROW = re.compile(rb"^ (\d) (\d+)\s+([+-]\d+\.\d\d)%(.*)$", re.M)
+
+
+def divisor(baud):
+    return (BUS_CLOCK + 8 * baud) // (16 * baud)
+
+
+def error(baud):
+    """Same integer arithmetic as SERIAL_ERROR() in serial.h."""
+    actual = BUS_CLOCK // (16 * divisor(baud))
+    return int((actual - baud) * 10000 / baud)
+
+
+def pattern_line(line):
+    text = "%04X" % line
+    text += "".join(chr(ord("0") + (line + i) % 64) for i in range(4, PATTERN_LINE_CHARS))
+    return text.encode() + b"\n\r"
+
+
+class SerialPort:
+    """A real port, through pyserial."""
+
+    def __init__(self, device):
+        import serial
+        self.port = serial.Serial(device, DEFAULT_BAUD, timeout=0.05)
+
+    def set_baud(self, baud):
+        self.port.baudrate = baud
+
+    def write(self, data):
+        self.port.write(data)
+        self.port.flush()
+
+    def read(self):
+        return self.port.read(4096)
+
+    def send_break(self):
+        self.port.send_break(0.05)
+
+
+class PtyPort:
+    """The host end of a pty with BoardModel on the other end."""
+
+    def __init__(self):
+        self.master, slave = os.openpty()
+        self.fd = slave
+        self.baud = DEFAULT_BAUD
+        os.set_blocking(self.fd, False)
+        import tty
+        tty.setraw(self.fd)
+        tty.setraw(self.master)
+
+    def set_baud(self, baud):
+        self.baud = baud
+
+    def write(self, data):
+        os.write(self.fd, data)
+
+    def read(self):
+        time.sleep(0.002)
+        try:
+            return os.read(self.fd, 4096)
+        except BlockingIOError:
+            return b""
+
+    def send_break(self):
+        os.write(self.fd, b"\0")     # the model takes a NUL for a break
+
+
+class BoardModel(threading.Thread):
+    """Enough of the console to answer "baud" and "sendtest"."""
+
+    def __init__(self, port):
+        super().__init__(daemon=True)
+        self.port = port
+        self.fd = port.master
+        self.rate = 0
+        self.previous = 0
+        self.switch_end = None
+        self.sync = 0
+        self.bad_frames = 0
+        self.line = b""
+        self.picking = False
+
+    def baud(self):
+        return BOARD_RATES[self.rate]
+
+    def usable(self, rate):
+        return abs(error(BOARD_RATES[rate])) <= MAX_ERROR
+
+    def send(self, data):
+        """Pace the output at the model's rate; garble it if the host differs."""
+        if self.port.baud != self.baud():
+            data = bytes((b ^ 0x5A) | 0x80 for b in data)
+        for start in range(0, len(data), 64):
+            chunk = data[start:start + 64]
+            os.write(self.fd, chunk)
+            time.sleep(len(chunk) * 10 / self.baud())
+
+    def fall_back(self):
+        rate = 0
+        if self.switch_end is not None:
+            rate = self.previous
+            self.switch_end = None
+        self.bad_frames = 0
+        self.rate = rate
+
+    def receive(self, byte):
+        if byte == 0:
+            self.fall_back()
+            return
+        if self.port.baud != self.baud():
+            self.bad_frames += 1
+            if self.bad_frames >= FALLBACK_ERRORS:
+                self.fall_back()
+            return
+        self.bad_frames = 0
+        if self.switch_end is not None:
+            self.sync = self.sync + 1 if byte == SYNC[0] else 0
+            if self.sync >= len(SYNC):
+                self.switch_end = None
+                self.send(b"\n\rConsole at %d baud" % self.baud())
+            return
+        self.command(byte)
+
+    def command(self, byte):
+        self.send(bytes([byte]))
+        if self.picking:
+            self.picking = False
+            rate = byte - ord("0")
+            if byte == 0x0D:
+                return
+            if not 0 <= rate < len(BOARD_RATES) or not self.usable(rate):
+                self.send(b"\n\rError: Can't use that rate!")
+                return
+            self.send(b"\n\rBAUD %d: set the terminal to match and type %s\n\r"
+                      % (BOARD_RATES[rate], SYNC))
+            self.previous = self.rate
+            self.rate = rate
+            self.sync = 0
+            self.switch_end = time.time() + SWITCH_S
+        elif byte == 0x0D:
+            line, self.line = self.line, b""
+            if line == b"baud":
+                self.send(b"\n\r # baud    error")
+                for rate, baud in enumerate(BOARD_RATES):
+                    value = error(baud)
+                    row = b"\n\r %d %-7d %s%d.%02d%%" % (rate, baud, b"-" if value < 0 else b"+",
+                                                        abs(value) // 100, abs(value) % 100)
+                    if not self.usable(rate):
+                        row += b"  too far off"
+                    elif rate == self.rate:
+                        row += b"  <- now"
+                    self.send(row)
+                self.send(b"\n\rRate (ENTER to keep): ")
+                self.picking = True
+            elif line == b"sendtest":
+                self.send(b"\n\r#SEND\n\r")
+                self.send(b"".join(pattern_line(i) for i in range(PATTERN_LINES)) + b"#END\n\r")
+            else:
+                self.send(b"Error: Invalid command!")
+        else:
+            self.line += bytes([byte])
+
+    def run(self):
+        while True:
+            if self.switch_end is not None and time.time() >= self.switch_end:
+                self.switch_end = None
+                self.rate = self.previous
+            if not select.select([self.fd], [], [], 0.05)[0]:
+                continue
+            try:
+                data = os.read(self.fd, 64)
+            except OSError:
+                return
+            for byte in data:
+                self.receive(byte)
+
+
+class Console:
+    def __init__(self, port):
+        self.port = port
+        self.pending = b""
+
+    def expect(self, pattern, timeout):
+        """Read until the regex matches; returns the match and the time of its last byte."""
+        end = time.time() + timeout
+        while True:
+            match = re.search(pattern, self.pending)
+            if match:
+                self.pending = self.pending[match.end():]
+                return match
+            if time.time() >= end:
+                raise TimeoutError("no %r in %r" % (pattern, self.pending[-80:]))
+            self.pending += self.port.read()
+
+    def type(self, text):
+        self.pending = b""
+        for byte in text:
+            self.port.write(bytes([byte]))
+            time.sleep(0.01)    # the console polls, it has no receive buffer
+
+    def rates(self):
+        self.type(b"baud\r")
+        self.expect(rb"# baud", 5)
+        listing = self.expect(rb"Rate \(ENTER to keep\): ", 5)
+        rows = RATE_ROW.findall(self.pending_before(listing))
+        self.type(b"\r")
+        return rows
+
+    def pending_before(self, match):
+        return match.string[:match.start()].replace(b"\r", b"")
+
+    def switch(self, rate, baud):
+        self.type(b"baud\r")
+        self.expect(rb"Rate \(ENTER to keep\): ", 5)
+        self.type(b"%d" % rate)
+        self.expect(rb"BAUD %d: .*\n\r" % baud, 5)
+        time.sleep(0.05)
+        self.port.set_baud(baud)
+        self.type(SYNC)
+        match = self.expect(rb"Console at (\d+) baud", SWITCH_S + 1)
+        return int(match.group(1)) == baud
+
+    def throughput(self):
+        self.type(b"sendtest\r")
+        self.expect(rb"#SEND\n\r", 5)
+        start = time.time()
+        received = self.pending
+        while b"#END" not in received:
+            if time.time() - start > 30:
+                raise TimeoutError("pattern did not end")
+            received += self.port.read()
+        elapsed = time.time() - start
+        body = received[:received.index(b"#END")]
+        expected = b"".join(pattern_line(i) for i in range(PATTERN_LINES))
+        bad = sum(1 for got, want in zip(body.split(b"\n\r"), expected.split(b"\n\r")) if got != want)
+        self.pending = b""
+        return len(body) / elapsed, bad
+
+
+def run(port):
+    console = Console(port)
+    rows = console.rates()
+    if not rows:
+        sys.exit("no rate table; is the console logged in and taking text commands?")
+
+    print("rate    divisor  error    board")
+    for rate, baud, board_error, note in rows:
+        baud = int(baud)
+        print("%-7d %7d  %+.2f%%  %s%s" % (baud, divisor(baud), error(baud) / 100,
+                                          board_error.decode(), note.decode()))
+        if "%+.2f" % (error(baud) / 100) != board_error.decode():
+            print("  error differs from this script's; is the bus clock 24 MHz?")
+
+    print("\nrate    bytes/s  of max   bad lines")
+    try:
+        for rate, baud, board_error, note in rows:
+            baud = int(baud)
+            if b"too far off" in note:
+                continue
+            if not console.switch(int(rate), baud):
+                print("%-7d no sync, board stayed at the old rate" % baud)
+                continue
+            rate_bytes, bad = console.throughput()
+            print("%-7d %7.0f  %5.1f%%  %d" % (baud, rate_bytes, rate_bytes * 1000 / baud, bad))
+        console.switch(0, DEFAULT_BAUD)
+    except TimeoutError as failure:
+        print("gave up: %s" % failure)
+        port.send_break()
+        port.set_baud(DEFAULT_BAUD)
+        return 1
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("device", nargs="?", help="serial port of the console")
+    parser.add_argument("--pty", action="store_true", help="test against a model of the board")
+    args = parser.parse_args()
+
+    if args.pty:
+        port = PtyPort()
+        BoardModel(port).start()
+    elif args.device:
+        port = SerialPort(args.device)
+    else:
+        parser.error("give a serial port or --pty")
+    return run(port)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""Decode black box recorder dumps captured from the security system's SCI.
+
+Save the terminal session to a file (PuTTY: Session > Logging > All session
+output), then run:
+
+    python3 blackbox_decode.py putty.log > window.csv
+
+Every window between "#BBOX" and "#END" is decoded into CSV rows of
+block sequence, time in ms relative to the alarm, the four channels and a
+trigger mark on the first sample recorded after the alarm. Lines
+that fail their checksum are reported on stderr and skipped; anything else
+in the log (console output, echoed commands) is ignored.
+
+The block format is documented at the top of Sources/recorder.c.
+"""
+
+import argparse
+import sys
+
+BLOCK_HEADER_SIZE = 16
+CHANNELS = ("light", "temp", "motion", "distance")
+TICK_MS = 1.024
+DEFAULT_PERIOD_TICKS = 98   # STATUS_STEP_TICKS in main.c
+
+
+def s8(value):
+    return value - 0x100 if value & 0x80 else value
+
+
+def s16(value):
+    return value - 0x10000 if value & 0x8000 else value
+
+
+def parse_block(text):
+    raw = bytes.fromhex(text)
+    if sum(raw) & 0xFF:
+        raise ValueError("bad checksum")
+    raw = raw[:-1]
+    if len(raw) < BLOCK_HEADER_SIZE:
+        raise ValueError("short block")
+
+    block = {
+        "seq": (raw[0] << 8) | raw[1],
+        "timestamp": (raw[2] << 8) | raw[3],
+        "count": raw[4],
+        "used": raw[5],
+        "trigger": raw[6],
+    }
+    if len(raw) != BLOCK_HEADER_SIZE + block["used"]:
+        raise ValueError("length does not match header")
+
+    values = [(raw[8 + 2 * i] << 8) | raw[9 + 2 * i] for i in range(len(CHANNELS))]
+    samples = [list(values)]
+    data = raw[BLOCK_HEADER_SIZE:]
+    pos = 0
+    while len(samples) < block["count"]:
+        tag = data[pos]
+        pos += 1
+        for channel in range(len(CHANNELS)):
+            code = (tag >> (6 - 2 * channel)) & 0x03
+            if code == 1:
+                values[channel] = (values[channel] + s8(data[pos])) & 0xFFFF
+                pos += 1
+            elif code == 2:
+                delta = s16((data[pos] << 8) | data[pos + 1])
+                values[channel] = (values[channel] + delta) & 0xFFFF
+                pos += 2
+            elif code == 3:
+                raise ValueError("reserved delta code")
+        samples.append(list(values))
+    block["samples"] = samples
+    return block
+
+
+def decode(lines, period_ticks, out):
+    window = None
+    out.write("window,seq,time_ms,%s,trigger\n" % ",".join(CHANNELS))
+    windows = 0
+
+    for number, line in enumerate(lines, 1):
+        line = line.strip()
+        if line.startswith("#BBOX"):
+            fields = line.split()
+            window = {"trigger": int(fields[1], 16), "missed": int(fields[2], 16), "blocks": []}
+        elif line.startswith("#END") and window is not None:
+            windows += 1
+            emit(window, windows, period_ticks, out)
+            window = None
+        elif line.startswith(":") and window is not None:
+            try:
+                window["blocks"].append(parse_block(line[1:]))
+            except ValueError as error:
+                sys.stderr.write("line %d: %s\n" % (number, error))
+
+    if window is not None:
+        sys.stderr.write("log ends inside a window; decoding what arrived\n")
+        windows += 1
+        emit(window, windows, period_ticks, out)
+
+
+def emit(window, index, period_ticks, out):
+    # Blocks come out in ring order, which is not always time order
+    blocks = sorted(window["blocks"], key=lambda b: (b["seq"] - window["blocks"][-1]["seq"] - 1) & 0xFFFF)
+    if window["missed"]:
+        sys.stderr.write("window %d: %d later alarm(s) not recorded\n" % (index, window["missed"]))
+
+    if not blocks:
+        return
+
+    # The 16-bit tick count wraps every 67 s, which a window can span, so
+    # unwrap the block timestamps in order before lining them up with the
+    # trigger (which falls in the newest blocks)
+    elapsed = 0
+    previous = None
+    for block in blocks:
+        if previous is not None:
+            if block["seq"] != (previous["seq"] + 1) & 0xFFFF:
+                sys.stderr.write("window %d: blocks %d to %d missing\n"
+                                 % (index, previous["seq"] + 1, block["seq"] - 1))
+            elapsed += (block["timestamp"] - previous["timestamp"]) & 0xFFFF
+        block["elapsed"] = elapsed
+        previous = block
+
+    last = blocks[-1]
+    trigger = last["elapsed"] - ((last["timestamp"] - window["trigger"]) & 0xFFFF)
+
+    for block in blocks:
+        for i, sample in enumerate(block["samples"]):
+            ticks = block["elapsed"] + i * period_ticks - trigger
+            mark = "TRIGGER" if block["trigger"] == i + 1 else ""
+            out.write("%d,%d,%.0f,%s,%s\n" % (index, block["seq"], ticks * TICK_MS,
+                                             ",".join(str(v) for v in sample), mark))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("log", nargs="?", help="terminal log (default: stdin)")
+    parser.add_argument("--period-ticks", type=int, default=DEFAULT_PERIOD_TICKS,
+                        help="ticks between samples (default %(default)s)")
+    args = parser.parse_args()
+
+    if args.log:
+        with open(args.log, errors="replace") as log:
+            decode(log, args.period_ticks, sys.stdout)
+    else:
+        decode(sys.stdin, args.period_ticks, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
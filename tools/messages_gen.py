@@ -0,0 +1,282 @@
+#!/usr/bin/env python3
+"""Build the banked console message table from Sources/messages.txt.
+
+    python3 messages_gen.py
+
+writes Sources/message_table.c and Sources/message_table.h and prints what
+each message costs before and after. Run it after editing messages.txt and
+commit the generated files with it; the CodeWarrior project doesn't run it.
+
+Messages with the same text share one copy, as does a message that is the
+tail of another. The rest is packed with a static dictionary: up to 128
+substrings that pay for themselves are replaced by one byte 0x80 + n, so
+messages_print() in Sources/messages.c decodes a byte at a time as it
+sends. The dictionary is chosen greedily, the substring saving the most
+bytes first, and entries never hold other entries.
+"""
+
+import argparse
+import collections
+import os
+import re
+import sys
+
+MAX_WORDS = 128
+MIN_WORD = 2
+MAX_WORD = 48
+CANDIDATES = 400
+SEGMENT = "MESSAGE_TABLE"
+
+LINE = re.compile(r'^([A-Z][A-Z0-9_]*)\s+"((?:[^"\\]|\\.)*)"\s*$')
+ESCAPES = {"n": "\n", "r": "\r", "t": "\t", '"': '"', "\\": "\\"}
+
+
+def unescape(text, where):
+    out = []
+    i = 0
+    while i < len(text):
+        if text[i] == "\\":
+            if text[i + 1] not in ESCAPES:
+                sys.exit("%s: unknown escape \\%s" % (where, text[i + 1]))
+            out.append(ESCAPES[text[i + 1]])
+            i += 2
+        else:
+            out.append(text[i])
+            i += 1
+    data = "".join(out).encode("ascii")
+    if not data or min(data) < 1 or max(data) > 0x7F:
+        sys.exit("%s: messages must be 7-bit ASCII with no NUL" % where)
+    return data
+
+
+def read_messages(path):
+    names = []
+    texts = []
+    with open(path) as source:
+        for number, line in enumerate(source, 1):
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            match = LINE.match(line)
+            if not match:
+                sys.exit("%s:%d: expected NAME \"text\"" % (path, number))
+            if match.group(1) in names:
+                sys.exit("%s:%d: %s defined twice" % (path, number, match.group(1)))
+            names.append(match.group(1))
+            texts.append(unescape(match.group(2), "%s:%d" % (path, number)))
+    return names, texts
+
+
+def occurrences(symbols, word):
+    """Non-overlapping matches of word among the literal runs of symbols."""
+    count = 0
+    i = 0
+    size = len(word)
+    while i + size <= len(symbols):
+        if tuple(symbols[i:i + size]) == word:
+            count += 1
+            i += size
+        else:
+            i += 1
+    return count
+
+
+def replace(symbols, word, token):
+    out = []
+    i = 0
+    size = len(word)
+    while i < len(symbols):
+        if tuple(symbols[i:i + size]) == word:
+            out.append(token)
+            i += size
+        else:
+            out.append(symbols[i])
+            i += 1
+    return out
+
+
+def build_dictionary(texts):
+    """Greedy dictionary; returns the words and the messages as symbol lists."""
+    messages = [list(text) for text in texts]
+    words = []
+    while len(words) < MAX_WORDS:
+        counts = collections.Counter()
+        for symbols in messages:
+            for start in range(len(symbols)):
+                if symbols[start] >= 0x80:
+                    continue
+                for end in range(start + MIN_WORD, min(start + MAX_WORD, len(symbols)) + 1):
+                    if symbols[end - 1] >= 0x80:
+                        break
+                    counts[tuple(symbols[start:end])] += 1
+        best = None
+        best_gain = 0
+        # Overlapping counts overstate the gain; check the likely ones exactly
+        ranked = sorted(counts.items(), key=lambda item: -item[1] * (len(item[0]) - 1))
+        for word, _ in ranked[:CANDIDATES]:
+            uses = sum(occurrences(symbols, word) for symbols in messages)
+            # Each use shrinks by len - 1; the entry costs its text, a NUL
+            # and a 2 byte offset
+            gain = uses * (len(word) - 1) - len(word) - 3
+            if gain > best_gain:
+                best, best_gain = word, gain
+        if best is None:
+            break
+        token = 0x80 + len(words)
+        messages = [replace(symbols, best, token) for symbols in messages]
+        words.append(bytes(best))
+    return words, [bytes(symbols) for symbols in messages]
+
+
+def pack(encoded):
+    """Lay out the NUL terminated messages, sharing equal texts and tails."""
+    blob = b""
+    offsets = {}
+    for text in sorted(set(encoded), key=lambda text: (-len(text), text)):
+        where = blob.find(text + b"\0")
+        if where < 0:
+            where = len(blob)
+            blob += text + b"\0"
+        offsets[text] = where
+    return blob, [offsets[text] for text in encoded]
+
+
+def count_uses(source_dir, names):
+    uses = collections.Counter()
+    for name in os.listdir(source_dir):
+        if name.endswith(".c") and name != "message_table.c":
+            with open(os.path.join(source_dir, name), encoding="latin-1") as source:
+                for match in re.finditer(r"\bMSG_([A-Z0-9_]+)\b", source.read()):
+                    uses[match.group(1)] += 1
+    return uses
+
+
+def c_bytes(data, indent="  "):
+    lines = []
+    for start in range(0, len(data), 12):
+        lines.append(indent + ", ".join("0x%02X" % b for b in data[start:start + 12]) + ",")
+    if lines:
+        lines[-1] = lines[-1][:-1]
+    return "\n".join(lines)
+
+
+def c_words(values, indent="  "):
+    lines = []
+    for start in range(0, len(values), 8):
+        lines.append(indent + ", ".join("%5u" % v for v in values[start:start + 8]) + ",")
+    if lines:
+        lines[-1] = lines[-1][:-1]
+    return "\n".join(lines)
+
+
+BANNER = """//*****************************************************************************
+//*****************************    C Source Code    ***************************
+//*****************************************************************************
+//
+// DESIGNER NAME: Kushal & Frank
+//
+//     FILE NAME: %s
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Generated by tools/messages_gen.py from messages.txt; don't edit.
+//    %s
+//
+//*****************************************************************************
+"""
+
+
+def write_header(path, names, words):
+    with open(path, "w", newline="\r\n") as out:
+        out.write(BANNER % ("message_table.h", "Message numbers for messages_print()."))
+        out.write("\n#ifndef _MESSAGE_TABLE_H_\n#define _MESSAGE_TABLE_H_\n\n")
+        out.write('#include "sys_types.h"\n\n')
+        width = max(len(name) for name in names) + 4
+        for number, name in enumerate(names):
+            out.write("#define %-*s %u\n" % (width, "MSG_" + name, number))
+        out.write("\n#define %-*s %u\n" % (width, "MESSAGES", len(names)))
+        out.write("#define %-*s %u\n\n" % (width, "MESSAGE_WORDS", max(len(words), 1)))
+        out.write("#pragma CONST_SEG __PPAGE_SEG %s\n" % SEGMENT)
+        out.write("extern const uint16 message_offsets[MESSAGES];\n")
+        out.write("extern const uint8  message_text[];\n")
+        out.write("extern const uint16 message_word_offsets[MESSAGE_WORDS];\n")
+        out.write("extern const uint8  message_words[];\n")
+        out.write("#pragma CONST_SEG DEFAULT\n\n")
+        out.write("#endif /* _MESSAGE_TABLE_H_ */\n")
+
+
+def layout_words(words):
+    blob = b""
+    offsets = []
+    for word in words:
+        offsets.append(len(blob))
+        blob += word + b"\0"
+    if not words:
+        offsets, blob = [0], b"\0"
+    return blob, offsets
+
+
+def decode(code, words):
+    """What messages_print() sends for an encoded message."""
+    return b"".join(words[b - 0x80] if b >= 0x80 else bytes([b]) for b in code)
+
+
+def write_source(path, blob, offsets, word_blob, word_offsets, report):
+    with open(path, "w", newline="\r\n") as out:
+        out.write(BANNER % ("message_table.c", report))
+        out.write('\n#include "message_table.h"\n\n')
+        out.write("#pragma CONST_SEG __PPAGE_SEG %s\n\n" % SEGMENT)
+        out.write("const uint16 message_offsets[MESSAGES] =\n{\n%s\n};\n\n" % c_words(offsets))
+        out.write("const uint8 message_text[%u] =\n{\n%s\n};\n\n" % (len(blob), c_bytes(blob)))
+        out.write("const uint16 message_word_offsets[MESSAGE_WORDS] =\n{\n%s\n};\n\n"
+                  % c_words(word_offsets))
+        out.write("const uint8 message_words[%u] =\n{\n%s\n};\n\n" % (len(word_blob), c_bytes(word_blob)))
+        out.write("#pragma CONST_SEG DEFAULT\n")
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--sources", default=os.path.join(here, "..", "Sources"),
+                        help="directory with messages.txt (default: ../Sources)")
+    args = parser.parse_args()
+
+    names, texts = read_messages(os.path.join(args.sources, "messages.txt"))
+    words, encoded = build_dictionary(texts)
+    blob, offsets = pack(encoded)
+    word_blob, word_offsets = layout_words(words)
+    uses = count_uses(args.sources, names)
+
+    for name, text, offset in zip(names, texts, offsets):
+        if decode(blob[offset:blob.index(b"\0", offset)], words) != text:
+            sys.exit("MSG_%s doesn't decode to its text" % name)
+
+    # A literal costs its text and NUL in non-banked flash for every use,
+    # unless the compiler happens to merge equal strings
+    literal = sum((len(text) + 1) * max(uses[name], 1) for name, text in zip(names, texts))
+    unpacked = sum(len(text) + 1 for text in set(texts))
+    table = len(blob) + 2 * len(offsets) + len(word_blob) + 2 * len(word_offsets)
+    report = "%u messages: %u bytes as literals, %u packed." % (len(names), literal, table)
+    write_source(os.path.join(args.sources, "message_table.c"),
+                 blob, offsets, word_blob, word_offsets, report)
+    write_header(os.path.join(args.sources, "message_table.h"), names, words)
+
+    print("%-24s %4s %8s %7s %6s" % ("message", "uses", "literal", "packed", "saved"))
+    for name, text, code in zip(names, texts, encoded):
+        before = (len(text) + 1) * max(uses[name], 1)
+        after = len(code) + 1 + 2
+        print("%-24s %4u %8u %7u %6d" % (name, uses[name], before, after, before - after))
+        if not uses[name]:
+            print("  warning: MSG_%s isn't used" % name, file=sys.stderr)
+    print()
+    print("banked page:  %5u bytes: text %u, offsets %u, %u dictionary words %u"
+          % (table, len(blob), 2 * len(offsets), len(words), len(word_blob) + 2 * len(word_offsets)))
+    print("non-banked:   %5u bytes of literals freed" % literal)
+    print("unique text:  %5u bytes, packed to %.0f%% with the dictionary"
+          % (unpacked, 100.0 * (len(blob) + len(word_blob)) / unpacked))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())